@@ -153,7 +153,8 @@ typedef enum
 typedef struct phOsalNfc_TimerHandle
 {
     uint32_t TimerId;                                   /* ID of the timer */
-    timer_t hTimerHandle;                               /* Handle of the timer */
+    uint64_t qwDeadline;                                /* Expiry time, CLOCK_MONOTONIC in ns */
+    uint32_t dwHeapPos;                                 /* Position + 1 in the deadline heap, 0 if not queued */
     pphOsalNfc_TimerCallbck_t   Application_callback;   /* Timer callback function to be invoked */
     void *pContext;                                     /* Parameter to be passed to the callback function */
     phOsalNfc_TimerStates_t eState;                     /* Timer states */
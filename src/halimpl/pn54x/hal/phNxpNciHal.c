@@ -23,9 +23,12 @@
 #include <phDnldNfc.h>
 #include <phDal4Nfc_messageQueueLib.h>
 #include <phNxpLog.h>
+#include <phNxpNciTrace.h>
 #include <phNxpConfig.h>
 #include <phNxpNciHal_NfcDepSWPrio.h>
 #include <phNxpNciHal_Kovio.h>
+#include <phNxpNciHal_SetConfig.h>
+#include <phNxpInitProfile.h>
 
 const char* product[] = {"UNKNOWN","PN547C3","PN65T","PN548C2","PN66T",
 "PN551","PN67T","PN553","PN80T","PN557","PN81T","INVALID"};
@@ -58,8 +61,6 @@ uint32_t wFwVerRsp;
 /* External global variable to get FW version */
 extern uint16_t wFwVer;
 extern int send_to_upper_kovio;
-extern int kovio_detected;
-extern int disable_kovio;
 
 /* (NFC_NXP_CHIP_TYPE == PN548C2) */
 extern uint8_t gRecFWDwnld;
@@ -68,6 +69,14 @@ static uint8_t gRecFwRetryCount; //variable to hold dummy FW recovery count
 
 static uint8_t Rx_data[NCI_MAX_DATA_LEN];
 
+/* Zero-copy receive: buffers lent by libnfc-nci through
+ * phNxpNciHal_set_rx_buf_cbacks. p_rx_buf_owner is non NULL while the HAL
+ * holds a lent buffer; p_rx_buf is where its data starts. */
+static nfc_stack_rx_buf_alloc_t *p_rx_buf_alloc;
+static nfc_stack_rx_buf_callback_t *p_rx_buf_cback;
+static void *p_rx_buf_owner;
+static uint8_t *p_rx_buf;
+
 uint32_t timeoutTimerId = 0;
 phNxpNciHal_Sem_t config_data;
 
@@ -79,7 +88,13 @@ phNxpNciRfSetting_t phNxpNciRfSet={0,};
 static NFCSTATUS phNxpNciHal_fw_download(void);
 static void phNxpNciHal_open_complete(NFCSTATUS status);
 static void phNxpNciHal_write_complete(void *pContext, phTmlNfc_TransactInfo_t *pInfo);
+static void phNxpNciHal_write_queued_complete(void *pContext, phTmlNfc_TransactInfo_t *pInfo);
+static int phNxpNciHal_write_queued(uint16_t data_len, const uint8_t *p_data);
+static int phNxpNciHal_write_cmd_data(void);
+static void phNxpNciHal_write_recovery(void);
 static void phNxpNciHal_read_complete(void *pContext, phTmlNfc_TransactInfo_t *pInfo);
+static uint8_t *phNxpNciHal_get_rx_buf(void);
+static void phNxpNciHal_give_rx_buf(uint16_t data_len);
 static void phNxpNciHal_close_complete(NFCSTATUS status);
 static void phNxpNciHal_core_initialized_complete(NFCSTATUS status);
 static void phNxpNciHal_pre_discover_complete(NFCSTATUS status);
@@ -95,7 +110,6 @@ static void phNxpNciHal_enable_i2c_fragmentation();
 NFCSTATUS phNxpNciHal_check_clock_config(void);
 NFCSTATUS phNxpNciHal_china_tianjin_rf_setting(void);
 static NFCSTATUS phNxpNciHalRFConfigCmdRecSequence ();
-static NFCSTATUS phNxpNciHal_CheckRFCmdRespStatus ();
 
 int  check_config_parameter();
 
@@ -438,13 +452,19 @@ int phNxpNciHal_open(nfc_stack_callback_t *p_cback, nfc_stack_data_callback_t *p
     char* nfc_dev_node = NULL;
     int init_retry_cnt=0;
     const uint16_t max_len = 260;
+    int phase;
 
     /* reset config cache */
+    phase = phNxpInitProfile_Begin("hal_config");
      resetNxpConfig();
 
     /* initialize trace level */
     phNxpLog_InitializeLogLevel();
 
+    /* map the binary NCI trace ring, if configured */
+    phNxpNciTrace_Init();
+    phNxpInitProfile_End(phase);
+
     /*Create the timer for extns write response*/
     timeoutTimerId = phOsalNfc_Timer_Create();
 
@@ -467,6 +487,15 @@ int phNxpNciHal_open(nfc_stack_callback_t *p_cback, nfc_stack_data_callback_t *p
     nxpncihal_ctrl.p_nfc_stack_cback = p_cback;
     nxpncihal_ctrl.p_nfc_stack_data_cback = p_data_cback;
 
+    /* Queue NCI data packets to TML instead of waiting for each write */
+    {
+        unsigned long num = 0;
+        if (GetNxpNumValue(NAME_NXP_ASYNC_DATA_WRITE, &num, sizeof(num)))
+        {
+            nxpncihal_ctrl.async_write = (num != 0) ? TRUE : FALSE;
+        }
+    }
+
     /* Configure hardware link */
     nxpncihal_ctrl.gDrvCfg.nClientId = phDal4Nfc_msgget(0, 0600);
     nxpncihal_ctrl.gDrvCfg.nLinkType = ENUM_LINK_TYPE_I2C;/* For PN54X */
@@ -498,8 +527,10 @@ int phNxpNciHal_open(nfc_stack_callback_t *p_cback, nfc_stack_data_callback_t *p
     tOsalConfig.pLogFile = NULL;
     tTmlConfig.dwGetMsgThreadId = (uintptr_t) nxpncihal_ctrl.gDrvCfg.nClientId;
 
-    /* Initialize TML layer */
+    /* Initialize TML layer, includes the NFCC hardware reset */
+    phase = phNxpInitProfile_Begin("tml_init");
     wConfigStatus = phTmlNfc_Init(&tTmlConfig);
+    phNxpInitProfile_End(phase);
     if (wConfigStatus != NFCSTATUS_SUCCESS)
     {
         NXPLOG_NCIHAL_E("phTmlNfc_Init Failed");
@@ -539,6 +570,7 @@ int phNxpNciHal_open(nfc_stack_callback_t *p_cback, nfc_stack_data_callback_t *p
         goto clean_and_return;
     }
 
+    phase = phNxpInitProfile_Begin("core_reset_init");
 init_retry:
 
     phNxpNciHal_ext_init();
@@ -579,8 +611,11 @@ init_retry:
         goto clean_and_return;
     }
     phNxpNciHal_enable_i2c_fragmentation();
+    phNxpInitProfile_End(phase);
     /*Get FW version from device*/
+    phase = phNxpInitProfile_Begin("fw_image_info");
     status = phDnldNfc_InitImgInfo();
+    phNxpInitProfile_End(phase);
     NXPLOG_NCIHAL_D ("FW version for FW file = 0x%x", wFwVer);
     NXPLOG_NCIHAL_D ("FW version from device = 0x%x", wFwVerRsp);
     if ((wFwVerRsp & 0x0000FFFF) == wFwVer)
@@ -622,6 +657,7 @@ force_download:
             {
                 wConfigStatus = NFCSTATUS_SUCCESS;
                 fw_download_success = 1;
+                phNxpNciHal_setConfig_invalidate();
                 /* call read pending */
                 status = phTmlNfc_Read(
                 nxpncihal_ctrl.p_cmd_data,
@@ -711,34 +747,56 @@ static void phNxpNciHal_open_complete(NFCSTATUS status)
  ******************************************************************************/
 int phNxpNciHal_write(uint16_t data_len, const uint8_t *p_data)
 {
-    NFCSTATUS status = NFCSTATUS_FAILED;
-    static phLibNfc_Message_t msg;
-
     /* Create local copy of cmd_data */
     memcpy(nxpncihal_ctrl.p_cmd_data, p_data, data_len);
     nxpncihal_ctrl.cmd_len = data_len;
 
-#ifdef P2P_PRIO_LOGIC_HAL_IMP
-    /* Specific logic to block RF disable when P2P priority logic is busy */
-    if (p_data[0] == 0x21&&
-        p_data[1] == 0x06 &&
-        p_data[2] == 0x01 &&
-        EnableP2P_PrioLogic == TRUE)
-    {
-        NXPLOG_NCIHAL_D ("P2P priority logic busy: Disable it.");
-        phNxpNciHal_clean_P2P_Prio();
-    }
-#endif
-    /* Specific logic to block RF disable when Kovio detection logic is active */
-    if (p_data[0] == 0x21&&
-        p_data[1] == 0x06 &&
-        p_data[2] == 0x01 &&
-        kovio_detected == TRUE)
+    return phNxpNciHal_write_cmd_data();
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_write_v
+ *
+ * Description      Same as phNxpNciHal_write, for an NCI packet given as a
+ *                  header and a payload. Both are gathered straight into the
+ *                  local copy of cmd_data, so the NFC stack does not need to
+ *                  build a contiguous packet for each fragment of its data.
+ *
+ * Returns          It returns number of bytes successfully written to NFCC.
+ *
+ ******************************************************************************/
+int phNxpNciHal_write_v(uint16_t hdr_len, const uint8_t *p_hdr,
+        uint16_t data_len, const uint8_t *p_data)
+{
+    if ((hdr_len + data_len) > sizeof(nxpncihal_ctrl.p_cmd_data))
     {
-        NXPLOG_NCIHAL_D ("Kovio detection logic is active: Set Flag to disable it.");
-        disable_kovio=0x01;
+        NXPLOG_NCIHAL_E("phNxpNciHal_write_v: packet too long (%d)", hdr_len + data_len);
+        return 0;
     }
 
+    /* Create local copy of cmd_data */
+    memcpy(nxpncihal_ctrl.p_cmd_data, p_hdr, hdr_len);
+    memcpy(nxpncihal_ctrl.p_cmd_data + hdr_len, p_data, data_len);
+    nxpncihal_ctrl.cmd_len = hdr_len + data_len;
+
+    return phNxpNciHal_write_cmd_data();
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_write_cmd_data
+ *
+ * Description      Sends the local copy of cmd_data, after the NXP extension
+ *                  processing, for phNxpNciHal_write and phNxpNciHal_write_v.
+ *
+ * Returns          It returns number of bytes successfully written to NFCC.
+ *
+ ******************************************************************************/
+static int phNxpNciHal_write_cmd_data(void)
+{
+    NFCSTATUS status = NFCSTATUS_FAILED;
+    static phLibNfc_Message_t msg;
+    int data_len = nxpncihal_ctrl.cmd_len;
+
     /* Check for NXP ext before sending write */
     status = phNxpNciHal_write_ext(&nxpncihal_ctrl.cmd_len,
             nxpncihal_ctrl.p_cmd_data, &nxpncihal_ctrl.rsp_len,
@@ -756,8 +814,19 @@ int phNxpNciHal_write(uint16_t data_len, const uint8_t *p_data)
     }
 
     CONCURRENCY_LOCK();
-    data_len = phNxpNciHal_write_unlocked(nxpncihal_ctrl.cmd_len,
-            nxpncihal_ctrl.p_cmd_data);
+    /* iCode EOF handling below relies on the data having been sent */
+    if ((nxpncihal_ctrl.async_write == TRUE) &&
+        ((nxpncihal_ctrl.p_cmd_data[0] & NXP_NCI_MT_MASK) == 0x00) &&
+        (icode_send_eof != 1))
+    {
+        data_len = phNxpNciHal_write_queued(nxpncihal_ctrl.cmd_len,
+                nxpncihal_ctrl.p_cmd_data);
+    }
+    else
+    {
+        data_len = phNxpNciHal_write_unlocked(nxpncihal_ctrl.cmd_len,
+                nxpncihal_ctrl.p_cmd_data);
+    }
     CONCURRENCY_UNLOCK();
 
     if (icode_send_eof == 1)
@@ -788,7 +857,6 @@ int phNxpNciHal_write_unlocked(uint16_t data_len, const uint8_t *p_data)
     NFCSTATUS status = NFCSTATUS_INVALID_PARAMETER;
     phNxpNciHal_Sem_t cb_data;
     nxpncihal_ctrl.retry_cnt = 0;
-    static uint8_t reset_ntf[] = {0x60, 0x00, 0x06, 0xA0, 0x00, 0xC7, 0xD4, 0x00, 0x00};
 
     /* Create the local semaphore */
     if (phNxpNciHal_init_cb_data(&cb_data, NULL) != NFCSTATUS_SUCCESS)
@@ -840,26 +908,7 @@ int phNxpNciHal_write_unlocked(uint16_t data_len, const uint8_t *p_data)
 
             NXPLOG_NCIHAL_E("write_unlocked failed - PN54X Maybe in Standby Mode (max count = 0x%x)", nxpncihal_ctrl.retry_cnt);
 
-            status = phTmlNfc_IoCtl(phTmlNfc_e_ResetDevice);
-
-            if(NFCSTATUS_SUCCESS == status)
-            {
-                NXPLOG_NCIHAL_D("PN54X Reset - SUCCESS\n");
-            }
-            else
-            {
-                NXPLOG_NCIHAL_D("PN54X Reset - FAILED\n");
-            }
-            if (nxpncihal_ctrl.p_nfc_stack_data_cback!= NULL &&
-                nxpncihal_ctrl.p_rx_data!= NULL &&
-                nxpncihal_ctrl.hal_open_status == TRUE)
-            {
-                NXPLOG_NCIHAL_D("Send the Core Reset NTF to upper layer, which will trigger the recovery\n");
-                //Send the Core Reset NTF to upper layer, which will trigger the recovery.
-                nxpncihal_ctrl.rx_data_len = sizeof(reset_ntf);
-                memcpy(nxpncihal_ctrl.p_rx_data, reset_ntf, sizeof(reset_ntf));
-                (*nxpncihal_ctrl.p_nfc_stack_data_cback)(nxpncihal_ctrl.rx_data_len, nxpncihal_ctrl.p_rx_data);
-            }
+            phNxpNciHal_write_recovery();
         }
     }
 
@@ -868,6 +917,113 @@ int phNxpNciHal_write_unlocked(uint16_t data_len, const uint8_t *p_data)
     return data_len;
 }
 
+/******************************************************************************
+ * Function         phNxpNciHal_write_queued
+ *
+ * Description      Asynchronous counterpart of phNxpNciHal_write_unlocked,
+ *                  used for NCI data packets when NXP_ASYNC_DATA_WRITE is
+ *                  set. The packet is copied into the TML write queue and
+ *                  the caller returns while I2C is still busy, so the NFC
+ *                  task can prepare the next fragment. Standby retries are
+ *                  done by the TML writer thread; a write that still fails
+ *                  is recovered from in phNxpNciHal_write_queued_complete.
+ *                  Falls back to a synchronous write when the queue is full,
+ *                  which also throttles the caller.
+ *
+ * Returns          It returns number of bytes queued or written to NFCC.
+ *
+ ******************************************************************************/
+static int phNxpNciHal_write_queued(uint16_t data_len, const uint8_t *p_data)
+{
+    NFCSTATUS status;
+
+    status = phTmlNfc_WriteQueued(p_data, data_len,
+            (pphTmlNfc_TransactCompletionCb_t) &phNxpNciHal_write_queued_complete,
+            NULL);
+    if (status != NFCSTATUS_PENDING)
+    {
+        NXPLOG_NCIHAL_D("write_queued status 0x%x - writing synchronously", status);
+        return phNxpNciHal_write_unlocked(data_len, p_data);
+    }
+
+    return data_len;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_write_queued_complete
+ *
+ * Description      This function handles the completion of a queued write.
+ *                  A write that failed even after the standby retries
+ *                  triggers the same recovery as phNxpNciHal_write_unlocked,
+ *                  once for a run of failed writes.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_write_queued_complete(void *pContext, phTmlNfc_TransactInfo_t *pInfo)
+{
+    /* Packets queued behind a failed one fail too; recover only once */
+    static uint8_t recovery_done = FALSE;
+    UNUSED(pContext);
+
+    if (pInfo->wStatus == NFCSTATUS_SUCCESS)
+    {
+        NXPLOG_NCIHAL_D("queued write successful status = 0x%x", pInfo->wStatus);
+        recovery_done = FALSE;
+    }
+    else
+    {
+        NXPLOG_NCIHAL_E("queued write failed - PN54X Maybe in Standby Mode, status = 0x%x",
+                pInfo->wStatus);
+        if (recovery_done == FALSE)
+        {
+            recovery_done = TRUE;
+            phNxpNciHal_write_recovery();
+        }
+    }
+
+    return;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_write_recovery
+ *
+ * Description      Resets the PN54X after a write kept failing and sends a
+ *                  CORE_RESET_NTF to the upper layer, which triggers the
+ *                  stack recovery.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_write_recovery(void)
+{
+    NFCSTATUS status;
+    static uint8_t reset_ntf[] = {0x60, 0x00, 0x06, 0xA0, 0x00, 0xC7, 0xD4, 0x00, 0x00};
+
+    status = phTmlNfc_IoCtl(phTmlNfc_e_ResetDevice);
+
+    if(NFCSTATUS_SUCCESS == status)
+    {
+        NXPLOG_NCIHAL_D("PN54X Reset - SUCCESS\n");
+    }
+    else
+    {
+        NXPLOG_NCIHAL_D("PN54X Reset - FAILED\n");
+    }
+    if (nxpncihal_ctrl.p_nfc_stack_data_cback!= NULL &&
+        nxpncihal_ctrl.p_rx_data!= NULL &&
+        nxpncihal_ctrl.hal_open_status == TRUE)
+    {
+        NXPLOG_NCIHAL_D("Send the Core Reset NTF to upper layer, which will trigger the recovery\n");
+        //Send the Core Reset NTF to upper layer, which will trigger the recovery.
+        nxpncihal_ctrl.rx_data_len = sizeof(reset_ntf);
+        memcpy(nxpncihal_ctrl.p_rx_data, reset_ntf, sizeof(reset_ntf));
+        (*nxpncihal_ctrl.p_nfc_stack_data_cback)(nxpncihal_ctrl.rx_data_len, nxpncihal_ctrl.p_rx_data);
+    }
+
+    return;
+}
+
 /******************************************************************************
  * Function         phNxpNciHal_write_complete
  *
@@ -945,8 +1101,18 @@ static void phNxpNciHal_read_complete(void *pContext, phTmlNfc_TransactInfo_t *p
         else if ((nxpncihal_ctrl.p_nfc_stack_data_cback != NULL) &&
                 (status == NFCSTATUS_SUCCESS)&&(send_to_upper_kovio==1))
         {
-            (*nxpncihal_ctrl.p_nfc_stack_data_cback)(
-                    nxpncihal_ctrl.rx_data_len, nxpncihal_ctrl.p_rx_data);
+            /* Read was done into a buffer lent by libnfc-nci: hand it over
+             * instead of the data callback */
+            if ((p_rx_buf != NULL) && (nxpncihal_ctrl.p_rx_data == p_rx_buf))
+            {
+                phNxpNciHal_give_rx_buf(nxpncihal_ctrl.rx_data_len);
+                nxpncihal_ctrl.p_rx_data = Rx_data;
+            }
+            else
+            {
+                (*nxpncihal_ctrl.p_nfc_stack_data_cback)(
+                        nxpncihal_ctrl.rx_data_len, nxpncihal_ctrl.p_rx_data);
+            }
         }
     }
     else if (pInfo->wStatus == NFCSTATUS_BOARD_COMMUNICATION_ERROR)
@@ -973,7 +1139,7 @@ static void phNxpNciHal_read_complete(void *pContext, phTmlNfc_TransactInfo_t *p
     }
     /* Read again because read must be pending always.*/
     status = phTmlNfc_Read(
-            Rx_data,
+            phNxpNciHal_get_rx_buf(),
             NCI_MAX_DATA_LEN,
             (pphTmlNfc_TransactCompletionCb_t) &phNxpNciHal_read_complete,
             NULL);
@@ -990,7 +1156,7 @@ void read_retry()
 {
     /* Read again because read must be pending always.*/
     NFCSTATUS status = phTmlNfc_Read(
-            Rx_data,
+            phNxpNciHal_get_rx_buf(),
             NCI_MAX_DATA_LEN,
             (pphTmlNfc_TransactCompletionCb_t) &phNxpNciHal_read_complete,
             NULL);
@@ -1000,6 +1166,82 @@ void read_retry()
         /* TODO: Not sure how to handle this ? */
     }
 }
+
+/******************************************************************************
+ * Function         phNxpNciHal_set_rx_buf_cbacks
+ *
+ * Description      This function is called by libnfc-nci to lend its own
+ *                  buffers for received NCI packets. TML then reads into them
+ *                  and they are handed back through p_cback, so a packet is
+ *                  not copied on its way up. Passing NULL reverts to
+ *                  Rx_data and the data callback. Only lend buffers while
+ *                  the data callback passed to phNxpNciHal_open leads to
+ *                  the same receiver as p_cback; call it while the HAL is
+ *                  closed.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+void phNxpNciHal_set_rx_buf_cbacks(nfc_stack_rx_buf_alloc_t *p_alloc,
+        nfc_stack_rx_buf_callback_t *p_cback)
+{
+    p_rx_buf_alloc = (p_cback != NULL) ? p_alloc : NULL;
+    p_rx_buf_cback = p_cback;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_get_rx_buf
+ *
+ * Description      This function returns the buffer for the next TML read:
+ *                  the lent buffer still held, else a new one from
+ *                  libnfc-nci, else Rx_data if none is available.
+ *
+ * Returns          pointer to a buffer of at least NCI_MAX_DATA_LEN bytes.
+ *
+ ******************************************************************************/
+static uint8_t *phNxpNciHal_get_rx_buf(void)
+{
+    void *p_owner = NULL;
+    uint8_t *p_buf;
+
+    if (__atomic_load_n(&p_rx_buf_owner, __ATOMIC_ACQUIRE) != NULL)
+    {
+        return p_rx_buf;
+    }
+    if (p_rx_buf_alloc != NULL)
+    {
+        p_buf = (*p_rx_buf_alloc)(NCI_MAX_DATA_LEN, &p_owner);
+        if (p_buf != NULL)
+        {
+            p_rx_buf = p_buf;
+            __atomic_store_n(&p_rx_buf_owner, p_owner, __ATOMIC_RELEASE);
+            return p_buf;
+        }
+    }
+    return Rx_data;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_give_rx_buf
+ *
+ * Description      This function gives the lent buffer back to libnfc-nci,
+ *                  holding data_len bytes of received data, or unused if
+ *                  data_len is 0. Safe to call when no buffer is held.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_give_rx_buf(uint16_t data_len)
+{
+    void *p_owner = __atomic_exchange_n(&p_rx_buf_owner, NULL, __ATOMIC_ACQ_REL);
+
+    if ((p_owner != NULL) && (p_rx_buf_cback != NULL))
+    {
+        p_rx_buf = NULL;
+        (*p_rx_buf_cback)(p_owner, data_len);
+    }
+}
+
 /******************************************************************************
  * Function         phNxpNciHal_core_initialized
  *
@@ -1027,6 +1269,7 @@ int phNxpNciHal_core_initialized(uint8_t* p_core_init_rsp_params)
     long bufflen = 260;
     long retlen = 0;
     int isfound;
+    uint8_t rsp_status;
     /* Temp fix to re-apply the proper clock setting */
      int temp_fix = 1;
 
@@ -1167,13 +1410,14 @@ retry_core_init:
 #endif
 
     phNxpNciHal_check_factory_reset();
+    phNxpNciHal_setConfig_begin();
     retlen = 0;
     config_access = TRUE;
     isfound = GetNxpByteArrayValue(NAME_NXP_NFC_PROFILE_EXTN, (char *) buffer,
             bufflen, &retlen);
     if (retlen > 0) {
         /* NXP ACT Proprietary Ext */
-        status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+        status = phNxpNciHal_setConfig_add(retlen, buffer, FALSE);
         if (status != NFCSTATUS_SUCCESS) {
             NXPLOG_NCIHAL_E("NXP ACT Proprietary Ext failed");
             retry_core_init_cnt++;
@@ -1199,7 +1443,7 @@ retry_core_init:
         					bufflen, &retlen);
         			if (retlen > 0)
         			{
-        				status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+        				status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
         				if (status != NFCSTATUS_SUCCESS)
         				{
         					NXPLOG_NCIHAL_E("EXT TVDD CFG 1 Settings failed");
@@ -1214,7 +1458,7 @@ retry_core_init:
         					bufflen, &retlen);
         			if (retlen > 0)
         			{
-        				status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+        				status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
         				if (status != NFCSTATUS_SUCCESS) {
         					NXPLOG_NCIHAL_E("EXT TVDD CFG 2 Settings failed");
         					retry_core_init_cnt++;
@@ -1228,7 +1472,7 @@ retry_core_init:
         					bufflen, &retlen);
         			if (retlen > 0)
         			{
-        				status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+        				status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
         				if (status != NFCSTATUS_SUCCESS)
         				{
         					NXPLOG_NCIHAL_E("EXT TVDD CFG 3 Settings failed");
@@ -1243,6 +1487,13 @@ retry_core_init:
         		}
 
         	}
+        	status = phNxpNciHal_setConfig_flush(NULL);
+        	if (status != NFCSTATUS_SUCCESS)
+        	{
+        		NXPLOG_NCIHAL_E("EXT TVDD CFG Settings failed");
+        		retry_core_init_cnt++;
+        		goto retry_core_init;
+        	}
         	config_access = FALSE;
         }
 
@@ -1253,7 +1504,7 @@ retry_core_init:
                 bufflen, &retlen);
         if (retlen > 0)
         {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+            status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
 
             if (status != NFCSTATUS_SUCCESS)
             {
@@ -1261,17 +1512,6 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
-            else if (nxpncihal_ctrl.nfcChipType == pn548C2)
-            {
-                status = phNxpNciHal_CheckRFCmdRespStatus ();
-                /*STATUS INVALID PARAM 0x09*/
-                if (status == 0x09)
-                {
-                    phNxpNciHalRFConfigCmdRecSequence ();
-                    retry_core_init_cnt++;
-                    goto retry_core_init;
-                }
-            }
         }
         retlen = 0;
 
@@ -1280,7 +1520,7 @@ retry_core_init:
                 bufflen, &retlen);
         if (retlen > 0)
         {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+            status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
 
             if (status != NFCSTATUS_SUCCESS)
             {
@@ -1288,17 +1528,6 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
-            else if (nxpncihal_ctrl.nfcChipType == pn548C2)
-            {
-                status = phNxpNciHal_CheckRFCmdRespStatus ();
-                /*STATUS INVALID PARAM 0x09*/
-                if (status == 0x09)
-                {
-                    phNxpNciHalRFConfigCmdRecSequence ();
-                    retry_core_init_cnt++;
-                    goto retry_core_init;
-                }
-            }
         }
         retlen = 0;
 
@@ -1307,24 +1536,13 @@ retry_core_init:
                 bufflen, &retlen);
         if (retlen > 0)
         {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+            status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
             if (status != NFCSTATUS_SUCCESS)
             {
                 NXPLOG_NCIHAL_E("RF Settings BLK 3 failed");
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
-            else if (nxpncihal_ctrl.nfcChipType == pn548C2)
-            {
-                status = phNxpNciHal_CheckRFCmdRespStatus ();
-                /*STATUS INVALID PARAM 0x09*/
-                if (status == 0x09)
-                {
-                    phNxpNciHalRFConfigCmdRecSequence ();
-                    retry_core_init_cnt++;
-                    goto retry_core_init;
-                }
-            }
         }
         retlen = 0;
 
@@ -1333,24 +1551,13 @@ retry_core_init:
                 bufflen, &retlen);
         if (retlen > 0)
         {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+            status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
             if (status != NFCSTATUS_SUCCESS)
             {
                 NXPLOG_NCIHAL_E("RF Settings BLK 4 failed");
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
-            else if (nxpncihal_ctrl.nfcChipType == pn548C2)
-            {
-                status = phNxpNciHal_CheckRFCmdRespStatus ();
-                /*STATUS INVALID PARAM 0x09*/
-                if (status == 0x09)
-                {
-                    phNxpNciHalRFConfigCmdRecSequence ();
-                    retry_core_init_cnt++;
-                    goto retry_core_init;
-                }
-            }
         }
         retlen = 0;
 
@@ -1358,24 +1565,13 @@ retry_core_init:
         isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_5, (char *) buffer,
                 bufflen, &retlen);
         if (retlen > 0) {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+            status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
             if (status != NFCSTATUS_SUCCESS)
             {
                 NXPLOG_NCIHAL_E("RF Settings BLK 5 failed");
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
-            else if (nxpncihal_ctrl.nfcChipType == pn548C2)
-            {
-                status = phNxpNciHal_CheckRFCmdRespStatus ();
-                /*STATUS INVALID PARAM 0x09*/
-                if (status == 0x09)
-                {
-                    phNxpNciHalRFConfigCmdRecSequence ();
-                    retry_core_init_cnt++;
-                    goto retry_core_init;
-                }
-            }
         }
         retlen = 0;
 
@@ -1384,28 +1580,32 @@ retry_core_init:
                 bufflen, &retlen);
         if (retlen > 0)
         {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+            status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
             if (status != NFCSTATUS_SUCCESS)
             {
                 NXPLOG_NCIHAL_E("RF Settings BLK 6 failed");
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
-            else if (nxpncihal_ctrl.nfcChipType == pn548C2)
-            {
-                status = phNxpNciHal_CheckRFCmdRespStatus ();
-                /*STATUS INVALID PARAM 0x09*/
-                if (status == 0x09)
-                {
-                    phNxpNciHalRFConfigCmdRecSequence ();
-                    retry_core_init_cnt++;
-                    goto retry_core_init;
-                }
-            }
         }
         retlen = 0;
         if (nxpncihal_ctrl.nfcChipType == pn548C2)
         {
+            /* RF settings are checked once the batch is applied */
+            status = phNxpNciHal_setConfig_flush(&rsp_status);
+            if (status != NFCSTATUS_SUCCESS)
+            {
+                NXPLOG_NCIHAL_E("RF Settings failed");
+                retry_core_init_cnt++;
+                goto retry_core_init;
+            }
+            /*STATUS INVALID PARAM 0x09*/
+            if (rsp_status == 0x09)
+            {
+                phNxpNciHalRFConfigCmdRecSequence ();
+                retry_core_init_cnt++;
+                goto retry_core_init;
+            }
             config_access = TRUE;
         }
 
@@ -1414,7 +1614,7 @@ retry_core_init:
                 (char *) buffer, bufflen, &retlen);
         if (retlen > 0) {
             /* NXP ACT Proprietary Ext */
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+            status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
             if (status != NFCSTATUS_SUCCESS) {
                 NXPLOG_NCIHAL_E("NXP Core configuration failed");
                 retry_core_init_cnt++;
@@ -1428,7 +1628,7 @@ retry_core_init:
                 (char *) buffer, bufflen, &retlen);
         if (retlen > 0) {
             /* NXP ACT Proprietary Ext */
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+            status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
             if (status != NFCSTATUS_SUCCESS) {
                 NXPLOG_NCIHAL_E("Setting mifare keys failed");
                 retry_core_init_cnt++;
@@ -1439,6 +1639,13 @@ retry_core_init:
         retlen = 0;
         if (nxpncihal_ctrl.nfcChipType == pn548C2)
         {
+            status = phNxpNciHal_setConfig_flush(NULL);
+            if (status != NFCSTATUS_SUCCESS)
+            {
+                NXPLOG_NCIHAL_E("NXP Core configuration failed");
+                retry_core_init_cnt++;
+                goto retry_core_init;
+            }
             config_access = FALSE;
         }
         isfound = GetNxpByteArrayValue(NAME_NXP_CORE_RF_FIELD,
@@ -1446,7 +1653,7 @@ retry_core_init:
         if (retlen > 0)
         {
             /* NXP ACT Proprietary Ext */
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+            status = phNxpNciHal_setConfig_add(retlen, buffer, TRUE);
 
             if (status != NFCSTATUS_SUCCESS)
             {
@@ -1454,22 +1661,25 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
-            else if (nxpncihal_ctrl.nfcChipType == pn548C2)
-            {
-                status = phNxpNciHal_CheckRFCmdRespStatus ();
-                /*STATUS INVALID PARAM 0x09*/
-                if (status == 0x09)
-                {
-                    phNxpNciHalRFConfigCmdRecSequence ();
-                    retry_core_init_cnt++;
-                    goto retry_core_init;
-                }
-            }
-
         }
 
         if (nxpncihal_ctrl.nfcChipType == pn548C2)
         {
+            /* RF settings are checked once the batch is applied */
+            status = phNxpNciHal_setConfig_flush(&rsp_status);
+            if (status != NFCSTATUS_SUCCESS)
+            {
+                NXPLOG_NCIHAL_E("Setting NXP_CORE_RF_FIELD status failed");
+                retry_core_init_cnt++;
+                goto retry_core_init;
+            }
+            /*STATUS INVALID PARAM 0x09*/
+            if (rsp_status == 0x09)
+            {
+                phNxpNciHalRFConfigCmdRecSequence ();
+                retry_core_init_cnt++;
+                goto retry_core_init;
+            }
             config_access = TRUE;
         }
 
@@ -1496,8 +1706,8 @@ retry_core_init:
                         swp_switch_timeout_cmd[8]=  ((timeoutHx & 0xFF00) >> 8);
                     }
 
-                    status = phNxpNciHal_send_ext_cmd (sizeof(swp_switch_timeout_cmd),
-                                                              swp_switch_timeout_cmd);
+                    status = phNxpNciHal_setConfig_add(sizeof(swp_switch_timeout_cmd),
+                                                              swp_switch_timeout_cmd, TRUE);
                     if (status != NFCSTATUS_SUCCESS)
                     {
                        NXPLOG_NCIHAL_E("SWP switch timeout Setting Failed");
@@ -1512,6 +1722,14 @@ retry_core_init:
 
             }
 
+            status = phNxpNciHal_setConfig_flush(NULL);
+            if (status != NFCSTATUS_SUCCESS)
+            {
+                NXPLOG_NCIHAL_E("SWP switch timeout Setting Failed");
+                retry_core_init_cnt++;
+                goto retry_core_init;
+            }
+
             status = phNxpNciHal_china_tianjin_rf_setting();
             if (status != NFCSTATUS_SUCCESS)
             {
@@ -1526,7 +1744,7 @@ retry_core_init:
     isfound = GetNxpByteArrayValue(NAME_NXP_CORE_STANDBY, (char *) buffer,bufflen, &retlen);
     if (retlen > 0) {
         /* NXP ACT Proprietary Ext */
-        status = phNxpNciHal_send_ext_cmd(retlen, buffer);
+        status = phNxpNciHal_setConfig_add(retlen, buffer, FALSE);
         if (status != NFCSTATUS_SUCCESS) {
             NXPLOG_NCIHAL_E("Stand by mode enable failed");
             retry_core_init_cnt++;
@@ -1539,7 +1757,7 @@ retry_core_init:
     if(retlen > 0)
     {
         /* NXP ACT Proprietary Ext */
-        status = phNxpNciHal_send_ext_cmd(retlen,buffer);
+        status = phNxpNciHal_setConfig_add(retlen, buffer, FALSE);
         if (status != NFCSTATUS_SUCCESS)
         {
             NXPLOG_NCIHAL_E("Core Set Config failed");
@@ -1548,6 +1766,14 @@ retry_core_init:
         }
     }
 
+    status = phNxpNciHal_setConfig_flush(NULL);
+    if (status != NFCSTATUS_SUCCESS)
+    {
+        NXPLOG_NCIHAL_E("Core Set Config failed");
+        retry_core_init_cnt++;
+        goto retry_core_init;
+    }
+
     config_access = FALSE;
     //if length of last command is 0 then only reset the P2P listen mode routing.
     if(p_core_init_rsp_params[35] == 0)
@@ -1738,6 +1964,7 @@ retry_core_init:
     }
 
     retry_core_init_cnt = 0;
+    phNxpNciHal_setConfig_end();
 
     if(buffer)
     {
@@ -1911,35 +2138,6 @@ NFCSTATUS phNxpNciHal_set_Boot_Mode(uint8_t mode) {
 
 
 
-/******************************************************************************
- * Function         phNxpNciHal_CheckRFCmdRespStatus
- *
- * Description      This function is called to check the resp status of
- *                  RF update commands.
- *
- * Returns          NFCSTATUS_SUCCESS           if successful,
- *                  NFCSTATUS_INVALID_PARAMETER if parameter is inavlid
- *                  NFCSTATUS_FAILED            if failed response
- *
- ******************************************************************************/
-NFCSTATUS phNxpNciHal_CheckRFCmdRespStatus ()
-{
-    NFCSTATUS status = NFCSTATUS_SUCCESS;
-    static uint16_t INVALID_PARAM = 0x09;
-    if ((nxpncihal_ctrl.rx_data_len > 0) && (nxpncihal_ctrl.p_rx_data[2] > 0))
-    {
-        if (nxpncihal_ctrl.p_rx_data[3] == 0x09)
-        {
-            status = INVALID_PARAM;
-        }
-        else if (nxpncihal_ctrl.p_rx_data[3] != NFCSTATUS_SUCCESS)
-        {
-            status = NFCSTATUS_FAILED;
-        }
-    }
-    return status;
-}
-
 /******************************************************************************
  * Function         phNxpNciHalRFConfigCmdRecSequence
  *
@@ -1976,6 +2174,7 @@ NFCSTATUS phNxpNciHalRFConfigCmdRecSequence ()
             if (status == NFCSTATUS_SUCCESS)
             {
                 fw_download_success = 1;
+                phNxpNciHal_setConfig_invalidate();
                 status = phTmlNfc_Read(
                     nxpncihal_ctrl.p_cmd_data,
                     NCI_MAX_DATA_LEN,
@@ -2113,6 +2312,8 @@ int phNxpNciHal_close(void)
         NXPLOG_NCIHAL_E ("NCI_CORE_RESET: Failed");
     }
 
+    phNxpNciHal_ext_dump_stats();
+
     if (NULL != gpphTmlNfc_Context->pDevHandle)
     {
         phNxpNciHal_close_complete(NFCSTATUS_SUCCESS);
@@ -2124,6 +2325,9 @@ int phNxpNciHal_close(void)
 
         status = phTmlNfc_Shutdown();
 
+        /* TML no longer reads into the lent buffer, give it back */
+        phNxpNciHal_give_rx_buf(0);
+
         phDal4Nfc_msgrelease(nxpncihal_ctrl.gDrvCfg.nClientId);
 
 
@@ -113,6 +113,12 @@ typedef struct phNxpNciHal_Control
     uint8_t read_retry_cnt;
     uint16_t retry_cnt;
 
+    /* NCI data packets are queued to TML instead of written synchronously */
+    uint8_t async_write;
+
+    /* Max Control Packet Payload Size of CORE_INIT_RSP */
+    uint8_t max_ctrl_payload;
+
     /* Rx data */
     uint16_t rx_data_len;
     uint8_t  *p_rx_data;
@@ -0,0 +1,619 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <phNxpNciHal_SetConfig.h>
+#include <phNxpNciHal_ext.h>
+#include <phNxpLog.h>
+#include <phNxpConfig.h>
+
+/* Kept next to the config timestamp file of phNxpConfig.cpp */
+#define SETCONFIG_CACHE_PATH        "/var/tmp/libnfc-nxp-setconfig-h1"
+#define SETCONFIG_CACHE_MAGIC       0x4E584343U     /* "NXCC" */
+#define SETCONFIG_CACHE_VERSION     1
+#define SETCONFIG_CACHE_MAX         256             /* parameters remembered */
+
+#define SETCONFIG_NCI_MAX_PAYLOAD   255
+#define SETCONFIG_MAX_TLV           64              /* TLVs in one pending command */
+#define SETCONFIG_HDR_LEN           4               /* 20 02 <len> <nb TLV> */
+
+#define SETCONFIG_PROP_ID           0xA0            /* first byte of NXP 2 byte IDs */
+#define SETCONFIG_RF_CLIF_CFG       0xA00D          /* one register per TLV */
+
+/* Parameter as remembered in the cache */
+typedef struct phNxpNciHal_SetConfigEntry
+{
+    uint32_t key;       /* ID << 16, plus the register for RF_CLIF_CFG */
+    uint32_t hash;      /* FNV-1a of length and value */
+} phNxpNciHal_SetConfigEntry_t;
+
+/* Cache file header, followed by <count> entries */
+typedef struct phNxpNciHal_SetConfigHdr
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t chip_type;     /* cache is only valid for the same NFCC ... */
+    uint32_t fw_version;    /* ... running the same FW */
+} phNxpNciHal_SetConfigHdr_t;
+
+typedef struct phNxpNciHal_SetConfig_Control
+{
+    uint8_t loaded;
+    uint8_t enabled;        /* NXP_SET_CONFIG_CACHE */
+    uint8_t dirty;          /* cache differs from the file */
+    uint8_t flushing;       /* pipeline is sending, do not forget */
+
+    phNxpNciHal_SetConfigHdr_t hdr;
+    phNxpNciHal_SetConfigEntry_t entry[SETCONFIG_CACHE_MAX];
+
+    /* Pending CORE_SET_CONFIG_CMD */
+    uint8_t cmd[SETCONFIG_HDR_LEN - 1 + SETCONFIG_NCI_MAX_PAYLOAD];
+    uint16_t cmd_len;
+    uint8_t nb_tlv;
+    phNxpNciHal_SetConfigEntry_t tlv[SETCONFIG_MAX_TLV];
+    bool_t tlv_persistent[SETCONFIG_MAX_TLV];
+    uint8_t rsp_status;     /* first error since the last explicit flush */
+
+    /* Statistics of the current initialization */
+    uint16_t nb_sent;
+    uint16_t nb_skipped;
+    uint16_t nb_cmd;
+} phNxpNciHal_SetConfig_Control_t;
+
+/******************* Global variables *****************************************/
+extern phNxpNciHal_Control_t nxpncihal_ctrl;
+extern uint32_t wFwVerRsp;
+
+static phNxpNciHal_SetConfig_Control_t setconfig_ctrl;
+
+static NFCSTATUS phNxpNciHal_setConfig_send(uint8_t *p_rsp_status);
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_hash
+**
+** Description      FNV-1a hash of a TLV length and value
+**
+*******************************************************************************/
+static uint32_t phNxpNciHal_setConfig_hash(const uint8_t *p_val, uint8_t len)
+{
+    uint32_t hash = 2166136261U;
+    uint8_t i;
+
+    hash = (hash ^ len) * 16777619U;
+    for (i = 0; i < len; i++)
+    {
+        hash = (hash ^ p_val[i]) * 16777619U;
+    }
+    return hash;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_next_tlv
+**
+** Description      Decodes the TLV at p_tlv
+**
+** Returns          Length of the TLV, 0 if it does not fit in len bytes
+**
+*******************************************************************************/
+static uint16_t phNxpNciHal_setConfig_next_tlv(const uint8_t *p_tlv, uint16_t len,
+        phNxpNciHal_SetConfigEntry_t *p_entry)
+{
+    uint16_t id;
+    uint16_t id_len = (p_tlv[0] == SETCONFIG_PROP_ID) ? 2 : 1;
+    uint8_t val_len;
+
+    if (len < id_len + 1)
+    {
+        return 0;
+    }
+    id = (id_len == 2) ? ((p_tlv[0] << 8) | p_tlv[1]) : p_tlv[0];
+    val_len = p_tlv[id_len];
+    if (len < id_len + 1 + val_len)
+    {
+        return 0;
+    }
+
+    p_entry->key = (uint32_t) id << 16;
+    if ((id == SETCONFIG_RF_CLIF_CFG) && (val_len >= 2))
+    {
+        p_entry->key |= (p_tlv[id_len + 1] << 8) | p_tlv[id_len + 2];
+    }
+    p_entry->hash = phNxpNciHal_setConfig_hash(&p_tlv[id_len + 1], val_len);
+
+    return id_len + 1 + val_len;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_find
+**
+** Description      Looks up a parameter in the cache
+**
+** Returns          Index of the entry, -1 if not cached
+**
+*******************************************************************************/
+static int phNxpNciHal_setConfig_find(uint32_t key)
+{
+    int i;
+
+    for (i = 0; i < setconfig_ctrl.hdr.count; i++)
+    {
+        if (setconfig_ctrl.entry[i].key == key)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_remove
+**
+** Description      Removes the cache entries for which (key & mask) matches
+**
+** Returns          TRUE if an entry was removed
+**
+*******************************************************************************/
+static bool_t phNxpNciHal_setConfig_remove(uint32_t key, uint32_t mask)
+{
+    bool_t removed = FALSE;
+    int i = 0;
+
+    while (i < setconfig_ctrl.hdr.count)
+    {
+        if ((setconfig_ctrl.entry[i].key & mask) == (key & mask))
+        {
+            setconfig_ctrl.entry[i] = setconfig_ctrl.entry[--setconfig_ctrl.hdr.count];
+            removed = TRUE;
+        }
+        else
+        {
+            i++;
+        }
+    }
+    if (removed)
+    {
+        setconfig_ctrl.dirty = TRUE;
+    }
+    return removed;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_save
+**
+** Description      Writes the cache file if it changed
+**
+*******************************************************************************/
+static void phNxpNciHal_setConfig_save(void)
+{
+    const char tmp_path[] = SETCONFIG_CACHE_PATH ".tmp";
+    size_t size;
+    int fd;
+
+    if (!setconfig_ctrl.enabled || !setconfig_ctrl.dirty)
+    {
+        return;
+    }
+
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        NXPLOG_NCIHAL_E("SetConfig cache: cannot create %s, errno %d", tmp_path, errno);
+        return;
+    }
+    size = sizeof(setconfig_ctrl.hdr) +
+            setconfig_ctrl.hdr.count * sizeof(phNxpNciHal_SetConfigEntry_t);
+    if ((write(fd, &setconfig_ctrl.hdr, sizeof(setconfig_ctrl.hdr)) != sizeof(setconfig_ctrl.hdr)) ||
+        (write(fd, setconfig_ctrl.entry, size - sizeof(setconfig_ctrl.hdr)) !=
+                (ssize_t) (size - sizeof(setconfig_ctrl.hdr))) ||
+        (fsync(fd) != 0))
+    {
+        NXPLOG_NCIHAL_E("SetConfig cache: write failed, errno %d", errno);
+        close(fd);
+        unlink(tmp_path);
+        return;
+    }
+    close(fd);
+    if (rename(tmp_path, SETCONFIG_CACHE_PATH) != 0)
+    {
+        NXPLOG_NCIHAL_E("SetConfig cache: rename failed, errno %d", errno);
+        unlink(tmp_path);
+        return;
+    }
+    setconfig_ctrl.dirty = FALSE;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_load
+**
+** Description      Reads NXP_SET_CONFIG_CACHE and the cache file, once
+**
+*******************************************************************************/
+static void phNxpNciHal_setConfig_load(void)
+{
+    unsigned long num = 1;
+    ssize_t size;
+    int fd;
+
+    if (setconfig_ctrl.loaded)
+    {
+        return;
+    }
+    setconfig_ctrl.loaded = TRUE;
+    setconfig_ctrl.dirty = FALSE;
+    setconfig_ctrl.hdr.count = 0;
+
+    if (GetNxpNumValue(NAME_NXP_SET_CONFIG_CACHE, &num, sizeof(num)) && (num == 0))
+    {
+        NXPLOG_NCIHAL_D("SetConfig cache disabled");
+        setconfig_ctrl.enabled = FALSE;
+        return;
+    }
+    setconfig_ctrl.enabled = TRUE;
+
+    fd = open(SETCONFIG_CACHE_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+    size = read(fd, &setconfig_ctrl.hdr, sizeof(setconfig_ctrl.hdr));
+    if ((size != sizeof(setconfig_ctrl.hdr)) ||
+        (setconfig_ctrl.hdr.magic != SETCONFIG_CACHE_MAGIC) ||
+        (setconfig_ctrl.hdr.version != SETCONFIG_CACHE_VERSION) ||
+        (setconfig_ctrl.hdr.count > SETCONFIG_CACHE_MAX))
+    {
+        setconfig_ctrl.hdr.count = 0;
+    }
+    else
+    {
+        size = read(fd, setconfig_ctrl.entry,
+                setconfig_ctrl.hdr.count * sizeof(phNxpNciHal_SetConfigEntry_t));
+        if (size != (ssize_t) (setconfig_ctrl.hdr.count * sizeof(phNxpNciHal_SetConfigEntry_t)))
+        {
+            setconfig_ctrl.hdr.count = 0;
+        }
+    }
+    close(fd);
+    NXPLOG_NCIHAL_D("SetConfig cache: %d parameters loaded", setconfig_ctrl.hdr.count);
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_begin
+**
+** Description      Starts the configuration of the NFCC: drops any pending
+**                  TLV and checks the cache was made for the NFCC and FW
+**                  reported by the last CORE_INIT_RSP.
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpNciHal_setConfig_begin(void)
+{
+    phNxpNciHal_setConfig_load();
+
+    if ((setconfig_ctrl.hdr.magic != SETCONFIG_CACHE_MAGIC) ||
+        (setconfig_ctrl.hdr.version != SETCONFIG_CACHE_VERSION) ||
+        (setconfig_ctrl.hdr.chip_type != (uint32_t) nxpncihal_ctrl.nfcChipType) ||
+        (setconfig_ctrl.hdr.fw_version != wFwVerRsp))
+    {
+        if (setconfig_ctrl.hdr.count != 0)
+        {
+            NXPLOG_NCIHAL_D("SetConfig cache: NFCC or FW changed, cache cleared");
+        }
+        setconfig_ctrl.hdr.magic = SETCONFIG_CACHE_MAGIC;
+        setconfig_ctrl.hdr.version = SETCONFIG_CACHE_VERSION;
+        setconfig_ctrl.hdr.count = 0;
+        setconfig_ctrl.hdr.chip_type = nxpncihal_ctrl.nfcChipType;
+        setconfig_ctrl.hdr.fw_version = wFwVerRsp;
+        setconfig_ctrl.dirty = TRUE;
+    }
+
+    setconfig_ctrl.nb_tlv = 0;
+    setconfig_ctrl.cmd_len = SETCONFIG_HDR_LEN;
+    setconfig_ctrl.rsp_status = NFCSTATUS_SUCCESS;
+    setconfig_ctrl.nb_sent = 0;
+    setconfig_ctrl.nb_skipped = 0;
+    setconfig_ctrl.nb_cmd = 0;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_add
+**
+** Description      Queues the TLVs of a CORE_SET_CONFIG_CMD. Persistent
+**                  proprietary parameters the NFCC already holds are dropped.
+**                  Any other command is sent right away, after the pending
+**                  TLVs.
+**
+** Parameters       cmd_len    - length of p_cmd
+**                  p_cmd      - NCI command
+**                  persistent - TLVs are stored in the NFCC EEPROM
+**
+** Returns          NFCSTATUS_SUCCESS, NFCSTATUS_FAILED if a command could not
+**                  be sent
+**
+*******************************************************************************/
+NFCSTATUS phNxpNciHal_setConfig_add(uint16_t cmd_len, uint8_t *p_cmd, bool_t persistent)
+{
+    phNxpNciHal_SetConfigEntry_t tlv;
+    NFCSTATUS status;
+    uint16_t offset;
+    uint16_t tlv_len;
+    uint8_t nb;
+    uint8_t i;
+    int idx;
+
+    /* Only well formed CORE_SET_CONFIG_CMDs are merged */
+    if ((cmd_len >= SETCONFIG_HDR_LEN) && (p_cmd[0] == 0x20) && (p_cmd[1] == 0x02) &&
+        (p_cmd[2] == cmd_len - 3))
+    {
+        for (nb = 0, offset = SETCONFIG_HDR_LEN; offset < cmd_len; nb++, offset += tlv_len)
+        {
+            tlv_len = phNxpNciHal_setConfig_next_tlv(&p_cmd[offset], cmd_len - offset, &tlv);
+            if (tlv_len == 0)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        nb = 0;
+        offset = 0;
+    }
+    if ((offset != cmd_len) || (nb != p_cmd[3]))
+    {
+        status = phNxpNciHal_setConfig_send(NULL);
+        if (status == NFCSTATUS_SUCCESS)
+        {
+            status = phNxpNciHal_send_ext_cmd(cmd_len, p_cmd);
+        }
+        return status;
+    }
+
+    for (offset = SETCONFIG_HDR_LEN; offset < cmd_len; offset += tlv_len)
+    {
+        tlv_len = phNxpNciHal_setConfig_next_tlv(&p_cmd[offset], cmd_len - offset, &tlv);
+
+        if (persistent && setconfig_ctrl.enabled && (p_cmd[offset] == SETCONFIG_PROP_ID))
+        {
+            idx = phNxpNciHal_setConfig_find(tlv.key);
+            if ((idx >= 0) && (setconfig_ctrl.entry[idx].hash == tlv.hash))
+            {
+                setconfig_ctrl.nb_skipped++;
+                continue;
+            }
+        }
+
+        /* A parameter set twice keeps the order of the two commands */
+        for (i = 0; i < setconfig_ctrl.nb_tlv; i++)
+        {
+            if (setconfig_ctrl.tlv[i].key == tlv.key)
+            {
+                break;
+            }
+        }
+        if ((i < setconfig_ctrl.nb_tlv) ||
+            (setconfig_ctrl.nb_tlv == SETCONFIG_MAX_TLV) ||
+            (setconfig_ctrl.cmd_len + tlv_len - 3 > nxpncihal_ctrl.max_ctrl_payload))
+        {
+            status = phNxpNciHal_setConfig_send(NULL);
+            if (status != NFCSTATUS_SUCCESS)
+            {
+                return status;
+            }
+        }
+
+        memcpy(&setconfig_ctrl.cmd[setconfig_ctrl.cmd_len], &p_cmd[offset], tlv_len);
+        setconfig_ctrl.cmd_len += tlv_len;
+        setconfig_ctrl.tlv[setconfig_ctrl.nb_tlv] = tlv;
+        setconfig_ctrl.tlv_persistent[setconfig_ctrl.nb_tlv] =
+                persistent && (p_cmd[offset] == SETCONFIG_PROP_ID);
+        setconfig_ctrl.nb_tlv++;
+    }
+
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_send
+**
+** Description      Sends the pending TLVs as one CORE_SET_CONFIG_CMD and
+**                  updates the cache from the response
+**
+** Returns          NFCSTATUS_SUCCESS if nothing was pending or a response was
+**                  received, else NFCSTATUS_FAILED
+**
+*******************************************************************************/
+static NFCSTATUS phNxpNciHal_setConfig_send(uint8_t *p_rsp_status)
+{
+    NFCSTATUS status;
+    uint8_t rsp_status;
+    uint8_t i;
+    int idx;
+
+    if (setconfig_ctrl.nb_tlv == 0)
+    {
+        return NFCSTATUS_SUCCESS;
+    }
+
+    setconfig_ctrl.cmd[0] = 0x20;
+    setconfig_ctrl.cmd[1] = 0x02;
+    setconfig_ctrl.cmd[2] = setconfig_ctrl.cmd_len - 3;
+    setconfig_ctrl.cmd[3] = setconfig_ctrl.nb_tlv;
+
+    setconfig_ctrl.flushing = TRUE;
+    status = phNxpNciHal_send_ext_cmd(setconfig_ctrl.cmd_len, setconfig_ctrl.cmd);
+    setconfig_ctrl.flushing = FALSE;
+    setconfig_ctrl.nb_cmd++;
+    setconfig_ctrl.nb_sent += setconfig_ctrl.nb_tlv;
+
+    if (status == NFCSTATUS_SUCCESS)
+    {
+        rsp_status = NFCSTATUS_FAILED;
+        if ((nxpncihal_ctrl.rx_data_len > 3) && (nxpncihal_ctrl.p_rx_data[2] > 0))
+        {
+            rsp_status = nxpncihal_ctrl.p_rx_data[3];
+        }
+        if (p_rsp_status != NULL)
+        {
+            *p_rsp_status = rsp_status;
+        }
+        if ((rsp_status != NFCSTATUS_SUCCESS) && (setconfig_ctrl.rsp_status == NFCSTATUS_SUCCESS))
+        {
+            setconfig_ctrl.rsp_status = rsp_status;
+        }
+
+        for (i = 0; i < setconfig_ctrl.nb_tlv; i++)
+        {
+            if ((rsp_status == NFCSTATUS_SUCCESS) && setconfig_ctrl.tlv_persistent[i])
+            {
+                idx = phNxpNciHal_setConfig_find(setconfig_ctrl.tlv[i].key);
+                if ((idx < 0) && (setconfig_ctrl.hdr.count < SETCONFIG_CACHE_MAX))
+                {
+                    idx = setconfig_ctrl.hdr.count++;
+                }
+                if (idx >= 0)
+                {
+                    setconfig_ctrl.entry[idx] = setconfig_ctrl.tlv[i];
+                    setconfig_ctrl.dirty = TRUE;
+                }
+            }
+            else
+            {
+                /* NFCC value is not known any more */
+                phNxpNciHal_setConfig_remove(setconfig_ctrl.tlv[i].key, 0xFFFFFFFFU);
+            }
+        }
+    }
+
+    setconfig_ctrl.nb_tlv = 0;
+    setconfig_ctrl.cmd_len = SETCONFIG_HDR_LEN;
+    return status;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_flush
+**
+** Description      Sends the pending TLVs
+**
+** Parameters       p_rsp_status - if not NULL, receives the first error status
+**                                 of a CORE_SET_CONFIG_RSP since the last
+**                                 flush, NFCSTATUS_SUCCESS if none
+**
+** Returns          NFCSTATUS_SUCCESS, NFCSTATUS_FAILED if a command could not
+**                  be sent
+**
+*******************************************************************************/
+NFCSTATUS phNxpNciHal_setConfig_flush(uint8_t *p_rsp_status)
+{
+    NFCSTATUS status = phNxpNciHal_setConfig_send(NULL);
+
+    if (p_rsp_status != NULL)
+    {
+        *p_rsp_status = setconfig_ctrl.rsp_status;
+    }
+    setconfig_ctrl.rsp_status = NFCSTATUS_SUCCESS;
+    return status;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_end
+**
+** Description      Ends a successful configuration of the NFCC and saves the
+**                  cache
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpNciHal_setConfig_end(void)
+{
+    NXPLOG_NCIHAL_D("SetConfig: %d parameters sent in %d commands, %d already set",
+            setconfig_ctrl.nb_sent, setconfig_ctrl.nb_cmd, setconfig_ctrl.nb_skipped);
+    phNxpNciHal_setConfig_save();
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_forget
+**
+** Description      Called for a CORE_SET_CONFIG_CMD sent outside of the
+**                  pipeline: the cached values of its parameters are dropped.
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpNciHal_setConfig_forget(const uint8_t *p_cmd, uint16_t cmd_len)
+{
+    phNxpNciHal_SetConfigEntry_t tlv;
+    bool_t removed = FALSE;
+    uint16_t offset;
+    uint16_t tlv_len;
+
+    if (setconfig_ctrl.flushing || !setconfig_ctrl.loaded || (setconfig_ctrl.hdr.count == 0))
+    {
+        return;
+    }
+
+    for (offset = SETCONFIG_HDR_LEN; offset < cmd_len; offset += tlv_len)
+    {
+        tlv_len = phNxpNciHal_setConfig_next_tlv(&p_cmd[offset], cmd_len - offset, &tlv);
+        if (tlv_len == 0)
+        {
+            break;
+        }
+        if (phNxpNciHal_setConfig_remove(tlv.key, 0xFFFF0000U))
+        {
+            removed = TRUE;
+        }
+    }
+    if (removed)
+    {
+        phNxpNciHal_setConfig_save();
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_setConfig_invalidate
+**
+** Description      Forgets all cached values, e.g. after a FW download
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpNciHal_setConfig_invalidate(void)
+{
+    phNxpNciHal_setConfig_load();
+    if (setconfig_ctrl.hdr.count != 0)
+    {
+        setconfig_ctrl.hdr.count = 0;
+        setconfig_ctrl.dirty = TRUE;
+        phNxpNciHal_setConfig_save();
+    }
+}
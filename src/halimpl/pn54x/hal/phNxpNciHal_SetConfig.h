@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _PHNXPNCIHAL_SETCONFIG_H_
+#define _PHNXPNCIHAL_SETCONFIG_H_
+
+#include <phNxpNciHal.h>
+
+/*
+ * CORE_SET_CONFIG pipeline used while the HAL configures the NFCC.
+ *
+ * The TLVs of consecutive CORE_SET_CONFIG_CMDs are merged into as few
+ * commands as the NFCC control packet size allows. Any other command flushes
+ * the pending TLVs first, so the NFCC sees the settings in the same order.
+ *
+ * NXP proprietary parameters (ID A0xx) are kept in the NFCC EEPROM. Those
+ * added as persistent are remembered, with a hash of their value, once the
+ * NFCC accepted them; the list is saved next to the config timestamp file and
+ * an unchanged parameter is not sent again on the next initialization. A
+ * parameter set outside of the pipeline is forgotten.
+ */
+
+void phNxpNciHal_setConfig_begin(void);
+NFCSTATUS phNxpNciHal_setConfig_add(uint16_t cmd_len, uint8_t *p_cmd, bool_t persistent);
+NFCSTATUS phNxpNciHal_setConfig_flush(uint8_t *p_rsp_status);
+void phNxpNciHal_setConfig_end(void);
+void phNxpNciHal_setConfig_forget(const uint8_t *p_cmd, uint16_t cmd_len);
+void phNxpNciHal_setConfig_invalidate(void);
+
+#endif /* _PHNXPNCIHAL_SETCONFIG_H_ */
@@ -19,6 +19,7 @@
 #include <phDal4Nfc_messageQueueLib.h>
 #include <phNxpNciHal_NfcDepSWPrio.h>
 #include <phNxpNciHal_Kovio.h>
+#include <phNxpNciHal_SetConfig.h>
 #include <phNxpLog.h>
 #include <phNxpConfig.h>
 
@@ -36,7 +37,6 @@ extern int send_to_upper_kovio;
 extern uint32_t cleanup_timer;
 static uint8_t icode_detected = 0x00;
 uint8_t icode_send_eof = 0x00;
-static uint8_t ee_disc_done = 0x00;
 uint8_t EnableP2P_PrioLogic = FALSE;
 static uint32_t RfDiscID = 1;
 static uint32_t RfProtocolType = 4;
@@ -69,6 +69,254 @@ static void hal_extns_write_rsp_timeout_cb(uint32_t TimerId, void *pContext);
 #define PROPRIETARY_CMD_FELICA_READER_MODE 0xFE
 static uint8_t gFelicaReaderMode;
 
+/*
+ * HAL extension dispatch table.
+ *
+ * Every workaround applied to an outgoing command (phNxpNciHal_write_ext) or
+ * to an incoming response/notification/data packet (phNxpNciHal_process_ext_rsp)
+ * is a handler registered for the (MT, GID, OID) of the packets it touches.
+ * Data packets are keyed on MT only, all connections share one bucket.
+ *
+ * phNxpNciHal_ext_register() compiles the handlers whose enable condition
+ * holds (chip type, configuration) into one bucket per MT/GID and direction,
+ * so a packet is only tested against the handlers of its own key. Handlers of
+ * a key run in table order; the first one not returning NFCSTATUS_SUCCESS ends
+ * the dispatch and its status is returned to the caller.
+ */
+typedef NFCSTATUS (*phNxpNciHal_ExtHandlerFn_t)(uint8_t *p_data, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+
+typedef enum
+{
+    EXT_TX,                 /* command/data sent to the NFCC */
+    EXT_RX                  /* response/notification/data from the NFCC */
+} phNxpNciHal_ExtDir_t;
+
+typedef enum
+{
+    EXT_EN_ALWAYS,          /* always registered */
+    EXT_EN_PN547C2,         /* PN547C2 only */
+    EXT_EN_MIFARE_READER    /* PN547C2 with MIFARE_READER_ENABLE=1 */
+} phNxpNciHal_ExtEnable_t;
+
+typedef struct
+{
+    phNxpNciHal_ExtDir_t        dir;
+    uint8_t                     mt_gid;     /* first header byte, PBF clear */
+    uint8_t                     oid;        /* EXT_ANY_OID for data packets */
+    phNxpNciHal_ExtEnable_t     enable;
+    phNxpNciHal_ExtHandlerFn_t  fn;
+    const char                  *name;
+} phNxpNciHal_ExtHandler_t;
+
+#define EXT_ANY_OID                 0xFF
+#define EXT_NB_KEYS                 128     /* MT (3 bits) x GID (4 bits) */
+#define EXT_MAX_HANDLERS_PER_KEY    8
+
+typedef struct
+{
+    uint8_t count;
+    uint8_t handler[EXT_MAX_HANDLERS_PER_KEY];  /* index in ext_handlers[] */
+} phNxpNciHal_ExtBucket_t;
+
+static NFCSTATUS ext_kovio_rf_deactivate(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+#ifdef P2P_PRIO_LOGIC_HAL_IMP
+static NFCSTATUS ext_p2p_prio_rf_deactivate(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+#endif
+static NFCSTATUS ext_nfcdep_poll_store(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_setconfig_forget(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_dta_update(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_felica_reader_mode(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_profile_select(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_emvco_discover_map(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_polling_loop_start(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_mifare_discover_map(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_nfcee_discover(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_dirty_set_config(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_set_host_list(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_icode_cmd(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+
+static NFCSTATUS ext_emvco_nfcdep_restart(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_felica_t3t_ntf(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+#ifdef P2P_PRIO_LOGIC_HAL_IMP
+static NFCSTATUS ext_p2p_prio_ntf(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+#endif
+static NFCSTATUS ext_intf_activated_log(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_icode_activated(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_mifare_sak(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_kovio_ntf(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_icode_data(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_icode_deactivated(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_core_init_rsp(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_cleanup_discover_ntf(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_cleanup_select_rsp(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+static NFCSTATUS ext_core_reset_ntf(uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data);
+
+static const phNxpNciHal_ExtHandler_t ext_handlers[] =
+{
+    /* Commands and data to the NFCC */
+    { EXT_TX, 0x21, 0x06, EXT_EN_ALWAYS, ext_kovio_rf_deactivate, "kovio_rf_deactivate" },
+#ifdef P2P_PRIO_LOGIC_HAL_IMP
+    { EXT_TX, 0x21, 0x06, EXT_EN_ALWAYS, ext_p2p_prio_rf_deactivate, "p2p_prio_rf_deactivate" },
+#endif
+    { EXT_TX, 0x21, 0x03, EXT_EN_ALWAYS, ext_nfcdep_poll_store, "nfcdep_poll_store" },
+    { EXT_TX, 0x20, 0x02, EXT_EN_ALWAYS, ext_setconfig_forget, "setconfig_forget" },
+    { EXT_TX, 0x20, 0x02, EXT_EN_ALWAYS, ext_dta_update, "dta_set_config" },
+    { EXT_TX, 0x21, 0x03, EXT_EN_ALWAYS, ext_dta_update, "dta_discover" },
+    { EXT_TX, 0x21, 0x08, EXT_EN_ALWAYS, ext_dta_update, "dta_listen_mode_routing" },
+    { EXT_TX, PROPRIETARY_CMD_FELICA_READER_MODE, PROPRIETARY_CMD_FELICA_READER_MODE & NXP_NCI_OID_MASK,
+              EXT_EN_ALWAYS, ext_felica_reader_mode, "felica_reader_mode" },
+    { EXT_TX, 0x20, 0x02, EXT_EN_ALWAYS, ext_profile_select, "profile_select" },
+    { EXT_TX, 0x21, 0x03, EXT_EN_ALWAYS, ext_emvco_discover_map, "emvco_discover" },
+    { EXT_TX, 0x21, 0x03, EXT_EN_ALWAYS, ext_polling_loop_start, "polling_loop_start" },
+    { EXT_TX, 0x21, 0x00, EXT_EN_MIFARE_READER, ext_mifare_discover_map, "mifare_discover_map" },
+    { EXT_TX, 0x22, 0x00, EXT_EN_ALWAYS, ext_nfcee_discover, "nfcee_discover" },
+    { EXT_TX, 0x20, 0x02, EXT_EN_ALWAYS, ext_dirty_set_config, "dirty_set_config" },
+    { EXT_TX, 0x00, EXT_ANY_OID, EXT_EN_ALWAYS, ext_set_host_list, "set_host_list" },
+    { EXT_TX, 0x00, EXT_ANY_OID, EXT_EN_ALWAYS, ext_icode_cmd, "icode_cmd" },
+
+    /* Responses, notifications and data from the NFCC */
+    { EXT_RX, 0x61, 0x05, EXT_EN_ALWAYS, ext_emvco_nfcdep_restart, "emvco_nfcdep_restart" },
+    { EXT_RX, 0x61, 0x05, EXT_EN_ALWAYS, ext_felica_t3t_ntf, "felica_t3t_ntf" },
+#ifdef P2P_PRIO_LOGIC_HAL_IMP
+    { EXT_RX, 0x61, 0x05, EXT_EN_ALWAYS, ext_p2p_prio_ntf, "p2p_prio_intf_activated" },
+    { EXT_RX, 0x61, 0x06, EXT_EN_ALWAYS, ext_p2p_prio_ntf, "p2p_prio_deactivate_ntf" },
+    { EXT_RX, 0x41, 0x06, EXT_EN_ALWAYS, ext_p2p_prio_ntf, "p2p_prio_deactivate_rsp" },
+    { EXT_RX, 0x41, 0x04, EXT_EN_ALWAYS, ext_p2p_prio_ntf, "p2p_prio_select_rsp" },
+#endif
+    { EXT_RX, 0x61, 0x05, EXT_EN_ALWAYS, ext_intf_activated_log, "intf_activated_log" },
+    { EXT_RX, 0x61, 0x05, EXT_EN_ALWAYS, ext_icode_activated, "icode_activated" },
+    { EXT_RX, 0x61, 0x05, EXT_EN_PN547C2, ext_mifare_sak, "mifare_sak" },
+    { EXT_RX, 0x61, 0x05, EXT_EN_ALWAYS, ext_kovio_ntf, "kovio_intf_activated" },
+    { EXT_RX, 0x41, 0x06, EXT_EN_ALWAYS, ext_kovio_ntf, "kovio_deactivate_rsp" },
+    { EXT_RX, 0x61, 0x06, EXT_EN_ALWAYS, ext_kovio_ntf, "kovio_deactivate_ntf" },
+    { EXT_RX, 0x61, 0x06, EXT_EN_ALWAYS, ext_icode_deactivated, "icode_deactivated" },
+    { EXT_RX, 0x61, 0x03, EXT_EN_ALWAYS, ext_kovio_ntf, "kovio_discover_ntf" },
+    { EXT_RX, 0x61, 0x03, EXT_EN_ALWAYS, ext_cleanup_discover_ntf, "cleanup_discover_ntf" },
+    { EXT_RX, 0x41, 0x04, EXT_EN_ALWAYS, ext_cleanup_select_rsp, "cleanup_select_rsp" },
+    { EXT_RX, 0x40, 0x01, EXT_EN_ALWAYS, ext_core_init_rsp, "core_init_rsp" },
+    { EXT_RX, 0x60, 0x00, EXT_EN_ALWAYS, ext_core_reset_ntf, "core_reset_ntf" },
+    { EXT_RX, 0x00, EXT_ANY_OID, EXT_EN_ALWAYS, ext_icode_data, "icode_data" },
+};
+
+#define EXT_NB_HANDLERS     (sizeof(ext_handlers) / sizeof(ext_handlers[0]))
+
+static phNxpNciHal_ExtBucket_t ext_tx_buckets[EXT_NB_KEYS];
+static phNxpNciHal_ExtBucket_t ext_rx_buckets[EXT_NB_KEYS];
+/* Number of packets dispatched to each handler since phNxpNciHal_ext_init */
+static uint32_t ext_handler_hits[EXT_NB_HANDLERS];
+/* Chip type the buckets were compiled for */
+static tNFC_chipType ext_chip_type = pnInvalid;
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_ext_key
+**
+** Description      Returns the bucket index of an NCI packet: MT and GID of
+**                  control packets, 0 for all data packets.
+**
+*******************************************************************************/
+static uint8_t phNxpNciHal_ext_key(uint8_t hdr0)
+{
+    if ((hdr0 & NXP_NCI_MT_MASK) == 0x00)
+    {
+        return 0;
+    }
+    return (uint8_t) (((hdr0 & NXP_NCI_MT_MASK) >> 1) | (hdr0 & 0x0F));
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_ext_register
+**
+** Description      Compiles the dispatch buckets from ext_handlers[], keeping
+**                  only the handlers enabled for the current chip type and
+**                  configuration. Called when the extensions are initialized
+**                  and again once CORE_INIT_RSP has identified the chip.
+**
+*******************************************************************************/
+static void phNxpNciHal_ext_register(void)
+{
+    phNxpNciHal_ExtBucket_t *p_bucket;
+    unsigned long mifare_reader = 0;
+    uint8_t enabled;
+    uint8_t i;
+
+    ext_chip_type = phNxpNciHal_getChipType();
+    if (!GetNxpNumValue(NAME_MIFARE_READER_ENABLE, &mifare_reader, sizeof(mifare_reader)))
+    {
+        mifare_reader = 0;
+    }
+
+    memset(ext_tx_buckets, 0, sizeof(ext_tx_buckets));
+    memset(ext_rx_buckets, 0, sizeof(ext_rx_buckets));
+    for (i = 0; i < EXT_NB_HANDLERS; i++)
+    {
+        switch (ext_handlers[i].enable)
+        {
+        case EXT_EN_PN547C2:
+            enabled = (ext_chip_type == pn547C2);
+            break;
+        case EXT_EN_MIFARE_READER:
+            enabled = ((ext_chip_type == pn547C2) && (mifare_reader == 0x01));
+            break;
+        default:
+            enabled = TRUE;
+            break;
+        }
+        if (!enabled)
+        {
+            continue;
+        }
+
+        p_bucket = (ext_handlers[i].dir == EXT_TX) ? ext_tx_buckets : ext_rx_buckets;
+        p_bucket += phNxpNciHal_ext_key(ext_handlers[i].mt_gid);
+        if (p_bucket->count >= EXT_MAX_HANDLERS_PER_KEY)
+        {
+            NXPLOG_NCIHAL_E("Too many extensions for 0x%02X, %s not registered",
+                    ext_handlers[i].mt_gid, ext_handlers[i].name);
+            continue;
+        }
+        p_bucket->handler[p_bucket->count++] = i;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_ext_dispatch
+**
+** Description      Runs the handlers registered for the key of p_data
+**
+** Returns          NFCSTATUS_SUCCESS if the packet goes on as usual, else the
+**                  status of the handler that stopped the dispatch
+**
+*******************************************************************************/
+static NFCSTATUS phNxpNciHal_ext_dispatch(const phNxpNciHal_ExtBucket_t *p_buckets,
+        uint8_t *p_data, uint16_t *p_len, uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    const phNxpNciHal_ExtBucket_t *p_bucket = &p_buckets[phNxpNciHal_ext_key(p_data[0])];
+    NFCSTATUS status = NFCSTATUS_SUCCESS;
+    uint8_t oid = p_data[1] & NXP_NCI_OID_MASK;
+    uint8_t idx;
+    uint8_t i;
+
+    for (i = 0; i < p_bucket->count; i++)
+    {
+        idx = p_bucket->handler[i];
+        if ((ext_handlers[idx].oid != EXT_ANY_OID) && (ext_handlers[idx].oid != oid))
+        {
+            continue;
+        }
+        ext_handler_hits[idx]++;
+        status = ext_handlers[idx].fn(p_data, p_len, p_rsp_len, p_rsp_data);
+        if (status != NFCSTATUS_SUCCESS)
+        {
+            break;
+        }
+    }
+
+    return status;
+}
 
 /*******************************************************************************
 **
@@ -86,6 +334,30 @@ void phNxpNciHal_ext_init (void)
     disable_kovio = 0x00;
     send_to_upper_kovio = 0x01;
     EnableP2P_PrioLogic = FALSE;
+    memset(ext_handler_hits, 0, sizeof(ext_handler_hits));
+    phNxpNciHal_ext_register();
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_ext_dump_stats
+**
+** Description      Logs how many packets each registered extension handled
+**
+*******************************************************************************/
+void phNxpNciHal_ext_dump_stats (void)
+{
+    uint8_t i;
+
+    for (i = 0; i < EXT_NB_HANDLERS; i++)
+    {
+        if (ext_handler_hits[i] != 0)
+        {
+            NXPLOG_NCIHAL_D("NxpExt> %-24s %02X%02X: %u", ext_handlers[i].name,
+                    ext_handlers[i].mt_gid, ext_handlers[i].oid,
+                    ext_handler_hits[i]);
+        }
+    }
 }
 
 /*******************************************************************************
@@ -99,13 +371,28 @@ void phNxpNciHal_ext_init (void)
 *******************************************************************************/
 NFCSTATUS phNxpNciHal_process_ext_rsp (uint8_t *p_ntf, uint16_t *p_len)
 {
+    send_to_upper_kovio = 1;
 
-    NFCSTATUS status = NFCSTATUS_SUCCESS;
-    uint16_t rf_technology_length_param = 0;
+    /* Response to the ICODE EOF sent by phNxpNciHal_write: not for the stack */
+    if (icode_detected == 1 &&
+        icode_send_eof == 2)
+    {
+        icode_send_eof = 3;
+        return NFCSTATUS_FAILED;
+    }
+
+    return phNxpNciHal_ext_dispatch(ext_rx_buckets, p_ntf, p_len, NULL, NULL);
+}
 
-    if (p_ntf[0] == 0x61 &&
-        p_ntf[1] == 0x05 &&
-        p_ntf[4] == 0x03 &&
+/* RF_INTF_ACTIVATED_NTF: NFC-DEP is not expected in EMVCo polling */
+static NFCSTATUS ext_emvco_nfcdep_restart(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_len);
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    if (p_ntf[4] == 0x03 &&
         p_ntf[5] == 0x05 &&
         nxpprofile_ctrl.profile_type == EMV_CO_PROFILE)
     {
@@ -114,10 +401,18 @@ NFCSTATUS phNxpNciHal_process_ext_rsp (uint8_t *p_ntf, uint16_t *p_len)
         p_ntf[6] = 0xFF;
         NXPLOG_NCIHAL_D("Nfc-Dep Detect in EmvCo profile - Restart polling");
     }
+    return NFCSTATUS_SUCCESS;
+}
 
-    if (p_ntf[0] == 0x61 &&
-        p_ntf[1] == 0x05 &&
-        p_ntf[4] == 0x01 &&
+/* RF_INTF_ACTIVATED_NTF: report T3T instead of NFC-DEP in Felica reader mode */
+static NFCSTATUS ext_felica_t3t_ntf(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_len);
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    if (p_ntf[4] == 0x01 &&
         p_ntf[5] == 0x05 &&
         p_ntf[6] == 0x02 &&
         gFelicaReaderMode)
@@ -127,8 +422,18 @@ NFCSTATUS phNxpNciHal_process_ext_rsp (uint8_t *p_ntf, uint16_t *p_len)
         p_ntf[5] = 0x03;
         NXPLOG_NCIHAL_D("FelicaReaderMode:Activity 1.1");
     }
+    return NFCSTATUS_SUCCESS;
+}
 
 #ifdef P2P_PRIO_LOGIC_HAL_IMP
+/* P2P priority logic: holds back ISO-DEP activations while NFC-DEP is polled */
+static NFCSTATUS ext_p2p_prio_ntf(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    NFCSTATUS status;
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
     if(p_ntf[0] == 0x61 &&
        p_ntf[1] == 0x05 &&
        p_ntf[4] == 0x02 &&
@@ -153,171 +458,217 @@ NFCSTATUS phNxpNciHal_process_ext_rsp (uint8_t *p_ntf, uint16_t *p_len)
             }
         }
     }
+    return NFCSTATUS_SUCCESS;
+}
 #endif
 
-    status = NFCSTATUS_SUCCESS;
-    status = phNxpNciHal_kovio_rsp_ext(p_ntf,p_len);
+/* RF_INTF_ACTIVATED_NTF: logs the activated interface, protocol and mode */
+static NFCSTATUS ext_intf_activated_log(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_len);
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
 
-    if (p_ntf[0] == 0x61 &&
-            p_ntf[1] == 0x05)
+    switch (p_ntf[4])
     {
-        switch (p_ntf[4])
+    case 0x00:
+        NXPLOG_NCIHAL_D("NxpNci: RF Interface = NFCEE Direct RF");
+        break;
+    case 0x01:
+        NXPLOG_NCIHAL_D("NxpNci: RF Interface = Frame RF");
+        break;
+    case 0x02:
+        NXPLOG_NCIHAL_D("NxpNci: RF Interface = ISO-DEP");
+        break;
+    case 0x03:
+        NXPLOG_NCIHAL_D("NxpNci: RF Interface = NFC-DEP");
+        break;
+    case 0x80:
+        NXPLOG_NCIHAL_D("NxpNci: RF Interface = MIFARE");
+        break;
+    default:
+        NXPLOG_NCIHAL_D("NxpNci: RF Interface = Unknown");
+        break;
+    }
+
+    switch (p_ntf[5])
+    {
+    case 0x01:
+        NXPLOG_NCIHAL_D("NxpNci: Protocol = T1T");
+        phNxpDta_T1TEnable();
+        break;
+    case 0x02:
+        NXPLOG_NCIHAL_D("NxpNci: Protocol = T2T");
+        break;
+    case 0x03:
+        NXPLOG_NCIHAL_D("NxpNci: Protocol = T3T");
+        break;
+    case 0x04:
+        NXPLOG_NCIHAL_D("NxpNci: Protocol = ISO-DEP");
+        break;
+    case 0x05:
+        NXPLOG_NCIHAL_D("NxpNci: Protocol = NFC-DEP");
+        break;
+    case 0x06:
+        NXPLOG_NCIHAL_D("NxpNci: Protocol = 15693");
+        break;
+    case 0x80:
+        NXPLOG_NCIHAL_D("NxpNci: Protocol = MIFARE");
+        break;
+    case 0x81:
+        if (phNxpNciHal_getChipType() != pn547C2)
         {
-        case 0x00:
-            NXPLOG_NCIHAL_D("NxpNci: RF Interface = NFCEE Direct RF");
-            break;
-        case 0x01:
-            NXPLOG_NCIHAL_D("NxpNci: RF Interface = Frame RF");
-            break;
-        case 0x02:
-            NXPLOG_NCIHAL_D("NxpNci: RF Interface = ISO-DEP");
-            break;
-        case 0x03:
-            NXPLOG_NCIHAL_D("NxpNci: RF Interface = NFC-DEP");
-            break;
-        case 0x80:
-            NXPLOG_NCIHAL_D("NxpNci: RF Interface = MIFARE");
-            break;
-        default:
-            NXPLOG_NCIHAL_D("NxpNci: RF Interface = Unknown");
-            break;
+            NXPLOG_NCIHAL_D("NxpNci: Mode = Kovio");
         }
-
-        switch (p_ntf[5])
+        else
+        {
+            NXPLOG_NCIHAL_D("NxpNci: Protocol = Unknown");
+        }
+        break;
+    case 0x8A:
+        if (phNxpNciHal_getChipType()  == pn547C2)
+        {
+            NXPLOG_NCIHAL_D("NxpNci: Mode = Kovio");
+        }
+        else
         {
-        case 0x01:
-            NXPLOG_NCIHAL_D("NxpNci: Protocol = T1T");
-            phNxpDta_T1TEnable();
-            break;
-        case 0x02:
-            NXPLOG_NCIHAL_D("NxpNci: Protocol = T2T");
-            break;
-        case 0x03:
-            NXPLOG_NCIHAL_D("NxpNci: Protocol = T3T");
-            break;
-        case 0x04:
-            NXPLOG_NCIHAL_D("NxpNci: Protocol = ISO-DEP");
-            break;
-        case 0x05:
-            NXPLOG_NCIHAL_D("NxpNci: Protocol = NFC-DEP");
-            break;
-        case 0x06:
-            NXPLOG_NCIHAL_D("NxpNci: Protocol = 15693");
-            break;
-        case 0x80:
-            NXPLOG_NCIHAL_D("NxpNci: Protocol = MIFARE");
-            break;
-        case 0x81:
-            if (phNxpNciHal_getChipType() != pn547C2)
-            {
-                NXPLOG_NCIHAL_D("NxpNci: Mode = Kovio");
-            }
-            else
-            {
-                NXPLOG_NCIHAL_D("NxpNci: Protocol = Unknown");
-            }
-            break;
-        case 0x8A:
-            if (phNxpNciHal_getChipType()  == pn547C2)
-            {
-                NXPLOG_NCIHAL_D("NxpNci: Mode = Kovio");
-            }
-            else
-            {
-                NXPLOG_NCIHAL_D("NxpNci: Protocol = Unknown");
-            }
-            break;
-        default:
             NXPLOG_NCIHAL_D("NxpNci: Protocol = Unknown");
-            break;
         }
+        break;
+    default:
+        NXPLOG_NCIHAL_D("NxpNci: Protocol = Unknown");
+        break;
+    }
 
-        switch (p_ntf[6])
+    switch (p_ntf[6])
+    {
+    case 0x00:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = A Passive Poll");
+        break;
+    case 0x01:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = B Passive Poll");
+        break;
+    case 0x02:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = F Passive Poll");
+        break;
+    case 0x03:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = A Active Poll");
+        break;
+    case 0x05:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = F Active Poll");
+        break;
+    case 0x06:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = 15693 Passive Poll");
+        break;
+    case 0x70:
+        if (phNxpNciHal_getChipType() != pn547C2)
         {
-        case 0x00:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = A Passive Poll");
-            break;
-        case 0x01:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = B Passive Poll");
-            break;
-        case 0x02:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = F Passive Poll");
-            break;
-        case 0x03:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = A Active Poll");
-            break;
-        case 0x05:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = F Active Poll");
-            break;
-        case 0x06:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = 15693 Passive Poll");
-            break;
-        case 0x70:
-            if (phNxpNciHal_getChipType() != pn547C2)
-            {
-                NXPLOG_NCIHAL_D("NxpNci: Mode = Kovio");
-            }
-            else
-            {
-                NXPLOG_NCIHAL_D("NxpNci: Protocol = Unknown");
-            }
-            break;
-        case 0x77:
-            if (phNxpNciHal_getChipType() == pn547C2)
-            {
-                NXPLOG_NCIHAL_D("NxpNci: Mode = Kovio");
-            }
-            else
-            {
-                NXPLOG_NCIHAL_D("NxpNci: Protocol = Unknown");
-            }
-            break;
-        case 0x80:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = A Passive Listen");
-            break;
-        case 0x81:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = B Passive Listen");
-            break;
-        case 0x82:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = F Passive Listen");
-            break;
-        case 0x83:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = A Active Listen");
-            break;
-        case 0x85:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = F Active Listen");
-            break;
-        case 0x86:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = 15693 Passive Listen");
-            break;
-        default:
-            NXPLOG_NCIHAL_D("NxpNci: Mode = Unknown");
-            break;
+            NXPLOG_NCIHAL_D("NxpNci: Mode = Kovio");
         }
+        else
+        {
+            NXPLOG_NCIHAL_D("NxpNci: Protocol = Unknown");
+        }
+        break;
+    case 0x77:
+        if (phNxpNciHal_getChipType() == pn547C2)
+        {
+            NXPLOG_NCIHAL_D("NxpNci: Mode = Kovio");
+        }
+        else
+        {
+            NXPLOG_NCIHAL_D("NxpNci: Protocol = Unknown");
+        }
+        break;
+    case 0x80:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = A Passive Listen");
+        break;
+    case 0x81:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = B Passive Listen");
+        break;
+    case 0x82:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = F Passive Listen");
+        break;
+    case 0x83:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = A Active Listen");
+        break;
+    case 0x85:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = F Active Listen");
+        break;
+    case 0x86:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = 15693 Passive Listen");
+        break;
+    default:
+        NXPLOG_NCIHAL_D("NxpNci: Mode = Unknown");
+        break;
     }
+    return NFCSTATUS_SUCCESS;
+}
 
-    if (p_ntf[0] == 0x61 &&
-            p_ntf[1] == 0x05 &&
-            p_ntf[2] == 0x15 &&
-            p_ntf[4] == 0x01 &&
-            p_ntf[5] == 0x06 &&
-            p_ntf[6] == 0x06)
+/* RF_INTF_ACTIVATED_NTF of an ISO 15693 tag: starts the ICODE workarounds */
+static NFCSTATUS ext_icode_activated(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_len);
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    if (p_ntf[2] == 0x15 &&
+        p_ntf[4] == 0x01 &&
+        p_ntf[5] == 0x06 &&
+        p_ntf[6] == 0x06)
     {
         NXPLOG_NCIHAL_D ("> Going through workaround - notification of ISO 15693");
         icode_detected = 0x01;
         p_ntf[21] = 0x01;
         p_ntf[22] = 0x01;
     }
-    else if (icode_detected == 1 &&
-            icode_send_eof == 2)
+    return NFCSTATUS_SUCCESS;
+}
+
+/* RF_INTF_ACTIVATED_NTF on PN547C2: MIFARE protocol over ISO-DEP needs SAK bit 6 */
+static NFCSTATUS ext_mifare_sak(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    uint16_t rf_technology_length_param = 0;
+    UNUSED(p_len);
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    if (p_ntf[4] == 0x02 && p_ntf[5] == 0x80
+            && p_ntf[6] == 0x00)
     {
-        icode_send_eof = 3;
-        status = NFCSTATUS_FAILED;
-        return status;
+        NXPLOG_NCIHAL_D("Going through workaround - iso-dep  interface  mifare protocol with sak value not equal to 0x20");
+        rf_technology_length_param = p_ntf[9];
+        if((p_ntf[ 9 + rf_technology_length_param] & 0x20) != 0x20)
+        {
+            p_ntf[4] = 0x80;
+        }
     }
-    else if (p_ntf[0] == 0x00 &&
-                p_ntf[1] == 0x00 &&
-                icode_detected == 1)
+    return NFCSTATUS_SUCCESS;
+}
+
+/* Kovio detection logic, see phNxpNciHal_Kovio.c */
+static NFCSTATUS ext_kovio_ntf(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    return phNxpNciHal_kovio_rsp_ext(p_ntf, p_len);
+}
+
+/* Data from an ICODE tag: strips the trailing status byte of the FW */
+static NFCSTATUS ext_icode_data(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    if (p_ntf[0] == 0x00 &&
+        p_ntf[1] == 0x00 &&
+        icode_detected == 1)
     {
         if (icode_send_eof == 3)
         {
@@ -330,116 +681,111 @@ NFCSTATUS phNxpNciHal_process_ext_rsp (uint8_t *p_ntf, uint16_t *p_len)
             (*p_len)--;
         }
     }
-    else if (p_ntf[2] == 0x02 &&
-            p_ntf[1] == 0x00 && icode_detected == 1)
-    {
-        NXPLOG_NCIHAL_D ("> ICODE EOF response do not send to upper layer");
-    }
-    else if(p_ntf[0] == 0x61 &&
-            p_ntf[1] == 0x06 && icode_detected == 1)
+    return NFCSTATUS_SUCCESS;
+}
+
+/* RF_DEACTIVATE_NTF: ends the ICODE workarounds */
+static NFCSTATUS ext_icode_deactivated(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_ntf);
+    UNUSED(p_len);
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    if (icode_detected == 1)
     {
         NXPLOG_NCIHAL_D ("> Polling Loop Re-Started");
         icode_detected = 0;
         icode_send_eof = 0;
     }
-#if 0 /* artf551669/artf551636 */
-    else if(*p_len == 4 &&
-                p_ntf[0] == 0x40 &&
-                p_ntf[1] == 0x02 &&
-                p_ntf[2] == 0x01 &&
-                p_ntf[3] == 0x06 )
-    {
-        NXPLOG_NCIHAL_D ("> Deinit workaround for LLCP set_config 0x%x 0x%x 0x%x", p_ntf[21], p_ntf[22], p_ntf[23]);
-        p_ntf[0] = 0x40;
-        p_ntf[1] = 0x02;
-        p_ntf[2] = 0x02;
-        p_ntf[3] = 0x00;
-        p_ntf[4] = 0x00;
-        *p_len = 5;
-    }
-#endif
-    else if ((p_ntf[0] == 0x40) && (p_ntf[1] == 0x01))
-    {
-        int len = p_ntf[2] + 2; /*include 2 byte header*/
-        wFwVerRsp= (((uint32_t)p_ntf[len - 2])<< 16U)|(((uint32_t)p_ntf[len - 1])<< 8U)|p_ntf[len];
-        if(wFwVerRsp == 0)
-            status = NFCSTATUS_FAILED;
-        iCoreInitRspLen = *p_len;
-        memcpy(bCoreInitRsp, p_ntf, *p_len);
-        NXPLOG_NCIHAL_D ("NxpNci> FW Version: %x.%x.%x", p_ntf[len-2], p_ntf[len-1], p_ntf[len]);
-        if(phNxpNciHal_deriveChipType(bCoreInitRsp, iCoreInitRspLen) == pnInvalid)
-        {
-            status = NFCSTATUS_FAILED;
-            NXPLOG_NCIHAL_E ("NxpNci> Invalid NFC Chip");
-        }
-    }
-    //4200 02 00 01
-    else if(p_ntf[0] == 0x42 && p_ntf[1] == 0x00 && ee_disc_done == 0x01)
-    {
-        NXPLOG_NCIHAL_D("Going through workaround - NFCEE_DISCOVER_RSP");
-        if(p_ntf[4] == 0x01)
-        {
-            p_ntf[4] = 0x00;
+    return NFCSTATUS_SUCCESS;
+}
 
-            ee_disc_done = 0x00;
-        }
-        NXPLOG_NCIHAL_D("Going through workaround - NFCEE_DISCOVER_RSP - END");
+/* CORE_INIT_RSP: FW version and chip type */
+static NFCSTATUS ext_core_init_rsp(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    NFCSTATUS status = NFCSTATUS_SUCCESS;
+    int len = p_ntf[2] + 2; /*include 2 byte header*/
+    int ctrl_payload = 12 + p_ntf[8]; /* after the supported RF interfaces */
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
 
-    }
-    else if(p_ntf[0] == 0x61 && p_ntf[1] == 0x03 /*&& cleanup_timer!=0*/)
+    nxpncihal_ctrl.max_ctrl_payload = 0xFF;
+    if ((ctrl_payload < *p_len) && (p_ntf[ctrl_payload] != 0))
     {
-        if(cleanup_timer!=0)
-        {
-            /* if RF Notification Type of RF_DISCOVER_NTF is Last Notification */
-            if(0== (*(p_ntf + 2 + (*(p_ntf+2)))))
-            {
-                phNxpNciHal_select_RF_Discovery(RfDiscID,RfProtocolType);
-                status = NFCSTATUS_FAILED;
-                return status;
-            }
-            else
-            {
-                RfDiscID=p_ntf[3];
-                RfProtocolType=p_ntf[4];
-            }
-            status = NFCSTATUS_FAILED;
-            return status;
-
-        }
-
+        nxpncihal_ctrl.max_ctrl_payload = p_ntf[ctrl_payload];
     }
-    else if(p_ntf[0] == 0x41 && p_ntf[1] == 0x04 && cleanup_timer!=0)
+
+    wFwVerRsp= (((uint32_t)p_ntf[len - 2])<< 16U)|(((uint32_t)p_ntf[len - 1])<< 8U)|p_ntf[len];
+    if(wFwVerRsp == 0)
+        status = NFCSTATUS_FAILED;
+    iCoreInitRspLen = *p_len;
+    memcpy(bCoreInitRsp, p_ntf, *p_len);
+    NXPLOG_NCIHAL_D ("NxpNci> FW Version: %x.%x.%x", p_ntf[len-2], p_ntf[len-1], p_ntf[len]);
+    if(phNxpNciHal_deriveChipType(bCoreInitRsp, iCoreInitRspLen) == pnInvalid)
     {
         status = NFCSTATUS_FAILED;
-        return status;
+        NXPLOG_NCIHAL_E ("NxpNci> Invalid NFC Chip");
     }
-    else if(p_ntf[0] == 0x60 && p_ntf[1] == 0x00)
+    else if (phNxpNciHal_getChipType() != ext_chip_type)
     {
-        NXPLOG_NCIHAL_E("CORE_RESET_NTF received!");
-        phNxpNciHal_emergency_recovery();
+        /* No other packet is in flight while CORE_INIT is answered */
+        phNxpNciHal_ext_register();
     }
-    else if(p_ntf[0] == 0x61 && p_ntf[1] == 0x05
-            && p_ntf[4] == 0x02 && p_ntf[5] == 0x80
-            && p_ntf[6] == 0x00
-            && (phNxpNciHal_getChipType() == pn547C2))
+    return status;
+}
+
+/* RF_DISCOVER_NTF while the P2P priority cleanup timer runs */
+static NFCSTATUS ext_cleanup_discover_ntf(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_len);
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    if(cleanup_timer == 0)
     {
-        NXPLOG_NCIHAL_D("Going through workaround - iso-dep  interface  mifare protocol with sak value not equal to 0x20");
-        rf_technology_length_param = p_ntf[9];
-        if((p_ntf[ 9 + rf_technology_length_param] & 0x20) != 0x20)
-        {
-            p_ntf[4] = 0x80;
-        }
+        return NFCSTATUS_SUCCESS;
     }
-    /*
-    else if(p_ntf[0] == 0x61 && p_ntf[1] == 0x05 && p_ntf[4] == 0x01 && p_ntf[5] == 0x00 && p_ntf[6] == 0x01)
+    /* if RF Notification Type of RF_DISCOVER_NTF is Last Notification */
+    if(0== (*(p_ntf + 2 + (*(p_ntf+2)))))
     {
-        NXPLOG_NCIHAL_D("Picopass type 3-B with undefined protocol is not supported, disabling");
-        p_ntf[4] = 0xFF;
-        p_ntf[5] = 0xFF;
-        p_ntf[6] = 0xFF;
-    }*/
+        phNxpNciHal_select_RF_Discovery(RfDiscID,RfProtocolType);
+    }
+    else
+    {
+        RfDiscID=p_ntf[3];
+        RfProtocolType=p_ntf[4];
+    }
+    return NFCSTATUS_FAILED;
+}
 
-    return status;
+/* RF_DISCOVER_SELECT_RSP while the P2P priority cleanup timer runs */
+static NFCSTATUS ext_cleanup_select_rsp(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_ntf);
+    UNUSED(p_len);
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    return (cleanup_timer != 0) ? NFCSTATUS_FAILED : NFCSTATUS_SUCCESS;
+}
+
+/* CORE_RESET_NTF: the NFCC reset on its own */
+static NFCSTATUS ext_core_reset_ntf(uint8_t *p_ntf, uint16_t *p_len,
+        uint16_t *p_rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_ntf);
+    UNUSED(p_len);
+    UNUSED(p_rsp_len);
+    UNUSED(p_rsp_data);
+
+    NXPLOG_NCIHAL_E("CORE_RESET_NTF received!");
+    phNxpNciHal_emergency_recovery();
+    return NFCSTATUS_SUCCESS;
 }
 
 /******************************************************************************
@@ -544,172 +890,184 @@ clean_and_return:
 NFCSTATUS phNxpNciHal_write_ext(uint16_t *cmd_len, uint8_t *p_cmd_data,
         uint16_t *rsp_len, uint8_t *p_rsp_data)
 {
-    NFCSTATUS status = NFCSTATUS_SUCCESS;
+    return phNxpNciHal_ext_dispatch(ext_tx_buckets, p_cmd_data, cmd_len,
+            rsp_len, p_rsp_data);
+}
+
+/* RF_DEACTIVATE_CMD: stops the Kovio detection logic once the NFCC answers */
+static NFCSTATUS ext_kovio_rf_deactivate(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(cmd_len);
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
+
+    /* Specific logic to block RF disable when Kovio detection logic is active */
+    if (p_cmd_data[2] == 0x01 &&
+        kovio_detected == TRUE)
+    {
+        NXPLOG_NCIHAL_D ("Kovio detection logic is active: Set Flag to disable it.");
+        disable_kovio=0x01;
+    }
+    return NFCSTATUS_SUCCESS;
+}
+
+#ifdef P2P_PRIO_LOGIC_HAL_IMP
+/* RF_DEACTIVATE_CMD: stops the P2P priority logic */
+static NFCSTATUS ext_p2p_prio_rf_deactivate(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(cmd_len);
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
+
+    /* Specific logic to block RF disable when P2P priority logic is busy */
+    if (p_cmd_data[2] == 0x01 &&
+        EnableP2P_PrioLogic == TRUE)
+    {
+        NXPLOG_NCIHAL_D ("P2P priority logic busy: Disable it.");
+        phNxpNciHal_clean_P2P_Prio();
+    }
+    return NFCSTATUS_SUCCESS;
+}
+#endif
+
+/* RF_DISCOVER_CMD: kept for the P2P priority logic */
+static NFCSTATUS ext_nfcdep_poll_store(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
 
     phNxpNciHal_NfcDep_cmd_ext(p_cmd_data, cmd_len);
+    return NFCSTATUS_SUCCESS;
+}
 
+/* DTA mode command changes, see phNxpNciHal_dta.c */
+static NFCSTATUS ext_dta_update(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
     if(phNxpDta_IsEnable() == TRUE)
     {
-        status = phNxpNHal_DtaUpdate(cmd_len, p_cmd_data,rsp_len, p_rsp_data);
+        return phNxpNHal_DtaUpdate(cmd_len, p_cmd_data, rsp_len, p_rsp_data);
     }
+    return NFCSTATUS_SUCCESS;
+}
 
-    if (p_cmd_data[0] == PROPRIETARY_CMD_FELICA_READER_MODE &&
-        p_cmd_data[1] == PROPRIETARY_CMD_FELICA_READER_MODE &&
-        p_cmd_data[2] == PROPRIETARY_CMD_FELICA_READER_MODE)
+/* FE FE FE <mode>: HAL proprietary command, answered by the HAL */
+static NFCSTATUS ext_felica_reader_mode(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(cmd_len);
+
+    if (p_cmd_data[1] != PROPRIETARY_CMD_FELICA_READER_MODE ||
+        p_cmd_data[2] != PROPRIETARY_CMD_FELICA_READER_MODE)
     {
-        NXPLOG_NCIHAL_D ("Received proprietary command to set Felica Reader mode:%d",p_cmd_data[3]);
-        gFelicaReaderMode = p_cmd_data[3];
-        /* frame the dummy response */
-        *rsp_len = 4;
-        p_rsp_data[0] = 0x00;
-        p_rsp_data[1] = 0x00;
-        p_rsp_data[2] = 0x00;
-        p_rsp_data[3] = 0x00;
-        status = NFCSTATUS_FAILED;
-    }
-    else if (p_cmd_data[0] == 0x20 &&
-            p_cmd_data[1] == 0x02 &&
-            p_cmd_data[2] == 0x05 &&
-            p_cmd_data[3] == 0x01 &&
-            p_cmd_data[4] == 0xA0 &&
-            p_cmd_data[5] == 0x44 &&
-            p_cmd_data[6] == 0x01 &&
-            p_cmd_data[7] == 0x01)
-    {
-        nxpprofile_ctrl.profile_type = EMV_CO_PROFILE;
-        NXPLOG_NCIHAL_D ("EMV_CO_PROFILE mode - Enabled");
-        status = NFCSTATUS_SUCCESS;
-    }
-    else if (p_cmd_data[0] == 0x20 &&
-            p_cmd_data[1] == 0x02 &&
-            p_cmd_data[2] == 0x05 &&
-            p_cmd_data[3] == 0x01 &&
-            p_cmd_data[4] == 0xA0 &&
-            p_cmd_data[5] == 0x44 &&
-            p_cmd_data[6] == 0x01 &&
-            p_cmd_data[7] == 0x00)
-    {
-        NXPLOG_NCIHAL_D ("NFC_FORUM_PROFILE mode - Enabled");
-        nxpprofile_ctrl.profile_type = NFC_FORUM_PROFILE;
-        status = NFCSTATUS_SUCCESS;
+        return NFCSTATUS_SUCCESS;
     }
+    NXPLOG_NCIHAL_D ("Received proprietary command to set Felica Reader mode:%d",p_cmd_data[3]);
+    gFelicaReaderMode = p_cmd_data[3];
+    /* frame the dummy response */
+    *rsp_len = 4;
+    p_rsp_data[0] = 0x00;
+    p_rsp_data[1] = 0x00;
+    p_rsp_data[2] = 0x00;
+    p_rsp_data[3] = 0x00;
+    return NFCSTATUS_FAILED;
+}
 
-    if (nxpprofile_ctrl.profile_type == EMV_CO_PROFILE)
+/* CORE_SET_CONFIG of the NXP profile selection parameter A044 */
+static NFCSTATUS ext_profile_select(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(cmd_len);
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
+
+    if (p_cmd_data[2] == 0x05 &&
+        p_cmd_data[3] == 0x01 &&
+        p_cmd_data[4] == 0xA0 &&
+        p_cmd_data[5] == 0x44 &&
+        p_cmd_data[6] == 0x01)
     {
-        if (p_cmd_data[0] == 0x21 &&
-                p_cmd_data[1] == 0x06 &&
-                p_cmd_data[2] == 0x01 &&
-                p_cmd_data[3] == 0x03)
+        if (p_cmd_data[7] == 0x01)
         {
-#if 0
-            //Needs clarification whether to keep it or not
-            NXPLOG_NCIHAL_D ("EmvCo Poll mode - RF Deactivate discard");
-            phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
-            *rsp_len = 4;
-            p_rsp_data[0] = 0x41;
-            p_rsp_data[1] = 0x06;
-            p_rsp_data[2] = 0x01;
-            p_rsp_data[3] = 0x00;
-            phNxpNciHal_print_packet("RECV", p_rsp_data, 4);
-            status = NFCSTATUS_FAILED;
-#endif
+            nxpprofile_ctrl.profile_type = EMV_CO_PROFILE;
+            NXPLOG_NCIHAL_D ("EMV_CO_PROFILE mode - Enabled");
         }
-        else if(p_cmd_data[0] == 0x21 &&
-                p_cmd_data[1] == 0x03 )
+        else if (p_cmd_data[7] == 0x00)
         {
-            NXPLOG_NCIHAL_D ("EmvCo Poll mode - Discover map only for A and B");
-            p_cmd_data[2] = 0x05;
-            p_cmd_data[3] = 0x02;
-            p_cmd_data[4] = 0x00;
-            p_cmd_data[5] = 0x01;
-            p_cmd_data[6] = 0x01;
-            p_cmd_data[7] = 0x01;
-            *cmd_len = 8;
+            NXPLOG_NCIHAL_D ("NFC_FORUM_PROFILE mode - Enabled");
+            nxpprofile_ctrl.profile_type = NFC_FORUM_PROFILE;
         }
     }
-    if ( p_cmd_data[0] == 0x21 &&
-        p_cmd_data[1] == 0x00
-        && (phNxpNciHal_getChipType() == pn547C2))
-    {
-        unsigned long retval = 0;
-        int isfound =  GetNxpNumValue(NAME_MIFARE_READER_ENABLE, &retval, sizeof(unsigned long));
+    return NFCSTATUS_SUCCESS;
+}
 
-        if(retval == 0x01)
-        {
-            NXPLOG_NCIHAL_D ("Going through extns - Adding Mifare in RF Discovery");
-            p_cmd_data[2] += 3;
-            p_cmd_data[3] += 1;
-            p_cmd_data[*cmd_len] = 0x80;
-            p_cmd_data[*cmd_len + 1] = 0x01;
-            p_cmd_data[*cmd_len + 2] = 0x80;
-            *cmd_len += 3;
-            status = NFCSTATUS_SUCCESS;
-            NXPLOG_NCIHAL_D ("Going through extns - Adding Mifare in RF Discovery - END");
-        }
-    }
-    else
-    if (p_cmd_data[3] == 0x81 &&
-            p_cmd_data[4] == 0x01 &&
-            p_cmd_data[5] == 0x03)
-    {
-        NXPLOG_NCIHAL_D("> Going through workaround - set host list");
+/* RF_DISCOVER_CMD in EMVCo profile: A and B polling only */
+static NFCSTATUS ext_emvco_discover_map(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
 
-        if( (phNxpNciHal_getChipType() != pn547C2))
-        {
-            *cmd_len = 8;
+    if (nxpprofile_ctrl.profile_type == EMV_CO_PROFILE)
+    {
+        NXPLOG_NCIHAL_D ("EmvCo Poll mode - Discover map only for A and B");
+        p_cmd_data[2] = 0x05;
+        p_cmd_data[3] = 0x02;
+        p_cmd_data[4] = 0x00;
+        p_cmd_data[5] = 0x01;
+        p_cmd_data[6] = 0x01;
+        p_cmd_data[7] = 0x01;
+        *cmd_len = 8;
+    }
+    return NFCSTATUS_SUCCESS;
+}
 
-            p_cmd_data[2] = 0x05;
-            p_cmd_data[6] = 0x02;
-            p_cmd_data[7] = 0xC0;
-        }
-        else
-        {
-            *cmd_len = 7;
+/* RF_DISCOVER_CMD: a new polling loop ends the ICODE workarounds */
+static NFCSTATUS ext_polling_loop_start(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(p_cmd_data);
+    UNUSED(cmd_len);
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
+
+    NXPLOG_NCIHAL_D ("> Polling Loop Started");
+    icode_detected = 0;
+    icode_send_eof = 0;
+    return NFCSTATUS_SUCCESS;
+}
 
-            p_cmd_data[2] = 0x04;
-            p_cmd_data[6] = 0xC0;
-        }
+/* RF_DISCOVER_MAP_CMD on PN547C2 with MIFARE_READER_ENABLE: adds MIFARE */
+static NFCSTATUS ext_mifare_discover_map(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
+
+    NXPLOG_NCIHAL_D ("Going through extns - Adding Mifare in RF Discovery");
+    p_cmd_data[2] += 3;
+    p_cmd_data[3] += 1;
+    p_cmd_data[*cmd_len] = 0x80;
+    p_cmd_data[*cmd_len + 1] = 0x01;
+    p_cmd_data[*cmd_len + 2] = 0x80;
+    *cmd_len += 3;
+    NXPLOG_NCIHAL_D ("Going through extns - Adding Mifare in RF Discovery - END");
+    return NFCSTATUS_SUCCESS;
+}
 
-        NXPLOG_NCIHAL_D("> Going through workaround - set host list - END");
-        status = NFCSTATUS_SUCCESS;
-    }
-    else if(icode_detected)
-    {
-        if ((p_cmd_data[3] & 0x40) == 0x40 &&
-            (p_cmd_data[4] == 0x21 ||
-             p_cmd_data[4] == 0x22 ||
-             p_cmd_data[4] == 0x24 ||
-             p_cmd_data[4] == 0x27 ||
-             p_cmd_data[4] == 0x28 ||
-             p_cmd_data[4] == 0x29 ||
-             p_cmd_data[4] == 0x2a))
-        {
-            NXPLOG_NCIHAL_D ("> Send EOF set");
-            icode_send_eof = 1;
-        }
+/* NFCEE_DISCOVER_CMD disable: answered by the HAL */
+static NFCSTATUS ext_nfcee_discover(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(cmd_len);
 
-        if(p_cmd_data[3]  == 0x20 || p_cmd_data[3]  == 0x24 ||
-           p_cmd_data[3]  == 0x60)
-        {
-            NXPLOG_NCIHAL_D ("> NFC ISO_15693 Proprietary CMD ");
-            p_cmd_data[3] += 0x02;
-        }
-    }
-    else if(p_cmd_data[0] == 0x21 &&
-            p_cmd_data[1] == 0x03 )
-    {
-        NXPLOG_NCIHAL_D ("> Polling Loop Started");
-        icode_detected = 0;
-        icode_send_eof = 0;
-    }
     //22000100
-    else if (p_cmd_data[0] == 0x22 &&
-            p_cmd_data[1] == 0x00 &&
-            p_cmd_data[2] == 0x01 &&
-            p_cmd_data[3] == 0x00
-            )
+    if (p_cmd_data[2] == 0x01 &&
+        p_cmd_data[3] == 0x00)
     {
-        //ee_disc_done = 0x01;//Reader Over SWP event getting
         *rsp_len = 0x05;
         p_rsp_data[0] = 0x42;
         p_rsp_data[1] = 0x00;
@@ -717,14 +1075,30 @@ NFCSTATUS phNxpNciHal_write_ext(uint16_t *cmd_len, uint8_t *p_cmd_data,
         p_rsp_data[3] = 0x00;
         p_rsp_data[4] = 0x00;
         phNxpNciHal_print_packet("RECV", p_rsp_data,5);
-        status = NFCSTATUS_FAILED;
+        return NFCSTATUS_FAILED;
     }
+    return NFCSTATUS_SUCCESS;
+}
+
+/* CORE_SET_CONFIG of the stack: values cached at init are not valid any more */
+static NFCSTATUS ext_setconfig_forget(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
+
+    phNxpNciHal_setConfig_forget(p_cmd_data, *cmd_len);
+    return NFCSTATUS_SUCCESS;
+}
+
+/* CORE_SET_CONFIG sequences of the stack that the FW does not handle */
+static NFCSTATUS ext_dirty_set_config(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    NFCSTATUS status = NFCSTATUS_SUCCESS;
+
     //2002 0904 3000 3100 3200 5000
-    else if ( (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02 ) &&
-            ( (p_cmd_data[2] == 0x09 && p_cmd_data[3] == 0x04) /*||
-              (p_cmd_data[2] == 0x0D && p_cmd_data[3] == 0x04)*/
-            )
-    )
+    if (p_cmd_data[2] == 0x09 && p_cmd_data[3] == 0x04)
     {
         *cmd_len += 0x01;
         p_cmd_data[2] += 0x01;
@@ -734,17 +1108,12 @@ NFCSTATUS phNxpNciHal_write_ext(uint16_t *cmd_len, uint8_t *p_cmd_data,
         p_cmd_data[12] = 0x00;
 
         NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config ");
-//        phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
         NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config - End ");
     }
-//    20020703300031003200
-//    2002 0301 3200
-    else if ( (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02 ) &&
-            (
-              (p_cmd_data[2] == 0x07 && p_cmd_data[3] == 0x03) ||
-              (p_cmd_data[2] == 0x03 && p_cmd_data[3] == 0x01 && p_cmd_data[4] == 0x32)
-            )
-    )
+    //    20020703300031003200
+    //    2002 0301 3200
+    else if ((p_cmd_data[2] == 0x07 && p_cmd_data[3] == 0x03) ||
+             (p_cmd_data[2] == 0x03 && p_cmd_data[3] == 0x01 && p_cmd_data[4] == 0x32))
     {
         NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config ");
         phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
@@ -759,107 +1128,84 @@ NFCSTATUS phNxpNciHal_write_ext(uint16_t *cmd_len, uint8_t *p_cmd_data,
         status = NFCSTATUS_FAILED;
         NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config - End ");
     }
-
-    //2002 0D04 300104 310100 320100 500100
     //2002 0401 320100
-    else if ( (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02 ) &&
-            (
-              /*(p_cmd_data[2] == 0x0D && p_cmd_data[3] == 0x04)*/
-                (p_cmd_data[2] == 0x04 && p_cmd_data[3] == 0x01 && p_cmd_data[4] == 0x32 && p_cmd_data[5] == 0x00)
-            )
-    )
+    else if (p_cmd_data[2] == 0x04 && p_cmd_data[3] == 0x01 &&
+             p_cmd_data[4] == 0x32 && p_cmd_data[5] == 0x00)
     {
-//        p_cmd_data[12] = 0x40;
-
         NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config ");
         phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
         p_cmd_data[6] = 0x60;
-
-        phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
-//        status = NFCSTATUS_FAILED;
         NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config - End ");
     }
+    return status;
+}
 
-#if 0
-    else if ( (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02 ) &&
-                 ((p_cmd_data[2] == 0x09 && p_cmd_data[3] == 0x04) ||
-                     (p_cmd_data[2] == 0x0B && p_cmd_data[3] == 0x05) ||
-                     (p_cmd_data[2] == 0x07 && p_cmd_data[3] == 0x02) ||
-                     (p_cmd_data[2] == 0x0A && p_cmd_data[3] == 0x03) ||
-                     (p_cmd_data[2] == 0x0A && p_cmd_data[3] == 0x04) ||
-                     (p_cmd_data[2] == 0x05 && p_cmd_data[3] == 0x02))
-             )
-    {
-        NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config ");
-        phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
-        *rsp_len = 5;
-        p_rsp_data[0] = 0x40;
-        p_rsp_data[1] = 0x02;
-        p_rsp_data[2] = 0x02;
-        p_rsp_data[3] = 0x00;
-        p_rsp_data[4] = 0x00;
-
-        phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
-        status = NFCSTATUS_FAILED;
-        NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config - End ");
-    }
+/* HCI ADM_SET_PARAMETER(WHITELIST) on the static pipe: sets the host list */
+static NFCSTATUS ext_set_host_list(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
 
-    else if((p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02) &&
-           ((p_cmd_data[3] == 0x00) ||
-           ((*cmd_len >= 0x06) && (p_cmd_data[5] == 0x00)))) /*If the length of the first param id is zero don't allow*/
+    if (p_cmd_data[3] == 0x81 &&
+        p_cmd_data[4] == 0x01 &&
+        p_cmd_data[5] == 0x03)
     {
-        NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config ");
-        phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
-        *rsp_len = 5;
-        p_rsp_data[0] = 0x40;
-        p_rsp_data[1] = 0x02;
-        p_rsp_data[2] = 0x02;
-        p_rsp_data[3] = 0x00;
-        p_rsp_data[4] = 0x00;
+        NXPLOG_NCIHAL_D("> Going through workaround - set host list");
 
-        phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
-        status = NFCSTATUS_FAILED;
-        NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config - End ");
-    }
-#endif
-    else if ((wFwVerRsp & 0x0000FFFF) == wFwVer)
-    {
-        /* skip CORE_RESET and CORE_INIT from Brcm */
-        if (p_cmd_data[0] == 0x20 &&
-            p_cmd_data[1] == 0x00 &&
-            p_cmd_data[2] == 0x01 &&
-            p_cmd_data[3] == 0x01
-            )
+        if( (phNxpNciHal_getChipType() != pn547C2))
         {
-//            *rsp_len = 6;
-//
-//            NXPLOG_NCIHAL_D("> Going - core reset optimization");
-//
-//            p_rsp_data[0] = 0x40;
-//            p_rsp_data[1] = 0x00;
-//            p_rsp_data[2] = 0x03;
-//            p_rsp_data[3] = 0x00;
-//            p_rsp_data[4] = 0x10;
-//            p_rsp_data[5] = 0x01;
-//
-//            status = NFCSTATUS_FAILED;
-//            NXPLOG_NCIHAL_D("> Going - core reset optimization - END");
+            *cmd_len = 8;
+
+            p_cmd_data[2] = 0x05;
+            p_cmd_data[6] = 0x02;
+            p_cmd_data[7] = 0xC0;
         }
-        /* CORE_INIT */
-        else if (
-            p_cmd_data[0] == 0x20 &&
-            p_cmd_data[1] == 0x01 &&
-            p_cmd_data[2] == 0x00
-            )
+        else
         {
-//            NXPLOG_NCIHAL_D("> Going - core init optimization");
-//            *rsp_len = iCoreInitRspLen;
-//            memcpy(p_rsp_data, bCoreInitRsp, iCoreInitRspLen);
-//            status = NFCSTATUS_FAILED;
-//            NXPLOG_NCIHAL_D("> Going - core init optimization - END");
+            *cmd_len = 7;
+
+            p_cmd_data[2] = 0x04;
+            p_cmd_data[6] = 0xC0;
         }
+
+        NXPLOG_NCIHAL_D("> Going through workaround - set host list - END");
     }
-    return status;
+    return NFCSTATUS_SUCCESS;
+}
+
+/* ISO 15693 command to an ICODE tag: EOF and proprietary command handling */
+static NFCSTATUS ext_icode_cmd(uint8_t *p_cmd_data, uint16_t *cmd_len,
+        uint16_t *rsp_len, uint8_t *p_rsp_data)
+{
+    UNUSED(cmd_len);
+    UNUSED(rsp_len);
+    UNUSED(p_rsp_data);
+
+    if (!icode_detected)
+    {
+        return NFCSTATUS_SUCCESS;
+    }
+    if ((p_cmd_data[3] & 0x40) == 0x40 &&
+        (p_cmd_data[4] == 0x21 ||
+         p_cmd_data[4] == 0x22 ||
+         p_cmd_data[4] == 0x24 ||
+         p_cmd_data[4] == 0x27 ||
+         p_cmd_data[4] == 0x28 ||
+         p_cmd_data[4] == 0x29 ||
+         p_cmd_data[4] == 0x2a))
+    {
+        NXPLOG_NCIHAL_D ("> Send EOF set");
+        icode_send_eof = 1;
+    }
+
+    if(p_cmd_data[3]  == 0x20 || p_cmd_data[3]  == 0x24 ||
+       p_cmd_data[3]  == 0x60)
+    {
+        NXPLOG_NCIHAL_D ("> NFC ISO_15693 Proprietary CMD ");
+        p_cmd_data[3] += 0x02;
+    }
+    return NFCSTATUS_SUCCESS;
 }
 
 /******************************************************************************
@@ -877,6 +1223,11 @@ NFCSTATUS phNxpNciHal_send_ext_cmd(uint16_t cmd_len, uint8_t *p_cmd)
 {
     NFCSTATUS status = NFCSTATUS_FAILED;
 
+    if ((cmd_len > 3) && (p_cmd[0] == 0x20) && (p_cmd[1] == 0x02))
+    {
+        phNxpNciHal_setConfig_forget(p_cmd, cmd_len);
+    }
+
     HAL_ENABLE_EXT();
     nxpncihal_ctrl.cmd_len = cmd_len;
     memcpy(nxpncihal_ctrl.p_cmd_data, p_cmd, cmd_len);
@@ -21,6 +21,7 @@
 #include <phNxpNciHal_dta.h>
 
 void phNxpNciHal_ext_init (void);
+void phNxpNciHal_ext_dump_stats (void);
 NFCSTATUS phNxpNciHal_process_ext_rsp (uint8_t *p_ntf, uint16_t *p_len);
 NFCSTATUS phNxpNciHal_send_ext_cmd(uint16_t cmd_len, uint8_t *p_cmd);
 NFCSTATUS phNxpNciHal_write_ext(uint16_t *cmd_len, uint8_t *p_cmd_data,
@@ -24,10 +24,14 @@
 int phNxpNciHal_open(nfc_stack_callback_t *p_cback,
         nfc_stack_data_callback_t *p_data_cback);
 int phNxpNciHal_write(uint16_t data_len, const uint8_t *p_data);
+int phNxpNciHal_write_v(uint16_t hdr_len, const uint8_t *p_hdr,
+        uint16_t data_len, const uint8_t *p_data);
 int phNxpNciHal_core_initialized(uint8_t* p_core_init_rsp_params);
 int phNxpNciHal_pre_discover(void);
 int phNxpNciHal_close(void);
 int phNxpNciHal_control_granted(void);
 int phNxpNciHal_power_cycle(void);
+void phNxpNciHal_set_rx_buf_cbacks(nfc_stack_rx_buf_alloc_t *p_alloc,
+        nfc_stack_rx_buf_callback_t *p_cback);
 
 #endif /* _PHNXPNCIHAL_ADAPTATION_H_ */
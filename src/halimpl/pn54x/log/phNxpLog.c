@@ -19,6 +19,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 #include <sys/time.h>
 #include <math.h>
@@ -44,6 +45,23 @@ const char * NXPLOG_ITEM_HCPR    = "NxpHcpR:     ";
 
 static pthread_mutex_t cs_mutex;
 
+/* Byte to two-character hex lookup tables, indexed by (byte * 2) */
+#define HEX_ROW_UPPER(h) h"0" h"1" h"2" h"3" h"4" h"5" h"6" h"7" \
+                         h"8" h"9" h"A" h"B" h"C" h"D" h"E" h"F"
+#define HEX_ROW_LOWER(h) h"0" h"1" h"2" h"3" h"4" h"5" h"6" h"7" \
+                         h"8" h"9" h"a" h"b" h"c" h"d" h"e" h"f"
+
+static const char hex_table_upper[] =
+    HEX_ROW_UPPER("0") HEX_ROW_UPPER("1") HEX_ROW_UPPER("2") HEX_ROW_UPPER("3")
+    HEX_ROW_UPPER("4") HEX_ROW_UPPER("5") HEX_ROW_UPPER("6") HEX_ROW_UPPER("7")
+    HEX_ROW_UPPER("8") HEX_ROW_UPPER("9") HEX_ROW_UPPER("A") HEX_ROW_UPPER("B")
+    HEX_ROW_UPPER("C") HEX_ROW_UPPER("D") HEX_ROW_UPPER("E") HEX_ROW_UPPER("F");
+static const char hex_table_lower[] =
+    HEX_ROW_LOWER("0") HEX_ROW_LOWER("1") HEX_ROW_LOWER("2") HEX_ROW_LOWER("3")
+    HEX_ROW_LOWER("4") HEX_ROW_LOWER("5") HEX_ROW_LOWER("6") HEX_ROW_LOWER("7")
+    HEX_ROW_LOWER("8") HEX_ROW_LOWER("9") HEX_ROW_LOWER("a") HEX_ROW_LOWER("b")
+    HEX_ROW_LOWER("c") HEX_ROW_LOWER("d") HEX_ROW_LOWER("e") HEX_ROW_LOWER("f");
+
 /* global log level structure */
 nci_log_level_t gLog_level;
 /*******************************************************************************
@@ -263,3 +281,26 @@ void phNxpLog_LogBuffer (UINT32 trace_set_mask, const char * item, unsigned char
     }
 
 }
+
+/*******************************************************************************
+ *
+ * Function         phNxpLog_HexEncode
+ *
+ * Description      Encodes len bytes of data as hex into hex, two characters
+ *                  per byte, followed by a terminating NUL. hex must have room
+ *                  for (len * 2) + 1 characters.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void phNxpLog_HexEncode (char *hex, const UINT8 *data, UINT32 len, BOOLEAN lower_case)
+{
+    const char *table = (lower_case) ? hex_table_lower : hex_table_upper;
+
+    while (len--)
+    {
+        memcpy (hex, &table[(*data++) << 1], 2);
+        hex += 2;
+    }
+    *hex = '\0';
+}
@@ -92,6 +92,7 @@ extern const char * NXPLOG_ITEM_HCPR;    /* Android logging tag for NxpHcpR   */
 void phNxpLog_InitializeLogLevel(void);
 void phNxpLog_LogMsg (UINT32 trace_set_mask, const char *item, const char *fmt_str, ...);
 void phNxpLog_LogBuffer (UINT32 trace_set_mask, const char * item, unsigned char *buffer, unsigned len);
+void phNxpLog_HexEncode (char *hex, const UINT8 *data, UINT32 len, BOOLEAN lower_case);
 
 /* ######################################## Defines used for Logging data ######################################### */
 #ifdef NXP_VRBS_REQ
@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* ############################################### Header Includes ################################################ */
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "data_types.h"
+#include "phNxpLog.h"
+#include "phNxpConfig.h"
+#include "phNxpNciTrace.h"
+
+#define PHNXPNCI_TRACE_PATH_MAX     260
+#define PHNXPNCI_TRACE_DUMP_BATCH   16
+
+typedef struct phNxpNciTrace_Ring
+{
+    phNxpNciTrace_Header_t hdr;
+    phNxpNciTrace_Record_t records[1];
+} phNxpNciTrace_Ring_t;
+
+/* NULL while tracing is disabled; never unmapped once set */
+static phNxpNciTrace_Ring_t *p_trace_ring = NULL;
+static uint64_t trace_slot_mask;
+/* Built at init so the signal handler does not have to format anything */
+static char trace_dump_path[PHNXPNCI_TRACE_PATH_MAX + 8];
+
+/*******************************************************************************
+ *
+ * Function         phNxpNciTrace_GetTime
+ *
+ * Description      Reads a clock in nanoseconds.
+ *
+ * Returns          Time in nanoseconds
+ *
+ ******************************************************************************/
+static uint64_t phNxpNciTrace_GetTime (clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime (clock, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+
+/*******************************************************************************
+ *
+ * Function         phNxpNciTrace_SignalHandler
+ *
+ * Description      Dumps the ring next to the trace file. Only uses
+ *                  async-signal-safe calls.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpNciTrace_SignalHandler (int signo)
+{
+    int saved_errno = errno;
+
+    (void) signo;
+    phNxpNciTrace_Dump (trace_dump_path);
+    errno = saved_errno;
+}
+
+/*******************************************************************************
+ *
+ * Function         phNxpNciTrace_Init
+ *
+ * Description      Maps the trace ring onto the file named by
+ *                  NXP_NCI_TRACE_FILE. Tracing stays disabled when the entry
+ *                  is missing. A ring left over from a previous run is kept
+ *                  as <file>.prev. Calling this again once the ring is mapped
+ *                  has no effect.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void phNxpNciTrace_Init (void)
+{
+    char path[PHNXPNCI_TRACE_PATH_MAX];
+    char prev_path[PHNXPNCI_TRACE_PATH_MAX + 8];
+    unsigned long slots = PHNXPNCI_TRACE_DEFAULT_SLOTS;
+    unsigned long signo = 0;
+    phNxpNciTrace_Ring_t *ring;
+    size_t size;
+    int fd;
+
+    if (p_trace_ring != NULL)
+    {
+        return;
+    }
+    memset (path, 0, sizeof(path));
+    if (!GetNxpStrValue (NAME_NXP_NCI_TRACE_FILE, path, sizeof(path)) || (path[0] == '\0'))
+    {
+        return;
+    }
+    if (GetNxpNumValue (NAME_NXP_NCI_TRACE_SLOTS, &slots, sizeof(slots)))
+    {
+        if ((slots == 0) || (slots & (slots - 1)))
+        {
+            NXPLOG_NCIHAL_W ("NCI trace: slot count %lu is not a power of two, using %d",
+                    slots, PHNXPNCI_TRACE_DEFAULT_SLOTS);
+            slots = PHNXPNCI_TRACE_DEFAULT_SLOTS;
+        }
+    }
+
+    snprintf (prev_path, sizeof(prev_path), "%s.prev", path);
+    rename (path, prev_path);
+
+    size = sizeof(phNxpNciTrace_Header_t) + (slots * sizeof(phNxpNciTrace_Record_t));
+    fd = open (path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        NXPLOG_NCIHAL_E ("NCI trace: cannot open %s (%d)", path, errno);
+        return;
+    }
+    if (ftruncate (fd, size) != 0)
+    {
+        NXPLOG_NCIHAL_E ("NCI trace: cannot size %s (%d)", path, errno);
+        close (fd);
+        return;
+    }
+    ring = (phNxpNciTrace_Ring_t *) mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close (fd);
+    if (ring == MAP_FAILED)
+    {
+        NXPLOG_NCIHAL_E ("NCI trace: cannot map %s (%d)", path, errno);
+        return;
+    }
+
+    ring->hdr.version = PHNXPNCI_TRACE_VERSION;
+    ring->hdr.record_size = sizeof(phNxpNciTrace_Record_t);
+    ring->hdr.slot_count = slots;
+    ring->hdr.next_seq = 0;
+    ring->hdr.realtime_offset_ns = (int64_t) (phNxpNciTrace_GetTime (CLOCK_REALTIME)
+            - phNxpNciTrace_GetTime (CLOCK_MONOTONIC));
+    /* Written last so the decoder never accepts a half initialised header */
+    __atomic_store_n (&ring->hdr.magic, PHNXPNCI_TRACE_MAGIC, __ATOMIC_RELEASE);
+
+    snprintf (trace_dump_path, sizeof(trace_dump_path), "%s.dump", path);
+    trace_slot_mask = slots - 1;
+    __atomic_store_n (&p_trace_ring, ring, __ATOMIC_RELEASE);
+
+    if (GetNxpNumValue (NAME_NXP_NCI_TRACE_DUMP_SIGNAL, &signo, sizeof(signo)) && (signo != 0))
+    {
+        struct sigaction sa;
+
+        memset (&sa, 0, sizeof(sa));
+        sa.sa_handler = phNxpNciTrace_SignalHandler;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset (&sa.sa_mask);
+        if (sigaction ((int) signo, &sa, NULL) != 0)
+        {
+            NXPLOG_NCIHAL_W ("NCI trace: cannot install handler for signal %lu", signo);
+        }
+    }
+    NXPLOG_NCIHAL_D ("NCI trace: %lu slots in %s", slots, path);
+}
+
+/*******************************************************************************
+ *
+ * Function         phNxpNciTrace_Record
+ *
+ * Description      Appends one frame to the trace ring. Lock free and safe to
+ *                  call from any thread; returns immediately when tracing is
+ *                  disabled. Frames longer than PHNXPNCI_TRACE_MAX_DATA are
+ *                  truncated but keep their original length.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void phNxpNciTrace_Record (uint8_t direction, const uint8_t *p_data, uint16_t len)
+{
+    phNxpNciTrace_RecordV (direction, p_data, len, NULL, 0);
+}
+
+/*******************************************************************************
+ *
+ * Function         phNxpNciTrace_RecordV
+ *
+ * Description      Same as phNxpNciTrace_Record, for a frame given as a header
+ *                  and a payload
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void phNxpNciTrace_RecordV (uint8_t direction, const uint8_t *p_hdr, uint16_t hdr_len,
+        const uint8_t *p_data, uint16_t len)
+{
+    phNxpNciTrace_Ring_t *ring = __atomic_load_n (&p_trace_ring, __ATOMIC_ACQUIRE);
+    phNxpNciTrace_Record_t *rec;
+    uint64_t seq;
+    uint16_t n;
+
+    if (ring == NULL)
+    {
+        return;
+    }
+    seq = __atomic_add_fetch (&ring->hdr.next_seq, 1, __ATOMIC_RELAXED);
+    rec = &ring->records[(seq - 1) & trace_slot_mask];
+
+    /* Same protocol as a seqlock: readers drop a slot whose seq is 0 or changed */
+    __atomic_store_n (&rec->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    rec->timestamp_ns = phNxpNciTrace_GetTime (CLOCK_MONOTONIC);
+    rec->length = hdr_len + len;
+    rec->direction = direction;
+    n = (hdr_len < PHNXPNCI_TRACE_MAX_DATA) ? hdr_len : PHNXPNCI_TRACE_MAX_DATA;
+    memcpy (rec->data, p_hdr, n);
+    if ((len > 0) && (n < PHNXPNCI_TRACE_MAX_DATA))
+    {
+        memcpy (rec->data + n, p_data,
+                (len < PHNXPNCI_TRACE_MAX_DATA - n) ? len : PHNXPNCI_TRACE_MAX_DATA - n);
+    }
+    __atomic_store_n (&rec->seq, seq, __ATOMIC_RELEASE);
+}
+
+/*******************************************************************************
+ *
+ * Function         phNxpNciTrace_Dump
+ *
+ * Description      Writes a consistent copy of the trace ring to path, in the
+ *                  same format as the trace file. Records being written while
+ *                  the dump runs are left out. Async-signal-safe.
+ *
+ * Returns          0 on success, -1 on failure (errno set)
+ *
+ ******************************************************************************/
+int phNxpNciTrace_Dump (const char *path)
+{
+    phNxpNciTrace_Ring_t *ring = __atomic_load_n (&p_trace_ring, __ATOMIC_ACQUIRE);
+    phNxpNciTrace_Header_t hdr;
+    phNxpNciTrace_Record_t batch[PHNXPNCI_TRACE_DUMP_BATCH];
+    uint32_t slot, i, n;
+    uint64_t seq;
+    int fd;
+    int ret = 0;
+
+    if (ring == NULL)
+    {
+        errno = ENODEV;
+        return -1;
+    }
+    fd = open (path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    hdr = ring->hdr;
+    hdr.next_seq = __atomic_load_n (&ring->hdr.next_seq, __ATOMIC_ACQUIRE);
+    if (write (fd, &hdr, sizeof(hdr)) != (ssize_t) sizeof(hdr))
+    {
+        ret = -1;
+    }
+
+    for (slot = 0; (ret == 0) && (slot < hdr.slot_count); slot += n)
+    {
+        n = hdr.slot_count - slot;
+        if (n > PHNXPNCI_TRACE_DUMP_BATCH)
+        {
+            n = PHNXPNCI_TRACE_DUMP_BATCH;
+        }
+        for (i = 0; i < n; i++)
+        {
+            phNxpNciTrace_Record_t *rec = &ring->records[slot + i];
+
+            seq = __atomic_load_n (&rec->seq, __ATOMIC_ACQUIRE);
+            memcpy (&batch[i], rec, sizeof(batch[i]));
+            __atomic_thread_fence (__ATOMIC_ACQUIRE);
+            if ((seq == 0) || (__atomic_load_n (&rec->seq, __ATOMIC_RELAXED) != seq))
+            {
+                seq = 0;
+            }
+            batch[i].seq = seq;
+        }
+        if (write (fd, batch, n * sizeof(batch[0])) != (ssize_t) (n * sizeof(batch[0])))
+        {
+            ret = -1;
+        }
+    }
+
+    close (fd);
+    return ret;
+}
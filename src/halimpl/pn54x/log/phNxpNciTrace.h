@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Binary NCI packet trace ring.
+ *
+ * Every frame exchanged with the NFCC is stored as a fixed size record in a
+ * ring that is memory mapped onto NXP_NCI_TRACE_FILE, so the trace survives a
+ * crash of the process. Writers reserve a slot with an atomic increment and
+ * never block each other. The ring (or a dump of it) is decoded offline by
+ * tools/nfcTraceDecode.
+ *
+ * This header also describes the on-disk layout and is shared with the
+ * decoder, so it must not depend on anything but <stdint.h>.
+ */
+
+#if ! defined (PHNXPNCITRACE__H_INCLUDED)
+#define PHNXPNCITRACE__H_INCLUDED
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PHNXPNCI_TRACE_MAGIC            0x5449434EU /* "NCIT" little endian */
+#define PHNXPNCI_TRACE_VERSION          1
+#define PHNXPNCI_TRACE_DEFAULT_SLOTS    1024        /* must be a power of two */
+#define PHNXPNCI_TRACE_MAX_DATA         264         /* largest frame kept in full */
+
+/* Record direction */
+#define PHNXPNCI_TRACE_DIR_TX           0x01        /* written to the NFCC by TML */
+#define PHNXPNCI_TRACE_DIR_RX           0x02        /* read from the NFCC by TML */
+#define PHNXPNCI_TRACE_DIR_STACK_TX     0x03        /* handed to the HAL by the NCI stack */
+
+/* File header, at offset 0 of the trace file */
+typedef struct phNxpNciTrace_Header
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t slot_count;
+    uint32_t reserved;
+    uint64_t next_seq;              /* last sequence number handed out */
+    int64_t  realtime_offset_ns;    /* CLOCK_REALTIME - CLOCK_MONOTONIC at init */
+} phNxpNciTrace_Header_t;
+
+/* One frame; slot_count of these follow the header */
+typedef struct phNxpNciTrace_Record
+{
+    uint64_t seq;                   /* 0 while empty or being written */
+    uint64_t timestamp_ns;          /* CLOCK_MONOTONIC */
+    uint16_t length;                /* frame length, may exceed what is stored */
+    uint8_t  direction;
+    uint8_t  reserved[5];
+    uint8_t  data[PHNXPNCI_TRACE_MAX_DATA];
+} phNxpNciTrace_Record_t;
+
+void phNxpNciTrace_Init (void);
+void phNxpNciTrace_Record (uint8_t direction, const uint8_t *p_data, uint16_t len);
+void phNxpNciTrace_RecordV (uint8_t direction, const uint8_t *p_hdr, uint16_t hdr_len,
+        const uint8_t *p_data, uint16_t len);
+int phNxpNciTrace_Dump (const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PHNXPNCITRACE__H_INCLUDED */
@@ -21,9 +21,12 @@
 #include <phTmlNfc.h>
 #include <phOsalNfc_Timer.h>
 #include <phNxpLog.h>
+#include <phNxpNciTrace.h>
 #include <phDal4Nfc_messageQueueLib.h>
+#include <phTmlNfc_WriteQueue.h>
 #include <phTmlNfc_i2c.h>
 #include <phNxpNciHal_utils.h>
+#include <phNxpConfig.h>
 
 #define CUSTOM_MAX_READ_ERROR_BEFORE_ABORT 100
 static uint8_t s_customReadErrCounter = 0;
@@ -46,6 +49,22 @@ static uint8_t bCurrentRetryCount = (2000 / PHTMLNFC_MAXTIME_RETRANSMIT) + 1;
 /* Initialize Context structure pointer used to access context structure */
 phTmlNfc_Context_t *gpphTmlNfc_Context = NULL;
 phTmlNfc_i2cfragmentation_t fragmentation_enabled = I2C_FRAGMENATATION_DISABLED;
+/* NFCC reset through VEN, see NXP_VEN_RESET_MODE */
+#define PH_TMLNFC_VEN_RESET_FIXED           (0)     /* fixed delays */
+#define PH_TMLNFC_VEN_RESET_READY           (1)     /* wait for the NFCC IRQ */
+#define PH_TMLNFC_VEN_LOW_TIME_DEF          (100)   /* ms */
+#define PH_TMLNFC_VEN_BOOT_TIMEOUT_DEF      (100)   /* ms */
+
+typedef struct phTmlNfc_VenReset
+{
+    unsigned long dwMode;
+    unsigned long dwLowTime;        /* ms VEN is held at each level */
+    unsigned long dwBootTimeout;    /* ms the NFCC may take to boot */
+} phTmlNfc_VenReset_t;
+
+static phTmlNfc_VenReset_t tVenReset = {
+    PH_TMLNFC_VEN_RESET_FIXED, PH_TMLNFC_VEN_LOW_TIME_DEF, PH_TMLNFC_VEN_BOOT_TIMEOUT_DEF };
+
 /* Local Function prototypes */
 static NFCSTATUS phTmlNfc_StartThread(void);
 static void phTmlNfc_CleanUp(void);
@@ -55,6 +74,8 @@ static void phTmlNfc_TmlThread(void *pParam);
 static void phTmlNfc_TmlWriterThread(void *pParam);
 static void phTmlNfc_ReTxTimerCb(uint32_t dwTimerId, void *pContext);
 static NFCSTATUS phTmlNfc_InitiateTimer(void);
+static void phTmlNfc_VenResetConfig(void);
+static void phTmlNfc_VenReset(void *pDevHandle);
 
 
 /* Function definitions */
@@ -119,6 +140,10 @@ NFCSTATUS phTmlNfc_Init(pphTmlNfc_Config_t pConfig)
             }
             else
             {
+                /*Reset PN54X*/
+                phTmlNfc_VenResetConfig();
+                phTmlNfc_VenReset(gpphTmlNfc_Context->pDevHandle);
+
                 gpphTmlNfc_Context->tReadInfo.bEnable = 0;
                 gpphTmlNfc_Context->tWriteInfo.bEnable = 0;
                 gpphTmlNfc_Context->tReadInfo.bThreadBusy = FALSE;
@@ -157,6 +182,7 @@ NFCSTATUS phTmlNfc_Init(pphTmlNfc_Config_t pConfig)
                             /** Retry Count = Standby Recovery time of NFCC / Retransmission time + 1 */
                             gpphTmlNfc_Context->bRetryCount = (2000 / PHTMLNFC_MAXTIME_RETRANSMIT) + 1;
                             gpphTmlNfc_Context->bWriteCbInvoked = FALSE;
+                            phTmlNfc_WriteQueueReset();
                         }
                         else
                         {
@@ -342,6 +368,7 @@ static void phTmlNfc_TmlThread(void *pParam)
     NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
     int32_t dwNoBytesWrRd = PH_TMLNFC_RESET_VALUE;
     uint8_t temp[260];
+    uint8_t *pReadBuf;
     /* Transaction info buffer to be passed to Callback Thread */
     static phTmlNfc_TransactInfo_t tTransactionInfo;
     /* Structure containing Tml callback function and parameters to be invoked
@@ -374,9 +401,23 @@ static void phTmlNfc_TmlThread(void *pParam)
             if ((uintptr_t)gpphTmlNfc_Context->pDevHandle > 0)
             {
                 NXPLOG_TML_D("PN54X - Invoking I2C Read.....\n");
-                dwNoBytesWrRd = phTmlNfc_i2c_read(gpphTmlNfc_Context->pDevHandle, temp, 260);
+                /* Read straight into the caller's buffer when a full frame fits */
+                pReadBuf = (gpphTmlNfc_Context->tReadInfo.wLength >= sizeof(temp)) ?
+                        gpphTmlNfc_Context->tReadInfo.pBuffer : temp;
+                dwNoBytesWrRd = phTmlNfc_i2c_read(gpphTmlNfc_Context->pDevHandle, pReadBuf, sizeof(temp));
 
-                if (-1 == dwNoBytesWrRd)
+                if (PH_TMLNFC_I2C_READ_ABORTED == dwNoBytesWrRd)
+                {
+                    /* Read aborted, shutdown or mode switch: start over if the
+                       read is still wanted, without counting it as an error */
+                    NXPLOG_TML_D("PN54X - I2C Read aborted.....\n");
+                    if ((1 == gpphTmlNfc_Context->tReadInfo.bEnable) &&
+                            (gpphTmlNfc_Context->bThreadDone))
+                    {
+                        sem_post(&gpphTmlNfc_Context->rxSemaphore);
+                    }
+                }
+                else if (-1 == dwNoBytesWrRd)
                 {
                     NXPLOG_TML_E("PN54X - Error in I2C Read.....\n");
                     s_customReadErrCounter++;
@@ -426,7 +467,10 @@ static void phTmlNfc_TmlThread(void *pParam)
                 else
                 {
                     s_customReadErrCounter = 0; // reset counter
-                    memcpy(gpphTmlNfc_Context->tReadInfo.pBuffer, temp, dwNoBytesWrRd);
+                    if (pReadBuf == temp)
+                    {
+                        memcpy(gpphTmlNfc_Context->tReadInfo.pBuffer, temp, dwNoBytesWrRd);
+                    }
 
                     NXPLOG_TML_D("PN54X - I2C Read successful.....\n");
                     /* This has to be reset only after a successful read */
@@ -451,6 +495,8 @@ static void phTmlNfc_TmlThread(void *pParam)
                     gpphTmlNfc_Context->tReadInfo.wLength = (uint16_t) (dwNoBytesWrRd);
                     phNxpNciHal_print_packet("RECV", gpphTmlNfc_Context->tReadInfo.pBuffer,
                             gpphTmlNfc_Context->tReadInfo.wLength);
+                    phNxpNciTrace_Record(PHNXPNCI_TRACE_DIR_RX, gpphTmlNfc_Context->tReadInfo.pBuffer,
+                            gpphTmlNfc_Context->tReadInfo.wLength);
 
                     dwNoBytesWrRd = PH_TMLNFC_RESET_VALUE;
 
@@ -480,7 +526,6 @@ static void phTmlNfc_TmlThread(void *pParam)
         else
         {
             NXPLOG_TML_D("PN54X - read request NOT enabled");
-            usleep(10*1000);
         }
     }/* End of While loop */
 
@@ -519,8 +564,13 @@ static void phTmlNfc_TmlWriterThread(void *pParam)
     {
         NXPLOG_TML_D("PN54X - Tml Writer Thread Running................\n");
         sem_wait(&gpphTmlNfc_Context->txSemaphore);
+        /* Queued writes were submitted first, so they go out first */
+        if (TRUE == phTmlNfc_WriteQueueService(gpphTmlNfc_Context->pDevHandle, &phTmlNfc_i2c_write))
+        {
+            continue;
+        }
         /* If Tml write is requested */
-        if (1 == gpphTmlNfc_Context->tWriteInfo.bEnable)
+        else if (1 == gpphTmlNfc_Context->tWriteInfo.bEnable)
         {
             NXPLOG_TML_D("PN54X - Write requested.....\n");
             /* Set the variable to success initially */
@@ -558,6 +608,8 @@ static void phTmlNfc_TmlWriterThread(void *pParam)
                 {
                     phNxpNciHal_print_packet("SEND", gpphTmlNfc_Context->tWriteInfo.pBuffer,
                             gpphTmlNfc_Context->tWriteInfo.wLength);
+                    phNxpNciTrace_Record(PHNXPNCI_TRACE_DIR_TX, gpphTmlNfc_Context->tWriteInfo.pBuffer,
+                            gpphTmlNfc_Context->tWriteInfo.wLength);
                 }
                 retry_cnt = 0;
                 if (NFCSTATUS_SUCCESS == wStatus)
@@ -693,16 +745,13 @@ NFCSTATUS phTmlNfc_Shutdown(void)
     {
         /* Reset thread variable to terminate the thread */
         gpphTmlNfc_Context->bThreadDone = 0;
-        usleep(1000);
-        /* Clear All the resources allocated during initialization */
+        /* Release the reader if it is blocked waiting for the PN54X */
+        phTmlNfc_i2c_wakeup();
+        /* Release the threads; the joins below wait for them to exit */
         sem_post(&gpphTmlNfc_Context->rxSemaphore);
-        usleep(1000);
         sem_post(&gpphTmlNfc_Context->txSemaphore);
-        usleep(1000);
         sem_post(&gpphTmlNfc_Context->postMsgSemaphore);
-        usleep(1000);
         sem_post(&gpphTmlNfc_Context->postMsgSemaphore);
-        usleep(1000);
         if (0 != pthread_join(gpphTmlNfc_Context->readerThread, (void**)NULL))
         {
             NXPLOG_TML_E ("Fail to kill reader thread!");
@@ -887,6 +936,8 @@ NFCSTATUS phTmlNfc_ReadAbort(void)
 {
     NFCSTATUS wStatus = NFCSTATUS_INVALID_PARAMETER;
     gpphTmlNfc_Context->tReadInfo.bEnable = 0;
+    /* Release the reader if it is blocked waiting for the PN54X */
+    phTmlNfc_i2c_wakeup();
 
     /*Reset the flag to accept another Read Request */
     gpphTmlNfc_Context->tReadInfo.bThreadBusy=FALSE;
@@ -957,20 +1008,23 @@ NFCSTATUS phTmlNfc_IoCtl(phTmlNfc_ControlCode_t eControlCode)
             case phTmlNfc_e_ResetDevice:
                 {
                     /*Reset PN54X*/
-                    phTmlNfc_i2c_reset(gpphTmlNfc_Context->pDevHandle, 1);
-                    usleep(100 * 1000);
-                    phTmlNfc_i2c_reset(gpphTmlNfc_Context->pDevHandle, 0);
-                    usleep(100 * 1000);
-                    phTmlNfc_i2c_reset(gpphTmlNfc_Context->pDevHandle, 1);
+                    phTmlNfc_VenReset(gpphTmlNfc_Context->pDevHandle);
                     break;
                 }
             case phTmlNfc_e_EnableNormalMode:
                 {
                     /*Reset PN54X*/
-                    phTmlNfc_i2c_reset(gpphTmlNfc_Context->pDevHandle, 0);
-                    usleep(10 * 1000);
-                    phTmlNfc_i2c_reset(gpphTmlNfc_Context->pDevHandle, 1);
-                    usleep(100 * 1000);
+                    if (PH_TMLNFC_VEN_RESET_READY == tVenReset.dwMode)
+                    {
+                        phTmlNfc_VenReset(gpphTmlNfc_Context->pDevHandle);
+                    }
+                    else
+                    {
+                        phTmlNfc_i2c_reset(gpphTmlNfc_Context->pDevHandle, 0);
+                        usleep(10 * 1000);
+                        phTmlNfc_i2c_reset(gpphTmlNfc_Context->pDevHandle, 1);
+                        usleep(100 * 1000);
+                    }
                     break;
                 }
             case phTmlNfc_e_EnableDownloadMode:
@@ -991,6 +1045,81 @@ NFCSTATUS phTmlNfc_IoCtl(phTmlNfc_ControlCode_t eControlCode)
     return wStatus;
 }
 
+/*******************************************************************************
+**
+** Function         phTmlNfc_VenResetConfig
+**
+** Description      Reads the VEN reset settings from the config file
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phTmlNfc_VenResetConfig(void)
+{
+    unsigned long num = 0;
+
+    tVenReset.dwMode = PH_TMLNFC_VEN_RESET_FIXED;
+    tVenReset.dwLowTime = PH_TMLNFC_VEN_LOW_TIME_DEF;
+    tVenReset.dwBootTimeout = PH_TMLNFC_VEN_BOOT_TIMEOUT_DEF;
+    if (GetNxpNumValue(NAME_NXP_VEN_RESET_MODE, &num, sizeof(num)))
+    {
+        tVenReset.dwMode = (num == PH_TMLNFC_VEN_RESET_READY) ?
+                PH_TMLNFC_VEN_RESET_READY : PH_TMLNFC_VEN_RESET_FIXED;
+    }
+    if (GetNxpNumValue(NAME_NXP_VEN_LOW_TIME, &num, sizeof(num)))
+    {
+        tVenReset.dwLowTime = num;
+    }
+    if (GetNxpNumValue(NAME_NXP_VEN_BOOT_TIMEOUT, &num, sizeof(num)))
+    {
+        tVenReset.dwBootTimeout = num;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_VenReset
+**
+** Description      Resets the PN54X through VEN, see NXP_VEN_RESET_MODE.
+**                  PH_TMLNFC_VEN_RESET_FIXED: VEN high, low and high again,
+**                  each level held for NXP_VEN_LOW_TIME.
+**                  PH_TMLNFC_VEN_RESET_READY: VEN low for NXP_VEN_LOW_TIME,
+**                  then high until the PN54X raises its IRQ, at most
+**                  NXP_VEN_BOOT_TIMEOUT. Without IRQ the first command is
+**                  retried while the PN54X boots.
+**
+** Parameters       pDevHandle  - valid device handle
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phTmlNfc_VenReset(void *pDevHandle)
+{
+    int ready;
+
+    if (PH_TMLNFC_VEN_RESET_READY != tVenReset.dwMode)
+    {
+        phTmlNfc_i2c_reset(pDevHandle, 1);
+        usleep(tVenReset.dwLowTime * 1000);
+        phTmlNfc_i2c_reset(pDevHandle, 0);
+        usleep(tVenReset.dwLowTime * 1000);
+        phTmlNfc_i2c_reset(pDevHandle, 1);
+        return;
+    }
+
+    phTmlNfc_i2c_reset(pDevHandle, 0);
+    usleep(tVenReset.dwLowTime * 1000);
+    phTmlNfc_i2c_reset(pDevHandle, 1);
+    ready = phTmlNfc_i2c_wait_ready(pDevHandle, (uint32_t)tVenReset.dwBootTimeout);
+    if (ready < 0)
+    {
+        usleep(tVenReset.dwBootTimeout * 1000);
+    }
+    NXPLOG_TML_D("PN54X - VEN reset, NFCC %s", (ready > 0) ? "ready" : "boot timeout");
+}
+
 /*******************************************************************************
 **
 ** Function         phTmlNfc_DeferredCall
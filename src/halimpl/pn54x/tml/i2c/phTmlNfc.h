@@ -45,6 +45,17 @@
  */
 #define PH_TMLNFC_RESETDEVICE               (0x00008001)
 
+/*
+ * Number of writes phTmlNfc_WriteQueued can hold, either waiting for the
+ * writer thread or waiting for their completion to be delivered
+ */
+#define PH_TMLNFC_WRITE_QUEUE_DEPTH         (8)
+
+/*
+ * Largest packet phTmlNfc_WriteQueued accepts
+ */
+#define PH_TMLNFC_WRITE_QUEUE_MAX_LEN       (260)
+
 /*
 ***************************Globals,Structure and Enumeration ******************
 */
@@ -198,6 +209,7 @@ typedef enum
 NFCSTATUS phTmlNfc_Init(pphTmlNfc_Config_t pConfig);
 NFCSTATUS phTmlNfc_Shutdown(void);
 NFCSTATUS phTmlNfc_Write(uint8_t *pBuffer, uint16_t wLength, pphTmlNfc_TransactCompletionCb_t pTmlWriteComplete,  void *pContext);
+NFCSTATUS phTmlNfc_WriteQueued(const uint8_t *pBuffer, uint16_t wLength, pphTmlNfc_TransactCompletionCb_t pTmlWriteComplete,  void *pContext);
 NFCSTATUS phTmlNfc_Read(uint8_t *pBuffer, uint16_t wLength, pphTmlNfc_TransactCompletionCb_t pTmlReadComplete,  void *pContext);
 NFCSTATUS phTmlNfc_WriteAbort(void);
 NFCSTATUS phTmlNfc_ReadAbort(void);
@@ -25,8 +25,13 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <sys/ioctl.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <time.h>
 #include <errno.h>
+#include <signal.h>
+#include <pthread.h>
 
 #include <linux/i2c-dev.h>
 #include <linux/i2c.h>
@@ -45,6 +50,20 @@
 #define FRAGMENTSIZE_MAX            PHNFC_I2C_FRAGMENT_SIZE
 static bool_t bFwDnldFlag = FALSE;
 
+/* Reader waits on the device fd (IRQ GPIO fd in ALT mode) and on an eventfd
+   used to abort the read. bDevPoll is FALSE when the driver has no poll. */
+static int iReadEpollFd = -1;
+static int iReadWakeFd  = -1;
+static bool_t bDevPoll  = FALSE;
+
+/* Without poll, a read blocked in the driver is interrupted with this signal.
+   Its handler does nothing, so that read() returns EINTR. */
+#define PH_TMLNFC_I2C_ABORT_SIGNAL   (SIGRTMIN + 3)
+#define PH_TMLNFC_I2C_ABORT_RETRIES  100        /* signals, 1 ms apart */
+static bool_t bAbortSignal = FALSE;             /* handler installed */
+static bool_t bReadBlocked = FALSE;             /* tReadThread may be in read() */
+static pthread_t tReadThread;
+
 // ----------------------------------------------------------------------------
 // Alternative use
 // ----------------------------------------------------------------------------
@@ -230,6 +249,167 @@ void phTmlNfc_i2c_close(void *pDevHandle)
 #else
     if (NULL != pDevHandle) close((intptr_t)pDevHandle);
 #endif
+    if (iReadEpollFd >= 0) close(iReadEpollFd);
+    if (iReadWakeFd  >= 0) close(iReadWakeFd);
+    iReadEpollFd = iReadWakeFd = -1;
+    bDevPoll = FALSE;
+
+    return;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_abort_handler
+**
+** Description      Handler of PH_TMLNFC_I2C_ABORT_SIGNAL. Does nothing: the
+**                  signal only makes a read() blocked in the driver return.
+**
+** Parameters       signo - signal number
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phTmlNfc_i2c_abort_handler(int signo)
+{
+    UNUSED(signo);
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_nopoll_init
+**
+** Description      Prepares reads for a driver without poll: they block in
+**                  read(), which phTmlNfc_i2c_wakeup interrupts with
+**                  PH_TMLNFC_I2C_ABORT_SIGNAL. A driver whose read ignores
+**                  signals still holds a read abort or shutdown until the
+**                  next PN54X frame.
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phTmlNfc_i2c_nopoll_init(void)
+{
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = phTmlNfc_i2c_abort_handler;
+    /* no SA_RESTART: read() must return EINTR */
+    sa.sa_flags = 0;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(PH_TMLNFC_I2C_ABORT_SIGNAL, &sa, NULL) != 0)
+    {
+        NXPLOG_TML_E("_i2c_open() sigaction errno : %x", errno);
+        NXPLOG_TML_W("_i2c_open() driver has no poll: a read abort waits for the next frame");
+        return;
+    }
+    bAbortSignal = TRUE;
+    NXPLOG_TML_W("_i2c_open() driver has no poll: reads block in the driver and are aborted "
+            "with signal %d", PH_TMLNFC_I2C_ABORT_SIGNAL);
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_epoll_init
+**
+** Description      Sets up the epoll set phTmlNfc_i2c_read waits on: the fd
+**                  signalling PN54X data and the eventfd signalled by
+**                  phTmlNfc_i2c_wakeup. A driver without poll (EPERM) is
+**                  left out; reads then block in read() instead, see
+**                  phTmlNfc_i2c_nopoll_init.
+**
+** Parameters       nHandle - device or IRQ GPIO fd, -1 if none
+**                  dwEvents - epoll events of nHandle
+**
+** Returns          NFC status:
+**                  NFCSTATUS_SUCCESS            - epoll set ready
+**                  NFCSTATUS_INVALID_DEVICE     - epoll/eventfd setup failure
+**
+*******************************************************************************/
+static NFCSTATUS phTmlNfc_i2c_epoll_init(int nHandle, uint32_t dwEvents)
+{
+    struct epoll_event ev;
+
+    bDevPoll = FALSE;
+    iReadWakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    iReadEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if ((iReadWakeFd < 0) || (iReadEpollFd < 0))
+    {
+        NXPLOG_TML_E("_i2c_open() epoll/eventfd errno : %x", errno);
+        return NFCSTATUS_INVALID_DEVICE;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = iReadWakeFd;
+    if (epoll_ctl(iReadEpollFd, EPOLL_CTL_ADD, iReadWakeFd, &ev) < 0)
+    {
+        NXPLOG_TML_E("_i2c_open() epoll_ctl(wake) errno : %x", errno);
+        return NFCSTATUS_INVALID_DEVICE;
+    }
+
+    if (nHandle < 0)
+    {
+        NXPLOG_TML_D("_i2c_open() no fd to poll, blocking reads");
+        return NFCSTATUS_SUCCESS;
+    }
+    ev.events = dwEvents;
+    ev.data.fd = nHandle;
+    if (epoll_ctl(iReadEpollFd, EPOLL_CTL_ADD, nHandle, &ev) < 0)
+    {
+        if (errno == EPERM)
+        {
+            phTmlNfc_i2c_nopoll_init();
+            return NFCSTATUS_SUCCESS;
+        }
+        NXPLOG_TML_E("_i2c_open() epoll_ctl(dev) errno : %x", errno);
+        return NFCSTATUS_INVALID_DEVICE;
+    }
+    bDevPoll = TRUE;
+
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_wakeup
+**
+** Description      Makes a phTmlNfc_i2c_read blocked waiting for the PN54X
+**                  return PH_TMLNFC_I2C_READ_ABORTED (read abort, shutdown or
+**                  mode switch). If no read is pending, the next one returns it.
+**                  Without poll, a read blocked in the driver is signalled
+**                  until it returns, for at most PH_TMLNFC_I2C_ABORT_RETRIES ms.
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_i2c_wakeup(void)
+{
+    uint64_t val = 1;
+    int i;
+
+    if (iReadWakeFd >= 0)
+    {
+        if (write(iReadWakeFd, &val, sizeof(val)) != sizeof(val))
+        {
+            NXPLOG_TML_E("i2c wakeup errno : %x", errno);
+        }
+    }
+
+    /* no poll: interrupt a read blocked in the driver */
+    for (i = 0; bAbortSignal && __atomic_load_n(&bReadBlocked, __ATOMIC_ACQUIRE); i++)
+    {
+        if (i == PH_TMLNFC_I2C_ABORT_RETRIES)
+        {
+            NXPLOG_TML_W("i2c wakeup: read not interrupted, it ends with the next frame");
+            break;
+        }
+        pthread_kill(tReadThread, PH_TMLNFC_I2C_ABORT_SIGNAL);
+        usleep(1000);
+    }
 
     return;
 }
@@ -238,7 +418,8 @@ void phTmlNfc_i2c_close(void *pDevHandle)
 **
 ** Function         phTmlNfc_i2c_open_and_configure
 **
-** Description      Open and configure PN54X device
+** Description      Open and configure PN54X device. The caller resets the
+**                  PN54X afterwards.
 **
 ** Parameters       pConfig     - hardware information
 **                  pLinkHandle - device handle
@@ -278,14 +459,15 @@ NFCSTATUS phTmlNfc_i2c_open_and_configure(pphTmlNfc_Config_t pConfig, void ** pL
         return( NFCSTATUS_INVALID_DEVICE );
     }
 
-    /*Reset NFC Controller */
-    pnOn();
-    usleep(100 * 1000);
-    pnOff();
-    usleep(100 * 1000);
-    pnOn();
-    
     *pLinkHandle = (void*) ((intptr_t)dummyHandle);
+
+    /* i2c-dev has no poll: wait for a rising edge on the IRQ pin instead */
+    if (NFCSTATUS_SUCCESS != phTmlNfc_i2c_epoll_init((iInterruptFd > 0) ? iInterruptFd : -1, EPOLLPRI))
+    {
+        phTmlNfc_i2c_close(*pLinkHandle);
+        *pLinkHandle = NULL;
+        return NFCSTATUS_INVALID_DEVICE;
+    }
 #else
     int nHandle;
     NXPLOG_TML_D("phTmlNfc_i2c_open_and_configure\n");
@@ -301,17 +483,121 @@ NFCSTATUS phTmlNfc_i2c_open_and_configure(pphTmlNfc_Config_t pConfig, void ** pL
 
     *pLinkHandle = (void*) ((intptr_t)nHandle);
 
-    /*Reset PN54X*/
-    phTmlNfc_i2c_reset((void *)((intptr_t)nHandle), 1);
-    usleep(100 * 1000);
-    phTmlNfc_i2c_reset((void *)((intptr_t)nHandle), 0);
-    usleep(100 * 1000);
-    phTmlNfc_i2c_reset((void *)((intptr_t)nHandle), 1);
+    if (NFCSTATUS_SUCCESS != phTmlNfc_i2c_epoll_init(nHandle, EPOLLIN))
+    {
+        phTmlNfc_i2c_close(*pLinkHandle);
+        *pLinkHandle = NULL;
+        return NFCSTATUS_INVALID_DEVICE;
+    }
 #endif
 
     return NFCSTATUS_SUCCESS;
 }
 
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_wait_data
+**
+** Description      Blocks until the PN54X has data or phTmlNfc_i2c_wakeup is
+**                  called. Without poll support it returns at once and the
+**                  read blocks in the driver instead, see
+**                  phTmlNfc_i2c_read_nopoll.
+**
+** Parameters       None
+**
+** Returns           0   - PN54X data pending (or no way to tell)
+**                  -1   - epoll failure
+**                  PH_TMLNFC_I2C_READ_ABORTED - woken up by phTmlNfc_i2c_wakeup
+**
+*******************************************************************************/
+static int phTmlNfc_i2c_wait_data(void)
+{
+    struct epoll_event events[2];
+    uint64_t val;
+    int ret;
+    int i;
+
+    if (FALSE == bDevPoll)
+    {
+        return 0;
+    }
+
+    for (;;)
+    {
+#ifdef PHFL_TML_ALT_NFC
+        /* IRQ already high; reading the pin also clears its edge event */
+        if (pnGetint() > 0)
+        {
+            return 0;
+        }
+#endif
+        do
+        {
+            ret = epoll_wait(iReadEpollFd, events, 2, -1);
+        } while ((ret < 0) && (errno == EINTR));
+
+        if (ret <= 0)
+        {
+            NXPLOG_TML_E("i2c epoll_wait() errno : %x",errno);
+            return -1;
+        }
+        for (i = 0; i < ret; i++)
+        {
+            if (events[i].data.fd == iReadWakeFd)
+            {
+                /* drain the eventfd; data left on the device is read next time */
+                (void) read(iReadWakeFd, &val, sizeof(val));
+                NXPLOG_TML_D("i2c read aborted");
+                return PH_TMLNFC_I2C_READ_ABORTED;
+            }
+        }
+#ifndef PHFL_TML_ALT_NFC
+        return 0;
+#endif
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_read_nopoll
+**
+** Description      read() for a driver without poll. The eventfd of
+**                  phTmlNfc_i2c_wakeup is checked before blocking and each
+**                  time PH_TMLNFC_I2C_ABORT_SIGNAL interrupts the read.
+**
+** Parameters       nHandle          - device fd
+**                  pBuffer          - buffer for read data
+**                  nNbBytesToRead   - number of bytes to read
+**
+** Returns          as read(), or PH_TMLNFC_I2C_READ_ABORTED
+**
+*******************************************************************************/
+static int phTmlNfc_i2c_read_nopoll(int nHandle, uint8_t * pBuffer, int nNbBytesToRead)
+{
+    uint64_t val;
+    int ret;
+
+    tReadThread = pthread_self();
+    __atomic_store_n(&bReadBlocked, TRUE, __ATOMIC_SEQ_CST);
+    for (;;)
+    {
+        if (read(iReadWakeFd, &val, sizeof(val)) == sizeof(val))
+        {
+            NXPLOG_TML_D("i2c read aborted");
+            ret = PH_TMLNFC_I2C_READ_ABORTED;
+            break;
+        }
+        ret = read(nHandle, pBuffer, nNbBytesToRead);
+        if ((ret >= 0) || (errno != EINTR))
+        {
+            break;
+        }
+    }
+    __atomic_store_n(&bReadBlocked, FALSE, __ATOMIC_RELEASE);
+
+    return ret;
+}
+
 /*******************************************************************************
 **
 ** Function         phTmlNfc_i2c_read
@@ -324,6 +610,7 @@ NFCSTATUS phTmlNfc_i2c_open_and_configure(pphTmlNfc_Config_t pConfig, void ** pL
 **
 ** Returns          numRead   - number of successfully read bytes
 **                  -1        - read operation failure
+**                  PH_TMLNFC_I2C_READ_ABORTED - woken up by phTmlNfc_i2c_wakeup
 **
 *******************************************************************************/
 int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead)
@@ -337,9 +624,7 @@ int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead)
   pDevHandle = (void*)iI2CFd;
 #endif
   
-    int ret_Select;
-    struct timeval tv;
-    fd_set rfds;
+    int ret_Wait;
 
     UNUSED(nNbBytesToRead);
     if (NULL == pDevHandle)
@@ -356,102 +641,98 @@ int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead)
         totalBtyesToRead = FW_DNLD_HEADER_LEN;
     }
 
-    /* Read with 2 second timeout, so that the read thread can be aborted
-       when the PN54X does not respond and we need to switch to FW download
-       mode. This should be done via a control socket instead. */
-    FD_ZERO(&rfds);
-    FD_SET((intptr_t) pDevHandle, &rfds);
-    tv.tv_sec = 2;
-    tv.tv_usec = 1;
-
-    ret_Select = select((int)((intptr_t)pDevHandle + (int)1), &rfds, NULL, NULL, &tv);
-    if (ret_Select < 0)
+    /* Block until the PN54X has data or the read is aborted (read abort,
+       shutdown, FW download mode switch) */
+    ret_Wait = phTmlNfc_i2c_wait_data();
+    if (ret_Wait != 0)
+    {
+        return ret_Wait;
+    }
+#ifdef PHFL_TML_ALT_NFC
+    wait4interrupt();
+#endif
+    if (FALSE == bDevPoll)
+    {
+        ret_Read = phTmlNfc_i2c_read_nopoll((intptr_t)pDevHandle, pBuffer, totalBtyesToRead - numRead);
+        if (ret_Read == PH_TMLNFC_I2C_READ_ABORTED)
+        {
+            return ret_Read;
+        }
+    }
+    else
+    {
+        ret_Read = read((intptr_t)pDevHandle, pBuffer, totalBtyesToRead - numRead);
+    }
+    if (ret_Read > 0)
+    {
+        numRead += ret_Read;
+    }
+    else if (ret_Read == 0)
     {
-        NXPLOG_TML_E("i2c select() errno : %x",errno);
+        NXPLOG_TML_E("_i2c_read() [hdr]EOF");
         return -1;
     }
-    else if (ret_Select == 0)
+    else
     {
-        NXPLOG_TML_E("i2c select() Timeout");
+        NXPLOG_TML_E("_i2c_read() [hdr] errno : %x",errno);
         return -1;
     }
+
+    if (FALSE == bFwDnldFlag)
+    {
+        totalBtyesToRead = NORMAL_MODE_HEADER_LEN;
+    }
     else
+    {
+        totalBtyesToRead = FW_DNLD_HEADER_LEN;
+    }
+
+    if(numRead < totalBtyesToRead)
     {
 #ifdef PHFL_TML_ALT_NFC
         wait4interrupt();
 #endif
         ret_Read = read((intptr_t)pDevHandle, pBuffer, totalBtyesToRead - numRead);
-        if (ret_Read > 0)
-        {
-            numRead += ret_Read;
-        }
-        else if (ret_Read == 0)
-        {
-            NXPLOG_TML_E("_i2c_read() [hdr]EOF");
-            return -1;
-        }
-        else
+        if (ret_Read != totalBtyesToRead - numRead)
         {
             NXPLOG_TML_E("_i2c_read() [hdr] errno : %x",errno);
             return -1;
         }
-
-        if (FALSE == bFwDnldFlag)
-        {
-            totalBtyesToRead = NORMAL_MODE_HEADER_LEN;
-        }
-        else
-        {
-            totalBtyesToRead = FW_DNLD_HEADER_LEN;
-        }
-
-        if(numRead < totalBtyesToRead)
-        {
-#ifdef PHFL_TML_ALT_NFC
-            wait4interrupt();
-#endif
-            ret_Read = read((intptr_t)pDevHandle, pBuffer, totalBtyesToRead - numRead);
-            if (ret_Read != totalBtyesToRead - numRead)
-            {
-                NXPLOG_TML_E("_i2c_read() [hdr] errno : %x",errno);
-                return -1;
-            }
-            else
-            {
-                numRead += ret_Read;
-            }
-        }
-        if(TRUE == bFwDnldFlag)
-        {
-            totalBtyesToRead = pBuffer[FW_DNLD_LEN_OFFSET] + FW_DNLD_HEADER_LEN + CRC_LEN;
-        }
         else
         {
-            totalBtyesToRead = pBuffer[NORMAL_MODE_LEN_OFFSET] + NORMAL_MODE_HEADER_LEN;
+            numRead += ret_Read;
         }
+    }
+    if(TRUE == bFwDnldFlag)
+    {
+        totalBtyesToRead = pBuffer[FW_DNLD_LEN_OFFSET] + FW_DNLD_HEADER_LEN + CRC_LEN;
+    }
+    else
+    {
+        totalBtyesToRead = pBuffer[NORMAL_MODE_LEN_OFFSET] + NORMAL_MODE_HEADER_LEN;
+    }
 #ifdef PHFL_TML_ALT_NFC
-        wait4interrupt();
+    wait4interrupt();
 #endif
-        ret_Read = read((intptr_t)pDevHandle, (pBuffer + numRead), totalBtyesToRead - numRead);
-        if (ret_Read > 0)
-        {
-            numRead += ret_Read;
-        }
-        else if (ret_Read == 0)
-        {
-            NXPLOG_TML_E("_i2c_read() [pyld] EOF");
-            return -1;
-        }
-        else
+    ret_Read = read((intptr_t)pDevHandle, (pBuffer + numRead), totalBtyesToRead - numRead);
+    if (ret_Read > 0)
+    {
+        numRead += ret_Read;
+    }
+    else if (ret_Read == 0)
+    {
+        NXPLOG_TML_E("_i2c_read() [pyld] EOF");
+        return -1;
+    }
+    else
+    {
+        if(FALSE == bFwDnldFlag)
         {
-            if(FALSE == bFwDnldFlag)
-            {
-                NXPLOG_TML_E("_i2c_read() [hdr] received");
-                phNxpNciHal_print_packet("RECV",pBuffer, NORMAL_MODE_HEADER_LEN);
-            }
-            NXPLOG_TML_E("_i2c_read() [pyld] errno : %x",errno);
-            return -1;
+            NXPLOG_TML_E("_i2c_read() [hdr] received");
+            phNxpNciHal_print_packet("RECV",pBuffer, NORMAL_MODE_HEADER_LEN);
         }
+        NXPLOG_TML_E("_i2c_read() [pyld] errno : %x",errno);
+        return -1;
     }
     return numRead;
 }
@@ -576,10 +857,93 @@ int phTmlNfc_i2c_reset(void *pDevHandle, long level)
     }else{
         bFwDnldFlag = FALSE;
     }
+    /* restart a pending read so that it uses the new mode's header length */
+    phTmlNfc_i2c_wakeup();
     return ret;
 #endif
 }
 
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_wait_ready
+**
+** Description      Waits for the PN54X to raise its IRQ line after VEN went
+**                  high, e.g. for the CORE_RESET_NTF of an NCI 2.0 NFCC.
+**                  The pending frame is left for the reader thread.
+**
+** Parameters       pDevHandle     - valid device handle
+**                  dwTimeoutMs    - maximum time to wait
+**
+** Returns           1   - PN54X signalled
+**                   0   - timeout
+**                  -1   - IRQ cannot be watched (driver without poll), the
+**                         caller waits the whole boot time
+**
+*******************************************************************************/
+int phTmlNfc_i2c_wait_ready(void *pDevHandle, uint32_t dwTimeoutMs)
+{
+    struct timespec now;
+    struct pollfd fds;
+    int64_t deadline;
+    int64_t remaining;
+    int ret;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    deadline = (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000 + dwTimeoutMs;
+#ifdef PHFL_TML_ALT_NFC
+    UNUSED(pDevHandle);
+    fds.fd = iInterruptFd;
+    fds.events = POLLPRI;
+#else
+    if (NULL == pDevHandle)
+    {
+        return -1;
+    }
+    /* epoll_ctl found no poll in the driver */
+    if (FALSE == bDevPoll)
+    {
+        return -1;
+    }
+    /* the pn54x driver reports the device readable while IRQ is high */
+    fds.fd = (intptr_t)pDevHandle;
+    fds.events = POLLIN | POLLOUT;
+#endif
+    for (;;)
+    {
+#ifdef PHFL_TML_ALT_NFC
+        ret = pnGetint();
+        if (ret != 0)
+        {
+            return (ret > 0) ? 1 : -1;
+        }
+#endif
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        remaining = deadline - ((int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000);
+        if (remaining <= 0)
+        {
+            return 0;
+        }
+        ret = poll(&fds, 1, (int)remaining);
+        if ((ret < 0) && (errno != EINTR))
+        {
+            NXPLOG_TML_E("i2c wait ready errno : %x", errno);
+            return -1;
+        }
+#ifndef PHFL_TML_ALT_NFC
+        /* a driver without poll reports the default mask, POLLOUT included,
+           which the pn54x never signals */
+        if ((ret > 0) && (fds.revents & (POLLOUT | POLLNVAL)))
+        {
+            return -1;
+        }
+        if ((ret > 0) && (fds.revents & POLLIN))
+        {
+            return 1;
+        }
+#endif
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         getDownloadFlag
@@ -22,11 +22,16 @@
 #include <phNfcTypes.h>
 #include <phTmlNfc.h>
 
+/* phTmlNfc_i2c_read return value when woken up by phTmlNfc_i2c_wakeup */
+#define PH_TMLNFC_I2C_READ_ABORTED  (-2)
+
 /* Function declarations */
 void phTmlNfc_i2c_close(void *pDevHandle);
 NFCSTATUS phTmlNfc_i2c_open_and_configure(pphTmlNfc_Config_t pConfig, void ** pLinkHandle);
 int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead);
+void phTmlNfc_i2c_wakeup(void);
 int phTmlNfc_i2c_write(void *pDevHandle,uint8_t * pBuffer, int nNbBytesToWrite);
 int phTmlNfc_i2c_reset(void *pDevHandle,long level);
+int phTmlNfc_i2c_wait_ready(void *pDevHandle, uint32_t dwTimeoutMs);
 bool_t getDownloadFlag(void);
 extern phTmlNfc_i2cfragmentation_t fragmentation_enabled;
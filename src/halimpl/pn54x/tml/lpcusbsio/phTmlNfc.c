@@ -21,7 +21,9 @@
 #include <phTmlNfc.h>
 #include <phOsalNfc_Timer.h>
 #include <phNxpLog.h>
+#include <phNxpNciTrace.h>
 #include <phDal4Nfc_messageQueueLib.h>
+#include <phTmlNfc_WriteQueue.h>
 #include <phTmlNfc_lpcusbsio.h>
 #include <phNxpNciHal_utils.h>
 
@@ -154,6 +156,7 @@ NFCSTATUS phTmlNfc_Init(pphTmlNfc_Config_t pConfig)
                             /** Retry Count = Standby Recovery time of NFCC / Retransmission time + 1 */
                             gpphTmlNfc_Context->bRetryCount = (2000 / PHTMLNFC_MAXTIME_RETRANSMIT) + 1;
                             gpphTmlNfc_Context->bWriteCbInvoked = FALSE;
+                            phTmlNfc_WriteQueueReset();
                         }
                         else
                         {
@@ -406,6 +409,8 @@ static void phTmlNfc_TmlThread(void *pParam)
                     gpphTmlNfc_Context->tReadInfo.wLength = (uint16_t) (dwNoBytesWrRd);
                     phNxpNciHal_print_packet("RECV", gpphTmlNfc_Context->tReadInfo.pBuffer,
                             gpphTmlNfc_Context->tReadInfo.wLength);
+                    phNxpNciTrace_Record(PHNXPNCI_TRACE_DIR_RX, gpphTmlNfc_Context->tReadInfo.pBuffer,
+                            gpphTmlNfc_Context->tReadInfo.wLength);
 
                     dwNoBytesWrRd = PH_TMLNFC_RESET_VALUE;
 
@@ -474,8 +479,13 @@ static void phTmlNfc_TmlWriterThread(void *pParam)
     {
         NXPLOG_TML_D("PN54X - Tml Writer Thread Running................");
         sem_wait(&gpphTmlNfc_Context->txSemaphore);
+        /* Queued writes were submitted first, so they go out first */
+        if (TRUE == phTmlNfc_WriteQueueService(gpphTmlNfc_Context->pDevHandle, &phTmlNfc_i2c_write))
+        {
+            continue;
+        }
         /* If Tml write is requested */
-        if (1 == gpphTmlNfc_Context->tWriteInfo.bEnable)
+        else if (1 == gpphTmlNfc_Context->tWriteInfo.bEnable)
         {
             NXPLOG_TML_D("PN54X - Write requested.....");
             /* Set the variable to success initially */
@@ -513,6 +523,8 @@ static void phTmlNfc_TmlWriterThread(void *pParam)
                 {
                     phNxpNciHal_print_packet("SEND", gpphTmlNfc_Context->tWriteInfo.pBuffer,
                             gpphTmlNfc_Context->tWriteInfo.wLength);
+                    phNxpNciTrace_Record(PHNXPNCI_TRACE_DIR_TX, gpphTmlNfc_Context->tWriteInfo.pBuffer,
+                            gpphTmlNfc_Context->tWriteInfo.wLength);
                 }
                 retry_cnt = 0;
                 if (NFCSTATUS_SUCCESS == wStatus)
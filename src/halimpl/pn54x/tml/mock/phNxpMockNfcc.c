@@ -0,0 +1,1735 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Scriptable software NFCC, see phNxpMockNfcc.h for the scenario syntax.
+ */
+
+/* ppoll, pthread_setname_np */
+#define _GNU_SOURCE
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <phNxpLog.h>
+#include <phNxpMockNfcc.h>
+
+#define PHNXPMOCKNFCC_MAX_RULES         (64)
+#define PHNXPMOCKNFCC_MAX_REPLIES       (8)
+#define PHNXPMOCKNFCC_MAX_PENDING       (512)   /* a 64 KiB R-APDU is 258 frames */
+#define PHNXPMOCKNFCC_DEFAULT_LATENCY   (100)   /* us */
+#define PHNXPMOCKNFCC_LINE_MAX          (1024)
+
+#define PHNXPMOCKNFCC_T4T_MAX_APDU      (7 + 65536 + 2)     /* extended C-APDU or R-APDU */
+#define PHNXPMOCKNFCC_T4T_MAX_FILE      (0x7FFFFF)          /* ODO offsets are 3 bytes */
+#define PHNXPMOCKNFCC_T4T_CC_FILE_ID    (0xE103)
+#define PHNXPMOCKNFCC_T4T_NDEF_FILE_ID  (0xE104)
+
+#define PHNXPMOCKNFCC_T2T_MAX_PAGES     (256)               /* one sector */
+#define PHNXPMOCKNFCC_T2T_CFG_PAGES     (5)                 /* after the data area */
+
+#define PHNXPMOCKNFCC_T5T_MAX_BLOCKS    (2048)              /* ST25DV64K */
+#define PHNXPMOCKNFCC_T5T_MAX_READ      (256)               /* Read Multiple Blocks */
+#define PHNXPMOCKNFCC_T5T_IC_REF_ST25DV (0x24)              /* 001001xx(b) */
+
+/* A frame sent by the NFCC */
+typedef struct phNxpMockNfcc_Frame
+{
+    uint32_t dwDelayUs;                         /* after the previous frame */
+    uint16_t wLength;
+    uint8_t aData[PHNXPMOCKNFCC_MAX_FRAME];
+} phNxpMockNfcc_Frame_t;
+
+/* "on" statement of the scenario with its "send" frames */
+typedef struct phNxpMockNfcc_Rule
+{
+    uint8_t aPattern[PHNXPMOCKNFCC_MAX_FRAME];
+    uint8_t aMask[PHNXPMOCKNFCC_MAX_FRAME];     /* 0x00 for "??" */
+    uint16_t wPatternLen;
+    bool_t bPrefix;                             /* pattern ends with "*" */
+    bool_t bOnce;
+    bool_t bFired;
+    uint8_t bNbReplies;
+    phNxpMockNfcc_Frame_t aReplies[PHNXPMOCKNFCC_MAX_REPLIES];
+} phNxpMockNfcc_Rule_t;
+
+/* Frame waiting for its send time */
+typedef struct phNxpMockNfcc_Pending
+{
+    uint64_t qwDueUs;
+    uint16_t wLength;
+    uint8_t aData[PHNXPMOCKNFCC_MAX_FRAME];
+} phNxpMockNfcc_Pending_t;
+
+/* NDEF Tag Application emulated by the "t4t" statement */
+typedef struct phNxpMockNfcc_T4t
+{
+    bool_t bEnabled;
+    uint8_t bVersion;                           /* mapping version of the CC */
+    uint16_t wMle;
+    uint16_t wMlc;
+    uint8_t bSelected;                          /* 0: none, 1: app, then file id */
+    uint16_t wFileId;
+    uint8_t aCc[17];
+    uint16_t wCcLen;
+    uint8_t *pNdef;                             /* NLEN or ENLEN, then NDEF */
+    uint32_t dwNdefLen;
+    uint8_t *pCApdu;                            /* C-APDU being reassembled */
+    uint32_t dwCApduLen;
+    uint8_t *pRApdu;
+} phNxpMockNfcc_T4t_t;
+
+/* Memory of the Type 2 tag emulated by the "t2t" statement */
+typedef struct phNxpMockNfcc_T2t
+{
+    bool_t bEnabled;
+    uint8_t bProduct;                           /* GET_VERSION product type, 0: none */
+    uint16_t wPages;
+    bool_t bHalted;                             /* NACK sent, silent until deactivated */
+    uint8_t aMem[PHNXPMOCKNFCC_T2T_MAX_PAGES * 4];
+} phNxpMockNfcc_T2t_t;
+
+/* Memory of the Type 5 tag emulated by the "t5t" statement, 4 byte blocks */
+typedef struct phNxpMockNfcc_T5t
+{
+    bool_t bEnabled;
+    uint8_t bIcRef;
+    uint16_t wBlocks;
+    uint16_t wMaxRead;                          /* blocks per Read Multiple Blocks */
+    uint8_t aMem[PHNXPMOCKNFCC_T5T_MAX_BLOCKS * 4];
+} phNxpMockNfcc_T5t_t;
+
+typedef struct phNxpMockNfcc_Context
+{
+    int nDevFd;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    bool_t bPowered;
+    uint32_t dwLatencyUs;
+    uint32_t dwBusKbps;                         /* I2C clock, 0 for no bus time */
+    uint32_t dwNbRules;
+    phNxpMockNfcc_Rule_t *pRules;
+    uint32_t dwNbPending;
+    phNxpMockNfcc_Pending_t aPending[PHNXPMOCKNFCC_MAX_PENDING];
+    phNxpMockNfcc_T4t_t t4t;
+    phNxpMockNfcc_T2t_t t2t;
+    phNxpMockNfcc_T5t_t t5t;
+} phNxpMockNfcc_Context_t;
+
+static phNxpMockNfcc_Context_t *gpMockNfcc = NULL;
+
+/* Held for the time of an I2C transfer: one transfer at a time */
+static pthread_mutex_t tMockBusLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Appended to every scenario: answers of a PN7150 with FW 10.01.A0 */
+static const char *gpMockNfccDefaults =
+    "on 20 00 *\n"
+    "  send 40 00 L 00 10 00\n"
+    "on 20 01 *\n"
+    "  send 40 01 L 00 03 1E 03 00 08 00 01 02 03 80 81 82 83"
+    " 02 D0 02 FF 02 00 04 88 10 01 A0\n";
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_GetTimeUs
+**
+** Description      Reads the monotonic clock
+**
+** Parameters       None
+**
+** Returns          Time in microseconds
+**
+*******************************************************************************/
+static uint64_t phNxpMockNfcc_GetTimeUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U);
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_ParseBytes
+**
+** Description      Parses the hex bytes of a pattern or a frame. A token may
+**                  hold several bytes ("400003"). "??" and a final "*" are
+**                  accepted when pMask is given, "L" when pLenPos is given.
+**
+** Parameters       pTokens   - remaining tokens of the line (strtok_r state)
+**                  pData     - parsed bytes
+**                  pMask     - 0xFF per literal byte, 0x00 per "??"
+**                  pPrefix   - set when the pattern ends with "*"
+**                  pLenPos   - offset of "L", -1 if absent
+**
+** Returns          Number of bytes, -1 on syntax error
+**
+*******************************************************************************/
+static int phNxpMockNfcc_ParseBytes(char **pTokens, uint8_t *pData, uint8_t *pMask,
+        bool_t *pPrefix, int *pLenPos)
+{
+    char *pToken;
+    char *pEnd;
+    unsigned long val;
+    int len = 0;
+    size_t i;
+
+    while (NULL != (pToken = strtok_r(NULL, " \t\r\n", pTokens)))
+    {
+        if (NULL != pPrefix && *pPrefix)
+        {
+            return -1;                          /* "*" must come last */
+        }
+        if ((NULL != pMask) && (0 == strcmp(pToken, "*")))
+        {
+            *pPrefix = TRUE;
+            continue;
+        }
+        if ((NULL != pMask) && (0 == strcmp(pToken, "??")))
+        {
+            if (len >= PHNXPMOCKNFCC_MAX_FRAME)
+            {
+                return -1;
+            }
+            pData[len] = 0x00;
+            pMask[len++] = 0x00;
+            continue;
+        }
+        if ((NULL != pLenPos) && (0 == strcasecmp(pToken, "L")))
+        {
+            if ((*pLenPos >= 0) || (len >= PHNXPMOCKNFCC_MAX_FRAME))
+            {
+                return -1;
+            }
+            *pLenPos = len;
+            pData[len++] = 0x00;
+            continue;
+        }
+        if ((strlen(pToken) % 2) != 0)
+        {
+            return -1;
+        }
+        for (i = 0; pToken[i] != '\0'; i += 2)
+        {
+            char byte[3] = { pToken[i], pToken[i + 1], '\0' };
+
+            val = strtoul(byte, &pEnd, 16);
+            if ((*pEnd != '\0') || (len >= PHNXPMOCKNFCC_MAX_FRAME))
+            {
+                return -1;
+            }
+            if (NULL != pMask)
+            {
+                pMask[len] = 0xFF;
+            }
+            pData[len++] = (uint8_t)val;
+        }
+    }
+
+    return len;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_T4tSetup
+**
+** Description      Parses the arguments of the "t4t" statement and builds the
+**                  CC file and the NDEF file of the emulated tag. The NDEF
+**                  message is one record of TNF "unknown" whose payload is a
+**                  byte counter.
+**
+** Parameters       pTokens   - remaining tokens of the line (strtok_r state)
+**
+** Returns          NFCSTATUS_SUCCESS or NFCSTATUS_FAILED on syntax error
+**
+*******************************************************************************/
+static NFCSTATUS phNxpMockNfcc_T4tSetup(char **pTokens)
+{
+    phNxpMockNfcc_T4t_t *pT4t = &gpMockNfcc->t4t;
+    unsigned long val[4] = { 0, 0xFF, 0xFF, 0 };
+    uint32_t nlenSize;
+    uint32_t payload;
+    uint32_t i;
+    uint8_t *p;
+    char *pArg;
+    char *pEnd;
+    int n;
+
+    for (n = 0; (n < 4) && (NULL != (pArg = strtok_r(NULL, " \t\r\n", pTokens))); n++)
+    {
+        val[n] = strtoul(pArg, &pEnd, 0);
+        if (*pEnd != '\0')
+        {
+            return NFCSTATUS_FAILED;
+        }
+    }
+    if ((n < 1) || (pT4t->bEnabled) || (val[0] < 3) || (val[1] < 0x0F) || (val[1] > 0xFFFF) ||
+            (val[2] < 0x01) || (val[2] > 0xFFFF))
+    {
+        return NFCSTATUS_FAILED;
+    }
+    /* files beyond 32 KiB need the ODO commands and ENLEN of version 3.0 */
+    if (0 == val[3])
+    {
+        val[3] = (val[0] + 2 > 0x7FFF) ? 0x30 : 0x20;
+    }
+    if (((val[3] != 0x20) && (val[3] != 0x30)) || (val[0] + 4 > PHNXPMOCKNFCC_T4T_MAX_FILE) ||
+            ((val[3] == 0x20) && (val[0] + 2 > 0x7FFF)))
+    {
+        return NFCSTATUS_FAILED;
+    }
+
+    nlenSize = (val[3] == 0x30) ? 4 : 2;
+    pT4t->pNdef = (uint8_t *)malloc(nlenSize + val[0]);
+    pT4t->pCApdu = (uint8_t *)malloc(PHNXPMOCKNFCC_T4T_MAX_APDU);
+    pT4t->pRApdu = (uint8_t *)malloc(PHNXPMOCKNFCC_T4T_MAX_APDU);
+    if ((NULL == pT4t->pNdef) || (NULL == pT4t->pCApdu) || (NULL == pT4t->pRApdu))
+    {
+        return NFCSTATUS_FAILED;
+    }
+    pT4t->bEnabled = TRUE;
+    pT4t->bVersion = (uint8_t)val[3];
+    pT4t->wMle = (uint16_t)val[1];
+    pT4t->wMlc = (uint16_t)val[2];
+    pT4t->dwNdefLen = nlenSize + val[0];
+
+    /* CC file: CCLEN, version, MLe, MLc, (E)NDEF File Control TLV */
+    p = pT4t->aCc;
+    pT4t->wCcLen = (nlenSize == 4) ? 17 : 15;
+    *p++ = 0x00;
+    *p++ = (uint8_t)pT4t->wCcLen;
+    *p++ = pT4t->bVersion;
+    *p++ = (uint8_t)(pT4t->wMle >> 8);
+    *p++ = (uint8_t)pT4t->wMle;
+    *p++ = (uint8_t)(pT4t->wMlc >> 8);
+    *p++ = (uint8_t)pT4t->wMlc;
+    *p++ = (nlenSize == 4) ? 0x06 : 0x04;
+    *p++ = (nlenSize == 4) ? 0x08 : 0x06;
+    *p++ = (uint8_t)(PHNXPMOCKNFCC_T4T_NDEF_FILE_ID >> 8);
+    *p++ = (uint8_t)PHNXPMOCKNFCC_T4T_NDEF_FILE_ID;
+    for (i = nlenSize; i > 0; i--)
+    {
+        *p++ = (uint8_t)(pT4t->dwNdefLen >> (8 * (i - 1)));
+    }
+    *p++ = 0x00;                                /* read access */
+    *p++ = 0x00;                                /* write access */
+
+    /* NDEF file: (E)NLEN then the record */
+    p = pT4t->pNdef;
+    for (i = nlenSize; i > 0; i--)
+    {
+        *p++ = (uint8_t)(val[0] >> (8 * (i - 1)));
+    }
+    if (val[0] - 3 <= 0xFF)
+    {
+        payload = val[0] - 3;
+        *p++ = 0xD5;                            /* MB, ME, SR, TNF unknown */
+        *p++ = 0x00;
+        *p++ = (uint8_t)payload;
+    }
+    else if (val[0] >= 6)
+    {
+        payload = val[0] - 6;
+        *p++ = 0xC5;                            /* MB, ME, TNF unknown */
+        *p++ = 0x00;
+        *p++ = (uint8_t)(payload >> 24);
+        *p++ = (uint8_t)(payload >> 16);
+        *p++ = (uint8_t)(payload >> 8);
+        *p++ = (uint8_t)payload;
+    }
+    else
+    {
+        return NFCSTATUS_FAILED;
+    }
+    for (i = 0; i < payload; i++)
+    {
+        *p++ = (uint8_t)i;
+    }
+
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_NdefTlv
+**
+** Description      Fills the data area of a Type 2 or Type 5 tag: an NDEF TLV,
+**                  short or long length field, then the terminator TLV. The
+**                  NDEF message is one record of TNF "unknown" whose payload
+**                  is a byte counter.
+**
+** Parameters       p          - start of the data area
+**                  dwArea     - size of the data area, at least 16 bytes
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpMockNfcc_NdefTlv(uint8_t *p, uint32_t dwArea)
+{
+    uint32_t msgLen, payload;
+    uint32_t i;
+
+    msgLen = (dwArea - 3 > 0xFE) ? (dwArea - 5) : (dwArea - 3);
+    *p++ = 0x03;
+    if (msgLen >= 0xFF)
+    {
+        *p++ = 0xFF;
+        *p++ = (uint8_t)(msgLen >> 8);
+    }
+    *p++ = (uint8_t)msgLen;
+    if (msgLen - 3 <= 0xFF)
+    {
+        payload = msgLen - 3;
+        *p++ = 0xD5;                            /* MB, ME, SR, TNF unknown */
+        *p++ = 0x00;
+        *p++ = (uint8_t)payload;
+    }
+    else
+    {
+        payload = msgLen - 6;
+        *p++ = 0xC5;                            /* MB, ME, TNF unknown */
+        *p++ = 0x00;
+        *p++ = (uint8_t)(payload >> 24);
+        *p++ = (uint8_t)(payload >> 16);
+        *p++ = (uint8_t)(payload >> 8);
+        *p++ = (uint8_t)payload;
+    }
+    for (i = 0; i < payload; i++)
+    {
+        *p++ = (uint8_t)i;
+    }
+    *p = 0xFE;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_T2tSetup
+**
+** Description      Parses the arguments of the "t2t" statement and builds the
+**                  memory of the emulated tag: UID, lock bytes, CC, then the
+**                  TLVs of phNxpMockNfcc_NdefTlv filling the data area.
+**
+** Parameters       pTokens   - remaining tokens of the line (strtok_r state)
+**
+** Returns          NFCSTATUS_SUCCESS or NFCSTATUS_FAILED on syntax error
+**
+*******************************************************************************/
+static NFCSTATUS phNxpMockNfcc_T2tSetup(char **pTokens)
+{
+    static const uint8_t header[] = {
+        0x04, 0x11, 0x22, 0xB9, 0x33, 0x44, 0x55, 0x66, 0x00, 0x48, 0x00, 0x00
+    };
+    phNxpMockNfcc_T2t_t *pT2t = &gpMockNfcc->t2t;
+    unsigned long val[2] = { 0, 0 };
+    uint8_t *p;
+    char *pArg;
+    char *pEnd;
+    int n;
+
+    for (n = 0; (n < 2) && (NULL != (pArg = strtok_r(NULL, " \t\r\n", pTokens))); n++)
+    {
+        val[n] = strtoul(pArg, &pEnd, 0);
+        if (*pEnd != '\0')
+        {
+            return NFCSTATUS_FAILED;
+        }
+    }
+    if ((n < 1) || (pT2t->bEnabled) || (val[0] < 2) ||
+            (4 + val[0] * 2 + PHNXPMOCKNFCC_T2T_CFG_PAGES > PHNXPMOCKNFCC_T2T_MAX_PAGES) ||
+            ((val[1] != 0) && (val[1] != 3) && (val[1] != 4)))
+    {
+        return NFCSTATUS_FAILED;
+    }
+
+    pT2t->bEnabled = TRUE;
+    pT2t->bProduct = (uint8_t)val[1];
+    pT2t->wPages = (uint16_t)(4 + val[0] * 2 + PHNXPMOCKNFCC_T2T_CFG_PAGES);
+    memset(pT2t->aMem, 0, sizeof(pT2t->aMem));
+
+    /* Pages 0 to 3: UID, lock bytes, CC (T2T 1.0, read/write) */
+    memcpy(pT2t->aMem, header, sizeof(header));
+    p = &pT2t->aMem[12];
+    *p++ = 0xE1;
+    *p++ = 0x10;
+    *p++ = (uint8_t)val[0];
+    *p++ = 0x00;
+
+    phNxpMockNfcc_NdefTlv(p, val[0] * 8);
+
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_T5tSetup
+**
+** Description      Parses the arguments of the "t5t" statement and builds the
+**                  memory of the emulated tag: CC, then the TLVs of
+**                  phNxpMockNfcc_NdefTlv filling the data area. The CC has 8
+**                  bytes when the memory exceeds 2040 bytes.
+**
+** Parameters       pTokens   - remaining tokens of the line (strtok_r state)
+**
+** Returns          NFCSTATUS_SUCCESS or NFCSTATUS_FAILED on syntax error
+**
+*******************************************************************************/
+static NFCSTATUS phNxpMockNfcc_T5tSetup(char **pTokens)
+{
+    phNxpMockNfcc_T5t_t *pT5t = &gpMockNfcc->t5t;
+    unsigned long val[3] = { 0, 0, 64 };
+    uint32_t size;
+    uint8_t *p;
+    char *pArg;
+    char *pEnd;
+    int n;
+
+    for (n = 0; (n < 3) && (NULL != (pArg = strtok_r(NULL, " \t\r\n", pTokens))); n++)
+    {
+        val[n] = strtoul(pArg, &pEnd, 0);
+        if (*pEnd != '\0')
+        {
+            return NFCSTATUS_FAILED;
+        }
+    }
+    /* only the ST25DV reports more than 256 blocks, with Extended Get System Information */
+    if ((n < 1) || (pT5t->bEnabled) || (val[0] < 8) || (val[0] > PHNXPMOCKNFCC_T5T_MAX_BLOCKS) ||
+            ((val[0] > 256) && ((val[1] & 0xFC) != PHNXPMOCKNFCC_T5T_IC_REF_ST25DV)) ||
+            (val[1] > 0xFF) || (val[2] < 1) || (val[2] > PHNXPMOCKNFCC_T5T_MAX_READ))
+    {
+        return NFCSTATUS_FAILED;
+    }
+
+    pT5t->bEnabled = TRUE;
+    pT5t->bIcRef = (uint8_t)val[1];
+    pT5t->wBlocks = (uint16_t)val[0];
+    pT5t->wMaxRead = (uint16_t)val[2];
+    memset(pT5t->aMem, 0, sizeof(pT5t->aMem));
+
+    /* CC: magic number, version 1.0 read/write, memory size, Read Multiple Blocks */
+    size = val[0] * 4;
+    p = pT5t->aMem;
+    if (size <= 2040)
+    {
+        *p++ = 0xE1;
+        *p++ = 0x40;
+        *p++ = (uint8_t)(size / 8);
+        *p++ = 0x01;
+    }
+    else
+    {
+        *p++ = 0xE2;
+        *p++ = 0x40;
+        *p++ = 0x00;
+        *p++ = 0x01;
+        *p++ = 0x00;
+        *p++ = 0x00;
+        *p++ = (uint8_t)((size / 8) >> 8);
+        *p++ = (uint8_t)(size / 8);
+    }
+
+    phNxpMockNfcc_NdefTlv(p, size - (uint32_t)(p - pT5t->aMem));
+
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_ParseLine
+**
+** Description      Parses one scenario statement into gpMockNfcc
+**
+** Parameters       pLine      - statement, modified in place
+**
+** Returns          NFCSTATUS_SUCCESS or NFCSTATUS_FAILED on syntax error
+**
+*******************************************************************************/
+static NFCSTATUS phNxpMockNfcc_ParseLine(char *pLine)
+{
+    phNxpMockNfcc_Rule_t *pRule;
+    phNxpMockNfcc_Frame_t *pFrame;
+    char *pTokens = NULL;
+    char *pKeyword;
+    char *pArg;
+    char *pEnd;
+    int len;
+    int lenPos = -1;
+
+    if (NULL != (pArg = strchr(pLine, '#')))
+    {
+        *pArg = '\0';
+    }
+    pKeyword = strtok_r(pLine, " \t\r\n", &pTokens);
+    if (NULL == pKeyword)
+    {
+        return NFCSTATUS_SUCCESS;
+    }
+
+    if (0 == strcmp(pKeyword, "latency"))
+    {
+        pArg = strtok_r(NULL, " \t\r\n", &pTokens);
+        if (NULL == pArg)
+        {
+            return NFCSTATUS_FAILED;
+        }
+        gpMockNfcc->dwLatencyUs = strtoul(pArg, &pEnd, 0);
+        return (*pEnd == '\0') ? NFCSTATUS_SUCCESS : NFCSTATUS_FAILED;
+    }
+
+    if (0 == strcmp(pKeyword, "i2c"))
+    {
+        pArg = strtok_r(NULL, " \t\r\n", &pTokens);
+        if (NULL == pArg)
+        {
+            return NFCSTATUS_FAILED;
+        }
+        gpMockNfcc->dwBusKbps = strtoul(pArg, &pEnd, 0);
+        return (*pEnd == '\0') ? NFCSTATUS_SUCCESS : NFCSTATUS_FAILED;
+    }
+
+    if (0 == strcmp(pKeyword, "t4t"))
+    {
+        return phNxpMockNfcc_T4tSetup(&pTokens);
+    }
+
+    if (0 == strcmp(pKeyword, "t2t"))
+    {
+        return phNxpMockNfcc_T2tSetup(&pTokens);
+    }
+
+    if (0 == strcmp(pKeyword, "t5t"))
+    {
+        return phNxpMockNfcc_T5tSetup(&pTokens);
+    }
+
+    if (0 == strcmp(pKeyword, "on"))
+    {
+        if (gpMockNfcc->dwNbRules >= PHNXPMOCKNFCC_MAX_RULES)
+        {
+            return NFCSTATUS_FAILED;
+        }
+        pRule = &gpMockNfcc->pRules[gpMockNfcc->dwNbRules];
+        memset(pRule, 0, sizeof(*pRule));
+        pArg = (NULL != pTokens) ? (pTokens + strspn(pTokens, " \t")) : "";
+        if ((0 == strncmp(pArg, "once", 4)) && isspace((unsigned char)pArg[4]))
+        {
+            (void)strtok_r(NULL, " \t\r\n", &pTokens);
+            pRule->bOnce = TRUE;
+        }
+        len = phNxpMockNfcc_ParseBytes(&pTokens, pRule->aPattern, pRule->aMask,
+                &pRule->bPrefix, NULL);
+        if (len <= 0)
+        {
+            return NFCSTATUS_FAILED;
+        }
+        pRule->wPatternLen = (uint16_t)len;
+        gpMockNfcc->dwNbRules++;
+        return NFCSTATUS_SUCCESS;
+    }
+
+    if (0 == strcmp(pKeyword, "send"))
+    {
+        if (0 == gpMockNfcc->dwNbRules)
+        {
+            return NFCSTATUS_FAILED;
+        }
+        pRule = &gpMockNfcc->pRules[gpMockNfcc->dwNbRules - 1];
+        if (pRule->bNbReplies >= PHNXPMOCKNFCC_MAX_REPLIES)
+        {
+            return NFCSTATUS_FAILED;
+        }
+        pFrame = &pRule->aReplies[pRule->bNbReplies];
+        pFrame->dwDelayUs = gpMockNfcc->dwLatencyUs;
+        if ((NULL != pTokens) && (*(pTokens + strspn(pTokens, " \t")) == '+'))
+        {
+            pArg = strtok_r(NULL, " \t\r\n", &pTokens);
+            pFrame->dwDelayUs = strtoul(pArg + 1, &pEnd, 0);
+            if ((pArg[1] == '\0') || (*pEnd != '\0'))
+            {
+                return NFCSTATUS_FAILED;
+            }
+        }
+        len = phNxpMockNfcc_ParseBytes(&pTokens, pFrame->aData, NULL, NULL, &lenPos);
+        if (len < 3)
+        {
+            return NFCSTATUS_FAILED;
+        }
+        if (lenPos >= 0)
+        {
+            pFrame->aData[lenPos] = (uint8_t)(len - lenPos - 1);
+        }
+        pFrame->wLength = (uint16_t)len;
+        pRule->bNbReplies++;
+        return NFCSTATUS_SUCCESS;
+    }
+
+    return NFCSTATUS_FAILED;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_LoadScenario
+**
+** Description      Parses the scenario file, then the built-in defaults
+**
+** Parameters       pScenario  - scenario file, NULL for the defaults only
+**
+** Returns          NFCSTATUS_SUCCESS or NFCSTATUS_FAILED
+**
+*******************************************************************************/
+static NFCSTATUS phNxpMockNfcc_LoadScenario(const char *pScenario)
+{
+    char line[PHNXPMOCKNFCC_LINE_MAX];
+    const char *pDefaults = gpMockNfccDefaults;
+    const char *pNext;
+    unsigned int lineNo = 0;
+    size_t len;
+    FILE *fp;
+
+    if (NULL != pScenario)
+    {
+        fp = fopen(pScenario, "r");
+        if (NULL == fp)
+        {
+            NXPLOG_TML_E("mock NFCC: cannot open scenario %s (%d)", pScenario, errno);
+            return NFCSTATUS_FAILED;
+        }
+        while (NULL != fgets(line, sizeof(line), fp))
+        {
+            lineNo++;
+            if (NFCSTATUS_SUCCESS != phNxpMockNfcc_ParseLine(line))
+            {
+                NXPLOG_TML_E("mock NFCC: %s:%u: syntax error", pScenario, lineNo);
+                fclose(fp);
+                return NFCSTATUS_FAILED;
+            }
+        }
+        fclose(fp);
+    }
+
+    while (*pDefaults != '\0')
+    {
+        pNext = strchr(pDefaults, '\n');
+        len = (NULL != pNext) ? (size_t)(pNext - pDefaults) : strlen(pDefaults);
+        memcpy(line, pDefaults, len);
+        line[len] = '\0';
+        (void)phNxpMockNfcc_ParseLine(line);
+        pDefaults += len + ((NULL != pNext) ? 1 : 0);
+    }
+
+    NXPLOG_TML_D("mock NFCC: %u rules loaded", gpMockNfcc->dwNbRules);
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_Schedule
+**
+** Description      Queues a frame for sending at qwDueUs. Frames due at the
+**                  same time keep their order. Called with the lock held.
+**
+** Parameters       qwDueUs    - send time
+**                  pData      - frame
+**                  wLength    - frame length
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpMockNfcc_Schedule(uint64_t qwDueUs, const uint8_t *pData, uint16_t wLength)
+{
+    phNxpMockNfcc_Pending_t *pPending;
+    uint32_t pos;
+
+    if (gpMockNfcc->dwNbPending >= PHNXPMOCKNFCC_MAX_PENDING)
+    {
+        NXPLOG_TML_E("mock NFCC: too many pending frames, dropped");
+        return;
+    }
+    pos = gpMockNfcc->dwNbPending;
+    while ((pos > 0) && (gpMockNfcc->aPending[pos - 1].qwDueUs > qwDueUs))
+    {
+        gpMockNfcc->aPending[pos] = gpMockNfcc->aPending[pos - 1];
+        pos--;
+    }
+    pPending = &gpMockNfcc->aPending[pos];
+    pPending->qwDueUs = qwDueUs;
+    pPending->wLength = wLength;
+    memcpy(pPending->aData, pData, wLength);
+    gpMockNfcc->dwNbPending++;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_SendData
+**
+** Description      Gives back the credit of a data packet from the host, then
+**                  schedules an answer on the same connection in chained data
+**                  packets: the first one after the latency, the others back
+**                  to back. Called with the lock held.
+**
+** Parameters       qwDueUs    - time the packet was received
+**                  bConnId    - first byte of the packet from the host
+**                  pData      - answer, NULL to give back the credit only
+**                  dwLength   - answer length
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpMockNfcc_SendData(uint64_t qwDueUs, uint8_t bConnId, const uint8_t *pData,
+        uint32_t dwLength)
+{
+    uint8_t frame[PHNXPMOCKNFCC_MAX_FRAME];
+    uint32_t pos, count;
+
+    frame[0] = 0x60;
+    frame[1] = 0x06;
+    frame[2] = 0x03;
+    frame[3] = 0x01;
+    frame[4] = bConnId & 0x0F;
+    frame[5] = 0x01;
+    qwDueUs += gpMockNfcc->dwLatencyUs;
+    phNxpMockNfcc_Schedule(qwDueUs, frame, 6);
+    if (NULL == pData)
+    {
+        return;
+    }
+
+    qwDueUs += gpMockNfcc->dwLatencyUs;
+    for (pos = 0; pos < dwLength; pos += count)
+    {
+        count = (dwLength - pos > 0xFF) ? 0xFF : (dwLength - pos);
+        frame[0] = (bConnId & 0x0F) | ((pos + count < dwLength) ? 0x10 : 0x00);
+        frame[1] = 0x00;
+        frame[2] = (uint8_t)count;
+        memcpy(&frame[3], &pData[pos], count);
+        phNxpMockNfcc_Schedule(qwDueUs, frame, (uint16_t)(count + 3));
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_T4tLength
+**
+** Description      Decodes Lc and Le of a C-APDU (ISO/IEC 7816-4 cases 1 to
+**                  4, short or extended)
+**
+** Parameters       pApdu      - C-APDU
+**                  dwLen      - C-APDU length
+**                  pLc        - Lc, 0 if absent
+**                  pLe        - Le, 0 if absent
+**
+** Returns          offset of the command data, 0 if the C-APDU is malformed
+**
+*******************************************************************************/
+static uint32_t phNxpMockNfcc_T4tLength(const uint8_t *pApdu, uint32_t dwLen,
+        uint32_t *pLc, uint32_t *pLe)
+{
+    *pLc = 0;
+    *pLe = 0;
+    if (dwLen == 4)
+    {
+        return 4;
+    }
+    if (dwLen == 5)
+    {
+        *pLe = (pApdu[4] != 0) ? pApdu[4] : 256;
+        return 5;
+    }
+    if (pApdu[4] != 0)
+    {
+        *pLc = pApdu[4];
+        if (dwLen == 5 + *pLc + 1)
+        {
+            *pLe = (pApdu[dwLen - 1] != 0) ? pApdu[dwLen - 1] : 256;
+        }
+        return ((dwLen >= 5 + *pLc) && (dwLen <= 5 + *pLc + 1)) ? 5 : 0;
+    }
+    if (dwLen == 7)
+    {
+        *pLe = ((pApdu[5] << 8) | pApdu[6]);
+        *pLe = (*pLe != 0) ? *pLe : 65536;
+        return 7;
+    }
+    if (dwLen < 7)
+    {
+        return 0;
+    }
+    *pLc = (pApdu[5] << 8) | pApdu[6];
+    if (dwLen == 7 + *pLc + 2)
+    {
+        *pLe = (pApdu[dwLen - 2] << 8) | pApdu[dwLen - 1];
+        *pLe = (*pLe != 0) ? *pLe : 65536;
+    }
+    return ((*pLc != 0) && ((dwLen == 7 + *pLc) || (dwLen == 7 + *pLc + 2))) ? 7 : 0;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_T4tBerLength
+**
+** Description      Decodes the BER-TLV length of a DDO
+**
+** Parameters       pData      - DDO, tag first
+**                  dwLen      - bytes available
+**                  pValue     - length of the value
+**
+** Returns          size of tag and length, 0 if malformed
+**
+*******************************************************************************/
+static uint32_t phNxpMockNfcc_T4tBerLength(const uint8_t *pData, uint32_t dwLen, uint32_t *pValue)
+{
+    if ((dwLen < 2) || (pData[0] != 0x53))
+    {
+        return 0;
+    }
+    if (pData[1] < 0x80)
+    {
+        *pValue = pData[1];
+        return 2;
+    }
+    if ((pData[1] == 0x81) && (dwLen >= 3))
+    {
+        *pValue = pData[2];
+        return 3;
+    }
+    if ((pData[1] == 0x82) && (dwLen >= 4))
+    {
+        *pValue = (pData[2] << 8) | pData[3];
+        return 4;
+    }
+    return 0;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_T4tApdu
+**
+** Description      Executes a C-APDU on the NDEF Tag Application: SELECT,
+**                  ReadBinary and UpdateBinary, with offset in P1-P2 or in an
+**                  ODO, short or extended Lc/Le
+**
+** Parameters       pApdu      - C-APDU
+**                  dwLen      - C-APDU length
+**                  pRApdu     - R-APDU
+**
+** Returns          R-APDU length
+**
+*******************************************************************************/
+static uint32_t phNxpMockNfcc_T4tApdu(const uint8_t *pApdu, uint32_t dwLen, uint8_t *pRApdu)
+{
+    static const uint8_t aid[] = { 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01 };
+    phNxpMockNfcc_T4t_t *pT4t = &gpMockNfcc->t4t;
+    const uint8_t *pFile;
+    uint32_t fileLen;
+    uint32_t data, lc, le;
+    uint32_t offset, count, hdr;
+    uint16_t sw = 0x9000;
+    uint32_t rlen = 0;
+
+    if ((dwLen < 4) || (0 == (data = phNxpMockNfcc_T4tLength(pApdu, dwLen, &lc, &le))))
+    {
+        sw = 0x6700;
+        goto done;
+    }
+    pFile = (pT4t->wFileId == PHNXPMOCKNFCC_T4T_CC_FILE_ID) ? pT4t->aCc : pT4t->pNdef;
+    fileLen = (pT4t->wFileId == PHNXPMOCKNFCC_T4T_CC_FILE_ID) ? pT4t->wCcLen : pT4t->dwNdefLen;
+
+    switch (pApdu[1])
+    {
+    case 0xA4:                                  /* SELECT */
+        if ((pApdu[2] == 0x04) && (lc == sizeof(aid)) && (0 == memcmp(&pApdu[data], aid, lc)))
+        {
+            pT4t->bSelected = 1;
+            pT4t->wFileId = 0;
+        }
+        else if ((pApdu[2] == 0x00) && (lc == 2) && (pT4t->bSelected != 0) &&
+                (((pApdu[data] << 8) | pApdu[data + 1]) == PHNXPMOCKNFCC_T4T_CC_FILE_ID ||
+                 ((pApdu[data] << 8) | pApdu[data + 1]) == PHNXPMOCKNFCC_T4T_NDEF_FILE_ID))
+        {
+            pT4t->wFileId = (uint16_t)((pApdu[data] << 8) | pApdu[data + 1]);
+        }
+        else
+        {
+            sw = 0x6A82;
+        }
+        break;
+
+    case 0xB0:                                  /* ReadBinary */
+    case 0xB1:                                  /* ReadBinary, ODO */
+        if (0 == pT4t->wFileId)
+        {
+            sw = 0x6986;
+            break;
+        }
+        if (pApdu[1] == 0xB0)
+        {
+            offset = ((pApdu[2] & 0x7F) << 8) | pApdu[3];
+            hdr = 0;
+        }
+        else
+        {
+            if ((pT4t->bVersion < 0x30) || (lc != 5) || (pApdu[data] != 0x54) || (pApdu[data + 1] != 0x03))
+            {
+                sw = (pT4t->bVersion < 0x30) ? 0x6D00 : 0x6A80;
+                break;
+            }
+            offset = (pApdu[data + 2] << 16) | (pApdu[data + 3] << 8) | pApdu[data + 4];
+            hdr = 4;
+        }
+        if ((le == 0) || (le > pT4t->wMle) || (le <= hdr))
+        {
+            sw = 0x6700;
+            break;
+        }
+        if (offset >= fileLen)
+        {
+            sw = 0x6B00;
+            break;
+        }
+        count = le - hdr;
+        if (count > fileLen - offset)
+        {
+            count = fileLen - offset;
+        }
+        if (hdr != 0)
+        {
+            pRApdu[rlen++] = 0x53;
+            if (count > 0xFF)
+            {
+                pRApdu[rlen++] = 0x82;
+                pRApdu[rlen++] = (uint8_t)(count >> 8);
+            }
+            else if (count > 0x7F)
+            {
+                pRApdu[rlen++] = 0x81;
+            }
+            pRApdu[rlen++] = (uint8_t)count;
+        }
+        memcpy(&pRApdu[rlen], &pFile[offset], count);
+        rlen += count;
+        break;
+
+    case 0xD6:                                  /* UpdateBinary */
+    case 0xD7:                                  /* UpdateBinary, ODO */
+        if (pT4t->wFileId != PHNXPMOCKNFCC_T4T_NDEF_FILE_ID)
+        {
+            sw = 0x6986;
+            break;
+        }
+        if ((lc == 0) || (lc > pT4t->wMlc))
+        {
+            sw = 0x6700;
+            break;
+        }
+        if (pApdu[1] == 0xD6)
+        {
+            offset = ((pApdu[2] & 0x7F) << 8) | pApdu[3];
+            count = lc;
+        }
+        else
+        {
+            if ((pT4t->bVersion < 0x30) || (lc < 7) || (pApdu[data] != 0x54) || (pApdu[data + 1] != 0x03) ||
+                    (0 == (hdr = phNxpMockNfcc_T4tBerLength(&pApdu[data + 5], lc - 5, &count))) ||
+                    (5 + hdr + count != lc))
+            {
+                sw = (pT4t->bVersion < 0x30) ? 0x6D00 : 0x6A80;
+                break;
+            }
+            offset = (pApdu[data + 2] << 16) | (pApdu[data + 3] << 8) | pApdu[data + 4];
+            data += 5 + hdr;
+        }
+        if ((offset > fileLen) || (count > fileLen - offset))
+        {
+            sw = 0x6B00;
+            break;
+        }
+        memcpy(&pT4t->pNdef[offset], &pApdu[data], count);
+        break;
+
+    default:
+        sw = 0x6D00;
+        break;
+    }
+
+done:
+    pRApdu[rlen++] = (uint8_t)(sw >> 8);
+    pRApdu[rlen++] = (uint8_t)sw;
+    return rlen;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_T4tReceive
+**
+** Description      Handles a data packet for the emulated tag: gives back the
+**                  credit, reassembles the C-APDU and, once complete, sends
+**                  the R-APDU in chained data packets. Called with the lock
+**                  held.
+**
+** Parameters       qwDueUs    - time the packet was received
+**                  pData      - packet
+**                  wLength    - packet length
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpMockNfcc_T4tReceive(uint64_t qwDueUs, const uint8_t *pData, uint16_t wLength)
+{
+    phNxpMockNfcc_T4t_t *pT4t = &gpMockNfcc->t4t;
+    uint32_t rlen;
+
+    if (pT4t->dwCApduLen + (wLength - 3) > PHNXPMOCKNFCC_T4T_MAX_APDU)
+    {
+        NXPLOG_TML_E("mock NFCC: C-APDU too long, dropped");
+        pT4t->dwCApduLen = 0;
+        phNxpMockNfcc_SendData(qwDueUs, pData[0], NULL, 0);
+        return;
+    }
+    memcpy(&pT4t->pCApdu[pT4t->dwCApduLen], &pData[3], wLength - 3);
+    pT4t->dwCApduLen += wLength - 3;
+    if (pData[0] & 0x10)
+    {
+        phNxpMockNfcc_SendData(qwDueUs, pData[0], NULL, 0);
+        return;                                 /* more segments to come */
+    }
+
+    rlen = phNxpMockNfcc_T4tApdu(pT4t->pCApdu, pT4t->dwCApduLen, pT4t->pRApdu);
+    pT4t->dwCApduLen = 0;
+    phNxpMockNfcc_SendData(qwDueUs, pData[0], pT4t->pRApdu, rlen);
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_T2tReceive
+**
+** Description      Executes a command of the data packet on the emulated Type
+**                  2 tag: READ, WRITE, GET_VERSION and FAST_READ. The answer
+**                  ends with the status byte of the Frame RF interface. As on
+**                  NXP tags, a NACK puts the tag in HALT state.
+**                  Called with the lock held.
+**
+** Parameters       qwDueUs    - time the packet was received
+**                  pData      - packet
+**                  wLength    - packet length
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpMockNfcc_T2tReceive(uint64_t qwDueUs, const uint8_t *pData, uint16_t wLength)
+{
+    phNxpMockNfcc_T2t_t *pT2t = &gpMockNfcc->t2t;
+    uint8_t answer[PHNXPMOCKNFCC_T2T_MAX_PAGES * 4 + 1];
+    const uint8_t *pCmd = &pData[3];
+    uint32_t cmdLen = wLength - 3;
+    uint32_t rlen = 0;
+    uint32_t i;
+
+    if (pT2t->bHalted)
+    {
+        phNxpMockNfcc_SendData(qwDueUs, pData[0], NULL, 0);
+        return;
+    }
+
+    switch ((cmdLen > 0) ? pCmd[0] : 0)
+    {
+    case 0x30:                                  /* READ: 4 pages, rolling over */
+        if ((cmdLen == 2) && (pCmd[1] < pT2t->wPages))
+        {
+            for (i = 0; i < 16; i++)
+            {
+                answer[rlen++] = pT2t->aMem[(pCmd[1] * 4 + i) % (pT2t->wPages * 4)];
+            }
+        }
+        break;
+
+    case 0xA2:                                  /* WRITE: ACK */
+        if ((cmdLen == 6) && (pCmd[1] >= 2) && (pCmd[1] < pT2t->wPages))
+        {
+            memcpy(&pT2t->aMem[pCmd[1] * 4], &pCmd[2], 4);
+            answer[rlen++] = 0x0A;
+        }
+        break;
+
+    case 0x60:                                  /* GET_VERSION */
+        if ((cmdLen == 1) && (pT2t->bProduct != 0))
+        {
+            answer[rlen++] = 0x00;
+            answer[rlen++] = 0x04;              /* NXP */
+            answer[rlen++] = pT2t->bProduct;
+            answer[rlen++] = 0x02;
+            answer[rlen++] = 0x01;
+            answer[rlen++] = 0x00;
+            answer[rlen++] = 0x13;              /* storage size */
+            answer[rlen++] = 0x03;              /* ISO/IEC 14443-3 */
+        }
+        break;
+
+    case 0x3A:                                  /* FAST_READ */
+        if ((cmdLen == 3) && (pT2t->bProduct != 0) && (pCmd[1] <= pCmd[2]) &&
+                (pCmd[2] < pT2t->wPages))
+        {
+            rlen = (pCmd[2] - pCmd[1] + 1) * 4;
+            memcpy(answer, &pT2t->aMem[pCmd[1] * 4], rlen);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (0 == rlen)
+    {
+        answer[rlen++] = 0x00;                  /* NACK */
+        pT2t->bHalted = TRUE;
+    }
+    answer[rlen++] = 0x00;                      /* status OK */
+    phNxpMockNfcc_SendData(qwDueUs, pData[0], answer, rlen);
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_T5tReceive
+**
+** Description      Executes an addressed ISO/IEC 15693 request of the data
+**                  packet on the emulated Type 5 tag: Get System Information,
+**                  Read Single Block, Write Single Block, Read Multiple
+**                  Blocks and Get Multiple Block Security Status, basic or
+**                  extended. Reading more than the Read Multiple Blocks size
+**                  of the "t5t" statement gets an error. The answer ends with
+**                  the status byte of the Frame RF interface.
+**                  Called with the lock held.
+**
+** Parameters       qwDueUs    - time the packet was received
+**                  pData      - packet
+**                  wLength    - packet length
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpMockNfcc_T5tReceive(uint64_t qwDueUs, const uint8_t *pData, uint16_t wLength)
+{
+    phNxpMockNfcc_T5t_t *pT5t = &gpMockNfcc->t5t;
+    uint8_t answer[2 + PHNXPMOCKNFCC_T5T_MAX_READ * 4 + 1];
+    const uint8_t *pCmd = &pData[3];
+    uint32_t cmdLen = wLength - 3;
+    uint32_t first = 0, count = 0;
+    uint32_t pos = 10;
+    uint32_t rlen = 1;
+    bool_t bExt = FALSE;
+    uint8_t error = 0x01;                       /* not supported */
+
+    /* flags, command code, parameter of Extended Get System Information, UID */
+    if ((cmdLen >= 2) && (pCmd[1] == 0x3B))
+    {
+        pos++;
+    }
+    if ((cmdLen < pos) || (0 == (pCmd[0] & 0x20)))
+    {
+        phNxpMockNfcc_SendData(qwDueUs, pData[0], NULL, 0);
+        return;
+    }
+    if ((pCmd[1] & 0xF0) == 0x30)
+    {
+        bExt = TRUE;
+    }
+    else if (pCmd[0] & 0x08)
+    {
+        bExt = TRUE;                            /* block numbers on 2 bytes */
+    }
+
+    /* first block number, then number of blocks minus one */
+    if (cmdLen >= pos + (bExt ? 2 : 1))
+    {
+        first = pCmd[pos++];
+        if (bExt)
+        {
+            first |= pCmd[pos++] << 8;
+        }
+    }
+    if (((pCmd[1] == 0x23) || (pCmd[1] == 0x2C)) && (cmdLen > pos))
+    {
+        count = pCmd[pos++] + 1;
+    }
+    else if (((pCmd[1] == 0x33) || (pCmd[1] == 0x3C)) && (cmdLen >= pos + 2))
+    {
+        count = (pCmd[pos] | (pCmd[pos + 1] << 8)) + 1;
+        pos += 2;
+    }
+
+    answer[0] = 0x00;                           /* no error */
+    switch (pCmd[1])
+    {
+    case 0x2B:                                  /* Get System Information */
+    case 0x3B:
+        answer[rlen++] = 0x0F;                  /* DSFID, AFI, memory size, IC reference */
+        memcpy(&answer[rlen], &pCmd[(pCmd[1] == 0x3B) ? 3 : 2], 8);
+        rlen += 8;
+        answer[rlen++] = 0x00;                  /* DSFID */
+        answer[rlen++] = 0x00;                  /* AFI */
+        if ((pCmd[1] == 0x3B) || (pCmd[0] & 0x08))
+        {
+            answer[rlen++] = (uint8_t)(pT5t->wBlocks - 1);
+            answer[rlen++] = (uint8_t)((pT5t->wBlocks - 1) >> 8);
+        }
+        else
+        {
+            answer[rlen++] = (uint8_t)(((pT5t->wBlocks > 256) ? 256 : pT5t->wBlocks) - 1);
+        }
+        answer[rlen++] = 0x03;                  /* block size - 1 */
+        answer[rlen++] = pT5t->bIcRef;
+        error = 0;
+        break;
+
+    case 0x20:                                  /* Read Single Block */
+    case 0x30:
+        if ((cmdLen == pos) && (first < pT5t->wBlocks))
+        {
+            if (pCmd[0] & 0x40)
+            {
+                answer[rlen++] = 0x00;          /* block security status */
+            }
+            memcpy(&answer[rlen], &pT5t->aMem[first * 4], 4);
+            rlen += 4;
+            error = 0;
+        }
+        else
+        {
+            error = 0x10;                       /* block not available */
+        }
+        break;
+
+    case 0x21:                                  /* Write Single Block */
+    case 0x31:
+        if ((cmdLen == pos + 4) && (first < pT5t->wBlocks))
+        {
+            memcpy(&pT5t->aMem[first * 4], &pCmd[pos], 4);
+            error = 0;
+        }
+        else
+        {
+            error = 0x10;
+        }
+        break;
+
+    case 0x23:                                  /* Read Multiple Blocks */
+    case 0x33:
+        if ((cmdLen != pos) || (count == 0) || (first + count > pT5t->wBlocks))
+        {
+            error = 0x10;
+        }
+        else if (count > pT5t->wMaxRead)
+        {
+            error = 0x0F;                       /* no information */
+        }
+        else
+        {
+            memcpy(&answer[rlen], &pT5t->aMem[first * 4], count * 4);
+            rlen += count * 4;
+            error = 0;
+        }
+        break;
+
+    case 0x2C:                                  /* Get Multiple Block Security Status */
+    case 0x3C:
+        if ((cmdLen != pos) || (count == 0) || (first + count > pT5t->wBlocks) ||
+                (count > sizeof(answer) - 2))
+        {
+            error = 0x10;
+        }
+        else
+        {
+            memset(&answer[rlen], 0x00, count);  /* not locked */
+            rlen += count;
+            error = 0;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (0 != error)
+    {
+        answer[0] = 0x01;                       /* error flag */
+        answer[1] = error;
+        rlen = 2;
+    }
+    answer[rlen++] = 0x00;                      /* status OK */
+    phNxpMockNfcc_SendData(qwDueUs, pData[0], answer, rlen);
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_Match
+**
+** Description      Checks a received packet against a rule
+**
+** Parameters       pRule      - rule
+**                  pData      - packet
+**                  wLength    - packet length
+**
+** Returns          TRUE if the rule applies
+**
+*******************************************************************************/
+static bool_t phNxpMockNfcc_Match(const phNxpMockNfcc_Rule_t *pRule, const uint8_t *pData,
+        uint16_t wLength)
+{
+    uint16_t i;
+
+    if ((pRule->bOnce && pRule->bFired) ||
+            (wLength < pRule->wPatternLen) ||
+            (!pRule->bPrefix && (wLength != pRule->wPatternLen)))
+    {
+        return FALSE;
+    }
+    for (i = 0; i < pRule->wPatternLen; i++)
+    {
+        if ((pData[i] & pRule->aMask[i]) != pRule->aPattern[i])
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_Receive
+**
+** Description      Handles a packet from the host: schedules the frames of
+**                  the first matching rule, or the generic answer
+**
+** Parameters       pData      - packet
+**                  wLength    - packet length
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpMockNfcc_Receive(const uint8_t *pData, uint16_t wLength)
+{
+    phNxpMockNfcc_Rule_t *pRule;
+    uint64_t qwDueUs = phNxpMockNfcc_GetTimeUs();
+    uint8_t answer[6];
+    uint32_t i;
+    uint8_t j;
+
+    pthread_mutex_lock(&gpMockNfcc->lock);
+    if (!gpMockNfcc->bPowered || (wLength < 3))
+    {
+        pthread_mutex_unlock(&gpMockNfcc->lock);
+        return;
+    }
+
+    /* RF_DEACTIVATE_CMD: the tag is woken up (WUPA) when selected again */
+    if ((pData[0] == 0x21) && (pData[1] == 0x06))
+    {
+        gpMockNfcc->t2t.bHalted = FALSE;
+    }
+
+    for (i = 0; i < gpMockNfcc->dwNbRules; i++)
+    {
+        pRule = &gpMockNfcc->pRules[i];
+        if (phNxpMockNfcc_Match(pRule, pData, wLength))
+        {
+            pRule->bFired = TRUE;
+            for (j = 0; j < pRule->bNbReplies; j++)
+            {
+                qwDueUs += pRule->aReplies[j].dwDelayUs;
+                phNxpMockNfcc_Schedule(qwDueUs, pRule->aReplies[j].aData,
+                        pRule->aReplies[j].wLength);
+            }
+            pthread_mutex_unlock(&gpMockNfcc->lock);
+            return;
+        }
+    }
+
+    if (gpMockNfcc->t4t.bEnabled && ((pData[0] & 0xE0) == 0x00))
+    {
+        phNxpMockNfcc_T4tReceive(qwDueUs, pData, wLength);
+        pthread_mutex_unlock(&gpMockNfcc->lock);
+        return;
+    }
+
+    if (gpMockNfcc->t2t.bEnabled && ((pData[0] & 0xE0) == 0x00))
+    {
+        phNxpMockNfcc_T2tReceive(qwDueUs, pData, wLength);
+        pthread_mutex_unlock(&gpMockNfcc->lock);
+        return;
+    }
+
+    if (gpMockNfcc->t5t.bEnabled && ((pData[0] & 0xE0) == 0x00))
+    {
+        phNxpMockNfcc_T5tReceive(qwDueUs, pData, wLength);
+        pthread_mutex_unlock(&gpMockNfcc->lock);
+        return;
+    }
+
+    qwDueUs += gpMockNfcc->dwLatencyUs;
+    switch (pData[0] & 0xE0)
+    {
+    case 0x20:                                  /* CMD: RSP status OK */
+        answer[0] = 0x40 | (pData[0] & 0x0F);
+        answer[1] = pData[1] & 0x3F;
+        answer[2] = 0x01;
+        answer[3] = 0x00;
+        phNxpMockNfcc_Schedule(qwDueUs, answer, 4);
+        break;
+    case 0x00:                                  /* DATA: one credit back */
+        answer[0] = 0x60;
+        answer[1] = 0x06;
+        answer[2] = 0x03;
+        answer[3] = 0x01;
+        answer[4] = pData[0] & 0x0F;
+        answer[5] = 0x01;
+        phNxpMockNfcc_Schedule(qwDueUs, answer, 6);
+        break;
+    default:
+        NXPLOG_TML_D("mock NFCC: ignoring packet 0x%02X 0x%02X", pData[0], pData[1]);
+        break;
+    }
+    pthread_mutex_unlock(&gpMockNfcc->lock);
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_Thread
+**
+** Description      NFCC main loop: receives host packets and sends the
+**                  pending frames once due. Ends when the host closes its end
+**                  of the socketpair.
+**
+** Parameters       pParam     - unused
+**
+** Returns          NULL
+**
+*******************************************************************************/
+static void *phNxpMockNfcc_Thread(void *pParam)
+{
+    uint8_t buffer[PHNXPMOCKNFCC_MAX_FRAME];
+    struct pollfd pfd;
+    struct timespec ts;
+    struct timespec *pTimeout;
+    uint64_t qwNowUs;
+    uint64_t qwWaitUs;
+    ssize_t ret;
+    UNUSED(pParam);
+
+    pfd.fd = gpMockNfcc->nDevFd;
+    pfd.events = POLLIN;
+
+    for (;;)
+    {
+        pTimeout = NULL;
+        pthread_mutex_lock(&gpMockNfcc->lock);
+        if (gpMockNfcc->dwNbPending > 0)
+        {
+            qwNowUs = phNxpMockNfcc_GetTimeUs();
+            qwWaitUs = (gpMockNfcc->aPending[0].qwDueUs > qwNowUs) ?
+                    (gpMockNfcc->aPending[0].qwDueUs - qwNowUs) : 0;
+            ts.tv_sec = qwWaitUs / 1000000U;
+            ts.tv_nsec = (qwWaitUs % 1000000U) * 1000U;
+            pTimeout = &ts;
+        }
+        pthread_mutex_unlock(&gpMockNfcc->lock);
+
+        ret = ppoll(&pfd, 1, pTimeout, NULL);
+        if ((ret < 0) && (errno != EINTR))
+        {
+            NXPLOG_TML_E("mock NFCC: poll errno : %x", errno);
+            break;
+        }
+        if ((ret > 0) && (pfd.revents != 0))
+        {
+            ret = recv(gpMockNfcc->nDevFd, buffer, sizeof(buffer), 0);
+            if (ret <= 0)
+            {
+                break;                          /* host side closed */
+            }
+            phNxpMockNfcc_Receive(buffer, (uint16_t)ret);
+        }
+
+        pthread_mutex_lock(&gpMockNfcc->lock);
+        qwNowUs = phNxpMockNfcc_GetTimeUs();
+        while ((gpMockNfcc->dwNbPending > 0) && (gpMockNfcc->aPending[0].qwDueUs <= qwNowUs))
+        {
+            if (send(gpMockNfcc->nDevFd, gpMockNfcc->aPending[0].aData,
+                    gpMockNfcc->aPending[0].wLength, MSG_NOSIGNAL) < 0)
+            {
+                NXPLOG_TML_E("mock NFCC: send errno : %x", errno);
+            }
+            gpMockNfcc->dwNbPending--;
+            memmove(&gpMockNfcc->aPending[0], &gpMockNfcc->aPending[1],
+                    gpMockNfcc->dwNbPending * sizeof(gpMockNfcc->aPending[0]));
+        }
+        pthread_mutex_unlock(&gpMockNfcc->lock);
+    }
+
+    NXPLOG_TML_D("mock NFCC: stopped");
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_Start
+**
+** Description      Loads the scenario and starts the NFCC on nDevFd. The NFCC
+**                  starts powered.
+**
+** Parameters       nDevFd     - NFCC end of a SOCK_SEQPACKET socketpair, owned
+**                               by the NFCC from now on
+**                  pScenario  - scenario file, NULL for the defaults only
+**
+** Returns          NFCSTATUS_SUCCESS or NFCSTATUS_FAILED
+**
+*******************************************************************************/
+NFCSTATUS phNxpMockNfcc_Start(int nDevFd, const char *pScenario)
+{
+    if (NULL != gpMockNfcc)
+    {
+        return NFCSTATUS_FAILED;
+    }
+    gpMockNfcc = (phNxpMockNfcc_Context_t *)calloc(1, sizeof(phNxpMockNfcc_Context_t));
+    if (NULL == gpMockNfcc)
+    {
+        return NFCSTATUS_FAILED;
+    }
+    gpMockNfcc->pRules = (phNxpMockNfcc_Rule_t *)calloc(PHNXPMOCKNFCC_MAX_RULES,
+            sizeof(phNxpMockNfcc_Rule_t));
+    gpMockNfcc->nDevFd = nDevFd;
+    gpMockNfcc->bPowered = TRUE;
+    gpMockNfcc->dwLatencyUs = PHNXPMOCKNFCC_DEFAULT_LATENCY;
+    pthread_mutex_init(&gpMockNfcc->lock, NULL);
+
+    if ((NULL == gpMockNfcc->pRules) ||
+            (NFCSTATUS_SUCCESS != phNxpMockNfcc_LoadScenario(pScenario)) ||
+            (0 != pthread_create(&gpMockNfcc->thread, NULL, phNxpMockNfcc_Thread, NULL)))
+    {
+        pthread_mutex_destroy(&gpMockNfcc->lock);
+        close(nDevFd);
+        free(gpMockNfcc->t4t.pNdef);
+        free(gpMockNfcc->t4t.pCApdu);
+        free(gpMockNfcc->t4t.pRApdu);
+        free(gpMockNfcc->pRules);
+        free(gpMockNfcc);
+        gpMockNfcc = NULL;
+        return NFCSTATUS_FAILED;
+    }
+    (void)pthread_setname_np(gpMockNfcc->thread, "MOCK_NFCC");
+
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_Stop
+**
+** Description      Waits for the NFCC thread and releases the NFCC. The host
+**                  end of the socketpair must be closed first.
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpMockNfcc_Stop(void)
+{
+    if (NULL == gpMockNfcc)
+    {
+        return;
+    }
+    pthread_join(gpMockNfcc->thread, NULL);
+    close(gpMockNfcc->nDevFd);
+    pthread_mutex_destroy(&gpMockNfcc->lock);
+    free(gpMockNfcc->t4t.pNdef);
+    free(gpMockNfcc->t4t.pCApdu);
+    free(gpMockNfcc->t4t.pRApdu);
+    free(gpMockNfcc->pRules);
+    free(gpMockNfcc);
+    gpMockNfcc = NULL;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_BusTransfer
+**
+** Description      Takes the I2C bus for the transfer of one packet, when the
+**                  scenario gives a bus clock: the address byte and the
+**                  packet, 9 clock cycles per byte. Called by the host port
+**                  before a write and after a read, so the caller is blocked
+**                  as it would be by the I2C driver.
+**
+** Parameters       wLength    - packet length
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpMockNfcc_BusTransfer(uint16_t wLength)
+{
+    uint32_t dwKbps;
+
+    if ((NULL == gpMockNfcc) || (0 == (dwKbps = gpMockNfcc->dwBusKbps)))
+    {
+        return;
+    }
+    pthread_mutex_lock(&tMockBusLock);
+    usleep((useconds_t)(((uint64_t)(1 + wLength) * 9 * 1000) / dwKbps));
+    pthread_mutex_unlock(&tMockBusLock);
+}
+
+/*******************************************************************************
+**
+** Function         phNxpMockNfcc_SetPower
+**
+** Description      Emulates the VEN pin. While off the NFCC drops every host
+**                  packet; switching it off also cancels the pending frames
+**                  and re-arms the "once" rules.
+**
+** Parameters       bOn        - VEN level
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpMockNfcc_SetPower(bool_t bOn)
+{
+    uint32_t i;
+
+    if (NULL == gpMockNfcc)
+    {
+        return;
+    }
+    pthread_mutex_lock(&gpMockNfcc->lock);
+    if (!bOn && gpMockNfcc->bPowered)
+    {
+        gpMockNfcc->dwNbPending = 0;
+        gpMockNfcc->t4t.bSelected = 0;
+        gpMockNfcc->t4t.wFileId = 0;
+        gpMockNfcc->t4t.dwCApduLen = 0;
+        for (i = 0; i < gpMockNfcc->dwNbRules; i++)
+        {
+            gpMockNfcc->pRules[i].bFired = FALSE;
+        }
+    }
+    gpMockNfcc->bPowered = bOn;
+    pthread_mutex_unlock(&gpMockNfcc->lock);
+}
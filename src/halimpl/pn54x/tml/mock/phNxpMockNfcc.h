@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Scriptable software NFCC used by the mock TML.
+ *
+ * The NFCC runs in its own thread on one end of a SOCK_SEQPACKET socketpair,
+ * one NCI packet per message. Every packet received from the host is matched
+ * against the rules of a scenario file, first match wins, and the frames of
+ * the matching rule are sent back after their latency.
+ *
+ * Scenario file syntax, one statement per line, '#' starts a comment:
+ *
+ *   latency <us>             default delay before each reply frame (100 us)
+ *   i2c <kbit/s>             clock of the emulated I2C bus. Each host write
+ *                            and read then takes the time of its transfer,
+ *                            one transfer at a time. Without it the bus
+ *                            takes no time.
+ *   on [once] <pattern>      starts a rule. The pattern is a list of hex
+ *                            bytes, "??" matches any byte and a trailing "*"
+ *                            matches whatever follows. Without "*" the packet
+ *                            length must match. A "once" rule fires once per
+ *                            power cycle of the NFCC.
+ *   send [+<us>] <frame>     frame sent when the rule fires, <us> after the
+ *                            previous frame of the rule (or after the packet
+ *                            was received). "L" stands for the number of
+ *                            bytes that follow it, normally the NCI length.
+ *
+ *   t4t <size> [<mle> [<mlc> [<version>]]]
+ *                            emulates the NDEF Tag Application of a Type 4
+ *                            tag behind the ISO-DEP interface: data packets
+ *                            not matched by a rule carry C-APDUs for it. The
+ *                            NDEF file holds a <size> byte message, MLe and
+ *                            MLc default to 0xFF. Version 0x30 (ENDEF file,
+ *                            ODO ReadBinary/UpdateBinary) is the default when
+ *                            the file does not fit in 32 KiB, else 0x20.
+ *                            Short and extended Lc/Le are accepted; R-APDUs
+ *                            go back in chained data packets, the first one
+ *                            after the latency.
+ *
+ *   t2t <tms> [<product>]    emulates the memory of an NXP Type 2 tag behind
+ *                            the Frame RF interface: data packets not matched
+ *                            by a rule carry READ, WRITE and, when <product>
+ *                            is 3 (MIFARE Ultralight EV1) or 4 (NTAG),
+ *                            GET_VERSION and FAST_READ commands. Others get a
+ *                            NACK, after which the tag is in HALT state and
+ *                            answers nothing until RF_DEACTIVATE_CMD. The CC
+ *                            announces a data area of <tms> * 8 bytes, at most
+ *                            0x7B, filled with one NDEF message and a
+ *                            terminator TLV.
+ *
+ *   t5t <blocks> [<ic ref> [<max read>]]
+ *                            emulates the memory of a Type 5 tag of <blocks>
+ *                            4 byte blocks behind the Frame RF interface:
+ *                            data packets not matched by a rule carry
+ *                            addressed ISO/IEC 15693 requests, basic or
+ *                            extended. Get System Information reports
+ *                            <ic ref>; the UID is the one of the request.
+ *                            Read Multiple Blocks of more than <max read>
+ *                            blocks (default 64) get an error. More than 256
+ *                            blocks, at most 2048, need the IC reference of
+ *                            an ST25DV (0x24 to 0x27). The CC, of 8 bytes
+ *                            beyond 2040 bytes, is followed by one NDEF
+ *                            message and a terminator TLV.
+ *
+ * Packets matching no rule get a generic answer: a RSP with status OK for a
+ * command, a CORE_CONN_CREDITS_NTF returning one credit for data. CORE_RESET
+ * and CORE_INIT are answered as a PN7150 would unless the scenario overrides
+ * them.
+ */
+
+#if ! defined (PHNXPMOCKNFCC__H_INCLUDED)
+#define PHNXPMOCKNFCC__H_INCLUDED
+
+#include <phNfcTypes.h>
+#include <phNfcStatus.h>
+
+#define PHNXPMOCKNFCC_MAX_FRAME         (258)   /* NCI header + 255 byte payload */
+
+NFCSTATUS phNxpMockNfcc_Start(int nDevFd, const char *pScenario);
+void phNxpMockNfcc_Stop(void);
+void phNxpMockNfcc_SetPower(bool_t bOn);
+void phNxpMockNfcc_BusTransfer(uint16_t wLength);
+
+#endif /* PHNXPMOCKNFCC__H_INCLUDED */
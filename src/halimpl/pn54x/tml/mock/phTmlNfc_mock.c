@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * TML mock port: replaces the I2C device with the software NFCC of
+ * phNxpMockNfcc.c, so the HAL and the stack run without a PN54X.
+ *
+ * The generic TML (tml/i2c/phTmlNfc.c) is used unchanged; this file provides
+ * the phTmlNfc_i2c_* port functions on top of a SOCK_SEQPACKET socketpair.
+ * The NFCC behaviour comes from the scenario file named by
+ * NXP_MOCK_NFCC_SCENARIO.
+ */
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <string.h>
+
+#include <phNxpLog.h>
+#include <phNxpConfig.h>
+#include <phTmlNfc_i2c.h>
+#include <phNfcStatus.h>
+#include <phNxpMockNfcc.h>
+#include "phNxpNciHal_utils.h"
+
+#define PHTMLNFC_MOCK_PATH_MAX      260
+
+/* Host end of the socketpair */
+static int iMockFd = -1;
+
+/* Reader waits on the socket and on an eventfd used to abort the read */
+static int iReadEpollFd = -1;
+static int iReadWakeFd  = -1;
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_close
+**
+** Description      Closes the link to the mock NFCC and stops it
+**
+** Parameters       pDevHandle - device handle
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_i2c_close(void *pDevHandle)
+{
+    UNUSED(pDevHandle);
+
+    if (iMockFd >= 0) close(iMockFd);
+    if (iReadEpollFd >= 0) close(iReadEpollFd);
+    if (iReadWakeFd  >= 0) close(iReadWakeFd);
+    iMockFd = iReadEpollFd = iReadWakeFd = -1;
+    /* the NFCC thread ends once it sees the host end closed */
+    phNxpMockNfcc_Stop();
+
+    return;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_wakeup
+**
+** Description      Makes a phTmlNfc_i2c_read blocked waiting for the NFCC
+**                  return PH_TMLNFC_I2C_READ_ABORTED
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_i2c_wakeup(void)
+{
+    uint64_t val = 1;
+
+    if (iReadWakeFd >= 0)
+    {
+        if (write(iReadWakeFd, &val, sizeof(val)) != sizeof(val))
+        {
+            NXPLOG_TML_E("mock wakeup errno : %x", errno);
+        }
+    }
+
+    return;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_open_and_configure
+**
+** Description      Starts the mock NFCC with the scenario named by
+**                  NXP_MOCK_NFCC_SCENARIO (defaults only when not set) and
+**                  connects to it. pConfig->pDevName is not used.
+**
+** Parameters       pConfig     - hardware information
+**                  pLinkHandle - device handle
+**
+** Returns          NFC status:
+**                  NFCSTATUS_SUCCESS            - open_and_configure operation success
+**                  NFCSTATUS_INVALID_DEVICE     - device open operation failure
+**
+*******************************************************************************/
+NFCSTATUS phTmlNfc_i2c_open_and_configure(pphTmlNfc_Config_t pConfig, void ** pLinkHandle)
+{
+    char scenario[PHTMLNFC_MOCK_PATH_MAX];
+    struct epoll_event ev;
+    int fds[2];
+    UNUSED(pConfig);
+
+    *pLinkHandle = NULL;
+    memset(scenario, 0, sizeof(scenario));
+    if (!GetNxpStrValue(NAME_NXP_MOCK_NFCC_SCENARIO, scenario, sizeof(scenario)))
+    {
+        scenario[0] = '\0';
+    }
+    NXPLOG_TML_D("phTmlNfc_i2c_open_and_configure mock NFCC, scenario=%s\n",
+            (scenario[0] != '\0') ? scenario : "<defaults>");
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0)
+    {
+        NXPLOG_TML_E("_mock_open() socketpair errno : %x", errno);
+        return NFCSTATUS_INVALID_DEVICE;
+    }
+    if (NFCSTATUS_SUCCESS != phNxpMockNfcc_Start(fds[1],
+            (scenario[0] != '\0') ? scenario : NULL))
+    {
+        close(fds[0]);
+        return NFCSTATUS_INVALID_DEVICE;
+    }
+    iMockFd = fds[0];
+
+    iReadWakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    iReadEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = iMockFd;
+    if ((iReadWakeFd < 0) || (iReadEpollFd < 0) ||
+            (epoll_ctl(iReadEpollFd, EPOLL_CTL_ADD, iMockFd, &ev) < 0))
+    {
+        NXPLOG_TML_E("_mock_open() epoll/eventfd errno : %x", errno);
+        phTmlNfc_i2c_close(NULL);
+        return NFCSTATUS_INVALID_DEVICE;
+    }
+    ev.data.fd = iReadWakeFd;
+    if (epoll_ctl(iReadEpollFd, EPOLL_CTL_ADD, iReadWakeFd, &ev) < 0)
+    {
+        NXPLOG_TML_E("_mock_open() epoll_ctl(wake) errno : %x", errno);
+        phTmlNfc_i2c_close(NULL);
+        return NFCSTATUS_INVALID_DEVICE;
+    }
+
+    *pLinkHandle = (void*) ((intptr_t)iMockFd);
+
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_read
+**
+** Description      Reads one NCI packet sent by the mock NFCC
+**
+** Parameters       pDevHandle       - valid device handle
+**                  pBuffer          - buffer for read data
+**                  nNbBytesToRead   - size of pBuffer
+**
+** Returns          numRead   - number of successfully read bytes
+**                  -1        - read operation failure
+**                  PH_TMLNFC_I2C_READ_ABORTED - woken up by phTmlNfc_i2c_wakeup
+**
+*******************************************************************************/
+int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead)
+{
+    struct epoll_event events[2];
+    uint64_t val;
+    int ret_Wait;
+    int ret_Read;
+    int i;
+
+    if (NULL == pDevHandle)
+    {
+        return -1;
+    }
+
+    do
+    {
+        ret_Wait = epoll_wait(iReadEpollFd, events, 2, -1);
+    } while ((ret_Wait < 0) && (errno == EINTR));
+
+    if (ret_Wait <= 0)
+    {
+        NXPLOG_TML_E("mock epoll_wait() errno : %x",errno);
+        return -1;
+    }
+    for (i = 0; i < ret_Wait; i++)
+    {
+        if (events[i].data.fd == iReadWakeFd)
+        {
+            (void) read(iReadWakeFd, &val, sizeof(val));
+            NXPLOG_TML_D("mock read aborted");
+            return PH_TMLNFC_I2C_READ_ABORTED;
+        }
+    }
+
+    ret_Read = recv((intptr_t)pDevHandle, pBuffer, nNbBytesToRead, 0);
+    if (ret_Read == 0)
+    {
+        NXPLOG_TML_E("_mock_read() EOF");
+        return -1;
+    }
+    else if (ret_Read < 0)
+    {
+        NXPLOG_TML_E("_mock_read() errno : %x",errno);
+        return -1;
+    }
+    phNxpMockNfcc_BusTransfer((uint16_t)ret_Read);
+    return ret_Read;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_write
+**
+** Description      Sends one NCI packet to the mock NFCC
+**
+** Parameters       pDevHandle       - valid device handle
+**                  pBuffer          - buffer for read data
+**                  nNbBytesToWrite  - number of bytes requested to be written
+**
+** Returns          numWrote   - number of successfully written bytes
+**                  -1         - write operation failure
+**
+*******************************************************************************/
+int phTmlNfc_i2c_write(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToWrite)
+{
+    int ret;
+
+    if (NULL == pDevHandle)
+    {
+        return -1;
+    }
+    phNxpMockNfcc_BusTransfer((uint16_t)nNbBytesToWrite);
+    do
+    {
+        ret = send((intptr_t)pDevHandle, pBuffer, nNbBytesToWrite, MSG_NOSIGNAL);
+    } while ((ret < 0) && (errno == EINTR));
+    if (ret < 0)
+    {
+        NXPLOG_TML_E("_mock_write() errno : %x",errno);
+        return -1;
+    }
+
+    return ret;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_reset
+**
+** Description      Drives the VEN pin of the mock NFCC. Download mode (level
+**                  2) is not emulated, the NFCC stays in NCI mode.
+**
+** Parameters       pDevHandle     - valid device handle
+**                  level          - reset level
+**
+** Returns           0   - reset operation success
+**                  -1   - reset operation failure
+**
+*******************************************************************************/
+int phTmlNfc_i2c_reset(void *pDevHandle, long level)
+{
+    NXPLOG_TML_D("phTmlNfc_i2c_reset(), VEN level %ld", level);
+
+    if (NULL == pDevHandle)
+    {
+        return -1;
+    }
+    phNxpMockNfcc_SetPower((level != 0) ? TRUE : FALSE);
+    return 0;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_wait_ready
+**
+** Description      The mock NFCC is ready as soon as VEN is high
+**
+** Parameters       pDevHandle     - valid device handle
+**                  dwTimeoutMs    - maximum time to wait
+**
+** Returns           1   - NFCC ready
+**                  -1   - invalid handle
+**
+*******************************************************************************/
+int phTmlNfc_i2c_wait_ready(void *pDevHandle, uint32_t dwTimeoutMs)
+{
+    UNUSED(dwTimeoutMs);
+
+    return (NULL == pDevHandle) ? -1 : 1;
+}
+
+/*******************************************************************************
+**
+** Function         getDownloadFlag
+**
+** Description      Returns the current mode
+**
+** Parameters       none
+**
+** Returns           Current mode download/NCI
+*******************************************************************************/
+bool_t getDownloadFlag(void)
+{
+    return FALSE;
+}
@@ -26,18 +26,14 @@
 #include <phDal4Nfc_messageQueueLib.h>
 
 
-typedef struct phDal4Nfc_message_queue_item
-{
-    phLibNfc_Message_t nMsg;
-    struct phDal4Nfc_message_queue_item * pPrev;
-    struct phDal4Nfc_message_queue_item * pNext;
-} phDal4Nfc_message_queue_item_t;
-
 typedef struct phDal4Nfc_message_queue
 {
-    phDal4Nfc_message_queue_item_t * pItems;
+    phLibNfc_Message_t *pMsg;                      /* ring of posted messages */
+    uint32_t nSize;                                /* messages the ring can hold */
+    uint32_t nHead;                                /* next message to receive */
+    uint32_t nCount;                               /* messages in the ring */
     pthread_mutex_t nCriticalSectionMutex;
-    sem_t nProcessSemaphore;
+    sem_t nProcessSemaphore;                       /* counts posted messages */
 
 } phDal4Nfc_message_queue_t;
 
@@ -52,6 +48,9 @@ typedef struct phDal4Nfc_message_queue
 ** Returns          (int) value of pQueue if successful
 **                  -1, if failed to allocate memory or to init mutex
 **
+** Note             Room for PHDAL4NFC_MSGQ_DEPTH messages is allocated here;
+**                  phDal4Nfc_msgsnd only allocates when the queue is full.
+**
 *******************************************************************************/
 intptr_t phDal4Nfc_msgget(key_t key, int msgflg)
 {
@@ -62,13 +61,22 @@ intptr_t phDal4Nfc_msgget(key_t key, int msgflg)
     if (pQueue == NULL)
         return -1;
     memset(pQueue, 0, sizeof(phDal4Nfc_message_queue_t));
+    pQueue->pMsg = (phLibNfc_Message_t *) malloc(PHDAL4NFC_MSGQ_DEPTH * sizeof(phLibNfc_Message_t));
+    if (pQueue->pMsg == NULL)
+    {
+        free (pQueue);
+        return -1;
+    }
+    pQueue->nSize = PHDAL4NFC_MSGQ_DEPTH;
     if (pthread_mutex_init(&pQueue->nCriticalSectionMutex, NULL) == -1)
     {
+        free (pQueue->pMsg);
         free (pQueue);
         return -1;
     }
     if (sem_init(&pQueue->nProcessSemaphore, 0, 0) == -1)
     {
+        free (pQueue->pMsg);
         free (pQueue);
         return -1;
     }
@@ -101,6 +109,7 @@ void phDal4Nfc_msgrelease(intptr_t msqid)
         }
         pthread_mutex_destroy (&pQueue->nCriticalSectionMutex);
 
+        free(pQueue->pMsg);
         free(pQueue);
     }
 
@@ -123,7 +132,6 @@ void phDal4Nfc_msgrelease(intptr_t msqid)
 int phDal4Nfc_msgctl(intptr_t msqid, int cmd, void *buf)
 {
     phDal4Nfc_message_queue_t * pQueue;
-    phDal4Nfc_message_queue_item_t * p;
     UNUSED(cmd);
     UNUSED(buf);
     if (msqid == 0)
@@ -131,24 +139,15 @@ int phDal4Nfc_msgctl(intptr_t msqid, int cmd, void *buf)
 
     pQueue = (phDal4Nfc_message_queue_t *) msqid;
     pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
-    if (pQueue->pItems != NULL)
+    pQueue->nHead = 0;
+    pQueue->nCount = 0;
+    pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
+    if (sem_destroy(&pQueue->nProcessSemaphore))
     {
-        p = pQueue->pItems;
-        while (p->pNext != NULL)
-        {
-            p = p->pNext;
-        }
-        while (p->pPrev != NULL)
-        {
-            p = p->pPrev;
-            free(p->pNext);
-            p->pNext = NULL;
-        }
-        free(p);
+        NXPLOG_TML_E("Failed to destroy semaphore (errno=0x%08x)", errno);
     }
-    pQueue->pItems = NULL;
-    pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
     pthread_mutex_destroy(&pQueue->nCriticalSectionMutex);
+    free(pQueue->pMsg);
     free(pQueue);
 
     return 0;
@@ -159,7 +158,9 @@ int phDal4Nfc_msgctl(intptr_t msqid, int cmd, void *buf)
 ** Function         phDal4Nfc_msgsnd
 **
 ** Description      Sends a message to the queue. The message will be added at the end of
-**                  the queue as appropriate for FIFO policy
+**                  the queue as appropriate for FIFO policy.
+**                  If the queue is full it is doubled, so the caller never waits
+**                  and no message is dropped.
 **
 ** Parameters       msqid  - message queue handle
 **                  msgp   - message to be sent
@@ -167,41 +168,47 @@ int phDal4Nfc_msgctl(intptr_t msqid, int cmd, void *buf)
 **                  msgflg - ignored
 **
 ** Returns          0,  if successful
-**                  -1, if invalid parameter passed or failed to allocate memory
+**                  -1, if invalid parameter passed or the full queue cannot grow
+**                      (errno ENOMEM)
 **
 *******************************************************************************/
 intptr_t phDal4Nfc_msgsnd(intptr_t msqid, phLibNfc_Message_t * msg, int msgflg)
 {
     phDal4Nfc_message_queue_t * pQueue;
-    phDal4Nfc_message_queue_item_t * p;
-    phDal4Nfc_message_queue_item_t * pNew;
+    phLibNfc_Message_t * pMsg;
+    uint32_t nFirst;
     UNUSED(msgflg);
     if ((msqid == 0) || (msg == NULL) )
         return -1;
 
 
     pQueue = (phDal4Nfc_message_queue_t *) msqid;
-    pNew = (phDal4Nfc_message_queue_item_t *) malloc(sizeof(phDal4Nfc_message_queue_item_t));
-    if (pNew == NULL)
-        return -1;
-    memset(pNew, 0, sizeof(phDal4Nfc_message_queue_item_t));
-    memcpy(&pNew->nMsg, msg, sizeof(phLibNfc_Message_t));
-    pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
 
-    if (pQueue->pItems != NULL)
+    pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
+    if (pQueue->nCount == pQueue->nSize)
     {
-        p = pQueue->pItems;
-        while (p->pNext != NULL)
+        pMsg = (phLibNfc_Message_t *) malloc(2 * pQueue->nSize * sizeof(phLibNfc_Message_t));
+        if (pMsg == NULL)
         {
-            p = p->pNext;
+            pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
+            NXPLOG_TML_E("Message queue full (%d messages), cannot grow it for message 0x%x",
+                    pQueue->nSize, msg->eMsgType);
+            errno = ENOMEM;
+            return -1;
         }
-        p->pNext = pNew;
-        pNew->pPrev = p;
-    }
-    else
-    {
-        pQueue->pItems = pNew;
+        /* unwrap the ring, oldest message first */
+        nFirst = pQueue->nSize - pQueue->nHead;
+        memcpy(pMsg, &pQueue->pMsg[pQueue->nHead], nFirst * sizeof(phLibNfc_Message_t));
+        memcpy(&pMsg[nFirst], pQueue->pMsg, pQueue->nHead * sizeof(phLibNfc_Message_t));
+        free(pQueue->pMsg);
+        pQueue->pMsg = pMsg;
+        pQueue->nHead = 0;
+        pQueue->nSize *= 2;
+        NXPLOG_TML_D("Message queue grown to %d messages", pQueue->nSize);
     }
+    memcpy(&pQueue->pMsg[(pQueue->nHead + pQueue->nCount) % pQueue->nSize],
+            msg, sizeof(phLibNfc_Message_t));
+    pQueue->nCount++;
     pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
 
     sem_post(&pQueue->nProcessSemaphore);
@@ -230,7 +237,6 @@ intptr_t phDal4Nfc_msgsnd(intptr_t msqid, phLibNfc_Message_t * msg, int msgflg)
 int phDal4Nfc_msgrcv(intptr_t msqid, phLibNfc_Message_t * msg, long msgtyp, int msgflg)
 {
     phDal4Nfc_message_queue_t * pQueue;
-    phDal4Nfc_message_queue_item_t * p;
     UNUSED(msgflg);
     UNUSED(msgtyp);
     if ((msqid == 0) || (msg == NULL))
@@ -242,12 +248,11 @@ int phDal4Nfc_msgrcv(intptr_t msqid, phLibNfc_Message_t * msg, long msgtyp, int
 
     pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
 
-    if (pQueue->pItems != NULL)
+    if (pQueue->nCount != 0)
     {
-        memcpy(msg, &(pQueue->pItems)->nMsg, sizeof(phLibNfc_Message_t));
-        p = pQueue->pItems->pNext;
-        free(pQueue->pItems);
-        pQueue->pItems = p;
+        memcpy(msg, &pQueue->pMsg[pQueue->nHead], sizeof(phLibNfc_Message_t));
+        pQueue->nHead = (pQueue->nHead + 1) % pQueue->nSize;
+        pQueue->nCount--;
     }
     pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
 
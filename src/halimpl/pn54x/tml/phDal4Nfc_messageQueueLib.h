@@ -28,6 +28,11 @@
 #define key_t __kernel_key_t
 #endif
 
+/* Number of messages a queue holds initially; phDal4Nfc_msgsnd doubles it when full */
+#ifndef PHDAL4NFC_MSGQ_DEPTH
+#define PHDAL4NFC_MSGQ_DEPTH 64
+#endif
+
 intptr_t phDal4Nfc_msgget(key_t key, int msgflg);
 void phDal4Nfc_msgrelease(intptr_t msqid);
 int phDal4Nfc_msgctl(intptr_t msqid, int cmd, void *buf);
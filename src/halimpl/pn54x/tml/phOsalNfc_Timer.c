@@ -16,9 +16,20 @@
 
 /*
  * OSAL Implementation for Timers.
+ *
+ * All timers share one thread blocked on a CLOCK_MONOTONIC timerfd, armed for
+ * the earliest deadline of a min-heap of the running timers. An expiry posts
+ * the deferred call of the timer on the client thread, as before; no thread
+ * is created per timeout and changes of the wall clock have no effect.
  */
 
-#include <signal.h>
+/* pthread_setname_np */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
 #include <phNfcTypes.h>
 #include <phOsalNfc_Timer.h>
 #include <phNfcCommon.h>
@@ -46,10 +57,31 @@ extern phNxpNciHal_Control_t nxpncihal_ctrl;
  * Invalid timer ID type. This ID used indicate timer creation is failed */
 #define PH_NFC_TIMER_ID_INVALID                     (0xFFFF)
 
+/*
+ * Timer thread and heap of the running timers, ordered by deadline.
+ * apTimerInfo and the heap are protected by lock.
+ */
+typedef struct phOsalNfc_TimerService
+{
+    pthread_mutex_t lock;
+    pthread_t thread;
+    int timerFd;                            /* -1 while the thread is not running */
+    uint8_t bStop;
+    uint32_t dwHeapSize;
+    uint32_t adwHeap[PH_NFC_MAX_TIMER];     /* indexes into apTimerInfo */
+} phOsalNfc_TimerService_t;
+
+static phOsalNfc_TimerService_t tTimerService = {
+    .lock = PTHREAD_MUTEX_INITIALIZER, .timerFd = -1 };
+
 /* Forward declarations */
 static void phOsalNfc_PostTimerMsg(phLibNfc_Message_t *pMsg);
 static void phOsalNfc_DeferredCall (void *pParams);
-static void phOsalNfc_Timer_Expired(union sigval sv);
+static void phOsalNfc_Timer_Expired(uint32_t dwIndex);
+static NFCSTATUS phOsalNfc_Timer_StartThread(void);
+static void phOsalNfc_Timer_HeapInsert(uint32_t dwIndex);
+static void phOsalNfc_Timer_HeapRemove(uint32_t dwIndex);
+static void phOsalNfc_Timer_Rearm(void);
 
 /*
  *************************** Function Definitions ******************************
@@ -72,13 +104,12 @@ uint32_t phOsalNfc_Timer_Create(void)
 {
     /* dwTimerId is also used as an index at which timer object can be stored */
     uint32_t dwTimerId = PH_OSALNFC_TIMER_ID_INVALID;
-    static struct sigevent se;
     phOsalNfc_TimerHandle_t *pTimerHandle;
-    /* Timer needs to be initialized for timer usage */
 
-        se.sigev_notify = SIGEV_THREAD;
-        se.sigev_notify_function = phOsalNfc_Timer_Expired;
-        se.sigev_notify_attributes = NULL;
+    pthread_mutex_lock(&tTimerService.lock);
+    /* Timer thread needs to run for timer usage */
+    if (NFCSTATUS_SUCCESS == phOsalNfc_Timer_StartThread())
+    {
         dwTimerId = phUtilNfc_CheckForAvailableTimer();
 
         /* Check whether timers are available, if yes create a timer handle structure */
@@ -87,24 +118,18 @@ uint32_t phOsalNfc_Timer_Create(void)
             pTimerHandle = (phOsalNfc_TimerHandle_t *)&apTimerInfo[dwTimerId-1];
             /* Build the Timer Id to be returned to Caller Function */
             dwTimerId += PH_NFC_TIMER_BASE_ADDRESS;
-            se.sigev_value.sival_int = (int)dwTimerId;
-            /* Create POSIX timer */
-            if(timer_create(CLOCK_REALTIME, &se, &(pTimerHandle->hTimerHandle)) == -1)
-            {
-                dwTimerId = PH_NFC_TIMER_ID_INVALID;
-            }
-            else
-            {
-                /* Set the state to indicate timer is ready */
-                pTimerHandle->eState = eTimerIdle;
-                /* Store the Timer Id which shall act as flag during check for timer availability */
-                pTimerHandle->TimerId = dwTimerId;
-            }
+            /* Set the state to indicate timer is ready */
+            pTimerHandle->eState = eTimerIdle;
+            pTimerHandle->dwHeapPos = 0;
+            /* Store the Timer Id which shall act as flag during check for timer availability */
+            pTimerHandle->TimerId = dwTimerId;
         }
         else
         {
             dwTimerId = PH_NFC_TIMER_ID_INVALID;
         }
+    }
+    pthread_mutex_unlock(&tTimerService.lock);
 
     /* Timer ID invalid can be due to Uninitialized state,Non availability of Timer */
     return dwTimerId;
@@ -135,39 +160,33 @@ NFCSTATUS phOsalNfc_Timer_Start(uint32_t dwTimerId, uint32_t dwRegTimeCnt, pphOs
 {
     NFCSTATUS wStartStatus= NFCSTATUS_SUCCESS;
 
-    struct itimerspec its;
+    struct timespec now;
     uint32_t dwIndex;
     phOsalNfc_TimerHandle_t *pTimerHandle;
     /* Retrieve the index at which the timer handle structure is stored */
     dwIndex = dwTimerId - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
     pTimerHandle = (phOsalNfc_TimerHandle_t *)&apTimerInfo[dwIndex];
-    /* OSAL Module needs to be initialized for timer usage */
+    pthread_mutex_lock(&tTimerService.lock);
         /* Check whether the handle provided by user is valid */
         if( (dwIndex < PH_NFC_MAX_TIMER) && (0x00 != pTimerHandle->TimerId) &&
                 (NULL != pApplication_callback) )
         {
-            its.it_interval.tv_sec  = 0;
-            its.it_interval.tv_nsec = 0;
-            its.it_value.tv_sec     = dwRegTimeCnt / 1000;
-            its.it_value.tv_nsec    = 1000000 * (dwRegTimeCnt % 1000);
-            if(its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
-            {
-                /* This would inadvertently stop the timer*/
-                its.it_value.tv_nsec = 1;
-            }
+            clock_gettime(CLOCK_MONOTONIC, &now);
             pTimerHandle->Application_callback = pApplication_callback;
             pTimerHandle->pContext = pContext;
             pTimerHandle->eState = eTimerRunning;
-            /* Arm the timer */
-            if((timer_settime(pTimerHandle->hTimerHandle, 0, &its, NULL)) == -1)
-            {
-                wStartStatus = PHNFCSTVAL(CID_NFC_OSAL, PH_OSALNFC_TIMER_START_ERROR);
-            }
+            /* A running timer restarts with the new timeout */
+            phOsalNfc_Timer_HeapRemove(dwIndex);
+            pTimerHandle->qwDeadline = (uint64_t)now.tv_sec * 1000000000U + now.tv_nsec +
+                    (uint64_t)dwRegTimeCnt * 1000000U;
+            phOsalNfc_Timer_HeapInsert(dwIndex);
+            phOsalNfc_Timer_Rearm();
         }
         else
         {
             wStartStatus = PHNFCSTVAL(CID_NFC_OSAL, NFCSTATUS_INVALID_PARAMETER);
         }
+    pthread_mutex_unlock(&tTimerService.lock);
 
     return wStartStatus;
 }
@@ -192,13 +211,12 @@ NFCSTATUS phOsalNfc_Timer_Start(uint32_t dwTimerId, uint32_t dwRegTimeCnt, pphOs
 NFCSTATUS phOsalNfc_Timer_Stop(uint32_t dwTimerId)
 {
     NFCSTATUS wStopStatus=NFCSTATUS_SUCCESS;
-    static struct itimerspec its = {{0, 0}, {0, 0}};
 
     uint32_t dwIndex;
     phOsalNfc_TimerHandle_t *pTimerHandle;
     dwIndex = dwTimerId - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
     pTimerHandle = (phOsalNfc_TimerHandle_t *)&apTimerInfo[dwIndex];
-    /* OSAL Module and Timer needs to be initialized for timer usage */
+    pthread_mutex_lock(&tTimerService.lock);
         /* Check whether the TimerId provided by user is valid */
         if( (dwIndex < PH_NFC_MAX_TIMER) && (0x00 != pTimerHandle->TimerId) &&
                 (pTimerHandle->eState != eTimerIdle) )
@@ -206,21 +224,17 @@ NFCSTATUS phOsalNfc_Timer_Stop(uint32_t dwTimerId)
             /* Stop the timer only if the callback has not been invoked */
             if(pTimerHandle->eState == eTimerRunning)
             {
-                if((timer_settime(pTimerHandle->hTimerHandle, 0, &its, NULL)) == -1)
-                {
-                    wStopStatus = PHNFCSTVAL(CID_NFC_OSAL, PH_OSALNFC_TIMER_STOP_ERROR);
-                }
-                else
-                {
-                    /* Change the state of timer to Stopped */
-                    pTimerHandle->eState = eTimerStopped;
-                }
+                phOsalNfc_Timer_HeapRemove(dwIndex);
+                phOsalNfc_Timer_Rearm();
+                /* Change the state of timer to Stopped */
+                pTimerHandle->eState = eTimerStopped;
             }
         }
         else
         {
             wStopStatus = PHNFCSTVAL(CID_NFC_OSAL, NFCSTATUS_INVALID_PARAMETER);
         }
+    pthread_mutex_unlock(&tTimerService.lock);
 
     return wStopStatus;
 }
@@ -250,7 +264,7 @@ NFCSTATUS phOsalNfc_Timer_Delete(uint32_t dwTimerId)
     phOsalNfc_TimerHandle_t *pTimerHandle;
     dwIndex = dwTimerId - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
     pTimerHandle = (phOsalNfc_TimerHandle_t *)&apTimerInfo[dwIndex];
-    /* OSAL Module and Timer needs to be initialized for timer usage */
+    pthread_mutex_lock(&tTimerService.lock);
 
         /* Check whether the TimerId passed by user is valid and Deregistering of timer is successful */
         if( (dwIndex < PH_NFC_MAX_TIMER) && (0x00 != pTimerHandle->TimerId)
@@ -258,10 +272,8 @@ NFCSTATUS phOsalNfc_Timer_Delete(uint32_t dwTimerId)
         )
         {
             /* Cancel the timer before deleting */
-            if(timer_delete(pTimerHandle->hTimerHandle) == -1)
-            {
-                wDeleteStatus = PHNFCSTVAL(CID_NFC_OSAL, PH_OSALNFC_TIMER_DELETE_ERROR);
-            }
+            phOsalNfc_Timer_HeapRemove(dwIndex);
+            phOsalNfc_Timer_Rearm();
             /* Clear Timer structure used to store timer related data */
             memset(pTimerHandle,(uint8_t)0x00,sizeof(phOsalNfc_TimerHandle_t));
         }
@@ -269,6 +281,7 @@ NFCSTATUS phOsalNfc_Timer_Delete(uint32_t dwTimerId)
         {
             wDeleteStatus = PHNFCSTVAL(CID_NFC_OSAL, NFCSTATUS_INVALID_PARAMETER);
         }
+    pthread_mutex_unlock(&tTimerService.lock);
     return wDeleteStatus;
 }
 
@@ -290,25 +303,48 @@ void phOsalNfc_Timer_Cleanup(void)
     /* Delete all timers */
     uint32_t dwIndex;
     phOsalNfc_TimerHandle_t *pTimerHandle;
+    struct itimerspec its;
+    int timerFd;
+
+    pthread_mutex_lock(&tTimerService.lock);
     for(dwIndex = 0; dwIndex < PH_NFC_MAX_TIMER; dwIndex++)
     {
         pTimerHandle = (phOsalNfc_TimerHandle_t *)&apTimerInfo[dwIndex];
-        /* OSAL Module and Timer needs to be initialized for timer usage */
 
         /* Check whether the TimerId passed by user is valid and Deregistering of timer is successful */
         if( (0x00 != pTimerHandle->TimerId)
                 && (NFCSTATUS_SUCCESS == phOsalNfc_CheckTimerPresence(pTimerHandle))
         )
         {
-            /* Cancel the timer before deleting */
-            if(timer_delete(pTimerHandle->hTimerHandle) == -1)
-            {
-                NXPLOG_TML_E("timer %d delete error!", dwIndex);
-            }
             /* Clear Timer structure used to store timer related data */
             memset(pTimerHandle,(uint8_t)0x00,sizeof(phOsalNfc_TimerHandle_t));
         }
     }
+    tTimerService.dwHeapSize = 0;
+
+    /* Stop the timer thread: expire the timerfd at once */
+    timerFd = tTimerService.timerFd;
+    if (timerFd >= 0)
+    {
+        tTimerService.bStop = 1;
+        memset(&its, 0, sizeof(its));
+        its.it_value.tv_nsec = 1;
+        if (timerfd_settime(timerFd, 0, &its, NULL) == -1)
+        {
+            NXPLOG_TML_E("timer thread stop error!");
+        }
+    }
+    pthread_mutex_unlock(&tTimerService.lock);
+
+    if (timerFd >= 0)
+    {
+        pthread_join(tTimerService.thread, NULL);
+        close(timerFd);
+        pthread_mutex_lock(&tTimerService.lock);
+        tTimerService.timerFd = -1;
+        tTimerService.bStop = 0;
+        pthread_mutex_unlock(&tTimerService.lock);
+    }
 
     return;
 }
@@ -371,26 +407,26 @@ static void phOsalNfc_PostTimerMsg(phLibNfc_Message_t *pMsg)
 ** Function         phOsalNfc_Timer_Expired
 **
 ** Description      posts message upon expiration of timer
-**                  Shall be invoked when any one timer is expired
+**                  Shall be invoked by the timer thread, with the lock held,
+**                  when any one timer is expired
 **                  Shall post message on user thread to invoke respective
 **                  callback function provided by the caller of Timer function
 **
+** Parameters       dwIndex - index of the timer in apTimerInfo
+**
 ** Returns          None
 **
 *******************************************************************************/
-static void phOsalNfc_Timer_Expired(union sigval sv)
+static void phOsalNfc_Timer_Expired(uint32_t dwIndex)
 {
-   uint32_t dwIndex;
-   phOsalNfc_TimerHandle_t *pTimerHandle;
-
+    phOsalNfc_TimerHandle_t *pTimerHandle;
 
-    dwIndex = ((uint32_t)(sv.sival_int)) - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
     pTimerHandle = (phOsalNfc_TimerHandle_t *)&apTimerInfo[dwIndex];
     /* Timer is stopped when callback function is invoked */
     pTimerHandle->eState = eTimerStopped;
 
     pTimerHandle->tDeferedCallInfo.pDeferedCall = &phOsalNfc_DeferredCall;
-    pTimerHandle->tDeferedCallInfo.pParam = (void *) ((intptr_t)(sv.sival_int));
+    pTimerHandle->tDeferedCallInfo.pParam = (void *) ((intptr_t)(pTimerHandle->TimerId));
 
     pTimerHandle->tOsalMessage.eMsgType = PH_LIBNFC_DEFERREDCALL_MSG;
     pTimerHandle->tOsalMessage.pMsgData = (void *)&pTimerHandle->tDeferedCallInfo;
@@ -402,6 +438,244 @@ static void phOsalNfc_Timer_Expired(union sigval sv)
     return;
 }
 
+/*******************************************************************************
+**
+** Function         phOsalNfc_Timer_Thread
+**
+** Description      Timer thread. Waits on the timerfd and expires every timer
+**                  whose deadline passed, until phOsalNfc_Timer_Cleanup
+**
+** Parameters       pParam - unused
+**
+** Returns          NULL
+**
+*******************************************************************************/
+static void *phOsalNfc_Timer_Thread(void *pParam)
+{
+    struct timespec now;
+    uint64_t qwNow;
+    uint64_t qwExpirations;
+    uint32_t dwIndex;
+    UNUSED(pParam);
+
+    for (;;)
+    {
+        if ((read(tTimerService.timerFd, &qwExpirations, sizeof(qwExpirations)) < 0) &&
+                (errno != EINTR) && (errno != EAGAIN))
+        {
+            NXPLOG_TML_E("timer thread read errno : %x", errno);
+        }
+
+        pthread_mutex_lock(&tTimerService.lock);
+        if (tTimerService.bStop)
+        {
+            pthread_mutex_unlock(&tTimerService.lock);
+            break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        qwNow = (uint64_t)now.tv_sec * 1000000000U + now.tv_nsec;
+        while ((tTimerService.dwHeapSize > 0) &&
+                (apTimerInfo[tTimerService.adwHeap[0]].qwDeadline <= qwNow))
+        {
+            dwIndex = tTimerService.adwHeap[0];
+            phOsalNfc_Timer_HeapRemove(dwIndex);
+            phOsalNfc_Timer_Expired(dwIndex);
+        }
+        phOsalNfc_Timer_Rearm();
+        pthread_mutex_unlock(&tTimerService.lock);
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_Timer_StartThread
+**
+** Description      Creates the timerfd and the timer thread, if not running.
+**                  Called with the lock held.
+**
+** Parameters       None
+**
+** Returns          NFCSTATUS_SUCCESS if the timer thread runs
+**
+*******************************************************************************/
+static NFCSTATUS phOsalNfc_Timer_StartThread(void)
+{
+    if (tTimerService.timerFd >= 0)
+    {
+        return NFCSTATUS_SUCCESS;
+    }
+
+    tTimerService.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tTimerService.timerFd < 0)
+    {
+        NXPLOG_TML_E("timerfd_create errno : %x", errno);
+        return NFCSTATUS_FAILED;
+    }
+    tTimerService.bStop = 0;
+    tTimerService.dwHeapSize = 0;
+    if (pthread_create(&tTimerService.thread, NULL, phOsalNfc_Timer_Thread, NULL) != 0)
+    {
+        NXPLOG_TML_E("timer thread create failed");
+        close(tTimerService.timerFd);
+        tTimerService.timerFd = -1;
+        return NFCSTATUS_FAILED;
+    }
+    if (pthread_setname_np(tTimerService.thread, "OSAL_TIMER_TASK"))
+    {
+        NXPLOG_TML_E("pthread_setname_np failed");
+    }
+
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_Timer_HeapSet
+**
+** Description      Places a timer at a position of the heap
+**
+** Parameters       dwPos   - position in the heap
+**                  dwIndex - index of the timer in apTimerInfo
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_Timer_HeapSet(uint32_t dwPos, uint32_t dwIndex)
+{
+    tTimerService.adwHeap[dwPos] = dwIndex;
+    apTimerInfo[dwIndex].dwHeapPos = dwPos + 1;
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_Timer_HeapFix
+**
+** Description      Moves the timer at a position of the heap up or down until
+**                  the heap is ordered by deadline again
+**
+** Parameters       dwPos   - position in the heap
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_Timer_HeapFix(uint32_t dwPos)
+{
+    uint32_t *pHeap = tTimerService.adwHeap;
+    uint32_t dwIndex = pHeap[dwPos];
+    uint64_t qwDeadline = apTimerInfo[dwIndex].qwDeadline;
+    uint32_t dwChild;
+
+    while ((dwPos > 0) && (apTimerInfo[pHeap[(dwPos - 1) / 2]].qwDeadline > qwDeadline))
+    {
+        phOsalNfc_Timer_HeapSet(dwPos, pHeap[(dwPos - 1) / 2]);
+        dwPos = (dwPos - 1) / 2;
+    }
+    for (;;)
+    {
+        dwChild = 2 * dwPos + 1;
+        if (dwChild >= tTimerService.dwHeapSize)
+        {
+            break;
+        }
+        if ((dwChild + 1 < tTimerService.dwHeapSize) &&
+                (apTimerInfo[pHeap[dwChild + 1]].qwDeadline < apTimerInfo[pHeap[dwChild]].qwDeadline))
+        {
+            dwChild++;
+        }
+        if (apTimerInfo[pHeap[dwChild]].qwDeadline >= qwDeadline)
+        {
+            break;
+        }
+        phOsalNfc_Timer_HeapSet(dwPos, pHeap[dwChild]);
+        dwPos = dwChild;
+    }
+    phOsalNfc_Timer_HeapSet(dwPos, dwIndex);
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_Timer_HeapInsert
+**
+** Description      Queues a timer on its deadline
+**
+** Parameters       dwIndex - index of the timer in apTimerInfo
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_Timer_HeapInsert(uint32_t dwIndex)
+{
+    uint32_t dwPos = tTimerService.dwHeapSize++;
+
+    phOsalNfc_Timer_HeapSet(dwPos, dwIndex);
+    phOsalNfc_Timer_HeapFix(dwPos);
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_Timer_HeapRemove
+**
+** Description      Removes a timer from the heap, if queued
+**
+** Parameters       dwIndex - index of the timer in apTimerInfo
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_Timer_HeapRemove(uint32_t dwIndex)
+{
+    uint32_t dwPos = apTimerInfo[dwIndex].dwHeapPos;
+    uint32_t dwLast;
+
+    if (0 == dwPos)
+    {
+        return;
+    }
+    dwPos--;
+    apTimerInfo[dwIndex].dwHeapPos = 0;
+    dwLast = --tTimerService.dwHeapSize;
+    if (dwPos != dwLast)
+    {
+        phOsalNfc_Timer_HeapSet(dwPos, tTimerService.adwHeap[dwLast]);
+        phOsalNfc_Timer_HeapFix(dwPos);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_Timer_Rearm
+**
+** Description      Arms the timerfd for the earliest deadline, or disarms it
+**                  when no timer runs
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_Timer_Rearm(void)
+{
+    struct itimerspec its;
+    uint64_t qwDeadline;
+
+    if (tTimerService.timerFd < 0)
+    {
+        return;
+    }
+    memset(&its, 0, sizeof(its));
+    if (tTimerService.dwHeapSize > 0)
+    {
+        qwDeadline = apTimerInfo[tTimerService.adwHeap[0]].qwDeadline;
+        its.it_value.tv_sec = qwDeadline / 1000000000U;
+        its.it_value.tv_nsec = qwDeadline % 1000000000U;
+    }
+    if (timerfd_settime(tTimerService.timerFd, TFD_TIMER_ABSTIME, &its, NULL) == -1)
+    {
+        NXPLOG_TML_E("timerfd_settime errno : %x", errno);
+    }
+}
 
 /*******************************************************************************
 **
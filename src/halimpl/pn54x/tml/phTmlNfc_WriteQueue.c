@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * TML write queue, see phTmlNfc_WriteQueued.
+ */
+
+#include <phTmlNfc.h>
+#include <phTmlNfc_WriteQueue.h>
+#include <phNxpLog.h>
+#include <phNxpNciTrace.h>
+#include <phNxpNciHal_utils.h>
+
+/* Value to reset variables of TML  */
+#define PH_TMLNFC_RESET_VALUE               (0x00)
+
+/* Indicates a Initial or offset value */
+#define PH_TMLNFC_VALUE_ONE                 (0x01)
+
+/* Retries of a queued write while the PN54X wakes up from standby */
+#define PH_TMLNFC_WRITE_QUEUE_RETRY_COUNT   (5)
+
+/*
+ * Entry of the queue behind phTmlNfc_WriteQueued. The data is copied in, and
+ * the completion is posted from the entry itself so the writer thread can
+ * move on before the callback thread has run.
+ */
+typedef struct phTmlNfc_WriteQueueEntry
+{
+    uint8_t aBuffer[PH_TMLNFC_WRITE_QUEUE_MAX_LEN];
+    uint16_t wLength;
+    pphTmlNfc_TransactCompletionCb_t pThread_Callback;
+    void *pContext;
+    phTmlNfc_TransactInfo_t tTransactionInfo;
+    phLibNfc_DeferredCall_t tDeferredInfo;
+} phTmlNfc_WriteQueueEntry_t;
+
+/*
+ * Entries are filled by phTmlNfc_WriteQueued, written by the writer thread and
+ * released once their completion has run, always in that order. The counters
+ * only grow; index = counter % PH_TMLNFC_WRITE_QUEUE_DEPTH.
+ */
+typedef struct phTmlNfc_WriteQueue
+{
+    phTmlNfc_WriteQueueEntry_t aEntry[PH_TMLNFC_WRITE_QUEUE_DEPTH];
+    uint32_t dwQueued;
+    uint32_t dwWritten;
+    uint32_t dwReleased;
+    pthread_mutex_t lock;
+} phTmlNfc_WriteQueue_t;
+
+extern phTmlNfc_Context_t *gpphTmlNfc_Context;
+
+static phTmlNfc_WriteQueue_t tWriteQueue = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void phTmlNfc_WriteQueueDeferredCb(void *pParams);
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_WriteQueueReset
+**
+** Description      Drops whatever a previous session left in the write queue.
+**                  Called by phTmlNfc_Init before the writer thread starts.
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_WriteQueueReset(void)
+{
+    pthread_mutex_lock(&tWriteQueue.lock);
+    tWriteQueue.dwQueued = 0;
+    tWriteQueue.dwWritten = 0;
+    tWriteQueue.dwReleased = 0;
+    pthread_mutex_unlock(&tWriteQueue.lock);
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_WriteQueueService
+**
+** Description      Writes the oldest entry of the write queue, if any, and
+**                  posts its completion onto the callback thread. Called by
+**                  the TML writer thread.
+**                  A failed write is retried while the PN54X may still be
+**                  waking up from standby, as phNxpNciHal_write_unlocked
+**                  does for direct writes. Queued writes are never
+**                  retransmitted.
+**
+** Parameters       pDevHandle - device handle, NULL if none
+**                  pDevWrite  - device write of the TML
+**
+** Returns          TRUE if an entry was written, FALSE if the queue is empty
+**
+*******************************************************************************/
+bool_t phTmlNfc_WriteQueueService(void *pDevHandle, pphTmlNfc_WriteQueueDevWrite_t pDevWrite)
+{
+    phTmlNfc_WriteQueueEntry_t *pEntry;
+    phLibNfc_Message_t tMsg;
+    NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
+    int32_t dwNoBytesWrRd = -1;
+    uint8_t bRetry = 0;
+
+    pthread_mutex_lock(&tWriteQueue.lock);
+    if (tWriteQueue.dwWritten == tWriteQueue.dwQueued)
+    {
+        pthread_mutex_unlock(&tWriteQueue.lock);
+        return FALSE;
+    }
+    pEntry = &tWriteQueue.aEntry[tWriteQueue.dwWritten % PH_TMLNFC_WRITE_QUEUE_DEPTH];
+    pthread_mutex_unlock(&tWriteQueue.lock);
+
+    if (NULL != pDevHandle)
+    {
+        dwNoBytesWrRd = pDevWrite(pDevHandle, pEntry->aBuffer, pEntry->wLength);
+        while ((-1 == dwNoBytesWrRd) && (bRetry++ < PH_TMLNFC_WRITE_QUEUE_RETRY_COUNT))
+        {
+            NXPLOG_TML_E("PN54X - Error in queued Write - PN54X Maybe in Standby Mode - Retry");
+            /* 1ms delay to give NFCC wake up delay */
+            usleep(1000);
+            dwNoBytesWrRd = pDevWrite(pDevHandle, pEntry->aBuffer, pEntry->wLength);
+        }
+    }
+
+    if (-1 == dwNoBytesWrRd)
+    {
+        NXPLOG_TML_E("PN54X - Error in queued Write.....");
+        wStatus = PHNFCSTVAL(CID_NFC_TML, NFCSTATUS_FAILED);
+        dwNoBytesWrRd = PH_TMLNFC_RESET_VALUE;
+    }
+    else
+    {
+        phNxpNciHal_print_packet("SEND", pEntry->aBuffer, pEntry->wLength);
+        phNxpNciTrace_Record(PHNXPNCI_TRACE_DIR_TX, pEntry->aBuffer, pEntry->wLength);
+        dwNoBytesWrRd = PH_TMLNFC_VALUE_ONE;
+    }
+
+    /* Fill the Transaction info structure to be passed to Callback Function */
+    pEntry->tTransactionInfo.wStatus = wStatus;
+    pEntry->tTransactionInfo.pBuff = pEntry->aBuffer;
+    pEntry->tTransactionInfo.wLength = (uint16_t) dwNoBytesWrRd;
+
+    /* Prepare the message to be posted on the User thread */
+    pEntry->tDeferredInfo.pCallback = &phTmlNfc_WriteQueueDeferredCb;
+    pEntry->tDeferredInfo.pParameter = pEntry;
+    tMsg.eMsgType = PH_LIBNFC_DEFERREDCALL_MSG;
+    tMsg.pMsgData = &pEntry->tDeferredInfo;
+    tMsg.Size = sizeof(pEntry->tDeferredInfo);
+
+    pthread_mutex_lock(&tWriteQueue.lock);
+    tWriteQueue.dwWritten++;
+    pthread_mutex_unlock(&tWriteQueue.lock);
+
+    phTmlNfc_DeferredCall(gpphTmlNfc_Context->dwCallbackThreadId, &tMsg);
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_WriteQueued
+**
+** Description      Queues a copy of the given data block for the writer thread
+**                  and returns without waiting for the write. Queued writes
+**                  are sent in order, ahead of any phTmlNfc_Write request made
+**                  after them. Completion is notified through the callback
+**                  thread as for phTmlNfc_Write; pBuff of the transaction info
+**                  then points to the internal copy.
+**                  Meant for NCI data packets: queued writes are never
+**                  retransmitted.
+**
+** Parameters       pBuffer              - data to be sent
+**                  wLength              - length of data buffer
+**                  pTmlWriteComplete    - pointer to the function to be invoked upon completion
+**                  pContext             - context provided by upper layer
+**
+** Returns          NFC status:
+**                  NFCSTATUS_PENDING             - data is queued
+**                  NFCSTATUS_INVALID_PARAMETER   - at least one parameter is invalid
+**                  NFCSTATUS_BUSY                - the queue is full
+**
+*******************************************************************************/
+NFCSTATUS phTmlNfc_WriteQueued(const uint8_t *pBuffer, uint16_t wLength, pphTmlNfc_TransactCompletionCb_t pTmlWriteComplete, void *pContext)
+{
+    phTmlNfc_WriteQueueEntry_t *pEntry;
+
+    if (NULL == gpphTmlNfc_Context)
+    {
+        return PHNFCSTVAL(CID_NFC_TML, NFCSTATUS_NOT_INITIALISED);
+    }
+    if ((NULL == gpphTmlNfc_Context->pDevHandle) || (NULL == pBuffer) ||
+            (PH_TMLNFC_RESET_VALUE == wLength) || (PH_TMLNFC_WRITE_QUEUE_MAX_LEN < wLength) ||
+            (NULL == pTmlWriteComplete))
+    {
+        return PHNFCSTVAL(CID_NFC_TML, NFCSTATUS_INVALID_PARAMETER);
+    }
+
+    pthread_mutex_lock(&tWriteQueue.lock);
+    if ((tWriteQueue.dwQueued - tWriteQueue.dwReleased) >= PH_TMLNFC_WRITE_QUEUE_DEPTH)
+    {
+        pthread_mutex_unlock(&tWriteQueue.lock);
+        return PHNFCSTVAL(CID_NFC_TML, NFCSTATUS_BUSY);
+    }
+    pEntry = &tWriteQueue.aEntry[tWriteQueue.dwQueued % PH_TMLNFC_WRITE_QUEUE_DEPTH];
+    memcpy(pEntry->aBuffer, pBuffer, wLength);
+    pEntry->wLength = wLength;
+    pEntry->pThread_Callback = pTmlWriteComplete;
+    pEntry->pContext = pContext;
+    tWriteQueue.dwQueued++;
+    pthread_mutex_unlock(&tWriteQueue.lock);
+
+    /* Set event to invoke Writer Thread */
+    sem_post(&gpphTmlNfc_Context->txSemaphore);
+
+    return NFCSTATUS_PENDING;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_WriteQueueDeferredCb
+**
+** Description      Completion of a queued write, runs on the callback thread.
+**                  The queue entry is released once the upper layer callback
+**                  has returned.
+**
+** Parameters       pParams - queue entry
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phTmlNfc_WriteQueueDeferredCb(void *pParams)
+{
+    phTmlNfc_WriteQueueEntry_t *pEntry = (phTmlNfc_WriteQueueEntry_t *) pParams;
+
+    pEntry->pThread_Callback(pEntry->pContext, &pEntry->tTransactionInfo);
+
+    pthread_mutex_lock(&tWriteQueue.lock);
+    tWriteQueue.dwReleased++;
+    pthread_mutex_unlock(&tWriteQueue.lock);
+
+    return;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Write queue behind phTmlNfc_WriteQueued, shared by the TML
+ * implementations. The TML writer thread drains it with
+ * phTmlNfc_WriteQueueService before the single-shot write slot.
+ */
+#ifndef PHTMLNFC_WRITEQUEUE_H
+#define PHTMLNFC_WRITEQUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+************************* Include Files ****************************************
+*/
+#include <phNfcTypes.h>
+
+/*
+ * Device write of the TML implementation, phTmlNfc_i2c_write.
+ * Returns the number of bytes written, -1 on failure.
+ */
+typedef int (*pphTmlNfc_WriteQueueDevWrite_t)(void *pDevHandle, uint8_t *pBuffer, int nNbBytesToWrite);
+
+/*
+***************************Globals,Structure and Enumeration ******************
+*/
+void phTmlNfc_WriteQueueReset(void);
+bool_t phTmlNfc_WriteQueueService(void *pDevHandle, pphTmlNfc_WriteQueueDevWrite_t pDevWrite);
+
+#ifdef __cplusplus
+}
+#endif /*  C++ Compilation guard */
+#endif /* PHTMLNFC_WRITEQUEUE_H */
@@ -43,6 +43,8 @@
 #include <list>
 #include <sys/stat.h>
 #include <string.h>
+#include <sched.h>
+#include <pthread.h>
 
 #include <phNxpLog.h>
 
@@ -64,6 +66,9 @@ const char transport_config_path[] = "/etc/";
 
 const char config_timestamp_path[] = "/var/tmp/libnfc-nxp-stamp-h1";
 
+/* Serializes the loading and reset of the settings, lookups do not take it */
+static pthread_mutex_t config_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 using namespace::std;
 
 class CNxpNfcParam : public string
@@ -81,6 +86,20 @@ private:
     unsigned long   m_numValue;
 };
 
+/* Read-only hash table over the settings, rebuilt after each file is read */
+class CNxpNfcIndex
+{
+public:
+    explicit CNxpNfcIndex(const vector<const CNxpNfcParam*>& params);
+    ~CNxpNfcIndex();
+    const CNxpNfcParam* lookup(const char* p_name) const;
+private:
+    static unsigned long hash(const char* p_name);
+    size_t                  m_mask;
+    unsigned long*          m_hash;
+    const CNxpNfcParam**    m_param;
+};
+
 class CNxpNfcConfig : public vector<const CNxpNfcParam*>
 {
 public:
@@ -101,16 +120,22 @@ public:
     bool    getValue(const char* name, unsigned short & rValue) const;
     bool    getValue(const char* name, char* pValue, long len,long* readlen) const;
     const CNxpNfcParam*    find(const char* p_name) const;
+    bool    loaded() const {return __atomic_load_n(&m_index, __ATOMIC_ACQUIRE) != NULL;}
     void    clean();
+    void    beginRead() const {__atomic_add_fetch(&m_readers, 1, __ATOMIC_SEQ_CST);}
+    void    endRead() const {__atomic_sub_fetch(&m_readers, 1, __ATOMIC_RELEASE);}
 private:
     CNxpNfcConfig();
     bool    readConfig(const char* name, bool bResetContent);
     void    moveFromList();
     void    moveToList();
     void    add(const CNxpNfcParam* pParam);
+    void    publishIndex(const CNxpNfcIndex* pIndex);
     list<const CNxpNfcParam*> m_list;
     bool    mValidFile;
     unsigned long m_timeStamp;
+    const CNxpNfcIndex* m_index;
+    mutable unsigned long m_readers;
 
     unsigned long   state;
 
@@ -119,6 +144,16 @@ private:
     inline void Reset(unsigned long f) {state &= ~f;}
 };
 
+/* Marks a lookup in progress: settings are not freed until it ends */
+class CNxpNfcConfigReader
+{
+public:
+    explicit CNxpNfcConfigReader(const CNxpNfcConfig& rConfig) : m_config(rConfig) {m_config.beginRead();}
+    ~CNxpNfcConfigReader() {m_config.endRead();}
+private:
+    const CNxpNfcConfig& m_config;
+};
+
 /*******************************************************************************
 **
 ** Function:    isPrintable()
@@ -209,6 +244,7 @@ bool CNxpNfcConfig::readConfig(const char* name, bool bResetContent)
     string  strValue;
     unsigned long    numValue = 0;
     CNxpNfcParam* pParam = NULL;
+    vector<const CNxpNfcParam*> retired;
     int     i = 0;
     int     base = 0;
     char    c;
@@ -231,8 +267,9 @@ bool CNxpNfcConfig::readConfig(const char* name, bool bResetContent)
     mValidFile = true;
     if (size() > 0)
     {
+        /* Old settings stay readable until the new index is published */
         if (bResetContent)
-        clean();
+            vector<const CNxpNfcParam*>::swap(retired);
         else
             moveToList();
     }
@@ -400,6 +437,9 @@ bool CNxpNfcConfig::readConfig(const char* name, bool bResetContent)
     fclose(fd);
 
     moveFromList();
+    publishIndex(size() > 0 ? new CNxpNfcIndex(*this) : NULL);
+    for (iterator it = retired.begin(), itEnd = retired.end(); it != itEnd; ++it)
+        delete *it;
     return size() > 0;
 }
 
@@ -415,6 +455,8 @@ bool CNxpNfcConfig::readConfig(const char* name, bool bResetContent)
 CNxpNfcConfig::CNxpNfcConfig() :
     mValidFile(true),
     m_timeStamp(0),
+    m_index(NULL),
+    m_readers(0),
     state(0)
 {
 }
@@ -451,6 +493,11 @@ CNxpNfcConfig& CNxpNfcConfig::GetInstance(unsigned long cfgtype)
     string strPath;
     string cfg_name;
 
+    /* Settings already loaded: no lock on the lookup path */
+    if ((cfgtype == NXP_CFG_INIT) && theInstance.loaded())
+        return theInstance;
+
+    pthread_mutex_lock(&config_mutex);
     current_cfg = cfgtype;
 
     cfg_name.assign(config_base);
@@ -529,6 +576,7 @@ CNxpNfcConfig& CNxpNfcConfig::GetInstance(unsigned long cfgtype)
             hw_cfg_loaded = true;
         }
     }
+    pthread_mutex_unlock(&config_mutex);
 
     return theInstance;
 }
@@ -641,31 +689,25 @@ bool CNxpNfcConfig::getValue(const char* name, unsigned short& rValue) const
 *******************************************************************************/
 const CNxpNfcParam* CNxpNfcConfig::find(const char* p_name) const
 {
-    if (size() == 0)
+    const CNxpNfcIndex* pIndex = __atomic_load_n(&m_index, __ATOMIC_ACQUIRE);
+    const CNxpNfcParam* pParam;
+
+    if (pIndex == NULL)
+        return NULL;
+
+    pParam = pIndex->lookup(p_name);
+    if (pParam == NULL)
         return NULL;
 
-    for (const_iterator it = begin(), itEnd = end(); it != itEnd; ++it)
+    if(pParam->str_len() > 0)
     {
-        if (**it < p_name)
-        {
-            continue;
-        }
-        else if (**it == p_name)
-        {
-            if((*it)->str_len() > 0)
-            {
-                NXPLOG_EXTNS_D("%s found %s\n", __func__, p_name);
-            }
-            else
-            {
-                NXPLOG_EXTNS_D("%s found %s=(0x%lx)\n", __func__, p_name, (*it)->numValue());
-            }
-            return *it;
-        }
-        else
-            break;
+        NXPLOG_EXTNS_D("%s found %s\n", __func__, p_name);
     }
-    return NULL;
+    else
+    {
+        NXPLOG_EXTNS_D("%s found %s=(0x%lx)\n", __func__, p_name, pParam->numValue());
+    }
+    return pParam;
 }
 
 /*******************************************************************************
@@ -682,11 +724,31 @@ void CNxpNfcConfig::clean()
     if (size() == 0)
         return;
 
+    publishIndex(NULL);
     for (iterator it = begin(), itEnd = end(); it != itEnd; ++it)
         delete *it;
     clear();
 }
 
+/*******************************************************************************
+**
+** Function:    CNxpNfcConfig::publishIndex()
+**
+** Description: replace the index used by find() and wait for the lookups
+**              still using the previous one
+**
+** Returns:     none
+**
+*******************************************************************************/
+void CNxpNfcConfig::publishIndex(const CNxpNfcIndex* pIndex)
+{
+    const CNxpNfcIndex* pOld = __atomic_exchange_n(&m_index, pIndex, __ATOMIC_SEQ_CST);
+
+    while (__atomic_load_n(&m_readers, __ATOMIC_SEQ_CST) != 0)
+        sched_yield();
+    delete pOld;
+}
+
 /*******************************************************************************
 **
 ** Function:    CNfcConfig::Add()
@@ -881,6 +943,97 @@ int CNxpNfcConfig::updateTimestamp()
     return ret;
 }
 
+/*******************************************************************************
+**
+** Function:    CNxpNfcIndex::CNxpNfcIndex()
+**
+** Description: class constructor, hash the settings in open addressing
+**              table at most half full. The first of two settings with the
+**              same name wins, as in the sorted array.
+**
+** Returns:     none
+**
+*******************************************************************************/
+CNxpNfcIndex::CNxpNfcIndex(const vector<const CNxpNfcParam*>& params)
+{
+    size_t size = 16;
+
+    while (size < 2 * params.size())
+        size <<= 1;
+    m_mask = size - 1;
+    m_hash = new unsigned long[size];
+    m_param = new const CNxpNfcParam*[size];
+    memset(m_param, 0, size * sizeof(m_param[0]));
+
+    for (size_t n = 0; n < params.size(); ++n)
+    {
+        unsigned long h = hash(params[n]->c_str());
+        size_t i = h & m_mask;
+
+        while (m_param[i] != NULL && !(m_hash[i] == h && *m_param[i] == *params[n]))
+            i = (i + 1) & m_mask;
+        if (m_param[i] == NULL)
+        {
+            m_hash[i] = h;
+            m_param[i] = params[n];
+        }
+    }
+}
+
+/*******************************************************************************
+**
+** Function:    CNxpNfcIndex::~CNxpNfcIndex()
+**
+** Description: class destructor, the settings are owned by CNxpNfcConfig
+**
+** Returns:     none
+**
+*******************************************************************************/
+CNxpNfcIndex::~CNxpNfcIndex()
+{
+    delete[] m_hash;
+    delete[] m_param;
+}
+
+/*******************************************************************************
+**
+** Function:    CNxpNfcIndex::hash()
+**
+** Description: FNV-1a hash of a setting name
+**
+** Returns:     hash value
+**
+*******************************************************************************/
+unsigned long CNxpNfcIndex::hash(const char* p_name)
+{
+    unsigned long h = 2166136261UL;
+
+    while (*p_name)
+        h = ((h ^ (unsigned char)*p_name++) * 16777619UL) & 0xFFFFFFFFUL;
+    return h;
+}
+
+/*******************************************************************************
+**
+** Function:    CNxpNfcIndex::lookup()
+**
+** Description: search a setting by name
+**
+** Returns:     pointer to the setting object, NULL if not found
+**
+*******************************************************************************/
+const CNxpNfcParam* CNxpNfcIndex::lookup(const char* p_name) const
+{
+    unsigned long h = hash(p_name);
+
+    for (size_t i = h & m_mask; m_param[i] != NULL; i = (i + 1) & m_mask)
+    {
+        if (m_hash[i] == h && *m_param[i] == p_name)
+            return m_param[i];
+    }
+    return NULL;
+}
+
 /*******************************************************************************
 **
 ** Function:    CNxpNfcParam::CNxpNfcParam()
@@ -951,6 +1104,7 @@ CNxpNfcParam::CNxpNfcParam(const char* name,  unsigned long value) :
 extern "C" int GetNxpStrValue(const char* name, char* pValue, unsigned long len)
 {
     CNxpNfcConfig& rConfig = CNxpNfcConfig::GetInstance();
+    CNxpNfcConfigReader reader(rConfig);
     bool val_status = rConfig.getValue(name, pValue, len);
     NXPLOG_EXTNS_D("%s: NXP Config Parameter : %s\n", __FUNCTION__, name);
     return val_status;
@@ -975,6 +1129,7 @@ extern "C" int GetNxpStrValue(const char* name, char* pValue, unsigned long len)
 extern "C" int GetNxpByteArrayValue(const char* name, char* pValue,long bufflen, long *len)
 {
     CNxpNfcConfig& rConfig = CNxpNfcConfig::GetInstance();
+    CNxpNfcConfigReader reader(rConfig);
     bool val_status = rConfig.getValue(name, pValue, bufflen,len);
     NXPLOG_EXTNS_D("%s: NXP Config Parameter : %s\n", __FUNCTION__, name);
     return val_status;
@@ -995,6 +1150,7 @@ extern "C" int GetNxpNumValue(const char* name, void* pValue, unsigned long len)
         return false;
 
     CNxpNfcConfig& rConfig = CNxpNfcConfig::GetInstance();
+    CNxpNfcConfigReader reader(rConfig);
     const CNxpNfcParam* pParam = rConfig.find(name);
 
     if (pParam == NULL)
@@ -1043,7 +1199,9 @@ extern "C" void resetNxpConfig()
 {
     CNxpNfcConfig& rConfig = CNxpNfcConfig::GetInstance();
 
+    pthread_mutex_lock(&config_mutex);
     rConfig.clean();
+    pthread_mutex_unlock(&config_mutex);
 }
 
 /*******************************************************************************
@@ -1112,5 +1270,5 @@ extern "C" int updateNxpConfigTimestamp()
 extern "C" int isNxpConfigValid(unsigned long type)
 {
     CNxpNfcConfig& rConfig = CNxpNfcConfig::GetInstance(type);
-    return (rConfig.size() != 0);
+    return rConfig.loaded();
 }
@@ -67,10 +67,17 @@ int isNxpConfigValid(unsigned long type);
 #define NAME_NXPLOG_NCIR_LOGLEVEL              "NXPLOG_NCIR_LOGLEVEL"
 #define NAME_NXPLOG_FWDNLD_LOGLEVEL            "NXPLOG_FWDNLD_LOGLEVEL"
 #define NAME_NXPLOG_TML_LOGLEVEL               "NXPLOG_TML_LOGLEVEL"
+#define NAME_NXP_NCI_TRACE_FILE                "NXP_NCI_TRACE_FILE"
+#define NAME_NXP_NCI_TRACE_SLOTS               "NXP_NCI_TRACE_SLOTS"
+#define NAME_NXP_NCI_TRACE_DUMP_SIGNAL         "NXP_NCI_TRACE_DUMP_SIGNAL"
 
 #define NAME_MIFARE_READER_ENABLE              "MIFARE_READER_ENABLE"
 #define NAME_NXP_NFC_CHIP                      "NXP_NFC_CHIP"
 #define NAME_NXP_NFC_DEV_NODE                  "NXP_NFC_DEV_NODE"
+#define NAME_NXP_MOCK_NFCC_SCENARIO            "NXP_MOCK_NFCC_SCENARIO"
+#define NAME_NXP_VEN_RESET_MODE                "NXP_VEN_RESET_MODE"
+#define NAME_NXP_VEN_LOW_TIME                  "NXP_VEN_LOW_TIME"
+#define NAME_NXP_VEN_BOOT_TIMEOUT              "NXP_VEN_BOOT_TIMEOUT"
 #define NAME_NXP_FW_PATH                       "NXP_NFC_FW_PATH"
 #define NAME_NXP_FW_NAME                       "NXP_NFC_FW_NAME"
 #define NAME_NXP_FW_PROTECION_OVERRIDE         "NXP_FW_PROTECION_OVERRIDE"
@@ -92,6 +99,7 @@ int isNxpConfigValid(unsigned long type);
 #define NAME_NXP_CORE_CONF                     "NXP_CORE_CONF"
 #define NAME_NXP_CORE_MFCKEY_SETTING           "NXP_CORE_MFCKEY_SETTING"
 #define NAME_NXP_CORE_STANDBY                  "NXP_CORE_STANDBY"
+#define NAME_NXP_SET_CONFIG_CACHE              "NXP_SET_CONFIG_CACHE"
 #define NAME_NXP_NFC_PROFILE_EXTN              "NXP_NFC_PROFILE_EXTN"
 #define NAME_NXP_CHINA_TIANJIN_RF_ENABLED      "NXP_CHINA_TIANJIN_RF_ENABLED"
 #define NAME_NXP_SWP_SWITCH_TIMEOUT            "NXP_SWP_SWITCH_TIMEOUT"
@@ -99,6 +107,7 @@ int isNxpConfigValid(unsigned long type);
 #define NAME_NXP_CORE_RF_FIELD                 "NXP_CORE_RF_FIELD"
 #define NAME_NXP_NFC_MERGE_RF_PARAMS           "NXP_NFC_MERGE_RF_PARAMS"
 #define NAME_NXP_I2C_FRAGMENTATION_ENABLED     "NXP_I2C_FRAGMENTATION_ENABLED"
+#define NAME_NXP_ASYNC_DATA_WRITE              "NXP_ASYNC_DATA_WRITE"
 #define NAME_NXP_NFC_PROPRIETARY_CFG           "NXP_NFC_PROPRIETARY_CFG"
 #define NAME_NXP_NFC_MAX_EE_SUPPORTED          "NXP_NFC_MAX_EE_SUPPORTED"
 #define NAME_AID_MATCHING_PLATFORM             "AID_MATCHING_PLATFORM"
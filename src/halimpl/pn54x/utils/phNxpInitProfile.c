@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <time.h>
+#include <phNxpInitProfile.h>
+
+typedef struct phNxpInitProfile_Control
+{
+    uint64_t origin_us;     /* CLOCK_MONOTONIC at phNxpInitProfile_Reset */
+    uint32_t count;         /* phases started, may exceed the table */
+    phNxpInitProfile_Phase_t phase[PHNXP_INIT_PROFILE_MAX];
+} phNxpInitProfile_Control_t;
+
+static phNxpInitProfile_Control_t init_profile;
+
+/*******************************************************************************
+**
+** Function         phNxpInitProfile_now
+**
+** Description      Current CLOCK_MONOTONIC time in microseconds
+**
+** Returns          time in us
+**
+*******************************************************************************/
+static uint64_t phNxpInitProfile_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpInitProfile_Reset
+**
+** Description      Drops the recorded phases and restarts the time base.
+**                  Called when an initialization of the stack starts.
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpInitProfile_Reset(void)
+{
+    uint32_t i;
+
+    __atomic_store_n(&init_profile.count, 0, __ATOMIC_RELAXED);
+    for (i = 0; i < PHNXP_INIT_PROFILE_MAX; i++)
+    {
+        __atomic_store_n(&init_profile.phase[i].name, NULL, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&init_profile.origin_us, phNxpInitProfile_now(), __ATOMIC_RELEASE);
+}
+
+/*******************************************************************************
+**
+** Function         phNxpInitProfile_Begin
+**
+** Description      Records the start of a phase
+**
+** Parameters       name - static name of the phase
+**
+** Returns          phase handle for phNxpInitProfile_End, -1 if the table
+**                  is full
+**
+*******************************************************************************/
+int phNxpInitProfile_Begin(const char *name)
+{
+    uint64_t origin = __atomic_load_n(&init_profile.origin_us, __ATOMIC_ACQUIRE);
+    uint32_t slot = __atomic_fetch_add(&init_profile.count, 1, __ATOMIC_RELAXED);
+    phNxpInitProfile_Phase_t *p;
+
+    if (slot >= PHNXP_INIT_PROFILE_MAX)
+    {
+        return -1;
+    }
+    p = &init_profile.phase[slot];
+    p->start_us = (uint32_t)(phNxpInitProfile_now() - origin);
+    __atomic_store_n(&p->duration_us, 0, __ATOMIC_RELAXED);
+    /* the name publishes the entry to phNxpInitProfile_Get */
+    __atomic_store_n(&p->name, name, __ATOMIC_RELEASE);
+    return (int)slot;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpInitProfile_End
+**
+** Description      Records the end of a phase
+**
+** Parameters       phase - handle returned by phNxpInitProfile_Begin
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpInitProfile_End(int phase)
+{
+    uint64_t origin = __atomic_load_n(&init_profile.origin_us, __ATOMIC_ACQUIRE);
+    phNxpInitProfile_Phase_t *p;
+    uint64_t end;
+
+    if ((phase < 0) || (phase >= PHNXP_INIT_PROFILE_MAX))
+    {
+        return;
+    }
+    p = &init_profile.phase[phase];
+    end = phNxpInitProfile_now() - origin;
+    __atomic_store_n(&p->duration_us, (uint32_t)(end - p->start_us), __ATOMIC_RELEASE);
+}
+
+/*******************************************************************************
+**
+** Function         phNxpInitProfile_Get
+**
+** Description      Copies the recorded phases, in the order they started
+**
+** Parameters       pPhases - array receiving the phases
+**                  max     - size of pPhases
+**
+** Returns          number of phases copied
+**
+*******************************************************************************/
+int phNxpInitProfile_Get(phNxpInitProfile_Phase_t *pPhases, int max)
+{
+    uint32_t count = __atomic_load_n(&init_profile.count, __ATOMIC_RELAXED);
+    uint32_t i;
+    int n = 0;
+
+    if ((pPhases == NULL) || (max <= 0))
+    {
+        return 0;
+    }
+    if (count > PHNXP_INIT_PROFILE_MAX)
+    {
+        count = PHNXP_INIT_PROFILE_MAX;
+    }
+    for (i = 0; (i < count) && (n < max); i++)
+    {
+        const phNxpInitProfile_Phase_t *p = &init_profile.phase[i];
+        const char *name = __atomic_load_n(&p->name, __ATOMIC_ACQUIRE);
+
+        /* slot taken but not filled in yet */
+        if (name == NULL)
+        {
+            continue;
+        }
+        pPhases[n].name = name;
+        pPhases[n].start_us = p->start_us;
+        pPhases[n].duration_us = __atomic_load_n(&p->duration_us, __ATOMIC_ACQUIRE);
+        n++;
+    }
+    return n;
+}
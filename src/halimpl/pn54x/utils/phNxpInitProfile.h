@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _PHNXPINITPROFILE_H_
+#define _PHNXPINITPROFILE_H_
+
+#include <stdint.h>
+
+/*
+ * Startup time profile of the NFC stack.
+ *
+ * Each phase of nfcManager_doInitialize() records its start, relative to the
+ * beginning of the initialization, and its duration in microseconds. Phases
+ * may run on any thread and may overlap; they are kept in the order they
+ * started. Recording is lock free and a phase that did not end yet reports a
+ * duration of 0.
+ */
+
+#define PHNXP_INIT_PROFILE_MAX      32
+
+typedef struct phNxpInitProfile_Phase
+{
+    const char *name;       /* static string */
+    uint32_t start_us;
+    uint32_t duration_us;
+} phNxpInitProfile_Phase_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void phNxpInitProfile_Reset(void);
+int phNxpInitProfile_Begin(const char *name);
+void phNxpInitProfile_End(int phase);
+int phNxpInitProfile_Get(phNxpInitProfile_Phase_t *pPhases, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PHNXPINITPROFILE_H_ */
@@ -486,18 +486,34 @@ void phNxpNciHal_releaseall_cb_data(void)
 void phNxpNciHal_print_packet(const char *pString, const uint8_t *p_data,
         uint16_t len)
 {
-    uint32_t i, j;
-    char print_buffer[len * 3 + 1];
+    uint8_t log_level;
 
-    memset (print_buffer, 0, sizeof(print_buffer));
-    for (i = 0; i < len; i++) {
-        snprintf(&print_buffer[i * 2], 3, "%02X", p_data[i]);
+    /* Only pay for the hex conversion when the line is actually printed */
+    if (0 == memcmp(pString, "SEND", 0x04))
+    {
+        log_level = gLog_level.ncix_log_level;
+    }
+    else if (0 == memcmp(pString, "RECV", 0x04))
+    {
+        log_level = gLog_level.ncir_log_level;
+    }
+    else
+    {
+        return;
     }
-    if( 0 == memcmp(pString,"SEND",0x04))
+    if (log_level < NXPLOG_LOG_DEBUG_LOGLEVEL)
+    {
+        return;
+    }
+
+    char print_buffer[len * 2 + 1];
+
+    phNxpLog_HexEncode(print_buffer, p_data, len, FALSE);
+    if (pString[0] == 'S')
     {
         NXPLOG_NCIX_D("len = %3d > %s", len, print_buffer);
     }
-    else if( 0 == memcmp(pString,"RECV",0x04))
+    else
     {
         NXPLOG_NCIR_D("len = %3d > %s", len, print_buffer);
     }
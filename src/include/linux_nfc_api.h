@@ -452,6 +452,24 @@ typedef struct {
    void (*onHandoverSelectReceived)(unsigned char *msg, unsigned int length);
 }nfcHandoverCallback_t;
 
+/**
+ *  \brief Phase of the NFC stack initialization, see nfcManager_getInitProfile().
+ */
+typedef struct {
+    /**
+     * \brief Name of the phase.
+     */
+    const char *name;
+    /**
+     * \brief Start of the phase, in microseconds since nfcManager_doInitialize() was called.
+     */
+    unsigned int start_us;
+    /**
+     * \brief Duration of the phase in microseconds, 0 if it did not end.
+     */
+    unsigned int duration_us;
+}nfcInitPhase_t;
+
 /**
 * \brief read text message from NDEF data.
 * \param ndef_buff:  the buffer with ndef message
@@ -686,6 +704,24 @@ extern int nfcManager_getNumTags(void);
 */
 extern int nfcManager_getFwVersion();
 
+/**
+* \brief Return the duration of each phase of the last nfcManager_doInitialize().\n
+*        Phases are listed in the order they started and may overlap.
+* \param phases:  array to fill with the phases.
+* \param max_phases:  size of phases array.
+* \return number of phases filled in.
+*/
+extern int nfcManager_getInitProfile(nfcInitPhase_t *phases, int max_phases);
+
+/**
+* \brief Write a snapshot of the binary NCI packet trace to a file.\n
+*        The trace is only kept when NXP_NCI_TRACE_FILE is set in libnfc-nxp-init.conf.
+*        The file can be read with nfcTraceDecode.
+* \param path:  file to write, replaced if it exists.
+* \return 0 if success, -1 if tracing is disabled or the file cannot be written.
+*/
+extern int nfcManager_dumpNciTrace(const char *path);
+
 /**
 * \brief Register a callback functions for snep client.
 * \param client_callback:  snep client callback functions.
@@ -50,15 +50,17 @@ extern "C"
     #include "phNxpNciHal.h"
     #include "phNxpNciHal_Adaptation.h"
     #include "phNxpLog.h"
+    #include "phNxpNciTrace.h"
     #include "phNxpConfig.h"
+    #include "phNxpInitProfile.h"
 }
 
 #define LOG_TAG "NfcAdaptation"
 
 extern "C" void GKI_shutdown();
 extern void resetConfig();
-extern "C" void verify_stack_non_volatile_store ();
-extern "C" void delete_stack_non_volatile_store (BOOLEAN forceDelete);
+extern "C" void start_stack_non_volatile_store_check (BOOLEAN preserve);
+extern "C" void wait_stack_non_volatile_store_check ();
 
 
 
@@ -66,6 +68,8 @@ NfcAdaptation* NfcAdaptation::mpInstance = NULL;
 ThreadMutex NfcAdaptation::sLock;
 tHAL_NFC_CBACK* NfcAdaptation::mHalCallback = NULL;
 tHAL_NFC_DATA_CBACK* NfcAdaptation::mHalDataCallback = NULL;
+tHAL_NFC_RX_BUF_ALLOC* NfcAdaptation::mHalRxBufAlloc = NULL;
+tHAL_NFC_RX_BUF_CBACK* NfcAdaptation::mHalRxBufCallback = NULL;
 ThreadCondVar NfcAdaptation::mHalOpenCompletedEvent;
 ThreadCondVar NfcAdaptation::mHalCloseCompletedEvent;
 #if (NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
@@ -152,6 +156,7 @@ void NfcAdaptation::Initialize ()
     const char* func = "NfcAdaptation::Initialize";
     NXPLOG_API_D("%s: enter", func);
     unsigned long num;
+    int phase;
 
     if ( GetNumValue ( NAME_USE_RAW_NCI_TRACE, &num, sizeof ( num ) ) )
     {
@@ -187,17 +192,19 @@ void NfcAdaptation::Initialize ()
 
     initializeGlobalAppLogLevel ();
 
-    verify_stack_non_volatile_store ();
+    // the NV store is first needed by NFA_Enable, well after the NFCC reset
     if ( GetNumValue ( NAME_PRESERVE_STORAGE, (char*)&num, sizeof ( num ) ) &&
             (num == 1) )
     {
         NXPLOG_API_D ("%s: preserve stack NV store", __FUNCTION__);
+        start_stack_non_volatile_store_check (TRUE);
     }
     else
     {
-        delete_stack_non_volatile_store (FALSE);
+        start_stack_non_volatile_store_check (FALSE);
     }
 
+    phase = phNxpInitProfile_Begin ("gki_tasks");
     GKI_init ();
     GKI_enable ();
     GKI_create_task ((TASKPTR)NFCA_TASK, BTU_TASK, (INT8*)"NFCA_TASK", 0, 0, (pthread_cond_t*)NULL, NULL);
@@ -206,6 +213,7 @@ void NfcAdaptation::Initialize ()
         GKI_create_task ((TASKPTR)Thread, MMI_TASK, (INT8*)"NFCA_THREAD", 0, 0, (pthread_cond_t*)NULL, NULL);
         mCondVar.wait();
     }
+    phNxpInitProfile_End (phase);
 
     memset (&mHalEntryFuncs, 0, sizeof(mHalEntryFuncs));
     InitializeHalDeviceContext ();
@@ -262,6 +270,7 @@ void NfcAdaptation::Finalize()
 
     NXPLOG_API_D ("%s: enter", func);
     GKI_shutdown ();
+    wait_stack_non_volatile_store_check ();
 
     resetConfig();
 
@@ -374,6 +383,8 @@ void NfcAdaptation::InitializeHalDeviceContext ()
     mHalEntryFuncs.control_granted = HalControlGranted;
     mHalEntryFuncs.power_cycle = HalPowerCycle;
     mHalEntryFuncs.get_max_ee = HalGetMaxNfcee;
+    mHalEntryFuncs.set_rx_buf_cbacks = HalSetRxBufCallbacks;
+    mHalEntryFuncs.write_v = HalWriteV;
     NXPLOG_API_D ("%s: exit", func);
 }
 
@@ -424,7 +435,9 @@ void NfcAdaptation::HalOpen (tHAL_NFC_CBACK *p_hal_cback, tHAL_NFC_DATA_CBACK* p
     NXPLOG_API_D ("%s", func);
     mHalCallback = p_hal_cback;
     mHalDataCallback = p_data_cback;
+    int phase = phNxpInitProfile_Begin ("hal_open");
     phNxpNciHal_open (HalDeviceContextCallback, HalDeviceContextDataCallback);
+    phNxpInitProfile_End (phase);
 }
 
 /*******************************************************************************
@@ -498,10 +511,33 @@ void NfcAdaptation::HalWrite (UINT16 data_len, UINT8* p_data)
 #if (NFC_SERVICE_DATA_DEBUG == 0x01)
     phNxpLog_LogBuffer (gLog_level.global_log_level, "\tSend", p_data , data_len);
 #endif
+    phNxpNciTrace_Record (PHNXPNCI_TRACE_DIR_STACK_TX, p_data, data_len);
 
     phNxpNciHal_write (data_len, p_data);
 }
 
+/*******************************************************************************
+**
+** Function:    NfcAdaptation::HalWriteV
+**
+** Description: Write NCI message, given as header and payload, to the controller.
+**
+** Returns:     None.
+**
+*******************************************************************************/
+void NfcAdaptation::HalWriteV (UINT16 hdr_len, UINT8* p_hdr, UINT16 data_len, UINT8* p_data)
+{
+    const char* func = "NfcAdaptation::HalWriteV";
+    NXPLOG_API_D ("%s", func);
+#if (NFC_SERVICE_DATA_DEBUG == 0x01)
+    phNxpLog_LogBuffer (gLog_level.global_log_level, "\tSend", p_hdr , hdr_len);
+    phNxpLog_LogBuffer (gLog_level.global_log_level, "\tSend", p_data , data_len);
+#endif
+    phNxpNciTrace_RecordV (PHNXPNCI_TRACE_DIR_STACK_TX, p_hdr, hdr_len, p_data, data_len);
+
+    phNxpNciHal_write_v (hdr_len, p_hdr, data_len, p_data);
+}
+
 /*******************************************************************************
 **
 ** Function:    NfcAdaptation::HalCoreInitialized
@@ -515,7 +551,9 @@ void NfcAdaptation::HalCoreInitialized (UINT8* p_core_init_rsp_params)
 {
     const char* func = "NfcAdaptation::HalCoreInitialized";
     NXPLOG_API_D ("%s", func);
+    int phase = phNxpInitProfile_Begin ("hal_core_initialized");
     phNxpNciHal_core_initialized (p_core_init_rsp_params);
+    phNxpInitProfile_End (phase);
 }
 
 /*******************************************************************************
@@ -593,6 +631,24 @@ UINT8 NfcAdaptation::HalGetMaxNfcee()
     return nfa_ee_max_ee_cfg;
 }
 
+/*******************************************************************************
+**
+** Function:    NfcAdaptation::HalSetRxBufCallbacks
+**
+** Description: Let the HAL read received packets into stack buffers.
+**
+** Returns:     None.
+**
+*******************************************************************************/
+void NfcAdaptation::HalSetRxBufCallbacks (tHAL_NFC_RX_BUF_ALLOC* p_alloc, tHAL_NFC_RX_BUF_CBACK* p_cback)
+{
+    const char* func = "NfcAdaptation::HalSetRxBufCallbacks";
+    NXPLOG_API_D ("%s", func);
+    mHalRxBufAlloc = p_alloc;
+    mHalRxBufCallback = p_cback;
+    phNxpNciHal_set_rx_buf_cbacks (p_alloc, p_cback);
+}
+
 
 /*******************************************************************************
 **
@@ -616,6 +672,8 @@ void NfcAdaptation::DownloadFirmware ()
 #endif
     HalInitialize ();
 
+    /* packets are for HalDownloadFirmwareDataCallback, not the stack */
+    phNxpNciHal_set_rx_buf_cbacks (NULL, NULL);
     mHalOpenCompletedEvent.lock ();
     NXPLOG_API_D ("%s: try open HAL", func);
     HalOpen (HalDownloadFirmwareCallback, HalDownloadFirmwareDataCallback);
@@ -643,6 +701,7 @@ void NfcAdaptation::DownloadFirmware ()
     NXPLOG_API_D ("%s: try close HAL", func);
     HalClose ();
     mHalCloseCompletedEvent.wait ();
+    phNxpNciHal_set_rx_buf_cbacks (mHalRxBufAlloc, mHalRxBufCallback);
 
     HalTerminate ();
     NXPLOG_API_D ("%s: exit", func);
@@ -52,7 +52,6 @@ extern UINT32 ScrProtocolTraceFlag;
 #define PRINT(s) printf (s)
 #define UNUSED(X) (void)X
 static char log_line [MAX_LOGCAT_LINE];
-static const char* sTable = "0123456789abcdef";
 static BOOLEAN sIsUseRaw = FALSE;
 static void ToHex (const UINT8* data, UINT16 len, char* hexString, UINT16 hexStringSize);
 static void dumpbin (const char* data, int size, UINT32 trace_layer, UINT32 trace_type);
@@ -92,6 +91,8 @@ void ProtoDispAdapterDisplayNciPacket (UINT8 *nciPacket, UINT16 nciPacketLen, BO
     //Protocol decoder is not available, so decode NCI packet into hex numbers.
     if (!(ScrProtocolTraceFlag & SCR_PROTO_TRACE_NCI))
         return;
+    if (((is_recv) ? gLog_level.ncir_log_level : gLog_level.ncix_log_level) < NXPLOG_LOG_DEBUG_LOGLEVEL)
+        return;
     char line_buf [(MAX_NCI_PACKET_SIZE*2)+1];
     ToHex (nciPacket, nciPacketLen, line_buf, sizeof(line_buf));
     phNxpLog_LogMsg(NXPLOG_LOG_DEBUG_LOGLEVEL, (is_recv) ? "NfcNciR:": "NfcNciX:", line_buf);
@@ -100,14 +101,9 @@ void ProtoDispAdapterDisplayNciPacket (UINT8 *nciPacket, UINT16 nciPacketLen, BO
 
 void ToHex (const UINT8* data, UINT16 len, char* hexString, UINT16 hexStringSize)
 {
-    int i=0, j=0;
-    for(i = 0, j = 0; i < len && j < hexStringSize-3; i++)
-    {
-        hexString [j++] = sTable [(*data >> 4) & 0xf];
-        hexString [j++] = sTable [*data & 0xf];
-        data++;
-    }
-    hexString [j] = '\0';
+    if (len > (hexStringSize - 1) / 2)
+        len = (hexStringSize - 1) / 2;
+    phNxpLog_HexEncode (hexString, data, len, TRUE);
 }
 
 
@@ -213,10 +209,8 @@ inline void byte2char (const char* data, char** str)
 
 inline void byte2hex (const char* data, char** str)
 {
-    **str = sTable[(*data >> 4) & 0xf];
-    ++*str;
-    **str = sTable[*data & 0xf];
-    ++*str;
+    phNxpLog_HexEncode (*str, (const UINT8*) data, 1, TRUE);
+    *str += 2;
 }
 
 
@@ -38,6 +38,8 @@
 #include "nci_config.h"
 #include <stdio.h>
 #include <string.h>
+#include <sched.h>
+#include <pthread.h>
 #include <string>
 #include <vector>
 #include <list>
@@ -53,6 +55,9 @@ const char transport_config_path[] = "/etc/";
 #define extra_config_ext        ".conf"
 #define     IsStringValue       0x80000000
 
+/* Serializes the loading and reset of the settings, lookups do not take it */
+static pthread_mutex_t config_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 using namespace::std;
 
 class CNfcParam : public string
@@ -70,6 +75,20 @@ private:
     unsigned long   m_numValue;
 };
 
+/* Read-only hash table over the settings, rebuilt after each file is read */
+class CNfcIndex
+{
+public:
+    explicit CNfcIndex(const vector<const CNfcParam*>& params);
+    ~CNfcIndex();
+    const CNfcParam* lookup(const char* p_name) const;
+private:
+    static unsigned long hash(const char* p_name);
+    size_t              m_mask;
+    unsigned long*      m_hash;
+    const CNfcParam**   m_param;
+};
+
 class CNfcConfig : public vector<const CNfcParam*>
 {
 public:
@@ -81,15 +100,21 @@ public:
     bool    getValue(const char* name, unsigned long& rValue) const;
     bool    getValue(const char* name, unsigned short & rValue) const;
     const CNfcParam*    find(const char* p_name) const;
+    bool    loaded() const {return __atomic_load_n(&m_index, __ATOMIC_ACQUIRE) != NULL;}
     void    clean();
+    void    beginRead() const {__atomic_add_fetch(&m_readers, 1, __ATOMIC_SEQ_CST);}
+    void    endRead() const {__atomic_sub_fetch(&m_readers, 1, __ATOMIC_RELEASE);}
 private:
     CNfcConfig();
     bool    readConfig(const char* name, bool bResetContent);
     void    moveFromList();
     void    moveToList();
     void    add(const CNfcParam* pParam);
+    void    publishIndex(const CNfcIndex* pIndex);
     list<const CNfcParam*> m_list;
     bool    mValidFile;
+    const CNfcIndex* m_index;
+    mutable unsigned long m_readers;
 
     unsigned long   state;
 
@@ -98,6 +123,16 @@ private:
     inline void Reset(unsigned long f) {state &= ~f;}
 };
 
+/* Marks a lookup in progress: settings are not freed until it ends */
+class CNfcConfigReader
+{
+public:
+    explicit CNfcConfigReader(const CNfcConfig& rConfig) : m_config(rConfig) {m_config.beginRead();}
+    ~CNfcConfigReader() {m_config.endRead();}
+private:
+    const CNfcConfig& m_config;
+};
+
 /*******************************************************************************
 **
 ** Function:    isPrintable()
@@ -187,6 +222,7 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
     string  strValue;
     unsigned long    numValue = 0;
     CNfcParam* pParam = NULL;
+    vector<const CNfcParam*> retired;
     int     i = 0;
     int     base = 0;
     char    c = 0;
@@ -208,8 +244,9 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
     mValidFile = true;
     if (size() > 0)
     {
+        /* Old settings stay readable until the new index is published */
         if (bResetContent)
-        clean();
+            vector<const CNfcParam*>::swap(retired);
         else
             moveToList();
     }
@@ -369,6 +406,9 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
     fclose(fd);
 
     moveFromList();
+    publishIndex(size() > 0 ? new CNfcIndex(*this) : NULL);
+    for (iterator it = retired.begin(), itEnd = retired.end(); it != itEnd; ++it)
+        delete *it;
     return size() > 0;
 }
 
@@ -383,6 +423,8 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
 *******************************************************************************/
 CNfcConfig::CNfcConfig() :
     mValidFile(true),
+    m_index(NULL),
+    m_readers(0),
     state(0)
 {
 }
@@ -415,8 +457,13 @@ CNfcConfig& CNfcConfig::GetInstance()
     string strPath;
     string cfg_name;
 
+    /* Settings already loaded: no lock on the lookup path */
+    if (theInstance.loaded())
+        return theInstance;
+
     cfg_name.assign(config_name);
 
+    pthread_mutex_lock(&config_mutex);
     if (theInstance.size() == 0 && theInstance.mValidFile)
     {
         if (alternative_config_path[0] != '\0')
@@ -441,6 +488,7 @@ CNfcConfig& CNfcConfig::GetInstance()
             theInstance.readConfig(strPath.c_str(), true);
         }
     }
+    pthread_mutex_unlock(&config_mutex);
 
     return theInstance;
 }
@@ -531,27 +579,12 @@ bool CNfcConfig::getValue(const char* name, unsigned short& rValue) const
 *******************************************************************************/
 const CNfcParam* CNfcConfig::find(const char* p_name) const
 {
-    if (size() == 0)
+    const CNfcIndex* pIndex = __atomic_load_n(&m_index, __ATOMIC_ACQUIRE);
+
+    if (pIndex == NULL)
         return NULL;
 
-    for (const_iterator it = begin(), itEnd = end(); it != itEnd; ++it)
-    {
-        if (**it < p_name)
-            continue;
-        else if (**it == p_name)
-        {
-            if((*it)->str_len() > 0)
-                //ALOGD("%s found %s=%s\n", __func__, p_name, (*it)->str_value());
-                ;
-            else
-                //ALOGD("%s found %s=(0x%lX)\n", __func__, p_name, (*it)->numValue());
-                ;
-            return *it;
-        }
-        else
-            break;
-    }
-    return NULL;
+    return pIndex->lookup(p_name);
 }
 
 /*******************************************************************************
@@ -568,11 +601,31 @@ void CNfcConfig::clean()
     if (size() == 0)
         return;
 
+    publishIndex(NULL);
     for (iterator it = begin(), itEnd = end(); it != itEnd; ++it)
         delete *it;
     clear();
 }
 
+/*******************************************************************************
+**
+** Function:    CNfcConfig::publishIndex()
+**
+** Description: replace the index used by find() and wait for the lookups
+**              still using the previous one
+**
+** Returns:     none
+**
+*******************************************************************************/
+void CNfcConfig::publishIndex(const CNfcIndex* pIndex)
+{
+    const CNfcIndex* pOld = __atomic_exchange_n(&m_index, pIndex, __ATOMIC_SEQ_CST);
+
+    while (__atomic_load_n(&m_readers, __ATOMIC_SEQ_CST) != 0)
+        sched_yield();
+    delete pOld;
+}
+
 /*******************************************************************************
 **
 ** Function:    CNfcConfig::Add()
@@ -637,6 +690,97 @@ void CNfcConfig::moveToList()
     clear();
 }
 
+/*******************************************************************************
+**
+** Function:    CNfcIndex::CNfcIndex()
+**
+** Description: class constructor, hash the settings in open addressing
+**              table at most half full. The first of two settings with the
+**              same name wins, as in the sorted array.
+**
+** Returns:     none
+**
+*******************************************************************************/
+CNfcIndex::CNfcIndex(const vector<const CNfcParam*>& params)
+{
+    size_t size = 16;
+
+    while (size < 2 * params.size())
+        size <<= 1;
+    m_mask = size - 1;
+    m_hash = new unsigned long[size];
+    m_param = new const CNfcParam*[size];
+    memset(m_param, 0, size * sizeof(m_param[0]));
+
+    for (size_t n = 0; n < params.size(); ++n)
+    {
+        unsigned long h = hash(params[n]->c_str());
+        size_t i = h & m_mask;
+
+        while (m_param[i] != NULL && !(m_hash[i] == h && *m_param[i] == *params[n]))
+            i = (i + 1) & m_mask;
+        if (m_param[i] == NULL)
+        {
+            m_hash[i] = h;
+            m_param[i] = params[n];
+        }
+    }
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcIndex::~CNfcIndex()
+**
+** Description: class destructor, the settings are owned by CNfcConfig
+**
+** Returns:     none
+**
+*******************************************************************************/
+CNfcIndex::~CNfcIndex()
+{
+    delete[] m_hash;
+    delete[] m_param;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcIndex::hash()
+**
+** Description: FNV-1a hash of a setting name
+**
+** Returns:     hash value
+**
+*******************************************************************************/
+unsigned long CNfcIndex::hash(const char* p_name)
+{
+    unsigned long h = 2166136261UL;
+
+    while (*p_name)
+        h = ((h ^ (unsigned char)*p_name++) * 16777619UL) & 0xFFFFFFFFUL;
+    return h;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcIndex::lookup()
+**
+** Description: search a setting by name
+**
+** Returns:     pointer to the setting object, NULL if not found
+**
+*******************************************************************************/
+const CNfcParam* CNfcIndex::lookup(const char* p_name) const
+{
+    unsigned long h = hash(p_name);
+
+    for (size_t i = h & m_mask; m_param[i] != NULL; i = (i + 1) & m_mask)
+    {
+        if (m_hash[i] == h && *m_param[i] == p_name)
+            return m_param[i];
+    }
+    return NULL;
+}
+
 /*******************************************************************************
 **
 ** Function:    CNfcParam::CNfcParam()
@@ -708,6 +852,7 @@ extern "C" int GetStrValue(const char* name, char* pValue, unsigned long l)
 {
     size_t len = l;
     CNfcConfig& rConfig = CNfcConfig::GetInstance();
+    CNfcConfigReader reader(rConfig);
 
     bool b = rConfig.getValue(name, pValue, len);
     //printf("%s: NCI Config Parameter : %s=%s\n", __FUNCTION__, name, pValue);
@@ -730,6 +875,7 @@ extern "C" int GetNumValue(const char* name, void* pValue, unsigned long len)
         return false;
 
     CNfcConfig& rConfig = CNfcConfig::GetInstance();
+    CNfcConfigReader reader(rConfig);
     const CNfcParam* pParam = rConfig.find(name);
 
     if (pParam == NULL)
@@ -781,7 +927,9 @@ extern void resetConfig()
 {
     CNfcConfig& rConfig = CNfcConfig::GetInstance();
 
+    pthread_mutex_lock(&config_mutex);
     rConfig.clean();
+    pthread_mutex_unlock(&config_mutex);
 }
 
 /*******************************************************************************
@@ -800,6 +948,10 @@ void readOptionalConfig(const char* extra)
     strPath += extra_config_base;
     strPath += extra;
     strPath += extra_config_ext;
-    CNfcConfig::GetInstance().readConfig(strPath.c_str(), false);
+    CNfcConfig& rConfig = CNfcConfig::GetInstance();
+
+    pthread_mutex_lock(&config_mutex);
+    rConfig.readConfig(strPath.c_str(), false);
+    pthread_mutex_unlock(&config_mutex);
 }
 
@@ -48,9 +48,19 @@
 #include "nfc_hal_nv_co.h"
 #include "nfa_nv_ci.h"
 #include "CrcChecksum.h"
+#include <pthread.h>
+#include "phNxpInitProfile.h"
 extern char nfc_nci_store[];
 static const char* sNfaStorageBin = "/nfaStorage.bin";
 
+/* Check of the NV store started by start_stack_non_volatile_store_check */
+static pthread_mutex_t sNvStoreCheckLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t sNvStoreCheckThread;
+static BOOLEAN sNvStoreCheckPending = FALSE;
+static BOOLEAN sNvStorePreserve = FALSE;
+
+void wait_stack_non_volatile_store_check ();
+
 /*******************************************************************************
 **
 ** Function         nfa_mem_co_alloc
@@ -108,6 +118,8 @@ extern void nfa_nv_co_read(UINT8 *pBuffer, UINT16 nbytes, UINT8 block)
 {
     char filename[256], filename2[256];
 
+    wait_stack_non_volatile_store_check ();
+
     memset (filename, 0, sizeof(filename));
     memset (filename2, 0, sizeof(filename2));
     strcpy(filename2, nfc_nci_store);
@@ -167,6 +179,8 @@ extern void nfa_nv_co_write(const UINT8 *pBuffer, UINT16 nbytes, UINT8 block)
 {
     char filename[256], filename2[256];
 
+    wait_stack_non_volatile_store_check ();
+
     memset (filename, 0, sizeof(filename));
     memset (filename2, 0, sizeof(filename2));
     strcpy(filename2, nfc_nci_store);
@@ -300,3 +314,78 @@ void verify_stack_non_volatile_store ()
         delete_stack_non_volatile_store (TRUE);
 }
 
+/*******************************************************************************
+**
+** Function         nv_store_check_thread
+**
+** Description      Verifies the non-volatile store and, unless it is preserved,
+**                  deletes it.
+**
+** Returns          NULL
+**
+*******************************************************************************/
+static void *nv_store_check_thread (void *arg)
+{
+    int phase = phNxpInitProfile_Begin ("nv_store_check");
+
+    (void)arg;
+    verify_stack_non_volatile_store ();
+    if (sNvStorePreserve == FALSE)
+        delete_stack_non_volatile_store (FALSE);
+    phNxpInitProfile_End (phase);
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         start_stack_non_volatile_store_check
+**
+** Description      Starts the startup check of the non-volatile store in the
+**                  background, so that it overlaps the NFCC reset. The store
+**                  is not read or written before the check completed.
+**
+** Parameters       preserve: keep the store content if it is valid.
+**
+** Returns          none
+**
+*******************************************************************************/
+void start_stack_non_volatile_store_check (BOOLEAN preserve)
+{
+    pthread_mutex_lock (&sNvStoreCheckLock);
+    if (sNvStoreCheckPending == FALSE)
+    {
+        sNvStorePreserve = preserve;
+        if (pthread_create (&sNvStoreCheckThread, NULL, nv_store_check_thread, NULL) == 0)
+        {
+            sNvStoreCheckPending = TRUE;
+        }
+        else
+        {
+            nv_store_check_thread (NULL);
+        }
+    }
+    pthread_mutex_unlock (&sNvStoreCheckLock);
+}
+
+/*******************************************************************************
+**
+** Function         wait_stack_non_volatile_store_check
+**
+** Description      Waits for the check started by
+**                  start_stack_non_volatile_store_check to complete.
+**
+** Parameters       none
+**
+** Returns          none
+**
+*******************************************************************************/
+void wait_stack_non_volatile_store_check ()
+{
+    pthread_mutex_lock (&sNvStoreCheckLock);
+    if (sNvStoreCheckPending == TRUE)
+    {
+        pthread_join (sNvStoreCheckThread, NULL);
+        sNvStoreCheckPending = FALSE;
+    }
+    pthread_mutex_unlock (&sNvStoreCheckLock);
+}
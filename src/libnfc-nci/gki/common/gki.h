@@ -344,15 +344,37 @@ typedef struct _tle
     TIMER_PARAM_TYPE   param;
     UINT16        event;
     UINT8         in_use;
+#if (GKI_TIMER_WHEEL == TRUE)
+    UINT8         wheel_level;      /* GKI_TW_EXPIRED once on the expired list */
+    UINT8         wheel_slot;
+    UINT32        expiry;           /* absolute expiry in list units */
+#endif
 } TIMER_LIST_ENT;
 
+#if (GKI_TIMER_WHEEL == TRUE)
+/* Timing wheel geometry: GKI_TW_LEVELS levels of GKI_TW_SIZE slots each, which
+** covers 2^(GKI_TW_BITS * GKI_TW_LEVELS) units before entries get re-cascaded.
+*/
+#define GKI_TW_BITS         6
+#define GKI_TW_SIZE         (1 << GKI_TW_BITS)
+#define GKI_TW_MASK         (GKI_TW_SIZE - 1)
+#define GKI_TW_LEVELS       4
+#define GKI_TW_EXPIRED      0xFF
+#endif
+
 /* Define a timer list queue
 */
 typedef struct
 {
-    TIMER_LIST_ENT   *p_first;
+    TIMER_LIST_ENT   *p_first;      /* with GKI_TIMER_WHEEL: expired entries only */
     TIMER_LIST_ENT   *p_last;
     INT32             last_ticks;
+#if (GKI_TIMER_WHEEL == TRUE)
+    UINT32            now;          /* wheel time in list units */
+    UINT32            count;        /* number of entries, pending or expired */
+    UINT64            occupied[GKI_TW_LEVELS];
+    TIMER_LIST_ENT   *slots[GKI_TW_LEVELS][GKI_TW_SIZE];
+#endif
 } TIMER_LIST_Q;
 
 
@@ -469,6 +491,9 @@ GKI_API extern void    GKI_stop_timer (UINT8);
 GKI_API extern void    GKI_timer_update(INT32);
 GKI_API extern UINT16  GKI_update_timer_list (TIMER_LIST_Q *, INT32);
 GKI_API extern UINT32  GKI_get_remaining_ticks (TIMER_LIST_Q *, TIMER_LIST_ENT  *);
+GKI_API extern BOOLEAN GKI_timer_list_empty (TIMER_LIST_Q *);
+GKI_API extern TIMER_LIST_ENT *GKI_timer_getfirst (TIMER_LIST_Q *);
+GKI_API extern UINT32  GKI_timer_list_next_update (TIMER_LIST_Q *);
 GKI_API extern UINT16  GKI_wait(UINT16, UINT32);
 
 /* Start and Stop system time tick callback
@@ -496,6 +521,7 @@ GKI_API extern void      GKI_os_free (void *);
 
 /* os timer operation */
 GKI_API extern UINT32 GKI_get_os_tick_count(void);
+GKI_API extern UINT32 GKI_get_os_time_us(void);
 
 /* Exception handling
 */
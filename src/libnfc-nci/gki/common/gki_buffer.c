@@ -51,6 +51,49 @@ static void gki_remove_from_pool_list(UINT8 pool_id);
 #define LOG_TAG "GKI_DEBUG"
 #define LOGD(format, ...)  LogMsg (TRACE_CTRL_GENERAL | TRACE_LAYER_GKI | TRACE_ORG_GKI | TRACE_TYPE_GENERIC, format, ## __VA_ARGS__)
 #endif
+/*******************************************************************************
+**
+** Function         gki_link_free_queue
+**
+** Description      Internal function to chain all buffers of a pool's memory
+**                  block onto the pool's free stack. The pool start address is
+**                  published last so that lock-free readers which see it also
+**                  see a fully initialized stack.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_link_free_queue (UINT8 id, void *p_mem)
+{
+    UINT16           i;
+    BUFFER_HDR_T    *hdr;
+    BUFFER_HDR_T    *hdr1 = NULL;
+    UINT32          *magic;
+    tGKI_COM_CB     *p_cb = &gki_cb.com;
+    FREE_QUEUE_T    *Q = &p_cb->freeq[id];
+    UINT16           act_size = p_cb->pool_size[id];
+
+    hdr = (BUFFER_HDR_T *)p_mem;
+    for (i = 0; i < Q->total; i++)
+    {
+        hdr->task_id = GKI_INVALID_TASK;
+        hdr->q_id    = id;
+        hdr->status  = BUF_STATUS_FREE;
+        magic        = (UINT32 *)((UINT8 *)hdr + BUFFER_HDR_SIZE + Q->size);
+        *magic       = MAGIC_NO;
+        hdr1         = hdr;
+        hdr          = (BUFFER_HDR_T *)((UINT8 *)hdr + act_size);
+        hdr1->p_next = hdr;
+    }
+    if (hdr1)
+        hdr1->p_next = NULL;
+
+    Q->free_top = GKI_FREEQ_TOP(GKI_FREEQ_TAG(Q->free_top), (Q->total) ? 1 : 0);
+
+    p_cb->pool_end[id] = (UINT8 *)p_mem + (act_size * Q->total);
+    __atomic_store_n(&p_cb->pool_start[id], (UINT8 *)p_mem, __ATOMIC_RELEASE);
+}
+
 /*******************************************************************************
 **
 ** Function         gki_init_free_queue
@@ -63,11 +106,7 @@ static void gki_remove_from_pool_list(UINT8 pool_id);
 *******************************************************************************/
 static void gki_init_free_queue (UINT8 id, UINT16 size, UINT16 total, void *p_mem)
 {
-    UINT16           i;
     UINT16           act_size;
-    BUFFER_HDR_T    *hdr;
-    BUFFER_HDR_T    *hdr1 = NULL;
-    UINT32          *magic;
     INT32            tempsize = size;
     tGKI_COM_CB     *p_cb = &gki_cb.com;
 
@@ -75,19 +114,13 @@ static void gki_init_free_queue (UINT8 id, UINT16 size, UINT16 total, void *p_me
     tempsize = (INT32)ALIGN_POOL(size);
     act_size = (UINT16)(tempsize + BUFFER_PADDING_SIZE);
 
-    /* Remember pool start and end addresses */
-    if(p_mem)
-    {
-        p_cb->pool_start[id] = (UINT8 *)p_mem;
-        p_cb->pool_end[id]   = (UINT8 *)p_mem + (act_size * total);
-    }
-
     p_cb->pool_size[id]  = act_size;
 
     p_cb->freeq[id].size      = (UINT16) tempsize;
     p_cb->freeq[id].total     = total;
     p_cb->freeq[id].cur_cnt   = 0;
     p_cb->freeq[id].max_cnt   = 0;
+    p_cb->freeq[id].free_top  = GKI_FREEQ_TOP(0, 0);
 
 #if GKI_BUFFER_DEBUG
     LOGD("gki_init_free_queue() init pool=%d, size=%d (aligned=%d) total=%d start=%p", id, size, tempsize, total, p_mem);
@@ -95,61 +128,248 @@ static void gki_init_free_queue (UINT8 id, UINT16 size, UINT16 total, void *p_me
 
     /* Initialize  index table */
     if(p_mem)
-    {
-        hdr = (BUFFER_HDR_T *)p_mem;
-        p_cb->freeq[id].p_first = hdr;
-        for (i = 0; i < total; i++)
-        {
-            hdr->task_id = GKI_INVALID_TASK;
-            hdr->q_id    = id;
-            hdr->status  = BUF_STATUS_FREE;
-            magic        = (UINT32 *)((UINT8 *)hdr + BUFFER_HDR_SIZE + tempsize);
-            *magic       = MAGIC_NO;
-            hdr1         = hdr;
-            hdr          = (BUFFER_HDR_T *)((UINT8 *)hdr + act_size);
-            hdr1->p_next = hdr;
-        }
-        hdr1->p_next = NULL;
-        p_cb->freeq[id].p_last = hdr1;
-    }
+        gki_link_free_queue(id, p_mem);
+
     return;
 }
 
 #ifdef GKI_USE_DEFERED_ALLOC_BUF_POOLS
-static BOOLEAN gki_alloc_free_queue(UINT8 id)
+/*******************************************************************************
+**
+** Function         gki_alloc_free_queue
+**
+** Description      Internal function to allocate the memory of a pool on first
+**                  use. Only the allocation itself is serialized; callers that
+**                  find the pool already populated never take the GKI mutex.
+**
+** Returns          TRUE if the pool memory is available
+**
+*******************************************************************************/
+static BOOLEAN gki_alloc_free_queue(UINT8 pool_id)
 {
     FREE_QUEUE_T  *Q;
     tGKI_COM_CB *p_cb = &gki_cb.com;
-    #if GKI_BUFFER_DEBUG
-        //ALOGD("\ngki_alloc_free_queue in, id:%d \n", id);
-    #endif
+    BOOLEAN      ret = TRUE;
 
-    Q = &p_cb->freeq[p_cb->pool_list[id]];
+    Q = &p_cb->freeq[pool_id];
+
+    GKI_disable();
 
-    if(Q->p_first == 0)
+    if (p_cb->pool_start[pool_id] == NULL)
     {
         void* p_mem = GKI_os_malloc((Q->size + BUFFER_PADDING_SIZE) * Q->total);
         if(p_mem)
         {
-            //re-initialize the queue with allocated memory
             #if GKI_BUFFER_DEBUG
-                //ALOGD("\ngki_alloc_free_queue calling  gki_init_free_queue, id:%d  size:%d, totol:%d\n", id, Q->size, Q->total);
+                LOGD("gki_alloc_free_queue() pool:%d size:%d total:%d", pool_id, Q->size, Q->total);
             #endif
-            gki_init_free_queue(id, Q->size, Q->total, p_mem);
-            #if GKI_BUFFER_DEBUG
-                //ALOGD("\ngki_alloc_free_queue ret OK, id:%d  size:%d, totol:%d\n", id, Q->size, Q->total);
-            #endif
-            return TRUE;
+            gki_link_free_queue(pool_id, p_mem);
+        }
+        else
+        {
+            GKI_exception (GKI_ERROR_BUF_SIZE_TOOBIG, "gki_alloc_free_queue: Not enough memory");
+            ret = FALSE;
         }
-        GKI_exception (GKI_ERROR_BUF_SIZE_TOOBIG, "gki_alloc_free_queue: Not enough memory");
     }
-    #if GKI_BUFFER_DEBUG
-        //ALOGD("\ngki_alloc_free_queue out failed, id:%d\n", id);
-    #endif
-    return FALSE;
+
+    GKI_enable();
+
+    return ret;
 }
 #endif
 
+/*******************************************************************************
+**
+** Function         gki_pool_exhausted
+**
+** Description      Internal function to clear the availability bit of a pool
+**                  whose last buffer was just reserved.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_pool_exhausted (FREE_QUEUE_T *Q, UINT8 pool_id)
+{
+    tGKI_COM_CB *p_cb = &gki_cb.com;
+    UINT16       bit = (UINT16)(1 << p_cb->pool_rank[pool_id]);
+
+    __atomic_and_fetch(&p_cb->pool_avail_rank_mask, (UINT16)~bit, __ATOMIC_SEQ_CST);
+
+    /* A buffer may have been freed before the bit was cleared */
+    if (__atomic_load_n(&Q->cur_cnt, __ATOMIC_SEQ_CST) < Q->total)
+        __atomic_or_fetch(&p_cb->pool_avail_rank_mask, bit, __ATOMIC_SEQ_CST);
+}
+
+/*******************************************************************************
+**
+** Function         gki_build_pool_index
+**
+** Description      Internal function to rebuild the lookup data used by
+**                  GKI_getbuf after the pool list or pool permissions change:
+**                  the position of each pool in pool_list, the public and
+**                  available pool bitmaps, and the size class table.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_build_pool_index (void)
+{
+    tGKI_COM_CB *p_cb = &gki_cb.com;
+    FREE_QUEUE_T *Q;
+    UINT16       public_mask = 0;
+    UINT16       avail_mask = 0;
+    UINT16       fit_mask;
+    UINT32       cls;
+    UINT8        i;
+
+    for (i = 0; i < p_cb->curr_total_no_of_pools; i++)
+    {
+        Q = &p_cb->freeq[p_cb->pool_list[i]];
+        p_cb->pool_rank[p_cb->pool_list[i]] = i;
+
+        if (!(((UINT16)1 << p_cb->pool_list[i]) & p_cb->pool_access_mask))
+            public_mask |= (UINT16)(1 << i);
+
+        if (Q->cur_cnt < Q->total)
+            avail_mask |= (UINT16)(1 << i);
+    }
+
+    for (cls = 0; cls < GKI_NUM_SIZE_CLASSES; cls++)
+    {
+        fit_mask = 0;
+        for (i = 0; i < p_cb->curr_total_no_of_pools; i++)
+        {
+            /* Pool may fit the smallest size of the class; GKI_getbuf checks the exact size */
+            if (p_cb->freeq[p_cb->pool_list[i]].size >= (cls << GKI_SIZE_CLASS_SHIFT) + 1)
+                fit_mask |= (UINT16)(1 << i);
+        }
+        p_cb->size_class_rank_mask[cls] = fit_mask;
+    }
+
+    p_cb->pool_public_rank_mask = public_mask;
+    __atomic_store_n(&p_cb->pool_avail_rank_mask, avail_mask, __ATOMIC_RELEASE);
+}
+
+/*******************************************************************************
+**
+** Function         gki_push_free_buf
+**
+** Description      Internal function to put a buffer back on the free stack
+**                  of its pool without taking the GKI mutex.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_push_free_buf (FREE_QUEUE_T *Q, UINT8 pool_id, BUFFER_HDR_T *p_hdr)
+{
+    tGKI_COM_CB *p_cb = &gki_cb.com;
+    UINT8       *p_start = p_cb->pool_start[pool_id];
+    UINT16       act_size = p_cb->pool_size[pool_id];
+    UINT32       idx = (UINT32)(((UINT8 *)p_hdr - p_start) / act_size) + 1;
+    UINT64       top, new_top;
+    UINT16       cnt;
+
+    top = __atomic_load_n(&Q->free_top, __ATOMIC_RELAXED);
+    do
+    {
+        if (GKI_FREEQ_IDX(top))
+            p_hdr->p_next = (BUFFER_HDR_T *)(p_start + (GKI_FREEQ_IDX(top) - 1) * act_size);
+        else
+            p_hdr->p_next = NULL;
+
+        new_top = GKI_FREEQ_TOP(GKI_FREEQ_TAG(top) + 1, idx);
+    } while (!__atomic_compare_exchange_n(&Q->free_top, &top, new_top, TRUE,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    /* Only give back the slot once the buffer is visible on the stack, so
+    ** that a reserved slot is always backed by a free buffer */
+    cnt = __atomic_load_n(&Q->cur_cnt, __ATOMIC_RELAXED);
+    while (cnt > 0 && !__atomic_compare_exchange_n(&Q->cur_cnt, &cnt, (UINT16)(cnt - 1), TRUE,
+                                                    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        ;
+
+    if (cnt == Q->total)
+        __atomic_or_fetch(&p_cb->pool_avail_rank_mask, (UINT16)(1 << p_cb->pool_rank[pool_id]), __ATOMIC_SEQ_CST);
+}
+
+/*******************************************************************************
+**
+** Function         gki_pop_free_buf
+**
+** Description      Internal function to take a buffer from the free stack of
+**                  a pool without taking the GKI mutex. A slot is reserved in
+**                  cur_cnt before popping, so the pop cannot find the stack
+**                  empty while the pool is not exhausted.
+**
+** Returns          the buffer header, or NULL if the pool is exhausted
+**
+*******************************************************************************/
+static BUFFER_HDR_T *gki_pop_free_buf (UINT8 pool_id)
+{
+    tGKI_COM_CB   *p_cb = &gki_cb.com;
+    FREE_QUEUE_T  *Q = &p_cb->freeq[pool_id];
+    BUFFER_HDR_T  *p_hdr;
+    UINT8         *p_start;
+    UINT16         act_size;
+    UINT16         cnt, max;
+    UINT64         top, new_top;
+    UINT32         next_idx;
+
+    /* Reserve a buffer */
+    cnt = __atomic_load_n(&Q->cur_cnt, __ATOMIC_RELAXED);
+    do
+    {
+        if (cnt >= Q->total)
+            return NULL;
+    } while (!__atomic_compare_exchange_n(&Q->cur_cnt, &cnt, (UINT16)(cnt + 1), TRUE,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    if ((UINT16)(cnt + 1) == Q->total)
+        gki_pool_exhausted(Q, pool_id);
+
+    max = __atomic_load_n(&Q->max_cnt, __ATOMIC_RELAXED);
+    while ((UINT16)(cnt + 1) > max
+           && !__atomic_compare_exchange_n(&Q->max_cnt, &max, (UINT16)(cnt + 1), TRUE,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+
+    p_start = __atomic_load_n(&p_cb->pool_start[pool_id], __ATOMIC_ACQUIRE);
+#ifdef GKI_USE_DEFERED_ALLOC_BUF_POOLS
+    if (p_start == NULL)
+    {
+        if (gki_alloc_free_queue(pool_id) != TRUE)
+        {
+            GKI_TRACE_ERROR_0("gki_pop_free_buf() fail alloc free queue");
+            __atomic_sub_fetch(&Q->cur_cnt, 1, __ATOMIC_RELEASE);
+            return NULL;
+        }
+        p_start = __atomic_load_n(&p_cb->pool_start[pool_id], __ATOMIC_ACQUIRE);
+    }
+#endif
+    act_size = p_cb->pool_size[pool_id];
+
+    top = __atomic_load_n(&Q->free_top, __ATOMIC_ACQUIRE);
+    do
+    {
+        if (GKI_FREEQ_IDX(top) == 0)
+        {
+            GKI_TRACE_ERROR_0("gki_pop_free_buf() free stack empty");
+            __atomic_sub_fetch(&Q->cur_cnt, 1, __ATOMIC_RELEASE);
+            return NULL;
+        }
+
+        p_hdr = (BUFFER_HDR_T *)(p_start + (GKI_FREEQ_IDX(top) - 1) * act_size);
+
+        /* p_next may be stale if another thread popped p_hdr meanwhile; the
+        ** tag makes the compare-and-swap below fail in that case */
+        next_idx = (p_hdr->p_next) ? (UINT32)(((UINT8 *)p_hdr->p_next - p_start) / act_size) + 1 : 0;
+        new_top  = GKI_FREEQ_TOP(GKI_FREEQ_TAG(top) + 1, next_idx);
+    } while (!__atomic_compare_exchange_n(&Q->free_top, &top, new_top, TRUE,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+
+    return p_hdr;
+}
+
 /*******************************************************************************
 **
 ** Function         gki_buffer_init
@@ -181,8 +401,7 @@ void gki_buffer_init(void)
         p_cb->pool_end[tt]   = NULL;
         p_cb->pool_size[tt]  = 0;
 
-        p_cb->freeq[tt].p_first = 0;
-        p_cb->freeq[tt].p_last  = 0;
+        p_cb->freeq[tt].free_top = GKI_FREEQ_TOP(0, 0);
         p_cb->freeq[tt].size    = 0;
         p_cb->freeq[tt].total   = 0;
         p_cb->freeq[tt].cur_cnt = 0;
@@ -333,6 +552,8 @@ void gki_buffer_init(void)
 
     p_cb->curr_total_no_of_pools = GKI_NUM_FIXED_BUF_POOLS;
 
+    gki_build_pool_index();
+
     return;
 }
 
@@ -378,6 +599,8 @@ void *GKI_getbuf (UINT16 size)
 #endif
 {
     UINT8         i;
+    UINT16        fit_mask;
+    UINT16        candidates;
     FREE_QUEUE_T  *Q;
     BUFFER_HDR_T  *p_hdr;
     tGKI_COM_CB *p_cb = &gki_cb.com;
@@ -394,61 +617,23 @@ void *GKI_getbuf (UINT16 size)
 #if GKI_BUFFER_DEBUG
     LOGD("GKI_getbuf() requesting %d func:%s(line=%d)", size, _function_, _line_);
 #endif
-    /* Find the first buffer pool that is public that can hold the desired size */
-    for (i=0; i < p_cb->curr_total_no_of_pools; i++)
-    {
-        if ( size <= p_cb->freeq[p_cb->pool_list[i]].size )
-            break;
-    }
+    /* Walk the public pools that can hold the desired size and still have
+     * free buffers, in pool_list order, until a buffer is found */
+    fit_mask   = p_cb->size_class_rank_mask[GKI_SIZE_CLASS(size)];
+    candidates = fit_mask & p_cb->pool_public_rank_mask
+                 & __atomic_load_n(&p_cb->pool_avail_rank_mask, __ATOMIC_RELAXED);
 
-    if(i == p_cb->curr_total_no_of_pools)
+    while (candidates)
     {
-        GKI_exception (GKI_ERROR_BUF_SIZE_TOOBIG, "getbuf: Size is too big");
-        return (NULL);
-    }
+        i = (UINT8)__builtin_ctz(candidates);
+        candidates &= (UINT16)(candidates - 1);
 
-    /* Make sure the buffers aren't disturbed til finished with allocation */
-    GKI_disable();
-
-    /* search the public buffer pools that are big enough to hold the size
-     * until a free buffer is found */
-    for ( ; i < p_cb->curr_total_no_of_pools; i++)
-    {
-        /* Only look at PUBLIC buffer pools (bypass RESTRICTED pools) */
-        if (((UINT16)1 << p_cb->pool_list[i]) & p_cb->pool_access_mask)
+        Q = &p_cb->freeq[p_cb->pool_list[i]];
+        if (size > Q->size)
             continue;
 
-        Q = &p_cb->freeq[p_cb->pool_list[i]];
-        if(Q->cur_cnt < Q->total)
+        if ((p_hdr = gki_pop_free_buf(p_cb->pool_list[i])) != NULL)
         {
-        #ifdef GKI_USE_DEFERED_ALLOC_BUF_POOLS
-            if(Q->p_first == 0 && gki_alloc_free_queue(i) != TRUE)
-            {
-                GKI_TRACE_ERROR_0("GKI_getbuf() out of buffer");
-                GKI_enable();
-                return NULL;
-            }
-        #endif
-
-            if(Q->p_first == 0)
-            {
-                /* gki_alloc_free_queue() failed to alloc memory */
-                GKI_TRACE_ERROR_0("GKI_getbuf() fail alloc free queue");
-                GKI_enable();
-                return NULL;
-            }
-
-            p_hdr = Q->p_first;
-            Q->p_first = p_hdr->p_next;
-
-            if (!Q->p_first)
-                Q->p_last = NULL;
-
-            if(++Q->cur_cnt > Q->max_cnt)
-                Q->max_cnt = Q->cur_cnt;
-
-            GKI_enable();
-
             p_hdr->task_id = GKI_get_taskid();
 
             p_hdr->status  = BUF_STATUS_UNLINKED;
@@ -465,6 +650,19 @@ void *GKI_getbuf (UINT16 size)
         }
     }
 
+    /* Find out whether any pool at all can hold the desired size */
+    for (i=0; i < p_cb->curr_total_no_of_pools; i++)
+    {
+        if ((fit_mask & (1 << i)) && (size <= p_cb->freeq[p_cb->pool_list[i]].size))
+            break;
+    }
+
+    if(i == p_cb->curr_total_no_of_pools)
+    {
+        GKI_exception (GKI_ERROR_BUF_SIZE_TOOBIG, "getbuf: Size is too big");
+        return (NULL);
+    }
+
     GKI_TRACE_ERROR_0("GKI_getbuf() unable to allocate buffer!!!!!");
 #if GKI_BUFFER_DEBUG
     LOGD("GKI_getbuf() unable to allocate buffer!!!!!");
@@ -495,8 +693,6 @@ void *GKI_getbuf (UINT16 size)
 
     GKI_TRACE_ERROR_0("Failed to allocate GKI buffer");
 
-    GKI_enable();
-
     return (NULL);
 }
 
@@ -522,7 +718,9 @@ void *GKI_getpoolbuf_debug (UINT8 pool_id, const char * _function_, int _line_)
 void *GKI_getpoolbuf (UINT8 pool_id)
 #endif
 {
+#if GKI_BUFFER_DEBUG
     FREE_QUEUE_T  *Q;
+#endif
     BUFFER_HDR_T  *p_hdr;
     tGKI_COM_CB *p_cb = &gki_cb.com;
 
@@ -532,36 +730,8 @@ void *GKI_getpoolbuf (UINT8 pool_id)
 #if GKI_BUFFER_DEBUG
     LOGD("GKI_getpoolbuf() requesting from %d func:%s(line=%d)", pool_id, _function_, _line_);
 #endif
-    /* Make sure the buffers aren't disturbed til finished with allocation */
-    GKI_disable();
-
-    Q = &p_cb->freeq[pool_id];
-    if(Q->cur_cnt < Q->total)
+    if ((p_hdr = gki_pop_free_buf(pool_id)) != NULL)
     {
-#ifdef GKI_USE_DEFERED_ALLOC_BUF_POOLS
-        if(Q->p_first == 0 && gki_alloc_free_queue(pool_id) != TRUE)
-            return NULL;
-#endif
-
-        if(Q->p_first == 0)
-        {
-            /* gki_alloc_free_queue() failed to alloc memory */
-            GKI_TRACE_ERROR_0("GKI_getpoolbuf() fail alloc free queue");
-            return NULL;
-        }
-
-        p_hdr = Q->p_first;
-        Q->p_first = p_hdr->p_next;
-
-        if (!Q->p_first)
-            Q->p_last = NULL;
-
-        if(++Q->cur_cnt > Q->max_cnt)
-            Q->max_cnt = Q->cur_cnt;
-
-        GKI_enable();
-
-
         p_hdr->task_id = GKI_get_taskid();
 
         p_hdr->status  = BUF_STATUS_UNLINKED;
@@ -569,6 +739,7 @@ void *GKI_getpoolbuf (UINT8 pool_id)
         p_hdr->Type    = 0;
 
 #if GKI_BUFFER_DEBUG
+        Q = &p_cb->freeq[pool_id];
         LOGD("GKI_getpoolbuf() allocated, %x, %x (%d of %d used) %d", (UINT8*)p_hdr + BUFFER_HDR_SIZE, p_hdr, Q->cur_cnt, Q->total, p_cb->freeq[pool_id].total);
 
         strncpy(p_hdr->_function, _function_, _GKI_MAX_FUNCTION_NAME_LEN);
@@ -579,8 +750,6 @@ void *GKI_getpoolbuf (UINT8 pool_id)
     }
 
     /* If here, no buffers in the specified pool */
-    GKI_enable();
-
 #if GKI_BUFFER_DEBUG
     /* try for free buffers in public pools */
     return (GKI_getbuf_debug(p_cb->freeq[pool_id].size, _function_, _line_));
@@ -632,25 +801,14 @@ void GKI_freebuf (void *p_buf)
         return;
     }
 
-    GKI_disable();
-
     /*
     ** Release the buffer
     */
     Q  = &gki_cb.com.freeq[p_hdr->q_id];
-    if (Q->p_last)
-        Q->p_last->p_next = p_hdr;
-    else
-        Q->p_first = p_hdr;
-
-    Q->p_last      = p_hdr;
-    p_hdr->p_next  = NULL;
     p_hdr->status  = BUF_STATUS_FREE;
     p_hdr->task_id = GKI_INVALID_TASK;
-    if (Q->cur_cnt > 0)
-        Q->cur_cnt--;
 
-    GKI_enable();
+    gki_push_free_buf(Q, p_hdr->q_id, p_hdr);
 
     return;
 }
@@ -1173,6 +1331,8 @@ UINT8 GKI_set_pool_permission(UINT8 pool_id, UINT8 permission)
         else    /* mark the pool as public */
             p_cb->pool_access_mask = (UINT16)(p_cb->pool_access_mask & ~(1 << pool_id));
 
+        gki_build_pool_index();
+
         return (GKI_SUCCESS);
     }
     else
@@ -1257,25 +1417,14 @@ static void gki_remove_from_pool_list(UINT8 pool_id)
 *******************************************************************************/
 void *GKI_igetpoolbuf (UINT8 pool_id)
 {
-    FREE_QUEUE_T  *Q;
     BUFFER_HDR_T  *p_hdr;
 
     if (pool_id >= GKI_NUM_TOTAL_BUF_POOLS)
         return (NULL);
 
 
-    Q = &gki_cb.com.freeq[pool_id];
-    if(Q->cur_cnt < Q->total)
+    if ((p_hdr = gki_pop_free_buf(pool_id)) != NULL)
     {
-        p_hdr = Q->p_first;
-        Q->p_first = p_hdr->p_next;
-
-        if (!Q->p_first)
-            Q->p_last = NULL;
-
-        if(++Q->cur_cnt > Q->max_cnt)
-            Q->max_cnt = Q->cur_cnt;
-
         p_hdr->task_id = GKI_get_taskid();
 
         p_hdr->status  = BUF_STATUS_UNLINKED;
@@ -1468,8 +1617,8 @@ UINT8 GKI_create_pool (UINT16 size, UINT16 count, UINT8 permission, void *p_mem_
         /* Initialize the new pool */
         gki_init_free_queue (xx, size, count, p_mem_pool);
         gki_add_to_pool_list(xx);
-        (void) GKI_set_pool_permission (xx, permission);
         p_cb->curr_total_no_of_pools++;
+        (void) GKI_set_pool_permission (xx, permission);
 
         return (xx);
     }
@@ -1507,8 +1656,7 @@ void GKI_delete_pool (UINT8 pool_id)
         Q->total     = 0;
         Q->cur_cnt   = 0;
         Q->max_cnt   = 0;
-        Q->p_first   = NULL;
-        Q->p_last    = NULL;
+        Q->free_top  = GKI_FREEQ_TOP(0, 0);
 
         GKI_os_free (p_cb->pool_start[pool_id]);
 
@@ -1518,6 +1666,7 @@ void GKI_delete_pool (UINT8 pool_id)
 
         gki_remove_from_pool_list(pool_id);
         p_cb->curr_total_no_of_pools--;
+        gki_build_pool_index();
     }
     else
         GKI_exception(GKI_ERROR_DELETE_POOL_BAD_QID, "Deleting bad pool");
@@ -96,10 +96,14 @@ typedef struct _buffer_hdr
 
 } BUFFER_HDR_T;
 
+/* The free buffers of a pool are kept on a lock-free (Treiber) stack. The
+** stack head packs an ABA tag in the upper 32 bits and the 1-based index of
+** the top buffer within the pool in the lower 32 bits (0 means empty), so a
+** single 64-bit compare-and-swap updates it.
+*/
 typedef struct _free_queue
 {
-    BUFFER_HDR_T *p_first;      /* first buffer in the queue */
-    BUFFER_HDR_T *p_last;       /* last buffer in the queue */
+    UINT64          free_top;      /* head of the free stack: tag | (index + 1) */
     UINT16          size;          /* size of the buffers in the pool */
     UINT16          total;         /* toatal number of buffers */
     UINT16          cur_cnt;       /* number of  buffers currently allocated */
@@ -115,6 +119,16 @@ typedef struct _free_queue
 #define MAX_USER_BUF_SIZE   ((UINT16)0xffff - BUFFER_PADDING_SIZE)  /* pool size must allow for header */
 #define MAGIC_NO            0xDDBADDBA
 
+#define GKI_FREEQ_IDX(top)          ((UINT32)((top) & 0xFFFFFFFFULL))
+#define GKI_FREEQ_TAG(top)          ((UINT32)((top) >> 32))
+#define GKI_FREEQ_TOP(tag, idx)     (((UINT64)(UINT32)(tag) << 32) | (UINT32)(idx))
+
+/* GKI_getbuf size classes: one entry per 16 bytes of requested size, each
+** holding a bitmap (by pool_list position) of the pools that may fit it */
+#define GKI_SIZE_CLASS_SHIFT        4
+#define GKI_NUM_SIZE_CLASSES        ((0xFFFF >> GKI_SIZE_CLASS_SHIFT) + 1)
+#define GKI_SIZE_CLASS(size)        (((UINT16)(size) - 1) >> GKI_SIZE_CLASS_SHIFT)
+
 #define BUF_STATUS_FREE     0
 #define BUF_STATUS_UNLINKED 1
 #define BUF_STATUS_QUEUED   2
@@ -348,6 +362,10 @@ typedef struct
     UINT16      pool_access_mask;                   /* Bits are set if the corresponding buffer pool is a restricted pool */
     UINT8       pool_list[GKI_NUM_TOTAL_BUF_POOLS]; /* buffer pools arranged in the order of size */
     UINT8       curr_total_no_of_pools;             /* number of fixed buf pools + current number of dynamic pools */
+    UINT8       pool_rank[GKI_NUM_TOTAL_BUF_POOLS]; /* position of each pool in pool_list */
+    UINT16      pool_public_rank_mask;              /* Bits are set for public pools, indexed by position in pool_list */
+    UINT16      pool_avail_rank_mask;               /* Bits are set for pools with free buffers, indexed by position in pool_list */
+    UINT16      size_class_rank_mask[GKI_NUM_SIZE_CLASSES]; /* pools big enough for each size class, indexed by position in pool_list */
 
     BOOLEAN     timer_nesting;                      /* flag to prevent timer interrupt nesting */
 
@@ -376,6 +394,12 @@ extern BOOLEAN   gki_chk_buf_owner(void *);
 extern void      gki_buffer_init (void);
 extern void      gki_timers_init(void);
 extern void      gki_adjust_timer_count (INT32);
+extern BOOLEAN   gki_timers_is_timer_running(void);
+#if (GKI_TICKLESS_TIMER == TRUE)
+extern void      gki_timer_sync (void);
+extern void      gki_timer_rearm (void);
+extern UINT32    gki_tick_count (void);
+#endif
 
 extern void    OSStartRdy(void);
 extern void    OSCtxSw(void);
@@ -147,7 +147,13 @@ BOOLEAN gki_timers_is_timer_running(void)
 *******************************************************************************/
 UINT32  GKI_get_tick_count(void)
 {
+#if (GKI_TICKLESS_TIMER == TRUE)
+    /* Without a heartbeat OSTicks only moves when the timer thread wakes up,
+    ** so read the clock rather than syncing the timers under the GKI lock */
+    return gki_tick_count();
+#else
     return gki_cb.com.OSTicks;
+#endif
 }
 
 
@@ -214,6 +220,11 @@ void GKI_start_timer (UINT8 tnum, INT32 ticks, BOOLEAN is_continuous)
 
     GKI_disable();
 
+#if (GKI_TICKLESS_TIMER == TRUE)
+    /* Account for the ticks elapsed since the timer thread last woke up */
+    gki_timer_sync();
+#endif
+
     if(gki_timers_is_timer_running() == FALSE)
     {
 #if (defined(GKI_DELAY_STOP_SYS_TICK) && (GKI_DELAY_STOP_SYS_TICK > 0))
@@ -285,6 +296,9 @@ void GKI_start_timer (UINT8 tnum, INT32 ticks, BOOLEAN is_continuous)
     {
         /* Only update the timeout value if it is less than any other newly started timers */
         gki_adjust_timer_count (orig_ticks);
+#if (GKI_TICKLESS_TIMER == TRUE)
+        gki_timer_rearm();
+#endif
     }
 
     GKI_enable();
@@ -358,6 +372,10 @@ void GKI_stop_timer (UINT8 tnum)
             gki_cb.com.p_tick_cb(FALSE); /* stop system tick */
 #endif
         }
+#if (GKI_TICKLESS_TIMER == TRUE)
+        /* Nothing left to expire, disarm the timer thread */
+        gki_timer_rearm();
+#endif
     }
 
     GKI_enable();
@@ -617,6 +635,63 @@ void GKI_timer_queue_register_callback (SYSTEM_TICK_CBACK *p_callback)
     return;
 }
 
+/*******************************************************************************
+**
+** Function         gki_timer_queue_add
+**
+** Description      Registers a timer list queue in gki_cb.com.timer_queues so
+**                  that GKI_timer_queue_empty reports it as active.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_timer_queue_add (TIMER_LIST_Q *p_timer_listq)
+{
+    UINT8 tt;
+
+    /* if we already add this timer queue to the array */
+    for (tt = 0; tt < GKI_MAX_TIMER_QUEUES; tt++)
+    {
+         if (gki_cb.com.timer_queues[tt] == p_timer_listq)
+             return;
+    }
+    /* add this timer queue to the array */
+    for (tt = 0; tt < GKI_MAX_TIMER_QUEUES; tt++)
+    {
+         if (gki_cb.com.timer_queues[tt] == NULL)
+             break;
+    }
+    if (tt < GKI_MAX_TIMER_QUEUES)
+    {
+        gki_cb.com.timer_queues[tt] = p_timer_listq;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         gki_timer_queue_remove
+**
+** Description      Unregisters an empty timer list queue from
+**                  gki_cb.com.timer_queues.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_timer_queue_remove (TIMER_LIST_Q *p_timer_listq)
+{
+    UINT8 tt;
+
+    for (tt = 0; tt < GKI_MAX_TIMER_QUEUES; tt++)
+    {
+        if (gki_cb.com.timer_queues[tt] == p_timer_listq)
+        {
+            gki_cb.com.timer_queues[tt] = NULL;
+            break;
+        }
+    }
+}
+
+#if (GKI_TIMER_WHEEL != TRUE)
 /*******************************************************************************
 **
 ** Function         GKI_init_timer_list
@@ -637,6 +712,7 @@ void GKI_init_timer_list (TIMER_LIST_Q *p_timer_listq)
 
     return;
 }
+#endif
 
 /*******************************************************************************
 **
@@ -660,6 +736,7 @@ void GKI_init_timer_list_entry (TIMER_LIST_ENT  *p_tle)
 }
 
 
+#if (GKI_TIMER_WHEEL != TRUE)
 /*******************************************************************************
 **
 ** Function         GKI_update_timer_list
@@ -800,7 +877,6 @@ UINT32 GKI_get_remaining_ticks (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_
 void GKI_add_to_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_tle)
 {
     UINT32           nr_ticks_total;
-    UINT8 tt;
     TIMER_LIST_ENT  *p_temp;
     if (p_tle == NULL || p_timer_listq == NULL) {
         GKI_TRACE_3("%s: invalid argument %x, %x****************************<<", __func__, p_timer_listq, p_tle);
@@ -865,22 +941,7 @@ void GKI_add_to_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_tle)
 
         p_tle->in_use = TRUE;
 
-        /* if we already add this timer queue to the array */
-        for (tt = 0; tt < GKI_MAX_TIMER_QUEUES; tt++)
-        {
-             if (gki_cb.com.timer_queues[tt] == p_timer_listq)
-                 return;
-        }
-        /* add this timer queue to the array */
-        for (tt = 0; tt < GKI_MAX_TIMER_QUEUES; tt++)
-        {
-             if (gki_cb.com.timer_queues[tt] == NULL)
-                 break;
-        }
-        if (tt < GKI_MAX_TIMER_QUEUES)
-        {
-            gki_cb.com.timer_queues[tt] = p_timer_listq;
-        }
+        gki_timer_queue_add (p_timer_listq);
     }
 
     return;
@@ -902,8 +963,6 @@ void GKI_add_to_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_tle)
 *******************************************************************************/
 void GKI_remove_from_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_tle)
 {
-    UINT8 tt;
-
     /* Verify that the entry is valid */
     if (p_tle == NULL || p_tle->in_use == FALSE || p_timer_listq->p_first == NULL)
     {
@@ -970,19 +1029,470 @@ void GKI_remove_from_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p
     /* if timer queue is empty */
     if (p_timer_listq->p_first == NULL && p_timer_listq->p_last == NULL)
     {
-        for (tt = 0; tt < GKI_MAX_TIMER_QUEUES; tt++)
+        gki_timer_queue_remove (p_timer_listq);
+    }
+
+    return;
+}
+
+
+#else /* GKI_TIMER_WHEEL */
+
+/*******************************************************************************
+**
+** Function         gki_tw_link
+**
+** Description      Internal helper that places a pending entry in the wheel
+**                  slot matching its expiry relative to the wheel time. Entries
+**                  further out than the wheel span are parked in the last slot
+**                  of the top level and re-cascaded from there.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_tw_link (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT *p_tle)
+{
+    UINT32 delta = p_tle->expiry - p_timer_listq->now;
+    UINT32 when  = p_tle->expiry;
+    UINT8  level = 0;
+    UINT8  slot;
+
+    while ((level < GKI_TW_LEVELS - 1) && (delta >> (GKI_TW_BITS * (level + 1))))
+        level++;
+
+    if (delta >> (GKI_TW_BITS * (level + 1)))
+    {
+        /* beyond the wheel span: wait in the furthest top level slot */
+        when  = p_timer_listq->now + ((1UL << (GKI_TW_BITS * GKI_TW_LEVELS)) - 1);
+    }
+
+    slot = (UINT8) ((when >> (GKI_TW_BITS * level)) & GKI_TW_MASK);
+
+    p_tle->wheel_level = level;
+    p_tle->wheel_slot  = slot;
+    p_tle->p_prev      = NULL;
+    p_tle->p_next      = p_timer_listq->slots[level][slot];
+    if (p_tle->p_next)
+        p_tle->p_next->p_prev = p_tle;
+    p_timer_listq->slots[level][slot] = p_tle;
+    p_timer_listq->occupied[level] |= ((UINT64) 1 << slot);
+}
+
+/*******************************************************************************
+**
+** Function         gki_tw_unlink
+**
+** Description      Internal helper that takes an entry off its wheel slot or
+**                  off the expired list.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_tw_unlink (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT *p_tle)
+{
+    TIMER_LIST_ENT **pp_head;
+
+    if (p_tle->wheel_level == GKI_TW_EXPIRED)
+    {
+        if (p_timer_listq->p_last == p_tle)
+            p_timer_listq->p_last = p_tle->p_prev;
+        pp_head = &p_timer_listq->p_first;
+    }
+    else
+    {
+        pp_head = &p_timer_listq->slots[p_tle->wheel_level][p_tle->wheel_slot];
+    }
+
+    if (p_tle->p_prev)
+        p_tle->p_prev->p_next = p_tle->p_next;
+    else
+        *pp_head = p_tle->p_next;
+
+    if (p_tle->p_next)
+        p_tle->p_next->p_prev = p_tle->p_prev;
+
+    if ((p_tle->wheel_level != GKI_TW_EXPIRED) && (*pp_head == NULL))
+        p_timer_listq->occupied[p_tle->wheel_level] &= ~((UINT64) 1 << p_tle->wheel_slot);
+
+    p_tle->p_next = p_tle->p_prev = NULL;
+}
+
+/*******************************************************************************
+**
+** Function         gki_tw_expire
+**
+** Description      Internal helper that appends an entry to the expired list,
+**                  with a tick value of '0' as the legacy list code did.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_tw_expire (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT *p_tle)
+{
+    p_tle->wheel_level = GKI_TW_EXPIRED;
+    p_tle->ticks       = 0;
+    p_tle->p_next      = NULL;
+    p_tle->p_prev      = p_timer_listq->p_last;
+
+    if (p_timer_listq->p_last)
+        p_timer_listq->p_last->p_next = p_tle;
+    else
+        p_timer_listq->p_first = p_tle;
+    p_timer_listq->p_last = p_tle;
+}
+
+/*******************************************************************************
+**
+** Function         gki_tw_step
+**
+** Description      Internal helper returning how far the wheel time can move
+**                  (at most max_units) before anything needs to be cascaded
+**                  or expired, so that empty slots are skipped in one go.
+**
+** Returns          number of units to advance
+**
+*******************************************************************************/
+static UINT32 gki_tw_step (TIMER_LIST_Q *p_timer_listq, UINT32 max_units)
+{
+    UINT32 step;
+    UINT64 ahead;
+    UINT8  cur = (UINT8) (p_timer_listq->now & GKI_TW_MASK);
+    UINT8  level;
+
+    for (level = 0; level < GKI_TW_LEVELS; level++)
+    {
+        if (p_timer_listq->occupied[level])
+            break;
+    }
+
+    if (level == GKI_TW_LEVELS)
+    {
+        /* nothing pending: only the expired list is populated */
+        return (max_units);
+    }
+
+    if (level == 0)
+    {
+        /* next occupied level 0 slot before the wrap, else the wrap itself */
+        ahead = (cur == GKI_TW_MASK) ? 0 : (p_timer_listq->occupied[0] & (~(UINT64) 0 << (cur + 1)));
+        if (ahead)
+            step = __builtin_ctzll (ahead) - cur;
+        else
+            step = GKI_TW_SIZE - cur;
+    }
+    else
+    {
+        /* lower levels are empty: jump to the next boundary of this level */
+        step = (1UL << (GKI_TW_BITS * level))
+             - (p_timer_listq->now & ((1UL << (GKI_TW_BITS * level)) - 1));
+    }
+
+    return ((step < max_units) ? step : max_units);
+}
+
+/*******************************************************************************
+**
+** Function         gki_tw_tick
+**
+** Description      Internal helper run when the wheel time lands on a slot:
+**                  cascades the upper levels at their boundaries and moves the
+**                  due level 0 slot onto the expired list.
+**
+** Returns          number of timers that expired
+**
+*******************************************************************************/
+static UINT16 gki_tw_tick (TIMER_LIST_Q *p_timer_listq)
+{
+    TIMER_LIST_ENT *p_tle, *p_next;
+    UINT16          num_time_out = 0;
+    UINT8           level, slot;
+
+    for (level = 1; level < GKI_TW_LEVELS; level++)
+    {
+        if (p_timer_listq->now & ((1UL << (GKI_TW_BITS * level)) - 1))
+            break;
+
+        slot  = (UINT8) ((p_timer_listq->now >> (GKI_TW_BITS * level)) & GKI_TW_MASK);
+        p_tle = p_timer_listq->slots[level][slot];
+        p_timer_listq->slots[level][slot] = NULL;
+        p_timer_listq->occupied[level] &= ~((UINT64) 1 << slot);
+
+        for (; p_tle; p_tle = p_next)
         {
-            if (gki_cb.com.timer_queues[tt] == p_timer_listq)
-            {
-                gki_cb.com.timer_queues[tt] = NULL;
-                break;
-            }
+            p_next = p_tle->p_next;
+            gki_tw_link (p_timer_listq, p_tle);
         }
     }
 
+    slot  = (UINT8) (p_timer_listq->now & GKI_TW_MASK);
+    p_tle = p_timer_listq->slots[0][slot];
+    p_timer_listq->slots[0][slot] = NULL;
+    p_timer_listq->occupied[0] &= ~((UINT64) 1 << slot);
+
+    for (; p_tle; p_tle = p_next)
+    {
+        p_next = p_tle->p_next;
+        gki_tw_expire (p_timer_listq, p_tle);
+        num_time_out++;
+    }
+
+    return (num_time_out);
+}
+
+/*******************************************************************************
+**
+** Function         GKI_init_timer_list
+**
+** Description      This function is called by applications when they
+**                  want to initialize a timer list.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**
+** Returns          void
+**
+*******************************************************************************/
+void GKI_init_timer_list (TIMER_LIST_Q *p_timer_listq)
+{
+    memset (p_timer_listq, 0, sizeof (TIMER_LIST_Q));
+
     return;
 }
 
+/*******************************************************************************
+**
+** Function         GKI_update_timer_list
+**
+** Description      This function is called by the applications when they
+**                  want to update a timer list. This should be at every
+**                  timer list unit tick, e.g. once per sec, once per minute etc.
+**
+**                  Timing wheel version: expired entries are moved, in expiry
+**                  order, to the list headed by p_timer_listq->p_first with a
+**                  tick value of '0'. Cost is bounded by the number of
+**                  occupied slots crossed, not by the number of timers.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**                  num_units_since_last_update - (input) number of units since the last update
+**                                  (allows for variable unit update)
+**
+** Returns          the number of timers that have expired
+**
+*******************************************************************************/
+UINT16 GKI_update_timer_list (TIMER_LIST_Q *p_timer_listq, INT32 num_units_since_last_update)
+{
+    TIMER_LIST_ENT  *p_tle;
+    UINT16           num_time_out = 0;
+    UINT32           step;
+
+    /* First, get the guys who have previously timed out */
+    for (p_tle = p_timer_listq->p_first; p_tle; p_tle = p_tle->p_next)
+        num_time_out++;
+
+    while (num_units_since_last_update > 0)
+    {
+        step = gki_tw_step (p_timer_listq, (UINT32) num_units_since_last_update);
+
+        p_timer_listq->now          += step;
+        num_units_since_last_update -= (INT32) step;
+
+        num_time_out += gki_tw_tick (p_timer_listq);
+    }
+
+    return (num_time_out);
+}
+
+/*******************************************************************************
+**
+** Function         GKI_get_remaining_ticks
+**
+** Description      This function is called by an application to get remaining
+**                  ticks to expire
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**                  p_target_tle    - (input) pointer to a timer list queue entry
+**
+** Returns          0 if timer is not used or timer is not in the list
+**                  remaining ticks if success
+**
+*******************************************************************************/
+UINT32 GKI_get_remaining_ticks (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_target_tle)
+{
+    if (!p_target_tle->in_use)
+    {
+        BT_ERROR_TRACE_0(TRACE_LAYER_GKI, "GKI_get_remaining_ticks: timer entry is not active");
+        return (0);
+    }
+
+    if (p_target_tle->wheel_level == GKI_TW_EXPIRED)
+        return (0);
+
+    return (p_target_tle->expiry - p_timer_listq->now);
+}
+
+/*******************************************************************************
+**
+** Function         GKI_add_to_timer_list
+**
+** Description      This function is called by an application to add a timer
+**                  entry to a timer list.
+**
+**                  Note: A timer value of '0' will effectively insert an already
+**                      expired event.  Negative tick values will be ignored.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**                  p_tle           - (input) pointer to a timer list queue entry
+**
+** Returns          void
+**
+*******************************************************************************/
+void GKI_add_to_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_tle)
+{
+    INT32 ticks;
+
+    if (p_tle == NULL || p_timer_listq == NULL) {
+        GKI_TRACE_3("%s: invalid argument %x, %x****************************<<", __func__, p_timer_listq, p_tle);
+        return;
+    }
+
+    /* Only process valid tick values */
+    if (p_tle->ticks < 0)
+        return;
+
+    ticks = p_tle->ticks;
+
+    /* an entry can only be on one slot at a time */
+    if (p_tle->in_use)
+        GKI_remove_from_timer_list (p_timer_listq, p_tle);
+
+    if (ticks == 0)
+    {
+        gki_tw_expire (p_timer_listq, p_tle);
+    }
+    else
+    {
+        p_tle->ticks  = ticks;
+        p_tle->expiry = p_timer_listq->now + (UINT32) ticks;
+        gki_tw_link (p_timer_listq, p_tle);
+    }
+
+    p_tle->in_use = TRUE;
+    p_timer_listq->count++;
+
+    gki_timer_queue_add (p_timer_listq);
+
+    return;
+}
+
+/*******************************************************************************
+**
+** Function         GKI_remove_from_timer_list
+**
+** Description      This function is called by an application to remove a timer
+**                  entry from a timer list.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**                  p_tle           - (input) pointer to a timer list queue entry
+**
+** Returns          void
+**
+*******************************************************************************/
+void GKI_remove_from_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_tle)
+{
+    /* Verify that the entry is valid */
+    if (p_tle == NULL || p_tle->in_use == FALSE || p_timer_listq->count == 0)
+    {
+        return;
+    }
+
+    gki_tw_unlink (p_timer_listq, p_tle);
+
+    p_tle->ticks = GKI_UNUSED_LIST_ENTRY;
+    p_tle->in_use = FALSE;
+
+    /* if timer queue is empty */
+    if (--p_timer_listq->count == 0)
+    {
+        gki_timer_queue_remove (p_timer_listq);
+    }
+
+    return;
+}
+
+#endif /* GKI_TIMER_WHEEL */
+
+/*******************************************************************************
+**
+** Function         GKI_timer_list_empty
+**
+** Description      This function is called by applications to check whether a
+**                  timer list holds any entry, pending or expired.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**
+** Returns          TRUE if the list is empty
+**
+*******************************************************************************/
+BOOLEAN GKI_timer_list_empty (TIMER_LIST_Q *p_timer_listq)
+{
+#if (GKI_TIMER_WHEEL == TRUE)
+    return (p_timer_listq->count == 0);
+#else
+    return (p_timer_listq->p_first == NULL);
+#endif
+}
+
+/*******************************************************************************
+**
+** Function         GKI_timer_getfirst
+**
+** Description      This function is called by applications to get the first
+**                  entry of a timer list. Expired entries (tick value '0')
+**                  always come first. With GKI_TIMER_WHEEL only expired
+**                  entries are ordered, so NULL is also returned while timers
+**                  are pending; use GKI_timer_list_empty to test for that.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**
+** Returns          pointer to the first entry, or NULL
+**
+*******************************************************************************/
+TIMER_LIST_ENT *GKI_timer_getfirst (TIMER_LIST_Q *p_timer_listq)
+{
+    return (p_timer_listq->p_first);
+}
+
+/*******************************************************************************
+**
+** Function         GKI_timer_list_next_update
+**
+** Description      This function is called by applications that drive a timer
+**                  list from a one-shot GKI timer instead of a periodic one.
+**                  It returns how many units the list can be moved on before
+**                  GKI_update_timer_list has anything to do: the first expiry,
+**                  or with GKI_TIMER_WHEEL possibly an earlier cascade of an
+**                  upper wheel level.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**
+** Returns          number of units, 0 if an expired entry is waiting.
+**                  Only meaningful if the list is not empty.
+**
+*******************************************************************************/
+UINT32 GKI_timer_list_next_update (TIMER_LIST_Q *p_timer_listq)
+{
+#if (GKI_TIMER_WHEEL == TRUE)
+    if (p_timer_listq->p_first)
+        return (0);
+
+    return (gki_tw_step (p_timer_listq, 0xFFFFFFFF));
+#else
+    /* delta list: the head holds the time to the first expiry */
+    if (p_timer_listq->p_first == NULL)
+        return (0);
+
+    return ((p_timer_listq->p_first->ticks > 0) ? (UINT32) p_timer_listq->p_first->ticks : 0);
+#endif
+}
 
 /*******************************************************************************
 **
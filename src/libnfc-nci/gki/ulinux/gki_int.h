@@ -60,6 +60,12 @@ typedef struct
     pthread_mutex_t     gki_timer_mutex;
     pthread_cond_t      gki_timer_cond;
     int                 gki_timer_wake_lock_on;
+#if (GKI_TICKLESS_TIMER == TRUE)
+    int                 timer_fd;           /* CLOCK_MONOTONIC timerfd armed to the next GKI timer expiry */
+    UINT64              timer_base_ms;      /* monotonic time (ms) up to which ticks have been accounted */
+    UINT64              tick_origin_ms;     /* monotonic time (ms) at which OSTicks was tick_origin */
+    UINT32              tick_origin;
+#endif
 #if (GKI_DEBUG == TRUE)
     pthread_mutex_t     GKI_trace_mutex;
 #endif
@@ -43,6 +43,9 @@
 
 #include <pthread.h>  /* must be 1st header defined  */
 #include <time.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
 #include "gki_int.h"
 #include "gki_target.h"
 
@@ -75,6 +78,10 @@ tGKI_CB   gki_cb;
 // #define GKI_TICK_TIMER_DEBUG
 #define GKI_NO_TICK_STOP
 
+#if (GKI_TICKLESS_TIMER == TRUE)
+static UINT64 gki_monotonic_ms(void);
+#endif
+
 #define LOCK(m)  pthread_mutex_lock(&m)
 #define UNLOCK(m) pthread_mutex_unlock(&m)
 #define INIT(m) pthread_mutex_init(&m, NULL)
@@ -110,6 +117,12 @@ typedef struct
 } gki_pthread_info_t;
 gki_pthread_info_t gki_pthread_info[GKI_MAX_TASKS];
 
+/* Task id of the calling thread. GKI tasks set it in gki_task_entry; other
+** (application) threads resolve it once in GKI_get_taskid and keep the result.
+*/
+#define GKI_TASKID_UNKNOWN  0xFE
+static __thread UINT8 gki_cur_taskid = GKI_TASKID_UNKNOWN;
+
 /*******************************************************************************
 **
 ** Function         gki_task_entry
@@ -128,6 +141,7 @@ void gki_task_entry(UINT32 params)
                 p_pthread_info->pCond, p_pthread_info->pMutex);
 
     gki_cb.os.thread_id[p_pthread_info->task_id] = thread_id;
+    gki_cur_taskid = p_pthread_info->task_id;
     /* Call the actual thread entry point */
     (p_pthread_info->task_entry)(p_pthread_info->params);
 
@@ -188,7 +202,135 @@ void GKI_init(void)
     p_os->no_timer_suspend = GKI_TIMER_TICK_RUN_COND;
     pthread_mutex_init(&p_os->gki_timer_mutex, NULL);
     pthread_cond_init(&p_os->gki_timer_cond, NULL);
+
+#if (GKI_TICKLESS_TIMER == TRUE)
+    p_os->timer_base_ms = gki_monotonic_ms();
+    p_os->tick_origin_ms = p_os->timer_base_ms;
+    p_os->tick_origin = gki_cb.com.OSTicks;
+    p_os->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (p_os->timer_fd < 0)
+        GKI_TRACE_ERROR_1("GKI_init: timerfd_create failed, errno=%d", errno);
+#endif
+}
+
+#if (GKI_TICKLESS_TIMER == TRUE)
+/*******************************************************************************
+**
+** Function         gki_monotonic_ms
+**
+** Description      Current CLOCK_MONOTONIC time in milliseconds
+**
+** Returns          time in ms
+**
+*******************************************************************************/
+static UINT64 gki_monotonic_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((UINT64)now.tv_sec * 1000 + now.tv_nsec / NANOSEC_PER_MILLISEC);
+}
+
+/*******************************************************************************
+**
+** Function         gki_timer_sync
+**
+** Description      Accounts for the whole ticks elapsed since the last call by
+**                  feeding them to GKI_timer_update. Replaces the periodic
+**                  heartbeat: it is called by the timer thread when the timerfd
+**                  fires, and by GKI_start_timer/GKI_get_tick_count so that
+**                  new timers and time stamps are relative to the current time.
+**
+** Returns          void
+**
+*******************************************************************************/
+void gki_timer_sync(void)
+{
+    UINT64 now = gki_monotonic_ms();
+    UINT64 elapsed;
+
+    GKI_disable();
+
+    /* timer_base_ms is only set once GKI_init has run */
+    if (gki_cb.os.timer_base_ms != 0 && now > gki_cb.os.timer_base_ms)
+    {
+        elapsed = GKI_MS_TO_TICKS(now - gki_cb.os.timer_base_ms);
+        if (elapsed > 0)
+        {
+            gki_cb.os.timer_base_ms += GKI_TICKS_TO_MS(elapsed);
+            GKI_timer_update((INT32)elapsed);
+        }
+    }
+
+    GKI_enable();
+}
+
+/*******************************************************************************
+**
+** Function         gki_tick_count
+**
+** Description      Current GKI tick count, derived from CLOCK_MONOTONIC and
+**                  the origin fixed by GKI_init. It matches OSTicks once the
+**                  elapsed ticks have been fed to GKI_timer_update, but
+**                  reads no state that changes afterwards, so it needs no
+**                  lock.
+**
+** Returns          tick count
+**
+*******************************************************************************/
+UINT32 gki_tick_count(void)
+{
+    if (gki_cb.os.tick_origin_ms == 0)
+        return (gki_cb.com.OSTicks);
+
+    return (gki_cb.os.tick_origin
+            + (UINT32)GKI_MS_TO_TICKS(gki_monotonic_ms() - gki_cb.os.tick_origin_ms));
+}
+
+/*******************************************************************************
+**
+** Function         gki_timer_rearm
+**
+** Description      Programs the timerfd to the next GKI timer expiry, or
+**                  disarms it when no timer is running so that the timer thread
+**                  does not wake up at all while idle.
+**
+** Returns          void
+**
+*******************************************************************************/
+void gki_timer_rearm(void)
+{
+    struct itimerspec its;
+    UINT64 deadline_ms;
+    INT32 ticks_til_exp;
+
+    memset(&its, 0, sizeof(its));
+
+    GKI_disable();
+
+    if (gki_cb.os.timer_fd < 0)
+    {
+        GKI_enable();
+        return;
+    }
+
+    if (gki_timers_is_timer_running())
+    {
+        ticks_til_exp = gki_cb.com.OSTicksTilExp;
+        if (ticks_til_exp <= 0)
+            ticks_til_exp = 1;
+
+        deadline_ms = gki_cb.os.timer_base_ms + GKI_TICKS_TO_MS((UINT64)ticks_til_exp);
+        its.it_value.tv_sec  = deadline_ms / 1000;
+        its.it_value.tv_nsec = (deadline_ms % 1000) * NANOSEC_PER_MILLISEC;
+    }
+
+    if (timerfd_settime(gki_cb.os.timer_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0)
+        GKI_TRACE_ERROR_1("gki_timer_rearm: timerfd_settime failed, errno=%d", errno);
+
+    GKI_enable();
 }
+#endif
 
 
 /*******************************************************************************
@@ -208,6 +350,25 @@ UINT32 GKI_get_os_tick_count(void)
     return (gki_cb.com.OSTicks);
 }
 
+/*******************************************************************************
+**
+** Function         GKI_get_os_time_us
+**
+** Description      This function returns a free running CLOCK_MONOTONIC time in
+**                  microseconds, to time operations shorter than a tick. It
+**                  wraps after about 71 minutes; use differences only.
+**
+** Returns          Time in microseconds
+**
+*******************************************************************************/
+UINT32 GKI_get_os_time_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((UINT32)now.tv_sec * 1000000 + (UINT32)(now.tv_nsec / 1000));
+}
+
 /*******************************************************************************
 **
 ** Function         GKI_create_task
@@ -406,6 +567,16 @@ void GKI_shutdown(void)
     *p_run_cond = GKI_TIMER_TICK_EXIT_COND;
     if (oldCOnd == GKI_TIMER_TICK_STOP_COND)
         pthread_cond_signal( &gki_cb.os.gki_timer_cond );
+#if (GKI_TICKLESS_TIMER == TRUE)
+    if (gki_cb.os.timer_fd >= 0)
+    {
+        /* fire immediately so that GKI_run sees the exit condition */
+        struct itimerspec its;
+        memset(&its, 0, sizeof(its));
+        its.it_value.tv_nsec = 1;
+        timerfd_settime(gki_cb.os.timer_fd, 0, &its, NULL);
+    }
+#endif
 
 }
 
@@ -513,8 +684,10 @@ void timer_thread(signed long id)
 void GKI_run (void *p_task_id)
 {
     GKI_TRACE_1("%s enter", __func__);
+#if !defined(NO_GKI_RUN_RETURN) && (GKI_TICKLESS_TIMER != TRUE)
     struct timespec delay;
     int err = 0;
+#endif
     volatile int * p_run_cond = &gki_cb.os.no_timer_suspend;
 
 #ifndef GKI_NO_TICK_STOP
@@ -547,6 +720,35 @@ void GKI_run (void *p_task_id)
             GKI_TRACE_1("pthread_setname_np in %s failed",__FUNCTION__);
         }
     }
+#elif (GKI_TICKLESS_TIMER == TRUE)
+    GKI_TRACE_2("GKI_run tickless, run_cond(%x)=%d ", p_run_cond, *p_run_cond);
+    gki_timer_rearm();
+    while (GKI_TIMER_TICK_EXIT_COND != *p_run_cond)
+    {
+        UINT64 expirations;
+
+        /* blocks until the next timer expiry, indefinitely if none is running */
+        if (read(gki_cb.os.timer_fd, &expirations, sizeof(expirations)) < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            GKI_TRACE_ERROR_1("GKI_run: timerfd read failed, errno=%d", errno);
+            break;
+        }
+
+        if (GKI_TIMER_TICK_EXIT_COND == *p_run_cond)
+            break; //GKI has shutdown
+
+        GKI_disable();
+        gki_timer_sync();
+        gki_timer_rearm();
+        GKI_enable();
+    }
+
+    GKI_disable();
+    close(gki_cb.os.timer_fd);
+    gki_cb.os.timer_fd = -1;
+    GKI_enable();
 #else
     GKI_TRACE_2("GKI_run, run_cond(%x)=%d ", p_run_cond, *p_run_cond);
     for (;GKI_TIMER_TICK_EXIT_COND != *p_run_cond;)
@@ -893,17 +1095,25 @@ UINT8 GKI_isend_event (UINT8 task_id, UINT16 event)
 UINT8 GKI_get_taskid (void)
 {
     int i;
+    pthread_t thread_id;
+
+    if (gki_cur_taskid != GKI_TASKID_UNKNOWN)
+        return (gki_cur_taskid);
 
-    pthread_t thread_id = pthread_self( );
+    /* Not a GKI task entry: look the thread up once. A thread that is not a
+    ** GKI task now never becomes one, so a miss is cached as well. */
+    thread_id = pthread_self( );
     for (i = 0; i < GKI_MAX_TASKS; i++) {
         if (gki_cb.os.thread_id[i] == thread_id) {
             GKI_TRACE_2("GKI_get_taskid %x %d done", thread_id, i);
+            gki_cur_taskid = i;
             return(i);
         }
     }
 
     GKI_TRACE_1("GKI_get_taskid: thread id = %x, task id = -1", thread_id);
 
+    gki_cur_taskid = (UINT8) -1;
     return(-1);
 }
 
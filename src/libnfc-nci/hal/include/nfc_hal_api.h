@@ -104,6 +104,12 @@ typedef void (tHAL_NFC_STATUS_CBACK) (tHAL_NFC_STATUS status);
 typedef void (tHAL_NFC_CBACK) (UINT8 event, tHAL_NFC_STATUS status);
 typedef void (tHAL_NFC_DATA_CBACK) (UINT16 data_len, UINT8   *p_data);
 
+/* Zero-copy receive: the HAL asks the stack for a buffer of at least buf_len
+** bytes to read the next packet into, and hands it back filled (data_len > 0)
+** or unused (data_len 0). p_owner identifies the buffer to the stack. */
+typedef UINT8 *(tHAL_NFC_RX_BUF_ALLOC) (UINT16 buf_len, void **pp_owner);
+typedef void (tHAL_NFC_RX_BUF_CBACK) (void *p_owner, UINT16 data_len);
+
 /*******************************************************************************
 ** tHAL_NFC_ENTRY HAL entry-point lookup table
 *******************************************************************************/
@@ -114,10 +120,13 @@ typedef void (tHAL_API_OPEN) (tHAL_NFC_CBACK *p_hal_cback, tHAL_NFC_DATA_CBACK *
 typedef void (tHAL_API_CLOSE) (void);
 typedef void (tHAL_API_CORE_INITIALIZED) (UINT8 *p_core_init_rsp_params);
 typedef void (tHAL_API_WRITE) (UINT16 data_len, UINT8 *p_data);
+/* Write of one NCI packet given as a header and a payload, not contiguous */
+typedef void (tHAL_API_WRITE_V) (UINT16 hdr_len, UINT8 *p_hdr, UINT16 data_len, UINT8 *p_data);
 typedef BOOLEAN (tHAL_API_PREDISCOVER) (void);
 typedef void (tHAL_API_CONTROL_GRANTED) (void);
 typedef void (tHAL_API_POWER_CYCLE) (void);
 typedef UINT8 (tHAL_API_GET_MAX_NFCEE) (void);
+typedef void (tHAL_API_SET_RX_BUF_CBACKS) (tHAL_NFC_RX_BUF_ALLOC *p_alloc, tHAL_NFC_RX_BUF_CBACK *p_cback);
 /*
  * The callback passed in from the NFC stack that the HAL
  * can use to pass events back to the stack.
@@ -130,6 +139,13 @@ typedef void (nfc_stack_callback_t) (nfc_event_t event, nfc_status_t event_statu
  */
 typedef void (nfc_stack_data_callback_t) (UINT16 data_len, UINT8* p_data);
 
+/*
+ * The callbacks passed in from the NFC stack that the HAL can use to read
+ * incoming data straight into stack buffers (see tHAL_NFC_RX_BUF_ALLOC).
+ */
+typedef tHAL_NFC_RX_BUF_ALLOC nfc_stack_rx_buf_alloc_t;
+typedef tHAL_NFC_RX_BUF_CBACK nfc_stack_rx_buf_callback_t;
+
 #define NFC_HAL_DM_PRE_SET_MEM_LEN  5
 typedef struct
 {
@@ -161,6 +177,8 @@ typedef struct
     tHAL_API_CONTROL_GRANTED *control_granted;
     tHAL_API_POWER_CYCLE *power_cycle;
     tHAL_API_GET_MAX_NFCEE *get_max_ee;
+    tHAL_API_SET_RX_BUF_CBACKS *set_rx_buf_cbacks;  /* optional, may be NULL */
+    tHAL_API_WRITE_V *write_v;                      /* optional, may be NULL */
 } tHAL_NFC_ENTRY;
 
 /*******************************************************************************
@@ -97,6 +97,8 @@ private:
     tHAL_NFC_ENTRY   mHalEntryFuncs; // function pointers for HAL entry points
     static tHAL_NFC_CBACK* mHalCallback;
     static tHAL_NFC_DATA_CBACK* mHalDataCallback;
+    static tHAL_NFC_RX_BUF_ALLOC* mHalRxBufAlloc;
+    static tHAL_NFC_RX_BUF_CBACK* mHalRxBufCallback;
     static ThreadCondVar mHalOpenCompletedEvent;
     static ThreadCondVar mHalCloseCompletedEvent;
 #if(NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
@@ -117,10 +119,12 @@ private:
     static void HalClose ();
     static void HalCoreInitialized (UINT8* p_core_init_rsp_params);
     static void HalWrite (UINT16 data_len, UINT8* p_data);
+    static void HalWriteV (UINT16 hdr_len, UINT8* p_hdr, UINT16 data_len, UINT8* p_data);
     static BOOLEAN HalPrediscover ();
     static void HalControlGranted ();
     static void HalPowerCycle ();
     static UINT8 HalGetMaxNfcee ();
+    static void HalSetRxBufCallbacks (tHAL_NFC_RX_BUF_ALLOC* p_alloc, tHAL_NFC_RX_BUF_CBACK* p_cback);
     static void HalDownloadFirmwareCallback (nfc_event_t event, nfc_status_t event_status);
     static void HalDownloadFirmwareDataCallback (UINT16 data_len, UINT8* p_data);
 };
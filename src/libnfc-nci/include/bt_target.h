@@ -540,8 +540,12 @@ BT_API extern void HCILL_RegState( tHCILL_STATE_CBACK *p_cback);
 /* if BRCM_USE_DELAY is FALSE then it should have 10 millisecond resolution  */
 /* if none of them is included then QUICK_TIMER_TICKS_PER_SEC is set to 0 to exclude quick timer */
 #ifndef QUICK_TIMER_TICKS_PER_SEC
+#if (GKI_TICKLESS_TIMER == TRUE) && (TICKS_PER_SEC == 1000)
+#define QUICK_TIMER_TICKS_PER_SEC   1000      /* 1ms timer */
+#else
 #define QUICK_TIMER_TICKS_PER_SEC   100       /* 10ms timer */
 #endif
+#endif
 
 /******************************************************************************
 **
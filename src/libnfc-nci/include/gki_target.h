@@ -146,10 +146,27 @@
 #define GKI_NUM_TIMERS              3
 #endif
 
-/* A conversion value for translating ticks to calculate GKI timer.  */
+/* TRUE to drive the GKI timers from a single CLOCK_MONOTONIC timerfd armed to
+** the next expiry, instead of a periodic TICKS_PER_SEC heartbeat. */
+#ifndef GKI_TICKLESS_TIMER
+#define GKI_TICKLESS_TIMER          TRUE
+#endif
+
+/* A conversion value for translating ticks to calculate GKI timer.
+** Without a heartbeat, millisecond ticks do not cost any extra wakeups. */
 #ifndef TICKS_PER_SEC
+#if (GKI_TICKLESS_TIMER == TRUE)
+#define TICKS_PER_SEC               1000
+#else
 #define TICKS_PER_SEC               100
 #endif
+#endif
+
+/* TRUE to back TIMER_LIST_Q with a hierarchical timing wheel (O(1) start/stop)
+** instead of the delta-encoded sorted list. */
+#ifndef GKI_TIMER_WHEEL
+#define GKI_TIMER_WHEEL             FALSE
+#endif
 
 /* delay in ticks before stopping system tick. */
 #ifndef GKI_DELAY_STOP_SYS_TICK
@@ -358,10 +375,11 @@ over HCI data and intentionally kept out of order */
 #endif
 
 
-/* The following pool is a dedicated pool for HDP
+/* The following pool is a dedicated pool for the extended length
+   commands of the Type 4 Tag reader (NFC_RW_EXT_POOL_ID)
    If a shared pool is more desirable then
-   1. set BTA_HL_LRG_DATA_POOL_ID to the desired Gki Pool ID
-   2. make sure that the shared pool size is larger than 9472
+   1. set NFC_RW_EXT_POOL_ID to the desired Gki Pool ID
+   2. make sure that the shared pool size is larger than GKI_BUF2_SIZE
    3. adjust GKI_NUM_FIXED_BUF_POOLS accordingly since
       POOL ID 7 is not needed
 */
@@ -371,10 +389,14 @@ over HCI data and intentionally kept out of order */
 #define GKI_POOL_ID_7               7
 #endif
 
-/* The size of the buffers in pool 7 */
+/* The size of the buffers in pool 7: a 32 KiB UpdateBinary and its headers */
 #ifndef GKI_BUF7_SIZE
+#if(NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
+#define GKI_BUF7_SIZE               (0x8000 + 0x40)
+#else
 #define GKI_BUF7_SIZE               9472
 #endif
+#endif
 
 /* The number of buffers in buffer pool 7. */
 #ifndef GKI_BUF7_MAX
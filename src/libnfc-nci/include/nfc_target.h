@@ -137,6 +137,15 @@
 #define NFC_RW_POOL_BUF_SIZE       GKI_BUF2_SIZE
 #endif
 
+/* Reader/Write commands with an extended length (T4T UpdateBinary) */
+#ifndef NFC_RW_EXT_POOL_ID
+#define NFC_RW_EXT_POOL_ID         GKI_POOL_ID_7
+#endif
+
+#ifndef NFC_RW_EXT_POOL_BUF_SIZE
+#define NFC_RW_EXT_POOL_BUF_SIZE   GKI_BUF7_SIZE
+#endif
+
 /* Card Emulation responses (NCI data payload) */
 #ifndef NFC_CE_POOL_ID
 #define NFC_CE_POOL_ID             GKI_POOL_ID_2
@@ -147,6 +156,19 @@
 #endif
 
 
+/* TRUE to let the HAL read received NCI packets straight into NFC_NCI_POOL_ID
+** buffers instead of copying them in nfc_main_hal_data_cback */
+#ifndef NFC_RX_ZERO_COPY
+#define NFC_RX_ZERO_COPY            FALSE
+#endif
+
+/* Max fragments of a chained data packet held as received. Beyond it they
+** are merged into one GKI_MAX_BUF_SIZE buffer, so that a long chain (e.g. an
+** extended-length R-APDU) does not run the NCI pool dry */
+#ifndef NFC_RAS_MAX_FRAGMENTS
+#define NFC_RAS_MAX_FRAGMENTS       16
+#endif
+
 /* NCI msg pool for HAL (for shared NFC/HAL GKI)*/
 #ifndef NFC_HAL_NCI_POOL_ID
 #define NFC_HAL_NCI_POOL_ID         NFC_NCI_POOL_ID
@@ -236,7 +258,9 @@
 #define NCI_MAX_CONN_CBS        4
 #endif
 
-/* Maximum number of NCI commands that the NFCC accepts without needing to wait for response */
+/* Maximum number of NCI commands that the NFCC accepts without needing to wait for response.
+** NCI allows a single outstanding command; above 1, CORE_GET_CONFIG and
+** proprietary commands of different GIDs are pipelined (see nfc_ncif.c) */
 #ifndef NCI_MAX_CMD_WINDOW
 #define NCI_MAX_CMD_WINDOW      1
 #endif
@@ -296,6 +320,13 @@
 #define RW_T2T_TOUT_RESP            150 /* Android requires 150 instead of 100 for presence-check*/
 #endif
 
+/* Max bytes asked with one T2T FAST_READ, a multiple of the 4 byte block.
+** The answer and the status byte of the Frame RF interface fit in one NCI
+** data packet */
+#ifndef RW_T2T_FAST_READ_MAX_LEN
+#define RW_T2T_FAST_READ_MAX_LEN    240
+#endif
+
 /* RW Type 2 Tag timeout for each API call, in ms */
 #ifndef RW_T2T_SEC_SEL_TOUT_RESP
 #define RW_T2T_SEC_SEL_TOUT_RESP    10
@@ -333,6 +364,12 @@
 #define RW_T4T_TOUT_RESP            1000
 #endif
 
+/* RW Type 4 Tag additional timeout per KiB of C-APDU or R-APDU data, in ms.
+** Covers the RF transfer of extended length APDUs at 106 kbps */
+#ifndef RW_T4T_TOUT_RESP_PER_KB
+#define RW_T4T_TOUT_RESP_PER_KB     100
+#endif
+
 /* CE Type 4 Tag timeout for update file, in ms */
 #ifndef CE_T4T_TOUT_UPDATE
 #define CE_T4T_TOUT_UPDATE          1000
@@ -358,16 +395,28 @@
 #define RW_I93_FLAG_DATA_RATE       I93_FLAG_DATA_RATE_HIGH
 #endif
 
+/* Number of ISO 15693 tags whose Read Multiple Blocks size, found smaller
+** than the cap of their product, is remembered (least recently used first
+** out) */
+#ifndef RW_I93_READ_SIZE_CACHE_SIZE
+#define RW_I93_READ_SIZE_CACHE_SIZE 8
+#endif
+
 /* TRUE, to include Card Emulation related test commands */
 #ifndef CE_TEST_INCLUDED
 #define CE_TEST_INCLUDED            FALSE
 #endif
 
 
-/* Quick Timer */
+/* Quick Timer. With tickless GKI timers the quick timer is a one-shot to the
+** head of its list rather than a heartbeat, so it can use 1ms units. */
 #ifndef QUICK_TIMER_TICKS_PER_SEC
+#if (GKI_TICKLESS_TIMER == TRUE) && (TICKS_PER_SEC == 1000)
+#define QUICK_TIMER_TICKS_PER_SEC   1000      /* 1ms timer */
+#else
 #define QUICK_TIMER_TICKS_PER_SEC   100       /* 10ms timer */
 #endif
+#endif
 
 
 /******************************************************************************
@@ -95,8 +95,8 @@ typedef struct nfa_dm_p2p_prio_logic
 
 static nfa_dm_p2p_prio_logic_t p2p_prio_logic_data;
 
-#define P2P_RESUME_POLL_TIMEOUT 16 /*mili second timeout value*/
-static UINT16 P2P_PRIO_LOGIC_CLEANUP_TIMEOUT = 50; /*timeout value 500 ms for p2p_prio_logic_cleanup*/
+#define P2P_RESUME_POLL_TIMEOUT ((160 * QUICK_TIMER_TICKS_PER_SEC) / 1000) /*160 mili second timeout value*/
+static UINT16 P2P_PRIO_LOGIC_CLEANUP_TIMEOUT = (500 * QUICK_TIMER_TICKS_PER_SEC) / 1000; /*timeout value 500 ms for p2p_prio_logic_cleanup*/
 #endif
 BOOLEAN etsi_reader_in_progress = FALSE;
 /*******************************************************************************
@@ -3371,7 +3371,7 @@ BOOLEAN nfa_dm_p2p_prio_logic(UINT8 event, UINT8 *p, UINT8 ntf_rsp)
     if(event == NCI_MSG_RF_DISCOVER && p2p_prio_logic_data.timer_expired == 1 && ntf_rsp == 1)
     {
         NFA_TRACE_DEBUG0("nfa_dm_p2p_prio_logic starting a timer for next rf intf activated ntf");
-        P2P_PRIO_LOGIC_CLEANUP_TIMEOUT = (nfa_dm_act_get_rf_disc_duration()/10); /*timeout value 50 ms multiplied by 10 for p2p_prio_logic_cleanup*/
+        P2P_PRIO_LOGIC_CLEANUP_TIMEOUT = (nfa_dm_act_get_rf_disc_duration() * QUICK_TIMER_TICKS_PER_SEC) / 1000; /*timeout value of the RF discovery duration for p2p_prio_logic_cleanup*/
 
         nfc_start_quick_timer (&p2p_prio_logic_data.timer_list,
                         NFC_TTYPE_P2P_PRIO_LOGIC_CLEANUP, P2P_PRIO_LOGIC_CLEANUP_TIMEOUT);
@@ -816,6 +816,18 @@ static void nfa_rw_handle_t2t_evt (tRW_EVENT event, tRW_DATA *p_rw_data)
         break;
 
     case RW_T2T_NDEF_READ_EVT:              /* NDEF read completed     */
+        if (  (p_rw_data->status != NFC_STATUS_OK)
+            &&(nfa_rw_cb.halt_event == RW_T2T_NDEF_READ_EVT)
+            &&(nfa_rw_cb.cur_op == NFA_RW_OP_READ_NDEF)
+            &&(RW_T2tIsNDefReadRetry ())  )
+        {
+            /* Tag woken up after NACKing FAST_READ: detect and read NDEF again, with READ */
+            NFA_TRACE_DEBUG0("nfa_rw_handle_t2t_evt(); Reading NDEF again after wake up from HALT");
+            nfa_rw_free_ndef_rx_buf ();
+            if (nfa_rw_start_ndef_detection () == NFC_STATUS_OK)
+                break;
+        }
+
         if (p_rw_data->status == NFC_STATUS_OK)
         {
             /* Process the ndef record */
@@ -1731,7 +1743,7 @@ static tNFC_STATUS nfa_rw_start_ndef_write(void)
             break;
 
         case NFC_PROTOCOL_ISO_DEP:     /* ISODEP/4A,4B- NFC-A or NFC-B */
-            status = RW_T4tUpdateNDef((UINT16)nfa_rw_cb.ndef_wr_len, nfa_rw_cb.p_ndef_wr_buf);
+            status = RW_T4tUpdateNDef(nfa_rw_cb.ndef_wr_len, nfa_rw_cb.p_ndef_wr_buf);
             break;
 
         case NFC_PROTOCOL_15693:       /* ISO 15693 */
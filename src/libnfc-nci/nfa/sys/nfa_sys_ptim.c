@@ -49,19 +49,16 @@ void nfa_sys_ptim_init (tPTIM_CB *p_cb, UINT16 period, UINT8 timer_id)
 
 /*******************************************************************************
 **
-** Function         nfa_sys_ptim_timer_update
+** Function         nfa_sys_ptim_sync
 **
-** Description      Update the protocol timer list and handle expired timers.
-**                  This function is called from the task running the protocol
-**                  timers when the periodic GKI timer expires.
+** Description      Move the protocol timer list on by the milliseconds elapsed
+**                  since it was last updated.
 **
 ** Returns          void
 **
 *******************************************************************************/
-void nfa_sys_ptim_timer_update (tPTIM_CB *p_cb)
+static void nfa_sys_ptim_sync (tPTIM_CB *p_cb)
 {
-    TIMER_LIST_ENT *p_tle;
-    BT_HDR *p_msg;
     UINT32 new_ticks_count;
     INT32  period_in_ticks;
 
@@ -85,12 +82,53 @@ void nfa_sys_ptim_timer_update (tPTIM_CB *p_cb)
     GKI_update_timer_list (&p_cb->timer_queue, GKI_TICKS_TO_MS (period_in_ticks));
 
     p_cb->last_gki_ticks = new_ticks_count;
+}
+
+#if (GKI_TICKLESS_TIMER == TRUE)
+/*******************************************************************************
+**
+** Function         nfa_sys_ptim_arm
+**
+** Description      Start the GKI timer as a one-shot to the next update of the
+**                  protocol timer list, instead of a periodic timer that wakes
+**                  up every period while timers are pending.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_sys_ptim_arm (tPTIM_CB *p_cb)
+{
+    UINT32 ms = GKI_timer_list_next_update (&p_cb->timer_queue);
+
+    if (ms > 0x7FFFFFFF)
+        ms = 0x7FFFFFFF;
+
+    GKI_start_timer (p_cb->timer_id, (INT32) GKI_MS_TO_TICKS (ms), FALSE);
+}
+#endif
+
+/*******************************************************************************
+**
+** Function         nfa_sys_ptim_timer_update
+**
+** Description      Update the protocol timer list and handle expired timers.
+**                  This function is called from the task running the protocol
+**                  timers when the GKI timer expires.
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfa_sys_ptim_timer_update (tPTIM_CB *p_cb)
+{
+    TIMER_LIST_ENT *p_tle;
+    BT_HDR *p_msg;
+
+    nfa_sys_ptim_sync (p_cb);
 
     /* while there are expired timers */
-    while ((p_cb->timer_queue.p_first) && (p_cb->timer_queue.p_first->ticks <= 0))
+    while (((p_tle = GKI_timer_getfirst (&p_cb->timer_queue)) != NULL) && (p_tle->ticks <= 0))
     {
         /* removed expired timer from list */
-        p_tle = p_cb->timer_queue.p_first;
         NFA_TRACE_DEBUG1 ("nfa_sys_ptim_timer_update expired: %08x", p_tle);
         GKI_remove_from_timer_list (&p_cb->timer_queue, p_tle);
 
@@ -111,11 +149,17 @@ void nfa_sys_ptim_timer_update (tPTIM_CB *p_cb)
     }
 
     /* if timer list is empty stop periodic GKI timer */
-    if (p_cb->timer_queue.p_first == NULL)
+    if (GKI_timer_list_empty (&p_cb->timer_queue))
     {
         NFA_TRACE_DEBUG0 ("ptim timer stop");
         GKI_stop_timer (p_cb->timer_id);
     }
+#if (GKI_TICKLESS_TIMER == TRUE)
+    else
+    {
+        nfa_sys_ptim_arm (p_cb);
+    }
+#endif
 }
 
 /*******************************************************************************
@@ -133,12 +177,21 @@ void nfa_sys_ptim_start_timer (tPTIM_CB *p_cb, TIMER_LIST_ENT *p_tle, UINT16 typ
     NFA_TRACE_DEBUG1 ("nfa_sys_ptim_start_timer %08x", p_tle);
 
     /* if timer list is currently empty, start periodic GKI timer */
-    if (p_cb->timer_queue.p_first == NULL)
+    if (GKI_timer_list_empty (&p_cb->timer_queue))
     {
         NFA_TRACE_DEBUG0 ("ptim timer start");
         p_cb->last_gki_ticks = GKI_get_tick_count ();
+#if (GKI_TICKLESS_TIMER != TRUE)
         GKI_start_timer (p_cb->timer_id, GKI_MS_TO_TICKS (p_cb->period), TRUE);
+#endif
     }
+#if (GKI_TICKLESS_TIMER == TRUE)
+    else
+    {
+        /* bring the list up to date before the entry is placed in it */
+        nfa_sys_ptim_sync (p_cb);
+    }
+#endif
 
     GKI_remove_from_timer_list (&p_cb->timer_queue, p_tle);
 
@@ -146,6 +199,10 @@ void nfa_sys_ptim_start_timer (tPTIM_CB *p_cb, TIMER_LIST_ENT *p_tle, UINT16 typ
     p_tle->ticks = timeout;
 
     GKI_add_to_timer_list (&p_cb->timer_queue, p_tle);
+
+#if (GKI_TICKLESS_TIMER == TRUE)
+    nfa_sys_ptim_arm (p_cb);
+#endif
 }
 
 /*******************************************************************************
@@ -164,7 +221,7 @@ void nfa_sys_ptim_stop_timer (tPTIM_CB *p_cb, TIMER_LIST_ENT *p_tle)
     GKI_remove_from_timer_list (&p_cb->timer_queue, p_tle);
 
     /* if timer list is empty stop periodic GKI timer */
-    if (p_cb->timer_queue.p_first == NULL)
+    if (GKI_timer_list_empty (&p_cb->timer_queue))
     {
         NFA_TRACE_DEBUG0 ("ptim timer stop");
         GKI_stop_timer (p_cb->timer_id);
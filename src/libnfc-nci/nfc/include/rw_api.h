@@ -579,6 +579,20 @@ NFC_API extern tNFC_STATUS RW_T2tDetectNDef (BOOLEAN skip_dyn_locks);
 *******************************************************************************/
 NFC_API extern tNFC_STATUS RW_T2tReadNDef (UINT8 *p_buffer, UINT16 buf_len);
 
+/*******************************************************************************
+**
+** Function         RW_T2tIsNDefReadRetry
+**
+** Description      Checks if the last NDEF read failed because the tag went to
+**                  HALT state after NACKing NXP GET_VERSION or FAST_READ, and
+**                  the tag has been woken up since. The NDEF read can then be
+**                  started again; it uses READ only.
+**
+** Returns          TRUE if the NDEF read can be started again
+**
+*******************************************************************************/
+NFC_API extern BOOLEAN RW_T2tIsNDefReadRetry (void);
+
 /*******************************************************************************
 **
 ** Function         RW_T2tWriteNDef
@@ -939,7 +953,7 @@ NFC_API extern tNFC_STATUS RW_T4tReadNDef (void);
 **                  NFC_STATUS_FAILED if T4T is busy or other error
 **
 *******************************************************************************/
-NFC_API extern tNFC_STATUS RW_T4tUpdateNDef (UINT16 length, UINT8 *p_data);
+NFC_API extern tNFC_STATUS RW_T4tUpdateNDef (UINT32 length, UINT8 *p_data);
 
 /*****************************************************************************
 **
@@ -198,6 +198,8 @@
 #define T2T_CMD_READ            0x30    /* read  4 blocks (16 bytes) */
 #define T2T_CMD_WRITE           0xA2    /* write 1 block  (4 bytes)  */
 #define T2T_CMD_SEC_SEL         0xC2    /* Sector select             */
+#define T2T_CMD_GET_VERSION     0x60    /* NXP: product version      */
+#define T2T_CMD_FAST_READ       0x3A    /* NXP: read a block range   */
 #define T2T_RSP_ACK             0xA
 #define T2T_RSP_NACK5           0x5
 #define T2T_RSP_NACK1           0x1     /* Nack can be either 1    */
@@ -208,6 +210,14 @@
 #define T2T_READ_DATA_LEN       (T2T_BLOCK_LEN * T2T_READ_BLOCKS)
 #define T2T_WRITE_DATA_LEN      4
 
+/* GET_VERSION response of NXP tags */
+#define T2T_GET_VERSION_RSP_LEN         8
+#define T2T_GET_VERSION_VENDOR_BYTE     1
+#define T2T_GET_VERSION_PROD_TYPE_BYTE  2
+#define T2T_VERSION_VENDOR_NXP          0x04
+#define T2T_VERSION_PROD_ULTRALIGHT     0x03  /* MIFARE Ultralight EV1 */
+#define T2T_VERSION_PROD_NTAG           0x04  /* NTAG21x, NTAG I2C     */
+
 
 /* Type 2 TLV definitions */
 #define T2T_TLV_TYPE_NULL         0     /* May be used for padding. SHALL ignore this */
@@ -347,7 +357,9 @@ typedef UINT8 tT3T_POLL_RC;
 */
 #define T4T_CMD_MIN_HDR_SIZE            4       /* CLA, INS, P1, P2 */
 #define T4T_CMD_MAX_HDR_SIZE            5       /* CLA, INS, P1, P2, Lc */
+#define T4T_CMD_MAX_EXT_HDR_SIZE        7       /* CLA, INS, P1, P2, extended Lc (00, Lc1, Lc2) */
 
+#define T4T_VERSION_3_0                 0x30    /* version 3.0 */
 #define T4T_VERSION_2_0                 0x20    /* version 2.0 */
 #define T4T_VERSION_1_0                 0x10    /* version 1.0 */
 #define T4T_MY_VERSION                  T4T_VERSION_2_0
@@ -358,6 +370,8 @@ typedef UINT8 tT3T_POLL_RC;
 #define T4T_CMD_INS_SELECT              0xA4
 #define T4T_CMD_INS_READ_BINARY         0xB0
 #define T4T_CMD_INS_UPDATE_BINARY       0xD6
+#define T4T_CMD_INS_READ_BINARY_ODO     0xB1    /* ReadBinary, offset in a data object (V3.0) */
+#define T4T_CMD_INS_UPDATE_BINARY_ODO   0xD7    /* UpdateBinary, offset in a data object (V3.0) */
 #if(NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
 #define T4T_CMD_DES_CLASS               0x90
 #define T4T_CMD_INS_GET_HW_VERSION      0x60
@@ -373,6 +387,15 @@ typedef UINT8 tT3T_POLL_RC;
 
 #define T4T_MAX_LENGTH_LE               0xFF    /* Max number of bytes to be read from file in ReadBinary Command */
 #define T4T_MAX_LENGTH_LC               0xFF    /* Max number of bytes written to NDEF file in UpdateBinary Command */
+#define T4T_MAX_LENGTH_LE_EXT           0x10000 /* Max number of bytes read with an extended Le (coded 0x0000) */
+#define T4T_MAX_LENGTH_LC_EXT           0xFFFF  /* Max number of bytes written with an extended Lc */
+#define T4T_MAX_OFFSET_IN_P1P2          0x7FFF  /* Max file offset of ReadBinary/UpdateBinary without ODO */
+
+#define T4T_ODO_TAG                     0x54    /* Offset Data Object */
+#define T4T_ODO_LENGTH                  0x03    /* offset coded on 3 bytes */
+#define T4T_ODO_SIZE                    0x05    /* size of T(1),L(1),V(3) for ODO */
+#define T4T_DDO_TAG                     0x53    /* Discretionary Data Object */
+#define T4T_DDO_MAX_HDR_SIZE            0x04    /* size of T(1) and L(1 to 3) for DDO */
 
 #define T4T_RSP_STATUS_WORDS_SIZE       0x02
 
@@ -396,18 +419,26 @@ typedef UINT8 tT3T_POLL_RC;
 #define T4T_VERSION_OFFSET_IN_CC          0x02
 #define T4T_FC_TLV_OFFSET_IN_CC           0x07
 #define T4T_FC_WRITE_ACCESS_OFFSET_IN_TLV 0x07  /* Offset of Write access byte from type field in CC */
+#define T4T_EFC_WRITE_ACCESS_OFFSET_IN_TLV 0x09 /* Offset of Write access byte from type field in CC (ENDEF) */
 
 #define T4T_NDEF_FILE_CONTROL_TYPE      0x04    /* NDEF File Control Type */
 #define T4T_PROP_FILE_CONTROL_TYPE      0x05    /* Proprietary File Control Type */
+#define T4T_ENDEF_FILE_CONTROL_TYPE     0x06    /* Extended NDEF File Control Type (V3.0) */
 
 #define T4T_FILE_CONTROL_TLV_SIZE       0x08    /* size of T(1),L(1),V(6) for file control */
 #define T4T_FILE_CONTROL_LENGTH         0x06    /* size of V(6) for file control */
+#define T4T_ENDEF_FILE_CONTROL_LENGTH   0x08    /* size of V(8) for extended file control */
 
 #define T4T_FC_READ_ACCESS              0x00    /* read access granted without any security */
 #define T4T_FC_WRITE_ACCESS             0x00    /* write access granted without any security */
 #define T4T_FC_NO_WRITE_ACCESS          0xFF    /* no write access granted at all (read-only) */
 
 #define T4T_FILE_LENGTH_SIZE            0x02
+#define T4T_EFILE_LENGTH_SIZE           0x04    /* ENLEN of the ENDEF file */
+
+#define T4T_HIS_CATEGORY_COMPACT_TLV    0x80    /* historical bytes hold COMPACT-TLV data objects */
+#define T4T_HIS_CARD_CAPABILITIES_TAG   0x07    /* card capabilities data object */
+#define T4T_HIS_CARD_CAP_EXT_LEN        0x40    /* 3rd byte: extended Lc and Le fields supported */
 #if(NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
 #define T4T_ADDI_FRAME_RESP             0xAFU
 #define T4T_SIZE_IDENTIFIER_2K          0x16U
@@ -511,17 +542,30 @@ typedef UINT8 tT3T_POLL_RC;
 #define I93_CMD_GET_SYS_INFO                0x2B    /* Get system information             */
 #define I93_CMD_GET_MULTI_BLK_SEC           0x2C    /* Get multiple block security status */
 
+/* ISO 15693 Extended commands, 2 bytes block numbers (ISO/IEC 15693-3:2019) */
+#define I93_CMD_EXT_READ_SINGLE_BLOCK       0x30    /* Extended read single block     */
+#define I93_CMD_EXT_WRITE_SINGLE_BLOCK      0x31    /* Extended write single block    */
+#define I93_CMD_EXT_READ_MULTI_BLOCK        0x33    /* Extended read multiple blocks  */
+#define I93_CMD_EXT_GET_SYS_INFO            0x3B    /* Extended get system information             */
+#define I93_CMD_EXT_GET_MULTI_BLK_SEC       0x3C    /* Extended get multiple block security status */
+
 /* Information flags definition */
 #define I93_INFO_FLAG_DSFID                 0x01    /* DSFID is supported and DSFID field is present */
 #define I93_INFO_FLAG_AFI                   0x02    /* AFI is supported and AFI field is present     */
 #define I93_INFO_FLAG_MEM_SIZE              0x04    /* VICC memory size field is present             */
 #define I93_INFO_FLAG_IC_REF                0x08    /* IC reference field is present                 */
 
+/* Parameter of Extended Get System Information, same bits as information flags */
+#define I93_EXT_SYS_INFO_REQ                (I93_INFO_FLAG_DSFID | I93_INFO_FLAG_AFI | I93_INFO_FLAG_MEM_SIZE | I93_INFO_FLAG_IC_REF)
+
 #define I93_MAX_BLOCK_LENGH                 32      /* Max block size in bytes */
 #define I93_MAX_NUM_BLOCK                   256     /* Max number of blocks    */
 
 /* ICODE Capability Container(CC) definition */
 #define I93_ICODE_CC_MAGIC_NUMER            0xE1    /* magic number in CC[0]  */
+#define I93_ICODE_CC_MAGIC_NUMER_E2         0xE2    /* magic number in CC[0], 2 bytes addresses */
+#define I93_ICODE_CC_8BYTE_MLEN             0x00    /* CC[2] of 8 bytes CC, MLEN in CC[6..7]    */
+#define I93_ICODE_CC_8BYTE_LEN              8       /* length of 8 bytes CC                     */
 #define I93_ICODE_CC_MAJOR_VER_MASK         0xC0    /* major version in CC[1] */
 #define I93_ICODE_CC_MINOR_VER_MASK         0x30    /* minor version in CC[1] */
 #define I93_ICODE_CC_READ_ACCESS_MASK       0x0C    /* read access condition in CC[1]        */
@@ -579,6 +623,7 @@ typedef UINT8 tT3T_POLL_RC;
 #define I93_IC_REF_STM_M24LR04E_R               0x5A    /* IC Reference for M24LR04E-R: 01011010(b), blockSize: 4, numberBlocks: 0x80 */
 #define I93_IC_REF_STM_M24LR16E_R               0x4E    /* IC Reference for M24LR16E-R: 01001110(b), blockSize: 4, numberBlocks: 0x200 */
 #define I93_IC_REF_STM_M24LR64E_R               0x5E    /* IC Reference for M24LR64E-R: 01011110(b), blockSize: 4, numberBlocks: 0x800 */
+#define I93_IC_REF_STM_ST25DV                   0x24    /* IC Reference for ST25DV:     001001xx(b), blockSize: 4, numberBlocks: 0x80 to 0x800 */
 
 #define I93_STM_BLOCKS_PER_SECTOR               32
 #define I93_STM_MAX_BLOCKS_PER_READ             32
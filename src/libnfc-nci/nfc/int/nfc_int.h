@@ -140,6 +140,8 @@ typedef struct
     tNFC_CONN_CBACK *p_cback;   /* the callback function to receive the data        */
     BUFFER_Q    tx_q;           /* transmit queue                                   */
     BUFFER_Q    rx_q;           /* receive queue                                    */
+    BUFFER_Q    ras_q;          /* fragments of the chained packet being received   */
+    UINT16      ras_len;        /* payload length of the fragments in ras_q         */
     UINT8       id;             /* NFCEE ID or RF Discovery ID or NFC_TEST_ID       */
     UINT8       act_protocol;   /* the active protocol on this logical connection   */
     UINT8       conn_id;        /* the connection id assigned by NFCC for this conn */
@@ -175,6 +177,8 @@ typedef void (tNFC_PWR_ST_CBACK) (void);
 /* data Reassembly error (in BT_HDR.layer_specific) */
 #define NFC_RAS_TOO_BIG             0x08
 #define NFC_RAS_FRAGMENTED          0x01
+/* fragments already merged into the first buffer of ras_q */
+#define NFC_RAS_MERGED              0x02
 
 /* NCI command buffer contains a VSC (in BT_HDR.layer_specific) */
 #define NFC_WAIT_RSP_VSC            0x01
@@ -182,6 +186,21 @@ typedef void (tNFC_PWR_ST_CBACK) (void);
 #define NFC_WAIT_RSP_NXP            0x02
 #endif
 
+/* NCI command sent to the NFCC and waiting for its response.
+** With NCI_MAX_CMD_WINDOW above 1, commands that do not change the NFCC state
+** may overlap as long as no two outstanding commands share a GID, so that a
+** response is matched to its command by GID and OID alone. */
+typedef struct
+{
+    BOOLEAN             in_use;
+    UINT8               hdr[NFC_SAVED_HDR_SIZE];    /* header of the command */
+    UINT8               cmd[NFC_SAVED_CMD_SIZE];    /* start of the command payload */
+    UINT8               len;                        /* payload length of the command */
+    UINT8               layer_specific;             /* NFC_WAIT_RSP_* of the command */
+    void               *p_vsc_cback;                /* callback of a VSC command */
+    TIMER_LIST_ENT      timer;                      /* timer waiting for the response */
+} tNFC_NCI_PENDING_CMD;
+
 typedef struct
 {
     UINT8               data_ntf_timeout;           /* indicates credit ntf timeout occured         */
@@ -245,7 +264,8 @@ typedef struct
     BUFFER_Q            nci_cmd_recov_xmit_q;     /* NCI recovery command queue */
     TIMER_LIST_ENT      listen_activation_timer_list;           /* Timer for monitoring listen activation */
 #endif
-    TIMER_LIST_ENT      nci_wait_rsp_timer; /* Timer for waiting for nci command response */
+    tNFC_NCI_PENDING_CMD nci_pending[NCI_MAX_CMD_WINDOW]; /* commands waiting for a response */
+    UINT8               nci_rsp_slot;       /* nci_pending index of the response being processed */
     TIMER_LIST_ENT      nci_wait_data_ntf_timer; /* Timer for waiting for core credit ntf*/
     UINT16              nci_wait_rsp_tout;  /* NCI command timeout (in ms) */
     UINT8               nci_wait_rsp;       /* layer_specific for last NCI message */
@@ -255,6 +275,11 @@ typedef struct
     BT_HDR              *p_nci_init_rsp;    /* holding INIT_RSP until receiving HAL_NFC_POST_INIT_CPLT_EVT */
     tHAL_NFC_ENTRY      *p_hal;
     i2c_data            i2c_data_t;         /* holding i2c fragmentation data */
+    UINT32              rx_copy_count;      /* received packets copied into a GKI buffer */
+    UINT32              rx_zero_copy_count; /* received packets read straight into a GKI buffer */
+    UINT32              tx_gather_count;    /* data fragments sent without a copy in a GKI buffer */
+    UINT32              ras_copy_count;     /* chained data packets copied into one buffer */
+    UINT32              ras_copy_bytes;     /* payload bytes copied by the data reassembly */
 } tNFC_CB;
 
 
@@ -288,6 +313,8 @@ NFC_API extern void nfc_data_event (tNFC_CONN_CB * p_cb);
 void nfc_ncif_send (BT_HDR *p_buf, BOOLEAN is_cmd);
 extern UINT8 nfc_ncif_send_data (tNFC_CONN_CB *p_cb, BT_HDR *p_data);
 NFC_API extern void nfc_ncif_cmd_timeout (void);
+NFC_API extern void nfc_ncif_rsp_timeout (TIMER_LIST_ENT *p_tle);
+NFC_API extern void nfc_ncif_clear_pending_cmds (void);
 NFC_API extern void nfc_wait_2_deactivate_timeout (void);
 NFC_API extern void nfc_ncif_credit_ntf_timeout (void);
 NFC_API extern BOOLEAN nfc_ncif_process_event (BT_HDR *p_msg);
@@ -296,6 +296,14 @@ typedef UINT8 tRW_T2T_LOCK_STATUS;
 #define RW_T2T_SUBSTATE_WAIT_SET_DYN_LOCK_BITS          0x1B    /* waiting for response to set dynamic lock bits            */
 #define RW_T2T_SUBSTATE_WAIT_SET_ST_LOCK_BITS           0x1C    /* waiting for response to set static lock bits             */
 
+/* Sub states in RW_T2T_STATE_READ_NDEF state */
+#define RW_T2T_SUBSTATE_WAIT_GET_VERSION                0x1D    /* waiting for response to GET_VERSION (FAST_READ support)  */
+
+/* FAST_READ support of the activated tag */
+#define RW_T2T_FAST_READ_UNKNOWN                        0x00    /* not checked yet                                          */
+#define RW_T2T_FAST_READ_SUPPORTED                      0x01
+#define RW_T2T_FAST_READ_NOT_SUPPORTED                  0x02
+
 typedef struct
 {
     UINT16              offset;                             /* Offset of the lock byte in the Tag                       */
@@ -339,6 +347,8 @@ typedef struct
     BOOLEAN             b_read_data;                        /* Tag data block read from tag                                 */
     BOOLEAN             b_hard_lock;                        /* Hard lock the tag as part of config tag to Read only         */
     BOOLEAN             check_tag_halt;                     /* Resent command after NACK rsp to find tag is in HALT State   */
+    UINT8               fast_read;                          /* RW_T2T_FAST_READ_xxx                                         */
+    UINT16              fast_read_len;                      /* Bytes asked by the FAST_READ command in progress             */
 #if (defined (RW_NDEF_INCLUDED) && (RW_NDEF_INCLUDED == TRUE))
     BOOLEAN             skip_dyn_locks;                     /* Skip reading dynamic lock bytes from the tag                 */
     UINT8               found_tlv;                          /* The Tlv found while searching a particular TLV               */
@@ -444,13 +454,20 @@ typedef struct
 /* Max data size using a single UpdateBinary. 6 bytes are for CLA, INS, P1, P2, Lc */
 #define RW_T4T_MAX_DATA_PER_WRITE          (NFC_RW_POOL_BUF_SIZE - BT_HDR_SIZE - NCI_MSG_OFFSET_SIZE - NCI_DATA_HDR_SIZE - T4T_CMD_MAX_HDR_SIZE)
 
+/* Max data size using a single ReadBinary with an extended Le. The R-APDU is
+** reassembled by NFC in one buffer, so the biggest GKI buffer bounds it */
+#define RW_T4T_MAX_DATA_PER_EXT_READ       (GKI_MAX_BUF_SIZE - BT_HDR_SIZE - NFC_RECEIVE_MSGS_OFFSET - NCI_DATA_HDR_SIZE - T4T_RSP_STATUS_WORDS_SIZE)
+
+/* Max data size using a single UpdateBinary with an extended Lc (NFC_RW_EXT_POOL_ID) */
+#define RW_T4T_MAX_DATA_PER_EXT_WRITE      (NFC_RW_EXT_POOL_BUF_SIZE - BT_HDR_SIZE - NCI_MSG_OFFSET_SIZE - NCI_DATA_HDR_SIZE - T4T_CMD_MAX_EXT_HDR_SIZE)
+
 
 
 /* Mandatory NDEF file control */
 typedef struct
 {
     UINT16              file_id;        /* File Identifier          */
-    UINT16              max_file_size;  /* Max NDEF file size       */
+    UINT32              max_file_size;  /* Max NDEF file size       */
     UINT8               read_access;    /* read access condition    */
     UINT8               write_access;   /* write access condition   */
 } tRW_T4T_NDEF_FC;
@@ -476,10 +493,10 @@ typedef struct
     UINT8               version;            /* currently effective version      */
     TIMER_LIST_ENT      timer;              /* timeout for each API call        */
 
-    UINT16              ndef_length;        /* length of NDEF data              */
+    UINT32              ndef_length;        /* length of NDEF data              */
     UINT8              *p_update_data;      /* pointer of data to update        */
-    UINT16              rw_length;          /* remaining bytes to read/write    */
-    UINT16              rw_offset;          /* remaining offset to read/write   */
+    UINT32              rw_length;          /* remaining bytes to read/write    */
+    UINT32              rw_offset;          /* remaining offset to read/write   */
     BT_HDR             *p_data_to_free;     /* GKI buffet to delete after done  */
 
     tRW_T4T_CC          cc_file;            /* Capability Container File        */
@@ -489,9 +506,11 @@ typedef struct
 
     UINT8               ndef_status;        /* bitmap for NDEF status           */
     UINT8               channel;            /* channel id: used for read-binary */
+    UINT8               nlen_size;          /* size of NLEN (ENLEN for ENDEF)   */
+    BOOLEAN             ext_len_allowed;    /* ATS does not rule out extended Lc/Le */
 
-    UINT16              max_read_size;      /* max reading size per a command   */
-    UINT16              max_update_size;    /* max updating size per a command  */
+    UINT32              max_read_size;      /* max reading size per a command   */
+    UINT32              max_update_size;    /* max updating size per a command  */
 #if (NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
     UINT16              card_size;
     UINT8               card_type;
@@ -522,6 +541,8 @@ typedef UINT8 tRW_I93_RW_SUBSTATE;
 #define RW_I93_FLAG_RESET_DSFID         0x04    /* need to reset DSFID for formatting      */
 #define RW_I93_FLAG_RESET_AFI           0x08    /* need to reset AFI for formatting        */
 #define RW_I93_FLAG_16BIT_NUM_BLOCK     0x10    /* use 2 bytes for number of blocks        */
+#define RW_I93_FLAG_EXT_COMMANDS        0x20    /* use extended commands for block numbers */
+#define RW_I93_FLAG_READ_SIZE_PROBED    0x40    /* tag rejected a Read Multiple Blocks     */
 
 #define RW_I93_TLV_DETECT_STATE_TYPE      0x01  /* searching for type                      */
 #define RW_I93_TLV_DETECT_STATE_LENGTH_1  0x02  /* searching for the first byte of length  */
@@ -546,6 +567,7 @@ enum
     RW_I93_STM_M24LR04E_R,              /* STM M24LR04E-R                   */
     RW_I93_STM_M24LR16E_R,              /* STM M24LR16E-R                   */
     RW_I93_STM_M24LR64E_R,              /* STM M24LR64E-R                   */
+    RW_I93_STM_ST25DV,                  /* STM ST25DV04K, ST25DV16K, ST25DV64K */
     RW_I93_UNKNOWN_PRODUCT              /* Unknwon product version          */
 };
 
@@ -581,8 +603,22 @@ typedef struct
     UINT8              *p_update_data;          /* pointer of data to update        */
     UINT16              rw_length;              /* bytes to read/write              */
     UINT16              rw_offset;              /* offset to read/write             */
+
+    UINT8               max_read_blocks;        /* blocks per Read Multiple Blocks  */
+    UINT16              read_blocks;            /* blocks asked by the pending read */
+    UINT32              read_start_us;          /* GKI_get_os_time_us at the read   */
+    UINT32              read_time_us;           /* time spent reading in procedure  */
+    UINT16              read_cmds;              /* reads sent in procedure          */
+    UINT16              read_total_blocks;      /* blocks read in procedure         */
 } tRW_I93_CB;
 
+/* Read Multiple Blocks size found for an ISO 15693 tag */
+typedef struct
+{
+    UINT8               uid[I93_UID_BYTE_LEN];  /* UID, unused if uid[0] is not I93_UID_FIRST_BYTE */
+    UINT8               max_blocks;             /* blocks the tag accepts in one read              */
+} tRW_I93_READ_SIZE;
+
 /* RW memory control blocks */
 typedef union
 {
@@ -599,6 +635,9 @@ typedef struct
     tRW_TCB             tcb;
     tRW_CBACK           *p_cback;
     UINT32              cur_retry;          /* Retry count for the current operation */
+    tRW_I93_READ_SIZE   i93_read_size[RW_I93_READ_SIZE_CACHE_SIZE]; /* most recently used first */
+    BOOLEAN             t2t_no_fast_read;   /* T2T NACKed GET_VERSION/FAST_READ, kept across wake up from HALT */
+    BOOLEAN             t2t_ndef_read_halt; /* T2T went to HALT on the READ sent after that NACK */
 #if (defined (RW_STATS_INCLUDED) && (RW_STATS_INCLUDED == TRUE))
     tRW_STATS           stats;
 #endif  /* RW_STATS_INCLUDED */
@@ -642,13 +681,17 @@ extern void rw_t1t_handle_op_complete (void);
 #if (defined (RW_NDEF_INCLUDED) && (RW_NDEF_INCLUDED == TRUE))
 extern tRW_EVENT rw_t2t_info_to_event (const tT2T_CMD_RSP_INFO *p_info);
 extern void rw_t2t_handle_rsp (UINT8 *p_data);
+extern BOOLEAN rw_t2t_handle_fast_read_error (BOOLEAN nack);
 #else
 #define rw_t2t_info_to_event(p)             t2t_info_to_evt (p)
 #define rw_t2t_handle_rsp(p)
+#define rw_t2t_handle_fast_read_error(n)    FALSE
 #endif
 
 extern tNFC_STATUS rw_t2t_sector_change (UINT8 sector);
 extern tNFC_STATUS rw_t2t_read (UINT16 block);
+extern tNFC_STATUS rw_t2t_get_version (void);
+extern tNFC_STATUS rw_t2t_fast_read (UINT16 block, UINT16 num_blocks);
 extern tNFC_STATUS rw_t2t_write (UINT16 block, UINT8 *p_write_data);
 extern void rw_t2t_process_timeout (TIMER_LIST_ENT *p_tle);
 extern tNFC_STATUS rw_t2t_select (void);
@@ -658,7 +701,7 @@ extern void rw_t3t_process_timeout (TIMER_LIST_ENT *p_tle);
 extern tNFC_STATUS rw_t3t_select (UINT8 peer_nfcid2[NCI_RF_F_UID_LEN], UINT8 mrti_check, UINT8 mrti_update);
 void rw_t3t_handle_nci_poll_ntf (UINT8 nci_status, UINT8 num_responses, UINT8 sensf_res_buf_size, UINT8 *p_sensf_res_buf);
 
-extern tNFC_STATUS rw_t4t_select (void);
+extern tNFC_STATUS rw_t4t_select (tNFC_ACTIVATE_DEVT *p_activate_params);
 extern void rw_t4t_process_timeout (TIMER_LIST_ENT *p_tle);
 
 extern tNFC_STATUS rw_i93_select (UINT8 *p_uid);
@@ -582,8 +582,8 @@ void nfc_main_flush_cmd_queue (void)
     /* initialize command window */
     nfc_cb.nci_cmd_window = NCI_MAX_CMD_WINDOW;
 
-    /* Stop command-pending timer */
-    nfc_stop_timer(&nfc_cb.nci_wait_rsp_timer);
+    /* Stop command-pending timers */
+    nfc_ncif_clear_pending_cmds ();
 
     /* dequeue and free buffer */
     while ((p_msg = (BT_HDR *)GKI_dequeue (&nfc_cb.nci_cmd_xmit_q)) != NULL)
@@ -719,6 +719,7 @@ static void nfc_main_hal_data_cback(UINT16 data_len, UINT8   *p_data)
 
             /* no need to check length, it always less than pool size */
             memcpy ((UINT8 *)(p_msg + 1) + p_msg->offset, p_data, p_msg->len);
+            nfc_cb.rx_copy_count++;
 
             GKI_send_msg (NFC_TASK, NFC_MBOX_ID, p_msg);
         }
@@ -729,6 +730,66 @@ static void nfc_main_hal_data_cback(UINT16 data_len, UINT8   *p_data)
     }
 }
 
+#if (NFC_RX_ZERO_COPY == TRUE)
+/*******************************************************************************
+**
+** Function         nfc_main_hal_rx_buf_alloc
+**
+** Description      HAL asks for a GKI buffer to read the next NCI packet into
+**
+** Returns          start of the data area, or NULL if none is available
+**
+*******************************************************************************/
+static UINT8 *nfc_main_hal_rx_buf_alloc (UINT16 buf_len, void **pp_owner)
+{
+    BT_HDR *p_msg;
+
+    if (BT_HDR_SIZE + NFC_RECEIVE_MSGS_OFFSET + buf_len > NFC_NCI_POOL_BUF_SIZE)
+    {
+        NFC_TRACE_ERROR1 ("nfc_main_hal_rx_buf_alloc (): %d bytes do not fit", buf_len);
+        return NULL;
+    }
+
+    if ((p_msg = (BT_HDR *) GKI_getpoolbuf (NFC_NCI_POOL_ID)) == NULL)
+    {
+        return NULL;
+    }
+
+    p_msg->offset = NFC_RECEIVE_MSGS_OFFSET;
+    *pp_owner     = p_msg;
+
+    return ((UINT8 *)(p_msg + 1) + p_msg->offset);
+}
+
+/*******************************************************************************
+**
+** Function         nfc_main_hal_rx_buf_cback
+**
+** Description      HAL gives back a buffer from nfc_main_hal_rx_buf_alloc,
+**                  holding data_len bytes of NCI packet, or unused if 0
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfc_main_hal_rx_buf_cback (void *p_owner, UINT16 data_len)
+{
+    BT_HDR *p_msg = (BT_HDR *) p_owner;
+
+    /* ignore all data while shutting down NFCC */
+    if ((data_len == 0) || (nfc_cb.nfc_state == NFC_STATE_W4_HAL_CLOSE))
+    {
+        GKI_freebuf (p_msg);
+        return;
+    }
+
+    p_msg->len   = data_len;
+    p_msg->event = BT_EVT_TO_NFC_NCI;
+    nfc_cb.rx_zero_copy_count++;
+
+    GKI_send_msg (NFC_TASK, NFC_MBOX_ID, p_msg);
+}
+#endif
+
 /*******************************************************************************
 **
 ** Function         NFC_Enable
@@ -806,6 +867,11 @@ void NFC_Disable (void)
         return;
     }
 
+    NFC_TRACE_DEBUG3 ("NFC_Disable (): rx packets copied: %u, zero-copy: %u, tx fragments gathered: %u",
+                      nfc_cb.rx_copy_count, nfc_cb.rx_zero_copy_count, nfc_cb.tx_gather_count);
+    NFC_TRACE_DEBUG2 ("NFC_Disable (): chained packets reassembled: %u, bytes copied: %u",
+                      nfc_cb.ras_copy_count, nfc_cb.ras_copy_bytes);
+
     /* Close transport and clean up */
     nfc_task_shutdown_nfcc ();
 }
@@ -836,8 +902,13 @@ void NFC_Init (tHAL_NFC_ENTRY *p_hal_entry_tbl)
 
     /* NCI init */
     nfc_cb.p_hal            = p_hal_entry_tbl;
+#if (NFC_RX_ZERO_COPY == TRUE)
+    if (p_hal_entry_tbl->set_rx_buf_cbacks)
+        p_hal_entry_tbl->set_rx_buf_cbacks (nfc_main_hal_rx_buf_alloc, nfc_main_hal_rx_buf_cback);
+#endif
     nfc_cb.nfc_state        = NFC_STATE_NONE;
     nfc_cb.nci_cmd_window   = NCI_MAX_CMD_WINDOW;
+    nfc_cb.nci_rsp_slot     = NCI_MAX_CMD_WINDOW;
     nfc_cb.nci_wait_rsp_tout= NFC_CMD_CMPL_TIMEOUT;
     nfc_cb.p_disc_maps      = nfc_interface_mapping;
     nfc_cb.trace_level      = NFC_INITIAL_TRACE_LEVEL;
@@ -84,6 +84,186 @@ UINT8 nfcc_dh_conn_id;
 #endif
 extern etsi_reader_in_progress;
 void disc_deact_ntf_timeout_handler(tNFC_RESPONSE_EVT event);
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_cmd_may_overlap
+**
+** Description      Check if a command may be outstanding together with other
+**                  commands. Only commands that do not change the NFCC state
+**                  and are not tracked for recovery qualify.
+**
+** Returns          TRUE if the command may overlap
+**
+*******************************************************************************/
+static BOOLEAN nfc_ncif_cmd_may_overlap (UINT8 *p_hdr, UINT8 layer_specific)
+{
+    UINT8 gid = p_hdr[0] & NCI_GID_MASK;
+    UINT8 oid = p_hdr[1] & NCI_OID_MASK;
+
+#if(NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
+    /* the response of an NXP command is taken from the next message received */
+    if (layer_specific == NFC_WAIT_RSP_NXP)
+        return FALSE;
+    /* saved in full for recovery */
+    if ((gid == NCI_GID_PROP) && (oid == 0x15))
+        return FALSE;
+#else
+    (void) layer_specific;
+#endif
+    if (gid == NCI_GID_PROP)
+        return TRUE;
+    return ((gid == NCI_GID_CORE) && (oid == NCI_MSG_CORE_GET_CONFIG));
+}
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_cmd_may_send
+**
+** Description      Check if a command may be sent while the commands in
+**                  nci_pending wait for their response
+**
+** Returns          TRUE if the command may be sent now
+**
+*******************************************************************************/
+static BOOLEAN nfc_ncif_cmd_may_send (BT_HDR *p_buf)
+{
+    UINT8 *p_hdr = (UINT8 *)(p_buf + 1) + p_buf->offset;
+    tNFC_NCI_PENDING_CMD *p_pend;
+    BOOLEAN overlap = nfc_ncif_cmd_may_overlap (p_hdr, p_buf->layer_specific);
+    int xx;
+
+    for (xx = 0; xx < NCI_MAX_CMD_WINDOW; xx++)
+    {
+        p_pend = &nfc_cb.nci_pending[xx];
+        if (!p_pend->in_use)
+            continue;
+        if (  (!overlap)
+            ||(!nfc_ncif_cmd_may_overlap (p_pend->hdr, p_pend->layer_specific))
+            ||((p_pend->hdr[0] & NCI_GID_MASK) == (p_hdr[0] & NCI_GID_MASK))  )
+            return FALSE;
+    }
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_find_pending_cmd
+**
+** Description      Find the outstanding command of a response. A GID/OID of 0xFF
+**                  matches any command.
+**
+** Returns          index in nci_pending, NCI_MAX_CMD_WINDOW if not found
+**
+*******************************************************************************/
+static UINT8 nfc_ncif_find_pending_cmd (UINT8 gid, UINT8 oid)
+{
+    tNFC_NCI_PENDING_CMD *p_pend;
+    UINT8 xx;
+
+    for (xx = 0; xx < NCI_MAX_CMD_WINDOW; xx++)
+    {
+        p_pend = &nfc_cb.nci_pending[xx];
+        if (  (p_pend->in_use)
+            &&((gid == 0xFF) || ((p_pend->hdr[0] & NCI_GID_MASK) == gid))
+            &&((oid == 0xFF) || ((p_pend->hdr[1] & NCI_OID_MASK) == oid))  )
+            break;
+    }
+    return xx;
+}
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_find_pending_cmd_slot
+**
+** Description      Find a free entry in nci_pending. There is one as long as
+**                  the command window is open.
+**
+** Returns          index in nci_pending, NCI_MAX_CMD_WINDOW if all are in use
+**
+*******************************************************************************/
+static UINT8 nfc_ncif_find_pending_cmd_slot (void)
+{
+    UINT8 xx;
+
+    for (xx = 0; xx < NCI_MAX_CMD_WINDOW; xx++)
+    {
+        if (!nfc_cb.nci_pending[xx].in_use)
+            return xx;
+    }
+    return NCI_MAX_CMD_WINDOW;
+}
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_restore_pending_cmd
+**
+** Description      Make an outstanding command the last command, for the
+**                  response handlers and the recovery
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfc_ncif_restore_pending_cmd (UINT8 slot)
+{
+    tNFC_NCI_PENDING_CMD *p_pend;
+
+    if (slot >= NCI_MAX_CMD_WINDOW)
+        return;
+    p_pend = &nfc_cb.nci_pending[slot];
+    memcpy (nfc_cb.last_hdr, p_pend->hdr, NFC_SAVED_HDR_SIZE);
+    memcpy (nfc_cb.last_cmd, p_pend->cmd, NFC_SAVED_CMD_SIZE);
+#if(NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
+    nfc_cb.cmd_size = p_pend->len;
+#endif
+    nfc_cb.p_vsc_cback = p_pend->p_vsc_cback;
+}
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_rsp_timeout
+**
+** Description      Handle the response timeout of an outstanding command
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfc_ncif_rsp_timeout (TIMER_LIST_ENT *p_tle)
+{
+    UINT8 xx;
+
+    for (xx = 0; xx < NCI_MAX_CMD_WINDOW; xx++)
+    {
+        if (nfc_cb.nci_pending[xx].in_use && (p_tle == &nfc_cb.nci_pending[xx].timer))
+        {
+            nfc_ncif_restore_pending_cmd (xx);
+            break;
+        }
+    }
+    nfc_ncif_cmd_timeout ();
+}
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_clear_pending_cmds
+**
+** Description      Forget all outstanding commands
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfc_ncif_clear_pending_cmds (void)
+{
+    UINT8 xx;
+
+    for (xx = 0; xx < NCI_MAX_CMD_WINDOW; xx++)
+    {
+        nfc_stop_timer (&nfc_cb.nci_pending[xx].timer);
+        nfc_cb.nci_pending[xx].in_use = FALSE;
+    }
+    nfc_cb.nci_rsp_slot = NCI_MAX_CMD_WINDOW;
+}
+
 /*******************************************************************************
 **
 ** Function         nfc_ncif_update_window
@@ -95,6 +275,8 @@ void disc_deact_ntf_timeout_handler(tNFC_RESPONSE_EVT event);
 *********************************************************************************/
 void nfc_ncif_update_window (void)
 {
+    UINT8 slot;
+
     /* Sanity check - see if we were expecting a update_window */
     if (nfc_cb.nci_cmd_window == NCI_MAX_CMD_WINDOW)
     {
@@ -105,8 +287,17 @@ void nfc_ncif_update_window (void)
         return;
     }
 
-    /* Stop command-pending timer */
-    nfc_stop_timer (&nfc_cb.nci_wait_rsp_timer);
+    /* Release the command answered, or the oldest one */
+    slot = nfc_cb.nci_rsp_slot;
+    if ((slot >= NCI_MAX_CMD_WINDOW) || (!nfc_cb.nci_pending[slot].in_use))
+        slot = nfc_ncif_find_pending_cmd (0xFF, 0xFF);
+    if (slot < NCI_MAX_CMD_WINDOW)
+    {
+        /* Stop command-pending timer */
+        nfc_stop_timer (&nfc_cb.nci_pending[slot].timer);
+        nfc_cb.nci_pending[slot].in_use = FALSE;
+    }
+    nfc_cb.nci_rsp_slot = NCI_MAX_CMD_WINDOW;
 
     nfc_cb.p_vsc_cback = NULL;
     nfc_cb.nci_cmd_window++;
@@ -172,7 +363,19 @@ void nfc_ncif_cmd_timeout (void)
         UINT8 bufflen = 0xFF;
         tNFC_STATUS status = NFC_STATUS_FAILED;
         tNFC_CONN_CB * p_cb;
-        nfc_stop_timer (&nfc_cb.nci_wait_rsp_timer);
+        UINT8 xx;
+
+        /* Only the last command is sent again, others are lost with the reset */
+        for (xx = 0; xx < NCI_MAX_CMD_WINDOW; xx++)
+        {
+            nfc_stop_timer (&nfc_cb.nci_pending[xx].timer);
+            if (  (nfc_cb.nci_pending[xx].in_use)
+                &&(memcmp (nfc_cb.nci_pending[xx].hdr, nfc_cb.last_hdr, NFC_SAVED_HDR_SIZE))  )
+            {
+                nfc_cb.nci_pending[xx].in_use = FALSE;
+                nfc_cb.nci_cmd_window++;
+            }
+        }
 
         buffer = (UINT8 *) malloc(bufflen*sizeof(UINT8 *));
         if(NULL == buffer)
@@ -307,6 +510,7 @@ UINT8 nfc_ncif_send_data (tNFC_CONN_CB *p_cb, BT_HDR *p_data)
     UINT8 *ps;
     UINT8   ulen = NCI_MAX_PAYLOAD_SIZE;
     BT_HDR *p;
+    UINT8   hdr[NCI_DATA_HDR_SIZE];
     UINT8   pbf = 1;
     UINT8   buffer_size = p_cb->buff_size;
     UINT8   hdr0 = p_cb->conn_id;
@@ -386,6 +590,33 @@ UINT8 nfc_ncif_send_data (tNFC_CONN_CB *p_cb, BT_HDR *p_data)
             p         = p_data;
             p_data    = (BT_HDR *)GKI_dequeue (&p_cb->tx_q);
         }
+        else if (nfc_cb.p_hal->write_v)
+        {
+            /* the HAL gathers the header and the slice of the original buffer,
+             * which is released with the last fragment */
+            pp = hdr;
+            NCI_DATA_PBLD_HDR(pp, pbf, hdr0, ulen);
+            ps = (UINT8 *)(p_data + 1) + p_data->offset;
+
+            if (p_cb->num_buff != NFC_CONN_NO_FC)
+                p_cb->num_buff--;
+
+            /* send to HAL */
+            nfc_cb.p_hal->write_v (NCI_DATA_HDR_SIZE, hdr, ulen, ps);
+            nfc_cb.tx_gather_count++;
+
+            /* adjust the BT_HDR on the old fragment */
+            p_data->len     -= ulen;
+            p_data->offset  += ulen;
+
+            /* start NFC data ntf timeout timer */
+            if( get_i2c_fragmentation_enabled () == I2C_FRAGMENATATION_ENABLED)
+            {
+                nfc_start_timer (&nfc_cb.nci_wait_data_ntf_timer, (UINT16)(NFC_TTYPE_NCI_WAIT_DATA_NTF), NFC_NCI_WAIT_DATA_NTF_TOUT );
+                nfc_cb.nci_cmd_window--;
+            }
+            continue;
+        }
         else
         {
             /* the data packet is too big and need to be fragmented
@@ -474,11 +705,13 @@ void nfc_ncif_empty_data_queue ()
 void nfc_ncif_check_cmd_queue (BT_HDR *p_buf)
 {
     UINT8   *ps;
+    UINT8   slot;
+    tNFC_NCI_PENDING_CMD *p_pend;
     /* If there are commands waiting in the xmit queue, or if the controller cannot accept any more commands, */
     /* then enqueue this command */
     if (p_buf)
     {
-        if ((nfc_cb.nci_cmd_xmit_q.count) || (nfc_cb.nci_cmd_window == 0))
+        if ((nfc_cb.nci_cmd_xmit_q.count) || (nfc_cb.nci_cmd_window == 0) || (!nfc_ncif_cmd_may_send (p_buf)))
         {
             GKI_enqueue (&nfc_cb.nci_cmd_xmit_q, p_buf);
 #if (NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
@@ -492,15 +725,29 @@ void nfc_ncif_check_cmd_queue (BT_HDR *p_buf)
         }
     }
 
-    /* If controller can accept another command, then send the next command */
-    if (nfc_cb.nci_cmd_window > 0)
+    /* While controller can accept another command, send the next command */
+    while (nfc_cb.nci_cmd_window > 0)
     {
         /* If no command was provided, or if older commands were in the queue, then get cmd from the queue */
         if (!p_buf)
+        {
+            p_buf = (BT_HDR *)GKI_getfirst (&nfc_cb.nci_cmd_xmit_q);
+            /* keep the order: stop at a command that must wait for the outstanding ones */
+            if ((!p_buf) || (!nfc_ncif_cmd_may_send (p_buf)))
+                break;
             p_buf = (BT_HDR *)GKI_dequeue (&nfc_cb.nci_cmd_xmit_q);
+        }
 
         if (p_buf)
         {
+            /* the window and nci_pending are out of step: keep the command for later */
+            slot = nfc_ncif_find_pending_cmd_slot ();
+            if (slot == NCI_MAX_CMD_WINDOW)
+            {
+                NFC_TRACE_ERROR1 ("nfc_ncif_check_cmd_queue: no free pending slot, window %d", nfc_cb.nci_cmd_window);
+                GKI_enqueue_head (&nfc_cb.nci_cmd_xmit_q, p_buf);
+                break;
+            }
 #if (NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
 
             /* save the message header to double check the response */
@@ -532,16 +779,25 @@ void nfc_ncif_check_cmd_queue (BT_HDR *p_buf)
             memcpy(nfc_cb.last_hdr, ps, NFC_SAVED_HDR_SIZE);
             memcpy(nfc_cb.last_cmd, ps + NCI_MSG_HDR_SIZE, NFC_SAVED_CMD_SIZE);
 #endif
+            /* remember the command until its response */
+            p_pend = &nfc_cb.nci_pending[slot];
+            p_pend->in_use         = TRUE;
+            p_pend->layer_specific = (UINT8) p_buf->layer_specific;
+            p_pend->len            = *(ps + NFC_SAVED_HDR_SIZE);
+            p_pend->p_vsc_cback    = NULL;
+            memcpy (p_pend->hdr, ps, NFC_SAVED_HDR_SIZE);
+            memcpy (p_pend->cmd, ps + NCI_MSG_HDR_SIZE, NFC_SAVED_CMD_SIZE);
+
             if (p_buf->layer_specific == NFC_WAIT_RSP_VSC)
             {
                 /* save the callback for NCI VSCs)  */
-                nfc_cb.p_vsc_cback = (void *)((tNFC_NCI_VS_MSG *)p_buf)->p_cback;
+                p_pend->p_vsc_cback = (void *)((tNFC_NCI_VS_MSG *)p_buf)->p_cback;
             }
 #if(NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
             else if (p_buf->layer_specific == NFC_WAIT_RSP_NXP)
             {
                 /* save the callback for NCI NXPs)  */
-                nfc_cb.p_vsc_cback = (void *)((tNFC_NCI_VS_MSG *)p_buf)->p_cback;
+                p_pend->p_vsc_cback = (void *)((tNFC_NCI_VS_MSG *)p_buf)->p_cback;
                 nfc_cb.nxpCbflag = TRUE;
             }
 #endif
@@ -557,8 +813,9 @@ void nfc_ncif_check_cmd_queue (BT_HDR *p_buf)
             nfc_cb.nci_cmd_window--;
 
             /* start NFC command-timeout timer */
-            nfc_start_timer (&nfc_cb.nci_wait_rsp_timer, (UINT16)(NFC_TTYPE_NCI_WAIT_RSP), nfc_cb.nci_wait_rsp_tout);
+            nfc_start_timer (&p_pend->timer, (UINT16)(NFC_TTYPE_NCI_WAIT_RSP), nfc_cb.nci_wait_rsp_tout);
         }
+        p_buf = NULL;
     }
 
     if (nfc_cb.nci_cmd_window == NCI_MAX_CMD_WINDOW)
@@ -658,7 +915,7 @@ BOOLEAN nfc_ncif_process_event (BT_HDR *p_msg)
     UINT8   mt, pbf, gid, *p, *pp;
     BOOLEAN free = TRUE;
     UINT8   oid;
-    UINT8   *p_old, old_gid, old_oid, old_mt;
+    UINT8   slot;
     p = (UINT8 *) (p_msg + 1) + p_msg->offset;
 
     pp = p;
@@ -675,6 +932,10 @@ BOOLEAN nfc_ncif_process_event (BT_HDR *p_msg)
 
     if ((nfc_cb.nxpCbflag == TRUE)&&(nfc_ncif_proc_proprietary_rsp(mt,gid,oid) == TRUE))
     {
+        /* an NXP command is never outstanding with other commands */
+        slot = nfc_ncif_find_pending_cmd (0xFF, 0xFF);
+        nfc_ncif_restore_pending_cmd (slot);
+        nfc_cb.nci_rsp_slot = slot;
         nci_proc_prop_nxp_rsp(p_msg);
         nfc_cb.nxpCbflag = FALSE;
         return (free);
@@ -693,11 +954,9 @@ BOOLEAN nfc_ncif_process_event (BT_HDR *p_msg)
     case NCI_MT_RSP:
         NFC_TRACE_DEBUG1 ("NFC received rsp gid:%d", gid);
         oid = ((*pp) & NCI_OID_MASK);
-        p_old   = nfc_cb.last_hdr;
-        NCI_MSG_PRS_HDR0(p_old, old_mt, pbf, old_gid);
-        old_oid = ((*p_old) & NCI_OID_MASK);
         /* make sure this is the RSP we are waiting for before updating the command window */
-        if ((old_gid != gid) || (old_oid != oid))
+        slot = nfc_ncif_find_pending_cmd (gid, oid);
+        if (slot >= NCI_MAX_CMD_WINDOW)
         {
             if(((gid == NCI_GID_RF_MANAGE)&&(oid == NCI_MSG_RF_DISCOVER)) && (etsi_reader_in_progress == TRUE))
             {
@@ -706,6 +965,7 @@ BOOLEAN nfc_ncif_process_event (BT_HDR *p_msg)
                 nfa_dm_cb.disc_cb.disc_flags &= ~(NFA_DM_DISC_FLAGS_W4_NTF | NFA_DM_DISC_FLAGS_STOPPING);
                 nfa_dm_cb.disc_cb.disc_flags |= (NFA_DM_DISC_FLAGS_W4_RSP|NFA_DM_DISC_FLAGS_NOTIFY|NFA_DM_DISC_FLAGS_ENABLED);
                 disc_deact_ntf_timeout_handler(NFC_NFCC_TIMEOUT_REVT);
+                slot = nfc_ncif_find_pending_cmd (0xFF, 0xFF);
             }
             else
             {
@@ -713,6 +973,9 @@ BOOLEAN nfc_ncif_process_event (BT_HDR *p_msg)
             return TRUE;
             }
         }
+        /* the response handlers find the command in last_hdr/last_cmd */
+        nfc_ncif_restore_pending_cmd (slot);
+        nfc_cb.nci_rsp_slot = slot;
 
         switch (gid)
         {
@@ -2016,6 +2279,168 @@ void nfc_data_event (tNFC_CONN_CB * p_cb)
     }
 }
 
+/*******************************************************************************
+**
+** Function         nfc_ncif_ras_copy
+**
+** Description      Copy the fragments chained on the reassembly queue of the
+**                  connection into one new buffer of the given size. The NCI
+**                  header of the first fragment is kept; its pbf and len are
+**                  stripped off at NFC_DATA_CEVT.
+**
+** Returns          the new buffer, or NULL if it cannot be allocated (the
+**                  fragments are left on the queue)
+**
+*******************************************************************************/
+static BT_HDR *nfc_ncif_ras_copy (tNFC_CONN_CB *p_cb, UINT32 size)
+{
+    BT_HDR  *p_first = (BT_HDR *) GKI_getfirst (&p_cb->ras_q);
+    BT_HDR  *p_frag, *p_ras;
+    UINT8   *pd;
+
+    if (  (size > GKI_MAX_BUF_SIZE)
+        ||((p_ras = (BT_HDR *) GKI_getbuf ((UINT16) size)) == NULL)  )
+    {
+        return NULL;
+    }
+
+    memcpy (p_ras, p_first, BT_HDR_SIZE);
+    pd = (UINT8 *) (p_ras + 1) + p_ras->offset;
+    memcpy (pd, (UINT8 *) (p_first + 1) + p_first->offset, NCI_MSG_HDR_SIZE);
+    pd += NCI_MSG_HDR_SIZE;
+
+    while ((p_frag = (BT_HDR *) GKI_dequeue (&p_cb->ras_q)) != NULL)
+    {
+        memcpy (pd, (UINT8 *) (p_frag + 1) + p_frag->offset + NCI_MSG_HDR_SIZE,
+                p_frag->len - NCI_MSG_HDR_SIZE);
+        pd += p_frag->len - NCI_MSG_HDR_SIZE;
+        GKI_freebuf (p_frag);
+    }
+    p_ras->len = NCI_MSG_HDR_SIZE + p_cb->ras_len;
+
+    nfc_cb.ras_copy_bytes += p_cb->ras_len;
+    return p_ras;
+}
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_ras_add
+**
+** Description      Chain a fragment on the reassembly queue of the connection.
+**                  Once NFC_RAS_MAX_FRAGMENTS are queued they are merged into
+**                  one buffer of the biggest GKI size, and the next fragments
+**                  are copied into it as they come, so that a long chain
+**                  holds only a few receive buffers. Every byte is still
+**                  copied only once.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfc_ncif_ras_add (tNFC_CONN_CB *p_cb, BT_HDR *p_msg, BOOLEAN more)
+{
+    BT_HDR  *p_ras = (BT_HDR *) GKI_getfirst (&p_cb->ras_q);
+    UINT16  len = p_msg->len - NCI_MSG_HDR_SIZE;
+
+    if ((p_ras != NULL) && (p_ras->layer_specific & NFC_RAS_MERGED))
+    {
+        /* the caller made sure the payload fits in GKI_MAX_BUF_SIZE */
+        memcpy ((UINT8 *) (p_ras + 1) + p_ras->offset + p_ras->len,
+                (UINT8 *) (p_msg + 1) + p_msg->offset + NCI_MSG_HDR_SIZE, len);
+        p_ras->len     += len;
+        p_cb->ras_len  += len;
+        nfc_cb.ras_copy_bytes += len;
+        GKI_freebuf (p_msg);
+        return;
+    }
+
+    GKI_enqueue (&p_cb->ras_q, p_msg);
+    p_cb->ras_len += len;
+
+    if ((more) && (p_cb->ras_q.count >= NFC_RAS_MAX_FRAGMENTS))
+    {
+        /* if GKI is short of big buffers keep chaining */
+        if ((p_ras = nfc_ncif_ras_copy (p_cb, GKI_MAX_BUF_SIZE)) != NULL)
+        {
+            p_ras->layer_specific = NFC_RAS_MERGED;
+            GKI_enqueue (&p_cb->ras_q, p_ras);
+        }
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_ras_build
+**
+** Description      Reassemble the fragments chained on the reassembly queue
+**                  of the connection into one buffer, sized for the whole
+**                  payload unless they were merged already.
+**
+** Returns          the reassembled buffer, or NULL if it does not fit in a
+**                  GKI buffer (the fragments are left on the queue)
+**
+*******************************************************************************/
+static BT_HDR *nfc_ncif_ras_build (tNFC_CONN_CB *p_cb)
+{
+    BT_HDR  *p_first = (BT_HDR *) GKI_getfirst (&p_cb->ras_q);
+    BT_HDR  *p_ras;
+
+    if (p_first->layer_specific & NFC_RAS_MERGED)
+    {
+        p_ras = (BT_HDR *) GKI_dequeue (&p_cb->ras_q);
+    }
+    else if ((p_ras = nfc_ncif_ras_copy (p_cb, BT_HDR_SIZE + p_first->offset
+                                         + NCI_MSG_HDR_SIZE + p_cb->ras_len)) == NULL)
+    {
+        return NULL;
+    }
+
+    nfc_cb.ras_copy_count++;
+    p_cb->ras_len = 0;
+    return p_ras;
+}
+
+/*******************************************************************************
+**
+** Function         nfc_ncif_ras_deliver
+**
+** Description      Move the fragments chained on the reassembly queue of the
+**                  connection to its receive queue, as one buffer if possible.
+**                  When is_last is FALSE more fragments of the packet are to
+**                  come and the data is reported with status Continue.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfc_ncif_ras_deliver (tNFC_CONN_CB *p_cb, BOOLEAN is_last)
+{
+    BT_HDR  *p_buf;
+
+    if ((p_buf = nfc_ncif_ras_build (p_cb)) != NULL)
+    {
+        p_buf->layer_specific = is_last ? 0 : (NFC_RAS_FRAGMENTED | NFC_RAS_TOO_BIG);
+#ifdef DISP_NCI
+        if (is_last)
+        {
+            /* this packet was reassembled. display the complete packet */
+            DISP_NCI ((UINT8 *) (p_buf + 1) + p_buf->offset, p_buf->len, TRUE);
+        }
+#endif
+        GKI_enqueue (&p_cb->rx_q, p_buf);
+        return;
+    }
+
+    /* Not enough memory to reassemble
+     * Send the fragments as they are with status Continue */
+    NFC_TRACE_DEBUG1 ("nfc_ncif_ras_deliver %d bytes not reassembled", p_cb->ras_len);
+    while ((p_buf = (BT_HDR *) GKI_dequeue (&p_cb->ras_q)) != NULL)
+    {
+        if ((p_cb->ras_q.count != 0) || (!is_last))
+            p_buf->layer_specific = NFC_RAS_FRAGMENTED | NFC_RAS_TOO_BIG;
+        GKI_enqueue (&p_cb->rx_q, p_buf);
+    }
+    p_cb->ras_len = 0;
+}
+
 /*******************************************************************************
 **
 ** Function         nfc_ncif_proc_data
@@ -2024,6 +2449,12 @@ void nfc_data_event (tNFC_CONN_CB * p_cb)
 **                  packet. Assemble the data packet, if needed.
 **                  Report the Data event.
 **
+**                  Fragments of a chained packet are queued as received and
+**                  copied once, into a buffer of the final size, when the
+**                  last fragment arrives (or into the biggest GKI buffer as
+**                  they come, for a long chain). A packet bigger than the biggest
+**                  GKI buffer is reported in parts with status Continue.
+**
 ** Returns          void
 **
 *******************************************************************************/
@@ -2032,10 +2463,6 @@ void nfc_ncif_proc_data (BT_HDR *p_msg)
     UINT8   *pp, cid;
     tNFC_CONN_CB * p_cb;
     UINT8   pbf;
-    BT_HDR  *p_last;
-    UINT8   *ps, *pd;
-    UINT16  size;
-    BT_HDR  *p_max = NULL;
     UINT16  len;
 
     pp   = (UINT8 *) (p_msg+1) + p_msg->offset;
@@ -2055,86 +2482,45 @@ void nfc_ncif_proc_data (BT_HDR *p_msg)
 #endif
             p_msg->layer_specific   = NFC_RAS_FRAGMENTED;
         }
-        p_last = (BT_HDR *)GKI_getlast (&p_cb->rx_q);
-        if (p_last && (p_last->layer_specific & NFC_RAS_FRAGMENTED))
-        {
-            /* last data buffer is not last fragment, append this new packet to the last */
-            size = GKI_get_buf_size(p_last);
-            if (size < (BT_HDR_SIZE + p_last->len + p_last->offset + len))
-            {
-                /* the current size of p_last is not big enough to hold the new fragment, p_msg */
-                if (size != GKI_MAX_BUF_SIZE)
-                {
-                    /* try the biggest GKI pool */
-                    p_max = (BT_HDR *)GKI_getpoolbuf (GKI_MAX_BUF_SIZE_POOL_ID);
-                    if (p_max)
-                    {
-                        /* copy the content of last buffer to the new buffer */
-                        memcpy(p_max, p_last, BT_HDR_SIZE);
-                        pd  = (UINT8 *)(p_max + 1) + p_max->offset;
-                        ps  = (UINT8 *)(p_last + 1) + p_last->offset;
-                        memcpy(pd, ps, p_last->len);
-
-                        /* place the new buffer in the queue instead */
-                        GKI_remove_from_queue (&p_cb->rx_q, p_last);
-                        GKI_freebuf (p_last);
-                        GKI_enqueue (&p_cb->rx_q, p_max);
-                        p_last  = p_max;
-                    }
-                }
-                if (p_max == NULL)
-                {
-                    /* Biggest GKI Pool not available (or)
-                     * Biggest available GKI Pool is not big enough to hold the new fragment, p_msg */
-                    p_last->layer_specific  |= NFC_RAS_TOO_BIG;
-                }
-            }
 
-            ps   = (UINT8 *)(p_msg + 1) + p_msg->offset + NCI_MSG_HDR_SIZE;
-            len  = p_msg->len - NCI_MSG_HDR_SIZE;
+        /* if this is the first fragment on RF link */
+        if (  (p_msg->layer_specific & NFC_RAS_FRAGMENTED)
+            &&(p_cb->ras_q.count == 0)
+            &&(p_cb->conn_id == NFC_RF_CONN_ID)
+            &&(p_cb->p_cback)  )
+        {
+            /* Indicate upper layer that local device started receiving data */
+            (*p_cb->p_cback) (p_cb->conn_id, NFC_DATA_START_CEVT, NULL);
+        }
 
-            if (!(p_last->layer_specific & NFC_RAS_TOO_BIG))
-            {
-                pd   = (UINT8 *)(p_last + 1) + p_last->offset + p_last->len;
-                memcpy(pd, ps, len);
-                p_last->len  += len;
-                /* do not need to update pbf and len in NCI header.
-                 * They are stripped off at NFC_DATA_CEVT and len may exceed 255 */
-                NFC_TRACE_DEBUG1 ("nfc_ncif_proc_data len:%d", p_last->len);
-                p_last->layer_specific  = p_msg->layer_specific;
-                GKI_freebuf (p_msg);
-#ifdef DISP_NCI
-                if (!(p_last->layer_specific & NFC_RAS_FRAGMENTED))
-                {
-                    /* this packet was reassembled. display the complete packet */
-                    DISP_NCI ((UINT8 *)(p_last + 1) + p_last->offset, p_last->len, TRUE);
-                }
-#endif
-                nfc_data_event (p_cb);
-            }
-            else
-            {
-                /* Not enough memory to add new buffer
-                 * Send data already in queue first with status Continue */
-                nfc_data_event (p_cb);
-                /* now enqueue the new buffer to the rx queue */
-                GKI_enqueue (&p_cb->rx_q, p_msg);
-            }
+        if (  ((p_cb->ras_q.count == 0) && (!pbf))
+            ||((p_cb->conn_id == NFC_RF_CONN_ID) && (!nfc_cb.reassembly))  )
+        {
+            /* not chained, or reassembly of rf data not requested */
+            if (p_cb->ras_q.count != 0)
+                nfc_ncif_ras_deliver (p_cb, FALSE);
+            GKI_enqueue (&p_cb->rx_q, p_msg);
         }
         else
         {
-            /* if this is the first fragment on RF link */
-            if (  (p_msg->layer_specific & NFC_RAS_FRAGMENTED)
-                &&(p_cb->conn_id == NFC_RF_CONN_ID)
-                &&(p_cb->p_cback)  )
+            len = p_msg->len - NCI_MSG_HDR_SIZE;
+            if (  (p_cb->ras_q.count != 0)
+                &&(  BT_HDR_SIZE + ((BT_HDR *) GKI_getfirst (&p_cb->ras_q))->offset
+                   + NCI_MSG_HDR_SIZE + (UINT32) p_cb->ras_len + len > GKI_MAX_BUF_SIZE)  )
             {
-                /* Indicate upper layer that local device started receiving data */
-                (*p_cb->p_cback) (p_cb->conn_id, NFC_DATA_START_CEVT, NULL);
+                /* the biggest GKI buffer cannot hold the new fragment.
+                 * Send data already reassembled first with status Continue */
+                nfc_ncif_ras_deliver (p_cb, FALSE);
             }
-            /* enqueue the new buffer to the rx queue */
-            GKI_enqueue (&p_cb->rx_q, p_msg);
-            nfc_data_event (p_cb);
+
+            /* chain the new fragment; it is copied only once */
+            nfc_ncif_ras_add (p_cb, p_msg, (BOOLEAN) (pbf != 0));
+            NFC_TRACE_DEBUG1 ("nfc_ncif_proc_data len:%d", p_cb->ras_len);
+
+            if (!pbf)
+                nfc_ncif_ras_deliver (p_cb, TRUE);
         }
+        nfc_data_event (p_cb);
         return;
     }
     GKI_freebuf (p_msg);
@@ -64,6 +64,104 @@
 #include "nfa_dm_int.h"
 #endif
 
+#if (GKI_TICKLESS_TIMER == TRUE)
+/* A timer list driven by a one-shot GKI timer armed to its next expiry,
+** instead of a periodic GKI timer that moves the list on by one unit */
+typedef struct
+{
+    TIMER_LIST_Q   *p_timer_listq;
+    UINT32          unit_ticks;     /* GKI ticks per list unit */
+    UINT32          last_ticks;     /* GKI tick count the list has been updated to */
+    UINT16          start_evt;      /* mailbox event to arm the timer from NFC_TASK */
+    UINT8           timer_id;       /* GKI timer of NFC_TASK */
+} tNFC_TIMER_LIST;
+
+static tNFC_TIMER_LIST nfc_timer_list =
+{
+    &nfc_cb.timer_queue, GKI_SECS_TO_TICKS (1), 0, BT_EVT_TO_START_TIMER, NFC_TIMER_ID
+};
+
+static tNFC_TIMER_LIST nfc_quick_timer_list =
+{
+    &nfc_cb.quick_timer_queue, GKI_SECS_TO_TICKS (1) / QUICK_TIMER_TICKS_PER_SEC, 0,
+    BT_EVT_TO_START_QUICK_TIMER, NFC_QUICK_TIMER_ID
+};
+
+/*******************************************************************************
+**
+** Function         nfc_sync_timer_list
+**
+** Description      Move a timer list on by the whole units elapsed since it
+**                  was last updated. An empty list starts counting now.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfc_sync_timer_list (tNFC_TIMER_LIST *p_list)
+{
+    UINT32 now = GKI_get_tick_count ();
+    UINT32 units;
+
+    if (GKI_timer_list_empty (p_list->p_timer_listq))
+    {
+        p_list->last_ticks = now;
+        return;
+    }
+
+    units = (now - p_list->last_ticks) / p_list->unit_ticks;
+    if (units)
+    {
+        p_list->last_ticks += units * p_list->unit_ticks;
+        GKI_update_timer_list (p_list->p_timer_listq, (INT32) units);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfc_arm_timer_list
+**
+** Description      Start the GKI timer of a timer list as a one-shot to the
+**                  next update of the list, or stop it if the list is empty.
+**                  GKI timers belong to the calling task, so from another
+**                  task an event is posted to NFC_TASK to do it.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfc_arm_timer_list (tNFC_TIMER_LIST *p_list)
+{
+    BT_HDR *p_msg;
+    UINT64  ticks;
+    UINT32  elapsed;
+
+    if (GKI_get_taskid () != NFC_TASK)
+    {
+        if ((p_msg = (BT_HDR *) GKI_getbuf (BT_HDR_SIZE)) != NULL)
+        {
+            p_msg->event = p_list->start_evt;
+            GKI_send_msg (NFC_TASK, NFC_MBOX_ID, p_msg);
+        }
+        return;
+    }
+
+    if (GKI_timer_list_empty (p_list->p_timer_listq))
+    {
+        GKI_stop_timer (p_list->timer_id);
+        return;
+    }
+
+    /* the list is behind by the part of a unit elapsed since its update */
+    elapsed = GKI_get_tick_count () - p_list->last_ticks;
+    ticks   = (UINT64) GKI_timer_list_next_update (p_list->p_timer_listq) * p_list->unit_ticks;
+    if (ticks <= elapsed)
+        ticks = 1;
+    else if ((ticks -= elapsed) > 0x7FFFFFFF)
+        ticks = 0x7FFFFFFF;
+
+    GKI_start_timer (p_list->timer_id, (INT32) ticks, FALSE);
+}
+#endif
+
 /*******************************************************************************
 **
 ** Function         nfc_start_timer
@@ -77,10 +175,13 @@
 *******************************************************************************/
 void nfc_start_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
 {
+#if (GKI_TICKLESS_TIMER == TRUE)
+    nfc_sync_timer_list (&nfc_timer_list);
+#else
     BT_HDR *p_msg;
 
     /* if timer list is currently empty, start periodic GKI timer */
-    if (nfc_cb.timer_queue.p_first == NULL)
+    if (GKI_timer_list_empty (&nfc_cb.timer_queue))
     {
         /* if timer starts on other than NFC task (scritp wrapper) */
         if (GKI_get_taskid () != NFC_TASK)
@@ -98,6 +199,7 @@ void nfc_start_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
             GKI_start_timer (NFC_TIMER_ID, GKI_SECS_TO_TICKS (1), TRUE);
         }
     }
+#endif
 
     GKI_remove_from_timer_list (&nfc_cb.timer_queue, p_tle);
 
@@ -105,6 +207,10 @@ void nfc_start_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
     p_tle->ticks = timeout;         /* Save the number of seconds for the timer */
 
     GKI_add_to_timer_list (&nfc_cb.timer_queue, p_tle);
+
+#if (GKI_TICKLESS_TIMER == TRUE)
+    nfc_arm_timer_list (&nfc_timer_list);
+#endif
 }
 
 /*******************************************************************************
@@ -118,6 +224,9 @@ void nfc_start_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
 *******************************************************************************/
 UINT32 nfc_remaining_time (TIMER_LIST_ENT *p_tle)
 {
+#if (GKI_TICKLESS_TIMER == TRUE)
+    nfc_sync_timer_list (&nfc_timer_list);
+#endif
     return (GKI_get_remaining_ticks (&nfc_cb.timer_queue, p_tle));
 }
 
@@ -134,17 +243,20 @@ void nfc_process_timer_evt (void)
 {
     TIMER_LIST_ENT  *p_tle;
 
+#if (GKI_TICKLESS_TIMER == TRUE)
+    nfc_sync_timer_list (&nfc_timer_list);
+#else
     GKI_update_timer_list (&nfc_cb.timer_queue, 1);
+#endif
 
-    while ((nfc_cb.timer_queue.p_first) && (!nfc_cb.timer_queue.p_first->ticks))
+    while (((p_tle = GKI_timer_getfirst (&nfc_cb.timer_queue)) != NULL) && (!p_tle->ticks))
     {
-        p_tle = nfc_cb.timer_queue.p_first;
         GKI_remove_from_timer_list (&nfc_cb.timer_queue, p_tle);
 
         switch (p_tle->event)
         {
         case NFC_TTYPE_NCI_WAIT_RSP:
-            nfc_ncif_cmd_timeout();
+            nfc_ncif_rsp_timeout (p_tle);
             break;
 
         case NFC_TTYPE_WAIT_2_DEACTIVATE:
@@ -173,11 +285,16 @@ void nfc_process_timer_evt (void)
         }
     }
 
+#if (GKI_TICKLESS_TIMER == TRUE)
+    /* re-arm to the next entry, or stop if the list is empty */
+    nfc_arm_timer_list (&nfc_timer_list);
+#else
     /* if timer list is empty stop periodic GKI timer */
-    if (nfc_cb.timer_queue.p_first == NULL)
+    if (GKI_timer_list_empty (&nfc_cb.timer_queue))
     {
         GKI_stop_timer (NFC_TIMER_ID);
     }
+#endif
 }
 
 /*******************************************************************************
@@ -194,7 +311,7 @@ void nfc_stop_timer (TIMER_LIST_ENT *p_tle)
     GKI_remove_from_timer_list (&nfc_cb.timer_queue, p_tle);
 
     /* if timer list is empty stop periodic GKI timer */
-    if (nfc_cb.timer_queue.p_first == NULL)
+    if (GKI_timer_list_empty (&nfc_cb.timer_queue))
     {
         GKI_stop_timer (NFC_TIMER_ID);
     }
@@ -215,10 +332,13 @@ void nfc_stop_timer (TIMER_LIST_ENT *p_tle)
 *******************************************************************************/
 void nfc_start_quick_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
 {
+#if (GKI_TICKLESS_TIMER == TRUE)
+    nfc_sync_timer_list (&nfc_quick_timer_list);
+#else
     BT_HDR *p_msg;
 
     /* if timer list is currently empty, start periodic GKI timer */
-    if (nfc_cb.quick_timer_queue.p_first == NULL)
+    if (GKI_timer_list_empty (&nfc_cb.quick_timer_queue))
     {
         /* if timer starts on other than NFC task (scritp wrapper) */
         if (GKI_get_taskid () != NFC_TASK)
@@ -236,6 +356,7 @@ void nfc_start_quick_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
             GKI_start_timer (NFC_QUICK_TIMER_ID, ((GKI_SECS_TO_TICKS (1) / QUICK_TIMER_TICKS_PER_SEC)), TRUE);
         }
     }
+#endif
 
     GKI_remove_from_timer_list (&nfc_cb.quick_timer_queue, p_tle);
 
@@ -243,6 +364,10 @@ void nfc_start_quick_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
     p_tle->ticks = timeout; /* Save the number of ticks for the timer */
 
     GKI_add_to_timer_list (&nfc_cb.quick_timer_queue, p_tle);
+
+#if (GKI_TICKLESS_TIMER == TRUE)
+    nfc_arm_timer_list (&nfc_quick_timer_list);
+#endif
 }
 
 
@@ -262,7 +387,7 @@ void nfc_stop_quick_timer (TIMER_LIST_ENT *p_tle)
     GKI_remove_from_timer_list (&nfc_cb.quick_timer_queue, p_tle);
 
     /* if timer list is empty stop periodic GKI timer */
-    if (nfc_cb.quick_timer_queue.p_first == NULL)
+    if (GKI_timer_list_empty (&nfc_cb.quick_timer_queue))
     {
         GKI_stop_timer (NFC_QUICK_TIMER_ID);
     }
@@ -281,11 +406,14 @@ void nfc_process_quick_timer_evt (void)
 {
     TIMER_LIST_ENT  *p_tle;
 
+#if (GKI_TICKLESS_TIMER == TRUE)
+    nfc_sync_timer_list (&nfc_quick_timer_list);
+#else
     GKI_update_timer_list (&nfc_cb.quick_timer_queue, 1);
+#endif
 
-    while ((nfc_cb.quick_timer_queue.p_first) && (!nfc_cb.quick_timer_queue.p_first->ticks))
+    while (((p_tle = GKI_timer_getfirst (&nfc_cb.quick_timer_queue)) != NULL) && (!p_tle->ticks))
     {
-        p_tle = nfc_cb.quick_timer_queue.p_first;
         GKI_remove_from_timer_list (&nfc_cb.quick_timer_queue, p_tle);
 
         switch (p_tle->event)
@@ -335,11 +463,16 @@ void nfc_process_quick_timer_evt (void)
         }
     }
 
+#if (GKI_TICKLESS_TIMER == TRUE)
+    /* re-arm to the next entry, or stop if the list is empty */
+    nfc_arm_timer_list (&nfc_quick_timer_list);
+#else
     /* if timer list is empty stop periodic GKI timer */
-    if (nfc_cb.quick_timer_queue.p_first == NULL)
+    if (GKI_timer_list_empty (&nfc_cb.quick_timer_queue))
     {
         GKI_stop_timer (NFC_QUICK_TIMER_ID);
     }
+#endif
 }
 
 /*******************************************************************************
@@ -408,6 +541,7 @@ UINT32 nfc_task (UINT32 param)
     /* Initialize the nfc control block */
     memset (&nfc_cb, 0, sizeof (tNFC_CB));
     nfc_cb.trace_level = NFC_INITIAL_TRACE_LEVEL;
+    nfc_cb.nci_rsp_slot = NCI_MAX_CMD_WINDOW;
 
     NFC_TRACE_DEBUG0 ("NFC_TASK started.");
 
@@ -441,13 +575,21 @@ UINT32 nfc_task (UINT32 param)
                         break;
 
                     case BT_EVT_TO_START_TIMER :
+#if (GKI_TICKLESS_TIMER == TRUE)
+                        nfc_arm_timer_list (&nfc_timer_list);
+#else
                         /* Start nfc_task 1-sec resolution timer */
                         GKI_start_timer (NFC_TIMER_ID, GKI_SECS_TO_TICKS (1), TRUE);
+#endif
                         break;
 
                     case BT_EVT_TO_START_QUICK_TIMER :
+#if (GKI_TICKLESS_TIMER == TRUE)
+                        nfc_arm_timer_list (&nfc_quick_timer_list);
+#else
                         /* Quick-timer is required for LLCP */
                         GKI_start_timer (NFC_QUICK_TIMER_ID, ((GKI_SECS_TO_TICKS (1) / QUICK_TIMER_TICKS_PER_SEC)), TRUE);
+#endif
                         break;
 
                     case BT_EVT_TO_NFC_MSGS:
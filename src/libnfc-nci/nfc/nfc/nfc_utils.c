@@ -172,6 +172,10 @@ void nfc_free_conn_cb (tNFC_CONN_CB *p_cb)
     while ((p_buf = GKI_dequeue (&p_cb->rx_q)) != NULL)
         GKI_freebuf (p_buf);
 
+    while ((p_buf = GKI_dequeue (&p_cb->ras_q)) != NULL)
+        GKI_freebuf (p_buf);
+    p_cb->ras_len                   = 0;
+
     while ((p_buf = GKI_dequeue (&p_cb->tx_q)) != NULL)
         GKI_freebuf (p_buf);
 
@@ -99,6 +99,37 @@ enum
     RW_I93_SUBSTATE_WAIT_LOCK_CC            /* lock block of CC                     */
 };
 
+/* Read Multiple Blocks capability of a product */
+typedef struct
+{
+    UINT8   max_blocks;     /* cap of blocks per read, 0 for RW_I93_READ_MULTI_BLOCK_SIZE bytes */
+    UINT8   flags;          /* RW_I93_PRODUCT_xxx */
+} tRW_I93_PRODUCT_INFO;
+
+#define RW_I93_PRODUCT_STM_SECTOR   0x01    /* a read must stay in a sector of I93_STM_BLOCKS_PER_SECTOR */
+
+/* indexed by product version, the size is probed down from max_blocks */
+static const tRW_I93_PRODUCT_INFO rw_i93_product_info[RW_I93_UNKNOWN_PRODUCT + 1] =
+{
+    { 64,                          0                         },  /* RW_I93_ICODE_SLI                  */
+    { 64,                          0                         },  /* RW_I93_ICODE_SLI_S                */
+    { 64,                          0                         },  /* RW_I93_ICODE_SLI_L                */
+    { 32,                          0                         },  /* RW_I93_TAG_IT_HF_I_PLUS_INLAY     */
+    { 32,                          0                         },  /* RW_I93_TAG_IT_HF_I_PLUS_CHIP      */
+    { 1,                           0                         },  /* RW_I93_TAG_IT_HF_I_STD_CHIP_INLAY */
+    { 1,                           0                         },  /* RW_I93_TAG_IT_HF_I_PRO_CHIP_INLAY */
+    { I93_STM_MAX_BLOCKS_PER_READ, 0                         },  /* RW_I93_STM_LRI1K                  */
+    { I93_STM_MAX_BLOCKS_PER_READ, 0                         },  /* RW_I93_STM_LRI2K                  */
+    { I93_STM_MAX_BLOCKS_PER_READ, 0                         },  /* RW_I93_STM_LRIS2K                 */
+    { I93_STM_MAX_BLOCKS_PER_READ, RW_I93_PRODUCT_STM_SECTOR },  /* RW_I93_STM_LRIS64K                */
+    { I93_STM_MAX_BLOCKS_PER_READ, RW_I93_PRODUCT_STM_SECTOR },  /* RW_I93_STM_M24LR64_R              */
+    { I93_STM_MAX_BLOCKS_PER_READ, RW_I93_PRODUCT_STM_SECTOR },  /* RW_I93_STM_M24LR04E_R             */
+    { I93_STM_MAX_BLOCKS_PER_READ, RW_I93_PRODUCT_STM_SECTOR },  /* RW_I93_STM_M24LR16E_R             */
+    { I93_STM_MAX_BLOCKS_PER_READ, RW_I93_PRODUCT_STM_SECTOR },  /* RW_I93_STM_M24LR64E_R             */
+    { 64,                          0                         },  /* RW_I93_STM_ST25DV                 */
+    { 0,                           0                         }   /* RW_I93_UNKNOWN_PRODUCT            */
+};
+
 #if (BT_TRACE_VERBOSE == TRUE)
 static char *rw_i93_get_state_name (UINT8 state);
 static char *rw_i93_get_sub_state_name (UINT8 sub_state);
@@ -183,6 +214,9 @@ void rw_i93_get_product_version (UINT8 *p_uid)
             case I93_IC_REF_STM_M24LR64_R:
                 p_i93->product_version = RW_I93_STM_M24LR64_R;
                 break;
+            case I93_IC_REF_STM_ST25DV:
+                p_i93->product_version = RW_I93_STM_ST25DV;
+                break;
             default:
                 p_i93->product_version = RW_I93_UNKNOWN_PRODUCT;
                 break;
@@ -319,6 +353,24 @@ BOOLEAN rw_i93_process_sys_info (UINT8* p_data)
                     p_i93->num_block = 64;
                     p_i93->block_size = 4;
                 }
+                else if (p_i93->product_version == RW_I93_STM_ST25DV)
+                {
+                    /*
+                    ** ST25DV16K and ST25DV64K have more than 256 blocks, they are only
+                    ** reported by Extended Get System Information. Extended commands
+                    ** are used with all ST25DV.
+                    */
+                    if (!(p_i93->intl_flags & RW_I93_FLAG_EXT_COMMANDS))
+                    {
+                        p_i93->intl_flags |= (RW_I93_FLAG_16BIT_NUM_BLOCK | RW_I93_FLAG_EXT_COMMANDS);
+
+                        if (rw_i93_send_cmd_get_sys_info (NULL, I93_FLAG_PROT_EXT_NO) == NFC_STATUS_OK)
+                        {
+                            return FALSE;
+                        }
+                        p_i93->intl_flags &= ~(RW_I93_FLAG_16BIT_NUM_BLOCK | RW_I93_FLAG_EXT_COMMANDS);
+                    }
+                }
             }
         }
     }
@@ -343,6 +395,7 @@ BOOLEAN rw_i93_check_sys_info_prot_ext (UINT8 error_code)
 
     if (  (p_i93->uid[1] == I93_UID_IC_MFG_CODE_STM)
         &&(p_i93->sent_cmd == I93_CMD_GET_SYS_INFO)
+        &&(!(p_i93->intl_flags & RW_I93_FLAG_EXT_COMMANDS))
         &&(error_code == I93_ERROR_CODE_OPTION_NOT_SUPPORTED)
         &&(rw_i93_send_cmd_get_sys_info (NULL, I93_FLAG_PROT_EXT_YES) == NFC_STATUS_OK)  )
     {
@@ -700,13 +753,20 @@ tNFC_STATUS rw_i93_send_cmd_read_single_block (UINT16 block_number, BOOLEAN read
     if (read_security)
         flags |= I93_FLAG_OPTION_SET;
 
-    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_16BIT_NUM_BLOCK)
+    if ((rw_cb.tcb.i93.intl_flags & (RW_I93_FLAG_16BIT_NUM_BLOCK | RW_I93_FLAG_EXT_COMMANDS)) == RW_I93_FLAG_16BIT_NUM_BLOCK)
         flags |= I93_FLAG_PROT_EXT_YES;
 
     UINT8_TO_STREAM (p, flags);
 
     /* Command Code */
-    UINT8_TO_STREAM (p, I93_CMD_READ_SINGLE_BLOCK);
+    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_EXT_COMMANDS)
+    {
+        UINT8_TO_STREAM (p, I93_CMD_EXT_READ_SINGLE_BLOCK);
+    }
+    else
+    {
+        UINT8_TO_STREAM (p, I93_CMD_READ_SINGLE_BLOCK);
+    }
 
     /* Parameters */
     ARRAY8_TO_STREAM (p, rw_cb.tcb.i93.uid);     /* UID */
@@ -774,13 +834,20 @@ tNFC_STATUS rw_i93_send_cmd_write_single_block (UINT16 block_number, UINT8 *p_da
         flags = (I93_FLAG_ADDRESS_SET | RW_I93_FLAG_SUB_CARRIER | RW_I93_FLAG_DATA_RATE);
     }
 
-    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_16BIT_NUM_BLOCK)
+    if ((rw_cb.tcb.i93.intl_flags & (RW_I93_FLAG_16BIT_NUM_BLOCK | RW_I93_FLAG_EXT_COMMANDS)) == RW_I93_FLAG_16BIT_NUM_BLOCK)
         flags |= I93_FLAG_PROT_EXT_YES;
 
     UINT8_TO_STREAM (p, flags);
 
     /* Command Code */
-    UINT8_TO_STREAM (p, I93_CMD_WRITE_SINGLE_BLOCK);
+    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_EXT_COMMANDS)
+    {
+        UINT8_TO_STREAM (p, I93_CMD_EXT_WRITE_SINGLE_BLOCK);
+    }
+    else
+    {
+        UINT8_TO_STREAM (p, I93_CMD_WRITE_SINGLE_BLOCK);
+    }
 
     /* Parameters */
     ARRAY8_TO_STREAM (p, rw_cb.tcb.i93.uid);    /* UID */
@@ -878,6 +945,9 @@ tNFC_STATUS rw_i93_send_cmd_lock_block (UINT8 block_number)
 ** Function         rw_i93_send_cmd_read_multi_blocks
 **
 ** Description      Send Read Multiple Blocks Request to VICC
+**                  Extended Read Multiple Blocks is sent if the tag uses the
+**                  extended commands, sent_cmd is I93_CMD_READ_MULTI_BLOCK
+**                  as both have the same answer.
 **
 ** Returns          tNFC_STATUS
 **
@@ -904,28 +974,43 @@ tNFC_STATUS rw_i93_send_cmd_read_multi_blocks (UINT16 first_block_number, UINT16
     /* Flags */
     flags = (I93_FLAG_ADDRESS_SET | RW_I93_FLAG_SUB_CARRIER | RW_I93_FLAG_DATA_RATE);
 
-    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_16BIT_NUM_BLOCK)
+    if ((rw_cb.tcb.i93.intl_flags & (RW_I93_FLAG_16BIT_NUM_BLOCK | RW_I93_FLAG_EXT_COMMANDS)) == RW_I93_FLAG_16BIT_NUM_BLOCK)
         flags |= I93_FLAG_PROT_EXT_YES;
 
     UINT8_TO_STREAM (p, flags);
 
-    /* Command Code */
-    UINT8_TO_STREAM (p, I93_CMD_READ_MULTI_BLOCK);
+    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_EXT_COMMANDS)
+    {
+        /* Command Code */
+        UINT8_TO_STREAM (p, I93_CMD_EXT_READ_MULTI_BLOCK);
 
-    /* Parameters */
-    ARRAY8_TO_STREAM (p, rw_cb.tcb.i93.uid);    /* UID */
+        /* Parameters */
+        ARRAY8_TO_STREAM (p, rw_cb.tcb.i93.uid);    /* UID */
 
-    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_16BIT_NUM_BLOCK)
-    {
         UINT16_TO_STREAM (p, first_block_number);   /* First block number */
-        p_cmd->len++;
+        UINT16_TO_STREAM (p, number_blocks - 1);    /* Number of blocks, 0x0000 to read one block */
+        p_cmd->len += 2;
     }
     else
     {
-        UINT8_TO_STREAM (p, first_block_number);   /* First block number */
-    }
+        /* Command Code */
+        UINT8_TO_STREAM (p, I93_CMD_READ_MULTI_BLOCK);
 
-    UINT8_TO_STREAM (p, number_blocks - 1);    /* Number of blocks, 0x00 to read one block */
+        /* Parameters */
+        ARRAY8_TO_STREAM (p, rw_cb.tcb.i93.uid);    /* UID */
+
+        if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_16BIT_NUM_BLOCK)
+        {
+            UINT16_TO_STREAM (p, first_block_number);   /* First block number */
+            p_cmd->len++;
+        }
+        else
+        {
+            UINT8_TO_STREAM (p, first_block_number);   /* First block number */
+        }
+
+        UINT8_TO_STREAM (p, number_blocks - 1);    /* Number of blocks, 0x00 to read one block */
+    }
 
     if (rw_i93_send_to_lower (p_cmd))
     {
@@ -1315,7 +1400,17 @@ tNFC_STATUS rw_i93_send_cmd_get_sys_info (UINT8 *p_uid, UINT8 extra_flags)
     UINT8_TO_STREAM (p, (I93_FLAG_ADDRESS_SET | RW_I93_FLAG_SUB_CARRIER | RW_I93_FLAG_DATA_RATE | extra_flags));
 
     /* Command Code */
-    UINT8_TO_STREAM (p, I93_CMD_GET_SYS_INFO);
+    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_EXT_COMMANDS)
+    {
+        /* the answer has the same fields as Get System Information, with 2 bytes number of blocks */
+        UINT8_TO_STREAM (p, I93_CMD_EXT_GET_SYS_INFO);
+        UINT8_TO_STREAM (p, I93_EXT_SYS_INFO_REQ);  /* Parameter request field */
+        p_cmd->len++;
+    }
+    else
+    {
+        UINT8_TO_STREAM (p, I93_CMD_GET_SYS_INFO);
+    }
 
     /* Parameters */
     if (p_uid)
@@ -1370,13 +1465,20 @@ tNFC_STATUS rw_i93_send_cmd_get_multi_block_sec (UINT16 first_block_number,
     /* Flags */
     flags = (I93_FLAG_ADDRESS_SET | RW_I93_FLAG_SUB_CARRIER | RW_I93_FLAG_DATA_RATE);
 
-    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_16BIT_NUM_BLOCK)
+    if ((rw_cb.tcb.i93.intl_flags & (RW_I93_FLAG_16BIT_NUM_BLOCK | RW_I93_FLAG_EXT_COMMANDS)) == RW_I93_FLAG_16BIT_NUM_BLOCK)
         flags |= I93_FLAG_PROT_EXT_YES;
 
     UINT8_TO_STREAM (p, flags);
 
     /* Command Code */
-    UINT8_TO_STREAM (p, I93_CMD_GET_MULTI_BLK_SEC);
+    if (rw_cb.tcb.i93.intl_flags & RW_I93_FLAG_EXT_COMMANDS)
+    {
+        UINT8_TO_STREAM (p, I93_CMD_EXT_GET_MULTI_BLK_SEC);
+    }
+    else
+    {
+        UINT8_TO_STREAM (p, I93_CMD_GET_MULTI_BLK_SEC);
+    }
 
     /* Parameters */
     ARRAY8_TO_STREAM (p, rw_cb.tcb.i93.uid);    /* UID */
@@ -1404,11 +1506,169 @@ tNFC_STATUS rw_i93_send_cmd_get_multi_block_sec (UINT16 first_block_number,
     }
 }
 
+/*******************************************************************************
+**
+** Function         rw_i93_find_read_size
+**
+** Description      Look up the Read Multiple Blocks size found for a tag and
+**                  make it the most recently used
+**
+** Returns          number of blocks, 0 if the tag is not known
+**
+*******************************************************************************/
+static UINT8 rw_i93_find_read_size (UINT8 *p_uid)
+{
+    tRW_I93_READ_SIZE entry;
+    UINT8             xx;
+
+    for (xx = 0; xx < RW_I93_READ_SIZE_CACHE_SIZE; xx++)
+    {
+        if (rw_cb.i93_read_size[xx].uid[0] != I93_UID_FIRST_BYTE)
+            break;
+
+        if (!memcmp (rw_cb.i93_read_size[xx].uid, p_uid, I93_UID_BYTE_LEN))
+        {
+            entry = rw_cb.i93_read_size[xx];
+            memmove (&rw_cb.i93_read_size[1], &rw_cb.i93_read_size[0], xx * sizeof (tRW_I93_READ_SIZE));
+            rw_cb.i93_read_size[0] = entry;
+
+            return entry.max_blocks;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_store_read_size
+**
+** Description      Remember the Read Multiple Blocks size of the activated tag,
+**                  dropping the least recently used tag if the cache is full
+**
+** Returns          void
+**
+*******************************************************************************/
+static void rw_i93_store_read_size (void)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+    UINT8       xx;
+
+    RW_TRACE_DEBUG1 ("rw_i93_store_read_size (): %d blocks", p_i93->max_read_blocks);
+
+    /* the entry of the tag if any, or the last one */
+    for (xx = 0; xx < RW_I93_READ_SIZE_CACHE_SIZE - 1; xx++)
+    {
+        if (  (rw_cb.i93_read_size[xx].uid[0] != I93_UID_FIRST_BYTE)
+            ||(!memcmp (rw_cb.i93_read_size[xx].uid, p_i93->uid, I93_UID_BYTE_LEN))  )
+            break;
+    }
+
+    memmove (&rw_cb.i93_read_size[1], &rw_cb.i93_read_size[0], xx * sizeof (tRW_I93_READ_SIZE));
+    memcpy (rw_cb.i93_read_size[0].uid, p_i93->uid, I93_UID_BYTE_LEN);
+    rw_cb.i93_read_size[0].max_blocks = p_i93->max_read_blocks;
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_set_read_size
+**
+** Description      Set the number of blocks per Read Multiple Blocks: the size
+**                  found earlier for the tag, otherwise the cap of the product
+**
+** Returns          void
+**
+*******************************************************************************/
+static void rw_i93_set_read_size (void)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+    UINT16      max_blocks;
+    UINT8       found;
+
+    max_blocks = rw_i93_product_info[p_i93->product_version].max_blocks;
+
+    if (max_blocks == 0)
+        max_blocks = RW_I93_READ_MULTI_BLOCK_SIZE / p_i93->block_size;
+
+    if ((found = rw_i93_find_read_size (p_i93->uid)) != 0)
+    {
+        if (found < max_blocks)
+            max_blocks = found;
+    }
+
+    if (max_blocks > p_i93->num_block)
+        max_blocks = p_i93->num_block;
+
+    p_i93->max_read_blocks = (UINT8) max_blocks;
+
+    RW_TRACE_DEBUG2 ("rw_i93_set_read_size (): %d blocks, known tag:%d", p_i93->max_read_blocks, (found != 0));
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_count_read
+**
+** Description      Account the time of the read answered by the tag
+**
+** Returns          void
+**
+*******************************************************************************/
+static void rw_i93_count_read (BOOLEAN accepted)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+
+    p_i93->read_time_us += GKI_get_os_time_us () - p_i93->read_start_us;
+    p_i93->read_cmds++;
+
+    if (accepted)
+        p_i93->read_total_blocks += p_i93->read_blocks;
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_clear_read_counts
+**
+** Description      Restart counting the reads of an NDEF procedure
+**
+** Returns          void
+**
+*******************************************************************************/
+static void rw_i93_clear_read_counts (void)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+
+    p_i93->read_time_us      = 0;
+    p_i93->read_cmds         = 0;
+    p_i93->read_total_blocks = 0;
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_report_reads
+**
+** Description      Trace the reads of the NDEF procedure and the latency per
+**                  block
+**
+** Returns          void
+**
+*******************************************************************************/
+static void rw_i93_report_reads (void)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+
+    if (p_i93->read_total_blocks)
+    {
+        RW_TRACE_API6 ("rw_i93_report_reads (): product_version:%d, size:%d, %d blocks in %d reads, %lu us, %lu us/block",
+                       p_i93->product_version, p_i93->max_read_blocks,
+                       p_i93->read_total_blocks, p_i93->read_cmds,
+                       p_i93->read_time_us, p_i93->read_time_us / p_i93->read_total_blocks);
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         rw_i93_get_next_blocks
 **
-** Description      Read as many blocks as possible (up to RW_I93_READ_MULTI_BLOCK_SIZE)
+** Description      Read as many blocks as possible (up to p_i93->max_read_blocks)
 **
 ** Returns          tNFC_STATUS
 **
@@ -1418,6 +1678,7 @@ tNFC_STATUS rw_i93_get_next_blocks (UINT16 offset)
     tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
     UINT16     first_block;
     UINT16     num_block;
+    tNFC_STATUS status;
 
     RW_TRACE_DEBUG0 ("rw_i93_get_next_blocks ()");
 
@@ -1425,41 +1686,102 @@ tNFC_STATUS rw_i93_get_next_blocks (UINT16 offset)
 
     /* more blocks, more efficent but more error rate */
 
-    if (p_i93->intl_flags & RW_I93_FLAG_READ_MULTI_BLOCK)
+    if (  (p_i93->intl_flags & RW_I93_FLAG_READ_MULTI_BLOCK)
+        &&(p_i93->max_read_blocks > 1)  )
     {
-        num_block = RW_I93_READ_MULTI_BLOCK_SIZE / p_i93->block_size;
+        num_block = p_i93->max_read_blocks;
 
         if (num_block + first_block > p_i93->num_block)
             num_block = p_i93->num_block - first_block;
 
-        if (p_i93->uid[1] == I93_UID_IC_MFG_CODE_STM)
+        if (rw_i93_product_info[p_i93->product_version].flags & RW_I93_PRODUCT_STM_SECTOR)
         {
             /* LRIS64K, M24LR64-R, M24LR04E-R, M24LR16E-R, M24LR64E-R requires
             **      The max number of blocks is 32 and they are all located in the same sector.
             **      The sector is 32 blocks of 4 bytes.
             */
-            if (  (p_i93->product_version == RW_I93_STM_LRIS64K)
-                ||(p_i93->product_version == RW_I93_STM_M24LR64_R)
-                ||(p_i93->product_version == RW_I93_STM_M24LR04E_R)
-                ||(p_i93->product_version == RW_I93_STM_M24LR16E_R)
-                ||(p_i93->product_version == RW_I93_STM_M24LR64E_R)  )
+            if ((first_block / I93_STM_BLOCKS_PER_SECTOR)
+                != ((first_block + num_block - 1) / I93_STM_BLOCKS_PER_SECTOR))
             {
-                if (num_block > I93_STM_MAX_BLOCKS_PER_READ)
-                    num_block = I93_STM_MAX_BLOCKS_PER_READ;
-
-                if ((first_block / I93_STM_BLOCKS_PER_SECTOR)
-                    != ((first_block + num_block - 1) / I93_STM_BLOCKS_PER_SECTOR))
-                {
-                    num_block = I93_STM_BLOCKS_PER_SECTOR - (first_block % I93_STM_BLOCKS_PER_SECTOR);
-                }
+                num_block = I93_STM_BLOCKS_PER_SECTOR - (first_block % I93_STM_BLOCKS_PER_SECTOR);
             }
         }
 
-        return rw_i93_send_cmd_read_multi_blocks (first_block, num_block);
+        status = rw_i93_send_cmd_read_multi_blocks (first_block, num_block);
     }
     else
     {
-        return rw_i93_send_cmd_read_single_block (first_block, FALSE);
+        num_block = 1;
+        status = rw_i93_send_cmd_read_single_block (first_block, FALSE);
+    }
+
+    if (status == NFC_STATUS_OK)
+    {
+        p_i93->read_blocks   = num_block;
+        p_i93->read_start_us = GKI_get_os_time_us ();
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_retry_smaller_read
+**
+** Description      Read again from p_i93->rw_offset with half as many blocks
+**                  after the tag failed a Read Multiple Blocks
+**
+** Returns          TRUE if the read was sent again
+**
+*******************************************************************************/
+static BOOLEAN rw_i93_retry_smaller_read (void)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+
+    if (  (  (p_i93->state != RW_I93_STATE_DETECT_NDEF)
+           ||(p_i93->sub_state != RW_I93_SUBSTATE_SEARCH_NDEF_TLV)  )
+        &&(p_i93->state != RW_I93_STATE_READ_NDEF)  )
+    {
+        return FALSE;
+    }
+
+    if (  (p_i93->sent_cmd != I93_CMD_READ_MULTI_BLOCK)
+        ||(p_i93->read_blocks <= 1)  )
+    {
+        return FALSE;
+    }
+
+    rw_i93_count_read (FALSE);
+
+    p_i93->max_read_blocks = (UINT8) (p_i93->read_blocks / 2);
+    p_i93->intl_flags     |= RW_I93_FLAG_READ_SIZE_PROBED;
+
+    RW_TRACE_DEBUG2 ("rw_i93_retry_smaller_read (): %d blocks failed, trying %d",
+                      p_i93->read_blocks, p_i93->max_read_blocks);
+
+    return (rw_i93_get_next_blocks (p_i93->rw_offset) == NFC_STATUS_OK);
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_read_accepted
+**
+** Description      Account a read answered without error, and remember the
+**                  size if it had to be probed down
+**
+** Returns          void
+**
+*******************************************************************************/
+static void rw_i93_read_accepted (void)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+
+    rw_i93_count_read (TRUE);
+
+    if (p_i93->intl_flags & RW_I93_FLAG_READ_SIZE_PROBED)
+    {
+        p_i93->intl_flags &= ~RW_I93_FLAG_READ_SIZE_PROBED;
+        rw_i93_store_read_size ();
     }
 }
 
@@ -1537,7 +1859,7 @@ void rw_i93_sm_detect_ndef (BT_HDR *p_resp)
             /* This STM tag supports more than 2040 bytes */
             p_i93->intl_flags |= RW_I93_FLAG_16BIT_NUM_BLOCK;
         }
-        else
+        else if (!rw_i93_retry_smaller_read ())
         {
             RW_TRACE_DEBUG1 ("Got error flags (0x%02x)", flags);
             rw_i93_handle_error (NFC_STATUS_FAILED);
@@ -1622,14 +1944,20 @@ void rw_i93_sm_detect_ndef (BT_HDR *p_resp)
         ** CC[3] : Bit 0:Read multiple blocks is supported [NXP, STM]
         **       : Bit 1:Inventory page read is supported [NXP]
         **       : Bit 2:More than 2040 bytes are supported [STM]
+        **
+        ** A CC of 8 bytes (CC[0] 0xE1 or 0xE2, CC[2] 0x00) has the memory size in
+        ** CC[6..7], the NDEF TLV is searched from offset 8.
         */
 
         RW_TRACE_DEBUG4 ("rw_i93_sm_detect_ndef (): cc: 0x%02X 0x%02X 0x%02X 0x%02X", cc[0], cc[1], cc[2], cc[3]);
         RW_TRACE_DEBUG2 ("rw_i93_sm_detect_ndef (): Total blocks:0x%04X, Block size:0x%02X", p_i93->num_block, p_i93->block_size );
 
-        if (  (cc[0] == I93_ICODE_CC_MAGIC_NUMER)
-            &&(  (cc[3] & I93_STM_CC_OVERFLOW_MASK)
-               ||(cc[2] * 8) == (p_i93->num_block * p_i93->block_size)  )  )
+        if (  (  (cc[0] == I93_ICODE_CC_MAGIC_NUMER)
+               &&(  (cc[3] & I93_STM_CC_OVERFLOW_MASK)
+                  ||(cc[2] == I93_ICODE_CC_8BYTE_MLEN)
+                  ||(cc[2] * 8) == (p_i93->num_block * p_i93->block_size)  )  )
+            ||(  (cc[0] == I93_ICODE_CC_MAGIC_NUMER_E2)
+               &&(cc[2] == I93_ICODE_CC_8BYTE_MLEN)  )  )
         {
             if ((cc[1] & I93_ICODE_CC_READ_ACCESS_MASK) == I93_ICODE_CC_READ_ACCESS_GRANTED)
             {
@@ -1642,6 +1970,7 @@ void rw_i93_sm_detect_ndef (BT_HDR *p_resp)
                 {
                     /* tag supports read multi blocks command */
                     p_i93->intl_flags |= RW_I93_FLAG_READ_MULTI_BLOCK;
+                    rw_i93_set_read_size ();
                 }
                 status = NFC_STATUS_OK;
             }
@@ -1649,8 +1978,11 @@ void rw_i93_sm_detect_ndef (BT_HDR *p_resp)
 
         if (status == NFC_STATUS_OK)
         {
-            /* seach NDEF TLV from offset 4 */
-            p_i93->rw_offset = 4;
+            /* seach NDEF TLV from offset 4, or 8 after a CC of 8 bytes */
+            if (cc[2] == I93_ICODE_CC_8BYTE_MLEN)
+                p_i93->rw_offset = I93_ICODE_CC_8BYTE_LEN;
+            else
+                p_i93->rw_offset = 4;
 
             if (rw_i93_get_next_blocks (p_i93->rw_offset) == NFC_STATUS_OK)
             {
@@ -1670,6 +2002,8 @@ void rw_i93_sm_detect_ndef (BT_HDR *p_resp)
 
     case RW_I93_SUBSTATE_SEARCH_NDEF_TLV:
 
+        rw_i93_read_accepted ();
+
         /* search TLV within read blocks */
         for (xx = 0; xx < length; xx++)
         {
@@ -1940,6 +2274,8 @@ void rw_i93_sm_detect_ndef (BT_HDR *p_resp)
         p_i93->state    = RW_I93_STATE_IDLE;
         p_i93->sent_cmd = 0;
 
+        rw_i93_report_reads ();
+
         RW_TRACE_DEBUG3 ("NDEF cur_size(%d),max_size (%d), flags (0x%x)",
                          rw_data.ndef.cur_size,
                          rw_data.ndef.max_size,
@@ -1977,11 +2313,17 @@ void rw_i93_sm_read_ndef (BT_HDR *p_resp)
 
     if (flags & I93_FLAG_ERROR_DETECTED)
     {
-        RW_TRACE_DEBUG1 ("Got error flags (0x%02x)", flags);
-        rw_i93_handle_error (NFC_STATUS_FAILED);
+        if (!rw_i93_retry_smaller_read ())
+        {
+            RW_TRACE_DEBUG1 ("Got error flags (0x%02x)", flags);
+            rw_i93_handle_error (NFC_STATUS_FAILED);
+        }
+        GKI_freebuf (p_resp);
         return;
     }
 
+    rw_i93_read_accepted ();
+
     /* if this is the first block */
     if (p_i93->rw_length == 0)
     {
@@ -2031,6 +2373,8 @@ void rw_i93_sm_read_ndef (BT_HDR *p_resp)
                          p_resp->len,
                          p_i93->ndef_length);
 
+        rw_i93_report_reads ();
+
         (*(rw_cb.p_cback)) (RW_I93_NDEF_READ_CPLT_EVT, &rw_data);
     }
     else
@@ -3096,6 +3440,12 @@ static void rw_i93_data_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p_
                 p_i93->retry_count = 0;
             }
 
+            /* long answers are more exposed to transmission errors */
+            if (rw_i93_retry_smaller_read ())
+            {
+                return;
+            }
+
             rw_i93_handle_error ((tNFC_STATUS) (*(UINT8*) p_data));
         }
         else
@@ -3881,8 +4231,9 @@ tNFC_STATUS RW_I93DetectNDef (void)
         rw_cb.tcb.i93.state      = RW_I93_STATE_DETECT_NDEF;
         rw_cb.tcb.i93.sub_state  = sub_state;
 
-        /* clear flags except flag for 2 bytes of number of blocks */
-        rw_cb.tcb.i93.intl_flags &= RW_I93_FLAG_16BIT_NUM_BLOCK;
+        /* clear flags except flags for 2 bytes of number of blocks */
+        rw_cb.tcb.i93.intl_flags &= (RW_I93_FLAG_16BIT_NUM_BLOCK | RW_I93_FLAG_EXT_COMMANDS);
+        rw_i93_clear_read_counts ();
     }
 
     return (status);
@@ -3921,6 +4272,8 @@ tNFC_STATUS RW_I93ReadNDef (void)
         rw_cb.tcb.i93.rw_offset = rw_cb.tcb.i93.ndef_tlv_start_offset;
         rw_cb.tcb.i93.rw_length = 0;
 
+        rw_i93_clear_read_counts ();
+
         if (rw_i93_get_next_blocks (rw_cb.tcb.i93.rw_offset) == NFC_STATUS_OK)
         {
             rw_cb.tcb.i93.state = RW_I93_STATE_READ_NDEF;
@@ -4302,6 +4655,8 @@ static char *rw_i93_get_tag_name (UINT8 product_version)
         return ("M24LR16E");
     case RW_I93_STM_M24LR64E_R:
         return ("M24LR64E");
+    case RW_I93_STM_ST25DV:
+        return ("ST25DV");
     case RW_I93_UNKNOWN_PRODUCT:
     default:
         return ("UNKNOWN");
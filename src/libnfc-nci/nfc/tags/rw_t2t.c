@@ -87,6 +87,7 @@ static void rw_t2t_proc_data (UINT8 conn_id, tNFC_DATA_CEVT *p_data)
     tRW_READ_DATA           evt_data = {0};
     tT2T_CMD_RSP_INFO       *p_cmd_rsp_info = (tT2T_CMD_RSP_INFO *) rw_cb.tcb.t2t.p_cmd_rsp_info;
     tRW_DETECT_NDEF_DATA    ndef_data;
+    UINT16                  rsp_len;
 #if (BT_TRACE_VERBOSE == TRUE)
     UINT8                   begin_state     = p_t2t->state;
 #endif
@@ -114,7 +115,10 @@ static void rw_t2t_proc_data (UINT8 conn_id, tNFC_DATA_CEVT *p_data)
 
     RW_TRACE_EVENT2 ("RW RECV [%s]:0x%x RSP", t2t_info_to_str (p_cmd_rsp_info), p_cmd_rsp_info->opcode);
 
-    if (  (  (p_pkt->len != p_cmd_rsp_info->rsp_len)
+    /* The length of a FAST_READ response depends on the block range asked */
+    rsp_len = (p_cmd_rsp_info->opcode == T2T_CMD_FAST_READ) ? p_t2t->fast_read_len : p_cmd_rsp_info->rsp_len;
+
+    if (  (  (p_pkt->len != rsp_len)
            &&(p_pkt->len != p_cmd_rsp_info->nack_rsp_len)
            &&(p_t2t->substate != RW_T2T_SUBSTATE_WAIT_SELECT_SECTOR)  )
         ||(p_t2t->state == RW_T2T_STATE_HALT)  )
@@ -134,6 +138,7 @@ static void rw_t2t_proc_data (UINT8 conn_id, tNFC_DATA_CEVT *p_data)
         return;
     }
     rw_cb.cur_retry = 0;
+    rw_cb.t2t_ndef_read_halt = FALSE;
 
     /* Assume the data is just the response byte sequence */
     p = (UINT8 *) (p_pkt + 1) + p_pkt->offset;
@@ -164,7 +169,7 @@ static void rw_t2t_proc_data (UINT8 conn_id, tNFC_DATA_CEVT *p_data)
     {
         evt_data.status = NFC_STATUS_FAILED;
     }
-    else if (  (p_pkt->len != p_cmd_rsp_info->rsp_len)
+    else if (  (p_pkt->len != rsp_len)
              ||((p_cmd_rsp_info->opcode == T2T_CMD_WRITE) && ((*p & 0x0f) != T2T_RSP_ACK))  )
     {
         /* Received NACK response */
@@ -178,7 +183,9 @@ static void rw_t2t_proc_data (UINT8 conn_id, tNFC_DATA_CEVT *p_data)
         {
             /* Just received first NACK. Retry just one time to find if tag went in to HALT State */
             b_notify =  FALSE;
-            rw_t2t_process_error ();
+            /* After a NACK to GET_VERSION/FAST_READ the retry is a READ */
+            if (!rw_t2t_handle_fast_read_error (TRUE))
+                rw_t2t_process_error ();
             /* Assume Tag is in HALT State, untill we get response to retry command */
             p_t2t->check_tag_halt = TRUE;
         }
@@ -321,6 +328,15 @@ void rw_t2t_conn_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p_data)
             p_t2t->p_sec_cmd_buf = NULL;
         }
 
+        /* A tag left in sleep may be woken up: remember it has no FAST_READ */
+        if (  (p_data == NULL)
+            ||(  (p_data->deactivate.type != NFC_DEACTIVATE_TYPE_SLEEP)
+               &&(p_data->deactivate.type != NFC_DEACTIVATE_TYPE_SLEEP_AF)  )  )
+        {
+            rw_cb.t2t_no_fast_read   = FALSE;
+            rw_cb.t2t_ndef_read_halt = FALSE;
+        }
+
         p_t2t->state = RW_T2T_STATE_NOT_ACTIVATED;
         NFC_SetStaticRfCback (NULL);
         break;
@@ -602,6 +618,13 @@ static void rw_t2t_process_error (void)
             RW_TRACE_DEBUG1 ("T2T maximum retransmission attempts reached (%i)", RW_MAX_RETRIES);
         }
     }
+
+    /* Before failing the operation, try again with READ if the tag did not
+     * answer GET_VERSION/FAST_READ */
+    if (  (!p_t2t->check_tag_halt)
+        &&(rw_t2t_handle_fast_read_error (FALSE))  )
+        return;
+
     rw_event = rw_t2t_info_to_event (p_cmd_rsp_info);
 #if (defined (RW_STATS_INCLUDED) && (RW_STATS_INCLUDED == TRUE))
     /* update failure count */
@@ -825,6 +848,87 @@ tNFC_STATUS rw_t2t_read (UINT16 block)
     return status;
 }
 
+/*******************************************************************************
+**
+** Function         rw_t2t_get_version
+**
+** Description      This function issues NXP GET_VERSION command. The command
+**                  does not depend on the selected sector.
+**
+** Returns          tNFC_STATUS
+**
+*******************************************************************************/
+tNFC_STATUS rw_t2t_get_version (void)
+{
+    return rw_t2t_send_cmd (T2T_CMD_GET_VERSION, NULL);
+}
+
+/*******************************************************************************
+**
+** Function         rw_t2t_fast_read
+**
+** Description      This function issues NXP FAST_READ command for num_blocks
+**                  blocks from the specified block. The blocks shall be in the
+**                  same sector. If it is not the current sector then it first
+**                  sends command to move to new sector and after the tag moves
+**                  to new sector it issues the FAST_READ command.
+**
+** Returns          tNFC_STATUS
+**
+*******************************************************************************/
+tNFC_STATUS rw_t2t_fast_read (UINT16 block, UINT16 num_blocks)
+{
+    tNFC_STATUS status;
+    UINT8       *p;
+    tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
+    UINT8       sector_byte2[1];
+    UINT8       read_cmd[2];
+
+    if (  (num_blocks == 0)
+        ||(num_blocks * T2T_BLOCK_LEN > RW_T2T_FAST_READ_MAX_LEN)
+        ||(block / T2T_BLOCKS_PER_SECTOR != (block + num_blocks - 1) / T2T_BLOCKS_PER_SECTOR)  )
+    {
+        return NFC_STATUS_FAILED;
+    }
+
+    read_cmd[0] = (UINT8) (block % T2T_BLOCKS_PER_SECTOR);
+    read_cmd[1] = (UINT8) ((block + num_blocks - 1) % T2T_BLOCKS_PER_SECTOR);
+    p_t2t->fast_read_len = num_blocks * T2T_BLOCK_LEN;
+
+    if (p_t2t->sector != block/T2T_BLOCKS_PER_SECTOR)
+    {
+        sector_byte2[0] = 0xFF;
+        /* First Move to new sector before sending FAST_READ command */
+        if ((status = rw_t2t_send_cmd (T2T_CMD_SEC_SEL, sector_byte2)) == NFC_STATUS_OK)
+        {
+            /* Prepare command that needs to be sent after sector change op is completed */
+            p_t2t->select_sector         = (UINT8) (block/T2T_BLOCKS_PER_SECTOR);
+            p_t2t->p_sec_cmd_buf->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
+
+            p = (UINT8 *) (p_t2t->p_sec_cmd_buf + 1) + p_t2t->p_sec_cmd_buf->offset;
+            UINT8_TO_BE_STREAM (p, T2T_CMD_FAST_READ);
+            ARRAY_TO_BE_STREAM (p, read_cmd, 2);
+            p_t2t->p_sec_cmd_buf->len = 3;
+            p_t2t->block_read = block;
+
+            /* Backup the current substate to move back to this substate after changing sector */
+            p_t2t->prev_substate = p_t2t->substate;
+            p_t2t->substate      = RW_T2T_SUBSTATE_WAIT_SELECT_SECTOR_SUPPORT;
+            return NFC_STATUS_OK;
+        }
+        return NFC_STATUS_FAILED;
+    }
+
+    /* Send FAST_READ command as sector change is not needed */
+    if ((status = rw_t2t_send_cmd (T2T_CMD_FAST_READ, read_cmd)) == NFC_STATUS_OK)
+    {
+        p_t2t->block_read = block;
+        RW_TRACE_EVENT2 ("rw_t2t_fast_read Sent Command for Blocks: %u - %u", block, block + num_blocks - 1);
+    }
+
+    return status;
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t2t_write
@@ -897,6 +1001,7 @@ tNFC_STATUS rw_t2t_select (void)
 
     p_t2t->state       = RW_T2T_STATE_IDLE;
     p_t2t->ndef_status = T2T_NDEF_NOT_DETECTED;
+    p_t2t->fast_read   = (rw_cb.t2t_no_fast_read) ? RW_T2T_FAST_READ_NOT_SUPPORTED : RW_T2T_FAST_READ_UNKNOWN;
 
 
     /* Alloc cmd buf for retransmissions */
@@ -1218,6 +1323,8 @@ static char *rw_t2t_get_substate_name (UINT8 substate)
         return ("RW_T2T_SUBSTATE_WAIT_WRITE_NDEF_LEN_NEXT_BLOCK");
     case RW_T2T_SUBSTATE_WAIT_WRITE_TERM_TLV_CMPLT:
         return ("RW_T2T_SUBSTATE_WAIT_WRITE_TERM_TLV_CMPLT");
+    case RW_T2T_SUBSTATE_WAIT_GET_VERSION:
+        return ("RW_T2T_SUBSTATE_WAIT_GET_VERSION");
     default:
         return ("???? UNKNOWN SUBSTATE");
     }
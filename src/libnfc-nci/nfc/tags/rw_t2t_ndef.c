@@ -76,6 +76,9 @@ static BOOLEAN rw_t2t_is_read_only_byte (UINT16 index);
 static tNFC_STATUS rw_t2t_write_ndef_first_block (UINT16 msg_len, BOOLEAN b_update_len);
 static tNFC_STATUS rw_t2t_write_ndef_next_block (UINT16 block, UINT16 msg_len, BOOLEAN b_update_len);
 static tNFC_STATUS rw_t2t_read_ndef_next_block (UINT16 block);
+static BOOLEAN rw_t2t_may_fast_read (void);
+static tNFC_STATUS rw_t2t_read_ndef_data (UINT16 block);
+static tNFC_STATUS rw_t2t_read_ndef_start (void);
 static tNFC_STATUS rw_t2t_add_terminator_tlv (void);
 static BOOLEAN rw_t2t_is_read_before_write_block (UINT16 block, UINT16 *p_block_to_read);
 static tNFC_STATUS rw_t2t_set_cc (UINT8 tms);
@@ -1089,6 +1092,177 @@ tNFC_STATUS rw_t2t_read_ndef_next_block (UINT16 block)
     return status;
 }
 
+/*******************************************************************************
+**
+** Function         rw_t2t_may_fast_read
+**
+** Description      This function checks if the tag may support NXP GET_VERSION
+**                  and FAST_READ. MIFARE Ultralight and Ultralight C do not,
+**                  and go to HALT state on the NACK, so GET_VERSION is only
+**                  sent to NXP tags whose memory size is different.
+**
+** Returns          TRUE if GET_VERSION can be sent to the tag
+**
+*******************************************************************************/
+static BOOLEAN rw_t2t_may_fast_read (void)
+{
+    tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
+
+    return (  (p_t2t->b_read_hdr)
+            &&(p_t2t->tag_hdr[0] == TAG_MIFARE_MID)
+            &&(p_t2t->tag_hdr[T2T_CC2_TMS_BYTE] != T2T_CC2_TMS_MUL)
+            &&(p_t2t->tag_hdr[T2T_CC2_TMS_BYTE] != T2T_CC2_TMS_MULC)  );
+}
+
+/*******************************************************************************
+**
+** Function         rw_t2t_read_ndef_data
+**
+** Description      This function reads NDEF Message data from the block passed
+**                  as argument. If the tag supports FAST_READ, the blocks up to
+**                  the end of the NDEF Message are read in one command, as far
+**                  as RW_T2T_FAST_READ_MAX_LEN and the end of the sector allow.
+**                  Otherwise 4 blocks are read.
+**
+** Returns          NCI_STATUS_OK, if read was started. Otherwise, error status.
+**
+*******************************************************************************/
+static tNFC_STATUS rw_t2t_read_ndef_data (UINT16 block)
+{
+    tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
+    UINT32      index;
+    UINT32      end;
+    UINT16      remaining;
+
+    if (p_t2t->fast_read != RW_T2T_FAST_READ_SUPPORTED)
+        return (rw_t2t_read (block));
+
+    index = (UINT32) block * T2T_BLOCK_LEN;
+    end   = index + RW_T2T_FAST_READ_MAX_LEN;
+    if (end > ((UINT32) block / T2T_BLOCKS_PER_SECTOR + 1) * T2T_SECTOR_SIZE)
+        end = ((UINT32) block / T2T_BLOCKS_PER_SECTOR + 1) * T2T_SECTOR_SIZE;
+
+    /* Find the last byte of the NDEF Message in range, skipping lock and reserved bytes */
+    if ((p_t2t->work_offset == 0) && (index < p_t2t->ndef_msg_offset))
+        index = p_t2t->ndef_msg_offset;
+
+    remaining = p_t2t->ndef_msg_len - p_t2t->work_offset;
+    while ((remaining > 0) && (index < end))
+    {
+        if (rw_t2t_is_lock_res_byte ((UINT16) index) == FALSE)
+            remaining--;
+        index++;
+    }
+
+    return (rw_t2t_fast_read (block, (UINT16) ((index - (UINT32) block * T2T_BLOCK_LEN + T2T_BLOCK_LEN - 1) / T2T_BLOCK_LEN)));
+}
+
+/*******************************************************************************
+**
+** Function         rw_t2t_read_ndef_start
+**
+** Description      This function starts reading the NDEF Message, from the
+**                  data read during NDEF detection if it holds the beginning.
+**
+** Returns          NCI_STATUS_OK, if read was started. Otherwise, error status.
+**
+*******************************************************************************/
+static tNFC_STATUS rw_t2t_read_ndef_start (void)
+{
+    tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
+    tNFC_STATUS status = NFC_STATUS_OK;
+    UINT16      block;
+
+    block  = (UINT16) (p_t2t->ndef_msg_offset / T2T_BLOCK_LEN);
+    if (p_t2t->fast_read != RW_T2T_FAST_READ_SUPPORTED)
+        block -= block % T2T_READ_BLOCKS;
+
+    if (  (block == T2T_FIRST_DATA_BLOCK)
+        &&(p_t2t->b_read_data)
+        &&(p_t2t->fast_read != RW_T2T_FAST_READ_SUPPORTED)  )
+    {
+        p_t2t->state        = RW_T2T_STATE_READ_NDEF;
+        p_t2t->block_read   = T2T_FIRST_DATA_BLOCK;
+        rw_t2t_handle_ndef_read_rsp (p_t2t->tag_data);
+    }
+    else
+    {
+        /* Start reading NDEF Message */
+        if ((status = rw_t2t_read_ndef_data (block)) == NFC_STATUS_OK)
+        {
+            p_t2t->state    = RW_T2T_STATE_READ_NDEF;
+        }
+    }
+
+    return (status);
+}
+
+/*******************************************************************************
+**
+** Function         rw_t2t_handle_fast_read_error
+**
+** Description      This function handles a NACK, or no response, to the
+**                  GET_VERSION or FAST_READ command sent during NDEF read: the
+**                  tag is taken as not supporting FAST_READ and the read goes
+**                  on with READ.
+**
+**                  NXP tags go to HALT state on a NACK. The READ sent after
+**                  one is then the retry of the check_tag_halt flow: if the
+**                  tag does not answer it, the read fails as REJECTED, NFA
+**                  wakes the tag up and reads the NDEF message again, READ
+**                  only (see RW_T2tIsNDefReadRetry).
+**
+** Parameters:      nack: TRUE for a NACK, FALSE for no response
+**
+** Returns          TRUE if the error was handled
+**
+*******************************************************************************/
+BOOLEAN rw_t2t_handle_fast_read_error (BOOLEAN nack)
+{
+    tRW_T2T_CB      *p_t2t = &rw_cb.tcb.t2t;
+    tRW_READ_DATA   evt_data;
+    UINT8           opcode;
+    tNFC_STATUS     status;
+
+    if (  (p_t2t->state != RW_T2T_STATE_READ_NDEF)
+        ||(p_t2t->p_cmd_rsp_info == NULL)  )
+    {
+        return FALSE;
+    }
+    opcode = p_t2t->p_cmd_rsp_info->opcode;
+    if ((opcode != T2T_CMD_GET_VERSION) && (opcode != T2T_CMD_FAST_READ))
+        return FALSE;
+
+    RW_TRACE_WARNING2 ("rw_t2t_handle_fast_read_error - %s to 0x%02x, reading with READ",
+                       (nack) ? "NACK" : "no response", opcode);
+    p_t2t->fast_read = RW_T2T_FAST_READ_NOT_SUPPORTED;
+    p_t2t->substate  = RW_T2T_SUBSTATE_NONE;
+    if (nack)
+    {
+        rw_cb.t2t_no_fast_read   = TRUE;
+        rw_cb.t2t_ndef_read_halt = TRUE;
+    }
+
+    if (opcode == T2T_CMD_GET_VERSION)
+        status = rw_t2t_read_ndef_start ();
+    else
+        status = rw_t2t_read (p_t2t->block_read);
+
+    /* Nothing sent if the data read during NDEF detection was enough */
+    if (p_t2t->state != RW_T2T_STATE_READ_NDEF)
+        rw_cb.t2t_ndef_read_halt = FALSE;
+
+    if (status != NFC_STATUS_OK)
+    {
+        rw_cb.t2t_ndef_read_halt = FALSE;
+        evt_data.status = NFC_STATUS_FAILED;
+        evt_data.p_data = NULL;
+        rw_t2t_handle_op_complete ();
+        (*rw_cb.p_cback) (RW_T2T_NDEF_READ_EVT, (tRW_DATA *) &evt_data);
+    }
+    return TRUE;
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t2t_is_read_before_write_block
@@ -1610,9 +1784,33 @@ static void rw_t2t_handle_ndef_read_rsp (UINT8 *p_data)
     BOOLEAN         failed = FALSE;
     BOOLEAN         done   = FALSE;
 
+    if (p_t2t->substate == RW_T2T_SUBSTATE_WAIT_GET_VERSION)
+    {
+        /* MIFARE Ultralight EV1 and NTAG support FAST_READ */
+        p_t2t->substate  = RW_T2T_SUBSTATE_NONE;
+        p_t2t->fast_read = RW_T2T_FAST_READ_NOT_SUPPORTED;
+        if (  (p_data[T2T_GET_VERSION_VENDOR_BYTE] == T2T_VERSION_VENDOR_NXP)
+            &&(  (p_data[T2T_GET_VERSION_PROD_TYPE_BYTE] == T2T_VERSION_PROD_ULTRALIGHT)
+               ||(p_data[T2T_GET_VERSION_PROD_TYPE_BYTE] == T2T_VERSION_PROD_NTAG)  )  )
+        {
+            p_t2t->fast_read = RW_T2T_FAST_READ_SUPPORTED;
+        }
+        RW_TRACE_DEBUG2 ("rw_t2t_handle_ndef_read_rsp - product type: 0x%02x, FAST_READ: %u",
+                         p_data[T2T_GET_VERSION_PROD_TYPE_BYTE], p_t2t->fast_read);
+
+        if (rw_t2t_read_ndef_start () != NFC_STATUS_OK)
+        {
+            evt_data.status = NFC_STATUS_FAILED;
+            evt_data.p_data = NULL;
+            rw_t2t_handle_op_complete ();
+            (*rw_cb.p_cback) (RW_T2T_NDEF_READ_EVT, (tRW_DATA *) &evt_data);
+        }
+        return;
+    }
+
     /* On the first read, adjust for any partial block offset */
     offset = 0;
-    len    = T2T_READ_DATA_LEN;
+    len    = (p_t2t->fast_read == RW_T2T_FAST_READ_SUPPORTED) ? p_t2t->fast_read_len : T2T_READ_DATA_LEN;
 
     if (p_t2t->work_offset == 0)
     {
@@ -1641,8 +1839,8 @@ static void rw_t2t_handle_ndef_read_rsp (UINT8 *p_data)
     }
     else
     {
-        /* Read next 4 blocks */
-        if (rw_t2t_read ((UINT16) (p_t2t->block_read + T2T_READ_BLOCKS)) != NFC_STATUS_OK)
+        /* Read the blocks that follow */
+        if (rw_t2t_read_ndef_data ((UINT16) (p_t2t->block_read + len / T2T_BLOCK_LEN)) != NFC_STATUS_OK)
             failed = TRUE;
     }
 
@@ -3011,6 +3209,8 @@ tNFC_STATUS RW_T2tDetectNDef (BOOLEAN skip_dyn_locks)
 **
 **                  Internally, this command will be separated into multiple Tag2
 **                  Read commands (if necessary) - depending on the NDEF Msg size
+**                  On NXP tags that support it (checked once per activation
+**                  with GET_VERSION), FAST_READ commands are used instead.
 **
 ** Parameters:      p_buffer:   The buffer into which to read the NDEF message
 **                  buf_len:    The length of the buffer
@@ -3022,7 +3222,6 @@ tNFC_STATUS RW_T2tReadNDef (UINT8 *p_buffer, UINT16 buf_len)
 {
     tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
     tNFC_STATUS status = NFC_STATUS_OK;
-    UINT16      block;
 
     if (p_t2t->state != RW_T2T_STATE_IDLE)
     {
@@ -3050,29 +3249,50 @@ tNFC_STATUS RW_T2tReadNDef (UINT8 *p_buffer, UINT16 buf_len)
 
     p_t2t->p_ndef_buffer  = p_buffer;
     p_t2t->work_offset    = 0;
+    p_t2t->substate       = RW_T2T_SUBSTATE_NONE;
 
-    block  = (UINT16) (p_t2t->ndef_msg_offset / T2T_BLOCK_LEN);
-    block -= block % T2T_READ_BLOCKS;
-
-    p_t2t->substate = RW_T2T_SUBSTATE_NONE;
-
-    if (  (block == T2T_FIRST_DATA_BLOCK)
-        &&(p_t2t->b_read_data)  )
-    {
-        p_t2t->state        = RW_T2T_STATE_READ_NDEF;
-        p_t2t->block_read   = T2T_FIRST_DATA_BLOCK;
-        rw_t2t_handle_ndef_read_rsp (p_t2t->tag_data);
-    }
-    else
+    if (p_t2t->fast_read == RW_T2T_FAST_READ_UNKNOWN)
     {
-        /* Start reading NDEF Message */
-        if ((status = rw_t2t_read (block)) == NFC_STATUS_OK)
+        if (rw_t2t_may_fast_read ())
         {
-            p_t2t->state    = RW_T2T_STATE_READ_NDEF;
+            /* Ask the tag for its version first, to know if it supports FAST_READ */
+            p_t2t->substate = RW_T2T_SUBSTATE_WAIT_GET_VERSION;
+            if ((status = rw_t2t_get_version ()) == NFC_STATUS_OK)
+            {
+                p_t2t->state = RW_T2T_STATE_READ_NDEF;
+            }
+            else
+            {
+                p_t2t->substate = RW_T2T_SUBSTATE_NONE;
+            }
+            return (status);
         }
+        p_t2t->fast_read = RW_T2T_FAST_READ_NOT_SUPPORTED;
     }
 
-    return (status);
+    return (rw_t2t_read_ndef_start ());
+}
+
+/*******************************************************************************
+**
+** Function         RW_T2tIsNDefReadRetry
+**
+** Description      Checks if the last NDEF read failed because the tag went to
+**                  HALT state after NACKing GET_VERSION or FAST_READ, and the
+**                  tag has been woken up since. The NDEF message can then be
+**                  read again: READ is used until the tag is deactivated.
+**                  The indication is cleared, so the read is retried once.
+**
+** Returns          TRUE if the NDEF read can be started again
+**
+*******************************************************************************/
+BOOLEAN RW_T2tIsNDefReadRetry (void)
+{
+    BOOLEAN retry = (  (rw_cb.t2t_ndef_read_halt)
+                     &&(rw_cb.tcb.t2t.state == RW_T2T_STATE_IDLE)  );
+
+    rw_cb.t2t_ndef_read_halt = FALSE;
+    return (retry);
 }
 
 /*******************************************************************************
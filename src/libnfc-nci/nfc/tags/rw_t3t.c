@@ -49,7 +49,7 @@
 #define RW_T3T_POLL_CMD_TIMEOUT_TICKS                               ((RW_T3T_TOUT_RESP*2*QUICK_TIMER_TICKS_PER_SEC) / 1000)
 #define RW_T3T_DEFAULT_CMD_TIMEOUT_TICKS                            ((RW_T3T_TOUT_RESP*QUICK_TIMER_TICKS_PER_SEC) / 1000)
 #define RW_T3T_RAW_FRAME_CMD_TIMEOUT_TICKS                          (RW_T3T_DEFAULT_CMD_TIMEOUT_TICKS * 4)
-#define RW_T3T_MIN_TIMEOUT_TICKS                                    10
+#define RW_T3T_MIN_TIMEOUT_TICKS                                    ((100*QUICK_TIMER_TICKS_PER_SEC) / 1000)
 
 /* Macro to extract major version from NDEF version byte */
 #define T3T_GET_MAJOR_VERSION(ver)      (ver>>4)
@@ -186,7 +186,7 @@ static UINT32 rw_t3t_check_timeout (UINT16 num_blocks)
     UINT32      timeout;
     UINT32      extra;
 
-    timeout = (p_cb->check_tout_a + num_blocks * p_cb->check_tout_b)*QUICK_TIMER_TICKS_PER_SEC/1000000;
+    timeout = (UINT32) (((UINT64) p_cb->check_tout_a + (UINT64) num_blocks * p_cb->check_tout_b)*QUICK_TIMER_TICKS_PER_SEC/1000000);
     /* allow some extra time for driver */
     extra   = (timeout / 10) + RW_T3T_MIN_TIMEOUT_TICKS;
     timeout += extra;
@@ -209,7 +209,7 @@ static UINT32 rw_t3t_update_timeout (UINT16 num_blocks)
     UINT32      timeout;
     UINT32      extra;
 
-    timeout = (p_cb->update_tout_a + num_blocks * p_cb->update_tout_b)*QUICK_TIMER_TICKS_PER_SEC/1000000;
+    timeout = (UINT32) (((UINT64) p_cb->update_tout_a + (UINT64) num_blocks * p_cb->update_tout_b)*QUICK_TIMER_TICKS_PER_SEC/1000000);
     /* allow some extra time for driver */
     extra   = (timeout / 10) + RW_T3T_MIN_TIMEOUT_TICKS;
     timeout += extra;
@@ -92,6 +92,7 @@
 #define RW_T3BT_SUBSTATE_WAIT_GET_ATTRIB        0x11
 #define RW_T3BT_SUBSTATE_WAIT_GET_PUPI          0x12
 #endif
+#define RW_T4T_SUBSTATE_WAIT_ENDEF_FILE_CTRL_TLV 0x13   /* waiting for response of reading the rest of ENDEF TLV */
 
 #if (BT_TRACE_VERBOSE == TRUE)
 static char *rw_t4t_get_state_name (UINT8 state);
@@ -99,13 +100,17 @@ static char *rw_t4t_get_sub_state_name (UINT8 sub_state);
 #endif
 
 static BOOLEAN rw_t4t_send_to_lower (BT_HDR *p_c_apdu);
+static BOOLEAN rw_t4t_send_to_lower_ext (BT_HDR *p_c_apdu, UINT32 data_len);
 static BOOLEAN rw_t4t_select_file (UINT16 file_id);
-static BOOLEAN rw_t4t_read_file (UINT16 offset, UINT16 length, BOOLEAN is_continue);
-static BOOLEAN rw_t4t_update_nlen (UINT16 ndef_len);
+static BOOLEAN rw_t4t_read_file (UINT32 offset, UINT32 length, BOOLEAN is_continue);
+static BOOLEAN rw_t4t_update_nlen (UINT32 ndef_len);
 static BOOLEAN rw_t4t_update_file (void);
 static BOOLEAN rw_t4t_update_cc_to_readonly (void);
 static BOOLEAN rw_t4t_select_application (UINT8 version);
 static BOOLEAN rw_t4t_validate_cc_file (void);
+static BOOLEAN rw_t4t_is_odo (UINT32 offset);
+static void rw_t4t_set_max_rw_size (void);
+static BOOLEAN rw_t4t_ext_len_allowed (tNFC_ACTIVATE_DEVT *p_activate_params);
 
 #if(NFC_NXP_NOT_OPEN_INCLUDED == TRUE)
 static BOOLEAN rw_t4t_get_hw_version (void);
@@ -120,6 +125,7 @@ static BOOLEAN rw_t3bt_get_pupi (void);
 #endif
 static void rw_t4t_handle_error (tNFC_STATUS status, UINT8 sw1, UINT8 sw2);
 static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu);
+static BOOLEAN rw_t4t_strip_ddo (BT_HDR *p_r_apdu);
 static void rw_t4t_sm_read_ndef (BT_HDR *p_r_apdu);
 static void rw_t4t_sm_update_ndef (BT_HDR  *p_r_apdu);
 static void rw_t4t_sm_set_readonly (BT_HDR  *p_r_apdu);
@@ -140,6 +146,24 @@ static void rw_t3Bt_sm_get_card_id(BT_HDR *p_r_apdu);
 *******************************************************************************/
 static BOOLEAN rw_t4t_send_to_lower (BT_HDR *p_c_apdu)
 {
+    return rw_t4t_send_to_lower_ext (p_c_apdu, 0);
+}
+
+/*******************************************************************************
+**
+** Function         rw_t4t_send_to_lower_ext
+**
+** Description      Send C-APDU to lower layer, the response timeout grows
+**                  with the data carried by the C-APDU or expected in the
+**                  R-APDU (extended length APDUs)
+**
+** Returns          TRUE if success
+**
+*******************************************************************************/
+static BOOLEAN rw_t4t_send_to_lower_ext (BT_HDR *p_c_apdu, UINT32 data_len)
+{
+    UINT32 tout = RW_T4T_TOUT_RESP + ((data_len >> 10) * RW_T4T_TOUT_RESP_PER_KB);
+
 #if (BT_TRACE_PROTOCOL == TRUE)
     DispRWT4Tags (p_c_apdu, FALSE);
 #endif
@@ -151,7 +175,7 @@ static BOOLEAN rw_t4t_send_to_lower (BT_HDR *p_c_apdu)
     }
 
     nfc_start_quick_timer (&rw_cb.tcb.t4t.timer, NFC_TTYPE_RW_T4T_RESPONSE,
-                           (RW_T4T_TOUT_RESP * QUICK_TIMER_TICKS_PER_SEC) / 1000);
+                           (tout * QUICK_TIMER_TICKS_PER_SEC) / 1000);
 
     return TRUE;
 }
@@ -738,22 +762,45 @@ static BOOLEAN rw_t4t_select_file (UINT16 file_id)
     return TRUE;
 }
 
+/*******************************************************************************
+**
+** Function         rw_t4t_is_odo
+**
+** Description      Check if the file offset needs the ODO variant of
+**                  ReadBinary/UpdateBinary (offset beyond P1-P2, V3.0 tag)
+**
+** Returns          TRUE if the offset is sent in an ODO
+**
+*******************************************************************************/
+static BOOLEAN rw_t4t_is_odo (UINT32 offset)
+{
+    return (  (offset > T4T_MAX_OFFSET_IN_P1P2)
+            &&(rw_cb.tcb.t4t.cc_file.version >= T4T_VERSION_3_0)  );
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t4t_read_file
 **
 ** Description      Send ReadBinary Command to peer
 **
+**                  Short Le:    CLA B0 P1 P2 Le
+**                  Extended Le: CLA B0 P1 P2 00 Le1 Le2
+**                  ODO (V3.0):  CLA B1 00 00 05 54 03 Offset(3) Le
+**                               (Lc and Le are extended together)
+**
 ** Returns          TRUE if success
 **
 *******************************************************************************/
-static BOOLEAN rw_t4t_read_file (UINT16 offset, UINT16 length, BOOLEAN is_continue)
+static BOOLEAN rw_t4t_read_file (UINT32 offset, UINT32 length, BOOLEAN is_continue)
 {
     tRW_T4T_CB      *p_t4t = &rw_cb.tcb.t4t;
     BT_HDR          *p_c_apdu;
     UINT8           *p;
+    UINT32          le;
+    BOOLEAN         is_odo = rw_t4t_is_odo (offset);
 
-    RW_TRACE_DEBUG3 ("rw_t4t_read_file () offset:%d, length:%d, is_continue:%d, ",
+    RW_TRACE_DEBUG3 ("rw_t4t_read_file () offset:%lu, length:%lu, is_continue:%d, ",
                       offset, length, is_continue);
 
     p_c_apdu = (BT_HDR *) GKI_getpoolbuf (NFC_RW_POOL_ID);
@@ -774,22 +821,62 @@ static BOOLEAN rw_t4t_read_file (UINT16 offset, UINT16 length, BOOLEAN is_contin
     }
 
     /* adjust reading length if payload is bigger than max size per single command */
-    if (length > p_t4t->max_read_size)
+    /* with ODO, the data comes in a DDO whose header is counted in Le */
+    le = p_t4t->max_read_size;
+    if (is_odo)
     {
-        length = (UINT8) (p_t4t->max_read_size);
+        le -= T4T_DDO_MAX_HDR_SIZE;
     }
+    if (length > le)
+    {
+        length = le;
+    }
+    le = (is_odo) ? length + T4T_DDO_MAX_HDR_SIZE : length;
 
     p_c_apdu->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
     p = (UINT8 *) (p_c_apdu + 1) + p_c_apdu->offset;
 
     UINT8_TO_BE_STREAM (p, (T4T_CMD_CLASS | rw_cb.tcb.t4t.channel));
-    UINT8_TO_BE_STREAM (p, T4T_CMD_INS_READ_BINARY);
-    UINT16_TO_BE_STREAM (p, offset);
-    UINT8_TO_BE_STREAM (p, length); /* Le */
 
-    p_c_apdu->len = T4T_CMD_MIN_HDR_SIZE + 1; /* adding Le */
+    if (is_odo)
+    {
+        UINT8_TO_BE_STREAM (p, T4T_CMD_INS_READ_BINARY_ODO);
+        UINT16_TO_BE_STREAM (p, 0x0000);
+        if (le > T4T_MAX_LENGTH_LE)
+        {
+            UINT8_TO_BE_STREAM (p, 0x00);
+            UINT16_TO_BE_STREAM (p, T4T_ODO_SIZE);
+        }
+        else
+        {
+            UINT8_TO_BE_STREAM (p, T4T_ODO_SIZE);
+        }
+        UINT8_TO_BE_STREAM (p, T4T_ODO_TAG);
+        UINT8_TO_BE_STREAM (p, T4T_ODO_LENGTH);
+        UINT24_TO_BE_STREAM (p, offset);
+    }
+    else
+    {
+        UINT8_TO_BE_STREAM (p, T4T_CMD_INS_READ_BINARY);
+        UINT16_TO_BE_STREAM (p, offset);
+        if (le > T4T_MAX_LENGTH_LE)
+        {
+            UINT8_TO_BE_STREAM (p, 0x00);
+        }
+    }
 
-    if (!rw_t4t_send_to_lower (p_c_apdu))
+    if (le > T4T_MAX_LENGTH_LE)
+    {
+        UINT16_TO_BE_STREAM (p, le); /* extended Le, 0x0000 for 65536 */
+    }
+    else
+    {
+        UINT8_TO_BE_STREAM (p, le); /* Le */
+    }
+
+    p_c_apdu->len = (UINT16) (p - ((UINT8 *) (p_c_apdu + 1) + p_c_apdu->offset));
+
+    if (!rw_t4t_send_to_lower_ext (p_c_apdu, le))
     {
         return FALSE;
     }
@@ -806,12 +893,12 @@ static BOOLEAN rw_t4t_read_file (UINT16 offset, UINT16 length, BOOLEAN is_contin
 ** Returns          TRUE if success
 **
 *******************************************************************************/
-static BOOLEAN rw_t4t_update_nlen (UINT16 ndef_len)
+static BOOLEAN rw_t4t_update_nlen (UINT32 ndef_len)
 {
     BT_HDR          *p_c_apdu;
     UINT8           *p;
 
-    RW_TRACE_DEBUG1 ("rw_t4t_update_nlen () NLEN:%d", ndef_len);
+    RW_TRACE_DEBUG1 ("rw_t4t_update_nlen () NLEN:%lu", ndef_len);
 
     p_c_apdu = (BT_HDR *) GKI_getpoolbuf (NFC_RW_POOL_ID);
 
@@ -827,10 +914,17 @@ static BOOLEAN rw_t4t_update_nlen (UINT16 ndef_len)
     UINT8_TO_BE_STREAM (p, T4T_CMD_CLASS);
     UINT8_TO_BE_STREAM (p, T4T_CMD_INS_UPDATE_BINARY);
     UINT16_TO_BE_STREAM (p, 0x0000);                    /* offset for NLEN */
-    UINT8_TO_BE_STREAM (p, T4T_FILE_LENGTH_SIZE);
-    UINT16_TO_BE_STREAM (p, ndef_len);
+    UINT8_TO_BE_STREAM (p, rw_cb.tcb.t4t.nlen_size);
+    if (rw_cb.tcb.t4t.nlen_size == T4T_EFILE_LENGTH_SIZE)
+    {
+        UINT32_TO_BE_STREAM (p, ndef_len);              /* ENLEN */
+    }
+    else
+    {
+        UINT16_TO_BE_STREAM (p, ndef_len);
+    }
 
-    p_c_apdu->len = T4T_CMD_MAX_HDR_SIZE + T4T_FILE_LENGTH_SIZE;
+    p_c_apdu->len = T4T_CMD_MAX_HDR_SIZE + rw_cb.tcb.t4t.nlen_size;
 
     if (!rw_t4t_send_to_lower (p_c_apdu))
     {
@@ -846,6 +940,10 @@ static BOOLEAN rw_t4t_update_nlen (UINT16 ndef_len)
 **
 ** Description      Send UpdateBinary Command to peer
 **
+**                  Short Lc:    CLA D6 P1 P2 Lc Data
+**                  Extended Lc: CLA D6 P1 P2 00 Lc1 Lc2 Data
+**                  ODO (V3.0):  CLA D7 00 00 Lc 54 03 Offset(3) 53 L Data
+**
 ** Returns          TRUE if success
 **
 *******************************************************************************/
@@ -854,41 +952,109 @@ static BOOLEAN rw_t4t_update_file (void)
     tRW_T4T_CB      *p_t4t = &rw_cb.tcb.t4t;
     BT_HDR          *p_c_apdu;
     UINT8           *p;
-    UINT16          length;
+    UINT32          length, lc, max_lc;
+    BOOLEAN         is_odo = rw_t4t_is_odo (p_t4t->rw_offset);
 
-    RW_TRACE_DEBUG2 ("rw_t4t_update_file () rw_offset:%d, rw_length:%d",
+    RW_TRACE_DEBUG2 ("rw_t4t_update_file () rw_offset:%lu, rw_length:%lu",
                       p_t4t->rw_offset, p_t4t->rw_length);
 
-    p_c_apdu = (BT_HDR *) GKI_getpoolbuf (NFC_RW_POOL_ID);
+    /* try to send all of remaining data */
+    length = p_t4t->rw_length;
 
-    if (!p_c_apdu)
+    /* adjust updating length if payload is bigger than max size per single command */
+    max_lc = p_t4t->max_update_size;
+    if (is_odo)
     {
-        RW_TRACE_ERROR0 ("rw_t4t_write_file (): Cannot allocate buffer");
-        return FALSE;
+        if (max_lc <= T4T_ODO_SIZE + T4T_DDO_MAX_HDR_SIZE)
+        {
+            RW_TRACE_ERROR1 ("rw_t4t_update_file (): MaxLc (%lu) too small for ODO", max_lc);
+            return FALSE;
+        }
+        max_lc -= T4T_ODO_SIZE + T4T_DDO_MAX_HDR_SIZE;
+    }
+    if (length > max_lc)
+    {
+        length = max_lc;
     }
 
-    /* try to send all of remaining data */
-    length = p_t4t->rw_length;
+    lc = length;
+    if (is_odo)
+    {
+        lc += T4T_ODO_SIZE + 2;                                 /* 53 L */
+        if (length > 0x7F)
+        {
+            lc += (length > 0xFF) ? 2 : 1;                      /* 53 81 L or 53 82 L1 L2 */
+        }
+    }
 
-    /* adjust updating length if payload is bigger than max size per single command */
-    if (length > p_t4t->max_update_size)
+    /* an extended C-APDU may not fit in the RW pool */
+    if (T4T_CMD_MAX_EXT_HDR_SIZE + lc > T4T_CMD_MAX_HDR_SIZE + RW_T4T_MAX_DATA_PER_WRITE)
     {
-        length = (UINT8) (p_t4t->max_update_size);
+        p_c_apdu = (BT_HDR *) GKI_getpoolbuf (NFC_RW_EXT_POOL_ID);
+    }
+    else
+    {
+        p_c_apdu = (BT_HDR *) GKI_getpoolbuf (NFC_RW_POOL_ID);
+    }
+
+    if (!p_c_apdu)
+    {
+        RW_TRACE_ERROR0 ("rw_t4t_write_file (): Cannot allocate buffer");
+        return FALSE;
     }
 
     p_c_apdu->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
     p = (UINT8 *) (p_c_apdu + 1) + p_c_apdu->offset;
 
     UINT8_TO_BE_STREAM (p, T4T_CMD_CLASS);
-    UINT8_TO_BE_STREAM (p, T4T_CMD_INS_UPDATE_BINARY);
-    UINT16_TO_BE_STREAM (p, p_t4t->rw_offset);
-    UINT8_TO_BE_STREAM (p, length);
+    if (is_odo)
+    {
+        UINT8_TO_BE_STREAM (p, T4T_CMD_INS_UPDATE_BINARY_ODO);
+        UINT16_TO_BE_STREAM (p, 0x0000);
+    }
+    else
+    {
+        UINT8_TO_BE_STREAM (p, T4T_CMD_INS_UPDATE_BINARY);
+        UINT16_TO_BE_STREAM (p, p_t4t->rw_offset);
+    }
+
+    if (lc > T4T_MAX_LENGTH_LC)
+    {
+        UINT8_TO_BE_STREAM (p, 0x00);
+        UINT16_TO_BE_STREAM (p, lc); /* extended Lc */
+    }
+    else
+    {
+        UINT8_TO_BE_STREAM (p, lc);
+    }
+
+    if (is_odo)
+    {
+        UINT8_TO_BE_STREAM (p, T4T_ODO_TAG);
+        UINT8_TO_BE_STREAM (p, T4T_ODO_LENGTH);
+        UINT24_TO_BE_STREAM (p, p_t4t->rw_offset);
+        UINT8_TO_BE_STREAM (p, T4T_DDO_TAG);
+        if (length > 0xFF)
+        {
+            UINT8_TO_BE_STREAM (p, 0x82);
+            UINT16_TO_BE_STREAM (p, length);
+        }
+        else
+        {
+            if (length > 0x7F)
+            {
+                UINT8_TO_BE_STREAM (p, 0x81);
+            }
+            UINT8_TO_BE_STREAM (p, length);
+        }
+    }
 
     memcpy (p, p_t4t->p_update_data, length);
+    p += length;
 
-    p_c_apdu->len = T4T_CMD_MAX_HDR_SIZE + length;
+    p_c_apdu->len = (UINT16) (p - ((UINT8 *) (p_c_apdu + 1) + p_c_apdu->offset));
 
-    if (!rw_t4t_send_to_lower (p_c_apdu))
+    if (!rw_t4t_send_to_lower_ext (p_c_apdu, length))
     {
         return FALSE;
     }
@@ -931,7 +1097,14 @@ static BOOLEAN rw_t4t_update_cc_to_readonly (void)
     /* Add Command Header */
     UINT8_TO_BE_STREAM (p, T4T_CMD_CLASS);
     UINT8_TO_BE_STREAM (p, T4T_CMD_INS_UPDATE_BINARY);
-    UINT16_TO_BE_STREAM (p, (T4T_FC_TLV_OFFSET_IN_CC + T4T_FC_WRITE_ACCESS_OFFSET_IN_TLV)); /* Offset for Read Write access byte of CC */
+    if (rw_cb.tcb.t4t.nlen_size == T4T_EFILE_LENGTH_SIZE)
+    {
+        UINT16_TO_BE_STREAM (p, (T4T_FC_TLV_OFFSET_IN_CC + T4T_EFC_WRITE_ACCESS_OFFSET_IN_TLV)); /* ENDEF File Control TLV */
+    }
+    else
+    {
+        UINT16_TO_BE_STREAM (p, (T4T_FC_TLV_OFFSET_IN_CC + T4T_FC_WRITE_ACCESS_OFFSET_IN_TLV)); /* Offset for Read Write access byte of CC */
+    }
     UINT8_TO_BE_STREAM (p, 1); /* Length of write access field in cc interms of bytes */
 
     /* Remove Write access */
@@ -1040,7 +1213,10 @@ static BOOLEAN rw_t4t_validate_cc_file (void)
         return FALSE;
     }
 
-    if (T4T_GET_MAJOR_VERSION (p_t4t->cc_file.version) != T4T_GET_MAJOR_VERSION (p_t4t->version))
+    /* V3.0 tags use the V2.0 application */
+    if (  (T4T_GET_MAJOR_VERSION (p_t4t->cc_file.version) != T4T_GET_MAJOR_VERSION (p_t4t->version))
+        &&(  (p_t4t->version != T4T_VERSION_2_0)
+           ||(T4T_GET_MAJOR_VERSION (p_t4t->cc_file.version) != T4T_GET_MAJOR_VERSION (T4T_VERSION_3_0))  )  )
     {
         RW_TRACE_ERROR2 ("rw_t4t_validate_cc_file (): Peer version (0x%02X) is matched to ours (0x%02X)",
                          p_t4t->cc_file.version, p_t4t->version);
@@ -1064,7 +1240,7 @@ static BOOLEAN rw_t4t_validate_cc_file (void)
     if (  (p_t4t->cc_file.ndef_fc.file_id == T4T_CC_FILE_ID)
         ||(p_t4t->cc_file.ndef_fc.file_id == 0xE102)
         ||(p_t4t->cc_file.ndef_fc.file_id == 0xE103)
-        ||((p_t4t->cc_file.ndef_fc.file_id == 0x0000) && (p_t4t->cc_file.version == 0x20))
+        ||((p_t4t->cc_file.ndef_fc.file_id == 0x0000) && (p_t4t->cc_file.version >= 0x20))
         ||(p_t4t->cc_file.ndef_fc.file_id == 0x3F00)
         ||(p_t4t->cc_file.ndef_fc.file_id == 0x3FFF)
         ||(p_t4t->cc_file.ndef_fc.file_id == 0xFFFF)  )
@@ -1075,9 +1251,11 @@ static BOOLEAN rw_t4t_validate_cc_file (void)
     }
 
     if (  (p_t4t->cc_file.ndef_fc.max_file_size < 0x0005)
-        ||(p_t4t->cc_file.ndef_fc.max_file_size == 0xFFFF)  )
+        ||(  (p_t4t->nlen_size == T4T_FILE_LENGTH_SIZE)
+           &&(p_t4t->cc_file.ndef_fc.max_file_size == 0xFFFF)  )
+        ||(p_t4t->cc_file.ndef_fc.max_file_size == 0xFFFFFFFF)  )
     {
-        RW_TRACE_ERROR1 ("rw_t4t_validate_cc_file (): max_file_size (%d) is reserved",
+        RW_TRACE_ERROR1 ("rw_t4t_validate_cc_file (): max_file_size (%lu) is reserved",
                          p_t4t->cc_file.ndef_fc.max_file_size);
         return FALSE;
     }
@@ -1100,6 +1278,84 @@ static BOOLEAN rw_t4t_validate_cc_file (void)
     return TRUE;
 }
 
+/*******************************************************************************
+**
+** Function         rw_t4t_set_max_rw_size
+**
+** Description      Set the max data size per ReadBinary/UpdateBinary from
+**                  MLe/MLc of CC file. Extended Le/Lc are used only when the
+**                  tag asks for more than 255 bytes and its ATS does not deny
+**                  them; the size is then bound by the buffers of the stack.
+**
+** Returns          none
+**
+*******************************************************************************/
+static void rw_t4t_set_max_rw_size (void)
+{
+    tRW_T4T_CB  *p_t4t = &rw_cb.tcb.t4t;
+
+    /* Get max bytes to read per command */
+    if (  (p_t4t->cc_file.max_le > T4T_MAX_LENGTH_LE)
+        &&(p_t4t->ext_len_allowed)  )
+    {
+        p_t4t->max_read_size = p_t4t->cc_file.max_le;
+
+        if (p_t4t->max_read_size > RW_T4T_MAX_DATA_PER_EXT_READ)
+        {
+            p_t4t->max_read_size = RW_T4T_MAX_DATA_PER_EXT_READ;
+        }
+    }
+    else
+    {
+        if (p_t4t->cc_file.max_le >= RW_T4T_MAX_DATA_PER_READ)
+        {
+            p_t4t->max_read_size = RW_T4T_MAX_DATA_PER_READ;
+        }
+        else
+        {
+            p_t4t->max_read_size = p_t4t->cc_file.max_le;
+        }
+
+        /* Le: valid range is 0x01 to 0xFF */
+        if (p_t4t->max_read_size >= T4T_MAX_LENGTH_LE)
+        {
+            p_t4t->max_read_size = T4T_MAX_LENGTH_LE;
+        }
+    }
+
+    /* Get max bytes to update per command */
+    if (  (p_t4t->cc_file.max_lc > T4T_MAX_LENGTH_LC)
+        &&(p_t4t->ext_len_allowed)  )
+    {
+        p_t4t->max_update_size = p_t4t->cc_file.max_lc;
+
+        if (p_t4t->max_update_size > RW_T4T_MAX_DATA_PER_EXT_WRITE)
+        {
+            p_t4t->max_update_size = RW_T4T_MAX_DATA_PER_EXT_WRITE;
+        }
+    }
+    else
+    {
+        if (p_t4t->cc_file.max_lc >= RW_T4T_MAX_DATA_PER_WRITE)
+        {
+            p_t4t->max_update_size = RW_T4T_MAX_DATA_PER_WRITE;
+        }
+        else
+        {
+            p_t4t->max_update_size = p_t4t->cc_file.max_lc;
+        }
+
+        /* Lc: valid range is 0x01 to 0xFF */
+        if (p_t4t->max_update_size >= T4T_MAX_LENGTH_LC)
+        {
+            p_t4t->max_update_size = T4T_MAX_LENGTH_LC;
+        }
+    }
+
+    RW_TRACE_DEBUG2 ("rw_t4t_set_max_rw_size (): max_read_size:%lu, max_update_size:%lu",
+                      p_t4t->max_read_size, p_t4t->max_update_size);
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t4t_handle_error
@@ -1498,7 +1754,8 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
 {
     tRW_T4T_CB  *p_t4t = &rw_cb.tcb.t4t;
     UINT8       *p, type, length;
-    UINT16      status_words, nlen;
+    UINT16      status_words;
+    UINT32      nlen;
     tRW_DATA    rw_data;
 
 #if (BT_TRACE_VERBOSE == TRUE)
@@ -1582,6 +1839,8 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
             if (  (type == T4T_NDEF_FILE_CONTROL_TYPE)
                 &&(length == T4T_FILE_CONTROL_LENGTH)  )
             {
+                p_t4t->nlen_size = T4T_FILE_LENGTH_SIZE;
+
                 BE_STREAM_TO_UINT16 (p_t4t->cc_file.ndef_fc.file_id, p);
                 BE_STREAM_TO_UINT16 (p_t4t->cc_file.ndef_fc.max_file_size, p);
                 BE_STREAM_TO_UINT8 (p_t4t->cc_file.ndef_fc.read_access, p);
@@ -1595,7 +1854,7 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
                 RW_TRACE_DEBUG1 ("  MaxLc:  0x%04X",    p_t4t->cc_file.max_lc);
                 RW_TRACE_DEBUG0 ("  NDEF File Control TLV");
                 RW_TRACE_DEBUG1 ("    FileID:      0x%04X", p_t4t->cc_file.ndef_fc.file_id);
-                RW_TRACE_DEBUG1 ("    MaxFileSize: 0x%04X", p_t4t->cc_file.ndef_fc.max_file_size);
+                RW_TRACE_DEBUG1 ("    MaxFileSize: 0x%04lX", p_t4t->cc_file.ndef_fc.max_file_size);
                 RW_TRACE_DEBUG1 ("    ReadAccess:  0x%02X", p_t4t->cc_file.ndef_fc.read_access);
                 RW_TRACE_DEBUG1 ("    WriteAccess: 0x%02X", p_t4t->cc_file.ndef_fc.write_access);
 #endif
@@ -1613,6 +1872,68 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
                     break;
                 }
             }
+            else if (  (type == T4T_ENDEF_FILE_CONTROL_TYPE)
+                     &&(length == T4T_ENDEF_FILE_CONTROL_LENGTH)
+                     &&(p_t4t->cc_file.cclen >= T4T_CC_FILE_MIN_LEN + 2)  )
+            {
+                /* ENDEF File Control TLV is 2 bytes longer than the mandatory part of CC */
+                p_t4t->nlen_size = T4T_EFILE_LENGTH_SIZE;
+
+                BE_STREAM_TO_UINT16 (p_t4t->cc_file.ndef_fc.file_id, p);
+                BE_STREAM_TO_UINT32 (p_t4t->cc_file.ndef_fc.max_file_size, p);
+
+                if (!rw_t4t_read_file (T4T_CC_FILE_MIN_LEN, 2, FALSE))
+                {
+                    rw_t4t_handle_error (NFC_STATUS_FAILED, 0, 0);
+                }
+                else
+                {
+                    p_t4t->sub_state = RW_T4T_SUBSTATE_WAIT_ENDEF_FILE_CTRL_TLV;
+                }
+                break;
+            }
+        }
+
+        /* invalid response or CC file */
+        p_t4t->ndef_status &= ~ (RW_T4T_NDEF_STATUS_NDEF_DETECTED);
+        rw_t4t_handle_error (NFC_STATUS_BAD_RESP, 0, 0);
+        break;
+
+    case RW_T4T_SUBSTATE_WAIT_ENDEF_FILE_CTRL_TLV:
+
+        /* access conditions of ENDEF file have been read */
+        if (p_r_apdu->len == 2 + T4T_RSP_STATUS_WORDS_SIZE)
+        {
+            p = (UINT8 *) (p_r_apdu + 1) + p_r_apdu->offset;
+
+            BE_STREAM_TO_UINT8 (p_t4t->cc_file.ndef_fc.read_access, p);
+            BE_STREAM_TO_UINT8 (p_t4t->cc_file.ndef_fc.write_access, p);
+
+#if (BT_TRACE_VERBOSE == TRUE)
+            RW_TRACE_DEBUG0 ("Capability Container (CC) file");
+            RW_TRACE_DEBUG1 ("  CCLEN:  0x%04X",    p_t4t->cc_file.cclen);
+            RW_TRACE_DEBUG1 ("  Version:0x%02X",    p_t4t->cc_file.version);
+            RW_TRACE_DEBUG1 ("  MaxLe:  0x%04X",    p_t4t->cc_file.max_le);
+            RW_TRACE_DEBUG1 ("  MaxLc:  0x%04X",    p_t4t->cc_file.max_lc);
+            RW_TRACE_DEBUG0 ("  ENDEF File Control TLV");
+            RW_TRACE_DEBUG1 ("    FileID:      0x%04X", p_t4t->cc_file.ndef_fc.file_id);
+            RW_TRACE_DEBUG1 ("    MaxFileSize: 0x%08lX", p_t4t->cc_file.ndef_fc.max_file_size);
+            RW_TRACE_DEBUG1 ("    ReadAccess:  0x%02X", p_t4t->cc_file.ndef_fc.read_access);
+            RW_TRACE_DEBUG1 ("    WriteAccess: 0x%02X", p_t4t->cc_file.ndef_fc.write_access);
+#endif
+
+            if (rw_t4t_validate_cc_file ())
+            {
+                if (!rw_t4t_select_file (p_t4t->cc_file.ndef_fc.file_id))
+                {
+                    rw_t4t_handle_error (NFC_STATUS_FAILED, 0, 0);
+                }
+                else
+                {
+                    p_t4t->sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_NDEF_FILE;
+                }
+                break;
+            }
         }
 
         /* invalid response or CC file */
@@ -1622,8 +1943,8 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
 
     case RW_T4T_SUBSTATE_WAIT_SELECT_NDEF_FILE:
 
-        /* NDEF file has been selected then read the first 2 bytes (NLEN) */
-        if (!rw_t4t_read_file (0, T4T_FILE_LENGTH_SIZE, FALSE))
+        /* NDEF file has been selected then read the first 2 bytes (NLEN) or 4 bytes (ENLEN) */
+        if (!rw_t4t_read_file (0, p_t4t->nlen_size, FALSE))
         {
             rw_t4t_handle_error (NFC_STATUS_FAILED, 0, 0);
         }
@@ -1636,13 +1957,20 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
     case RW_T4T_SUBSTATE_WAIT_READ_NLEN:
 
         /* NLEN has been read then report upper layer */
-        if (p_r_apdu->len == T4T_FILE_LENGTH_SIZE + T4T_RSP_STATUS_WORDS_SIZE)
+        if (p_r_apdu->len == p_t4t->nlen_size + T4T_RSP_STATUS_WORDS_SIZE)
         {
             /* get length of NDEF */
             p = (UINT8 *) (p_r_apdu + 1) + p_r_apdu->offset;
-            BE_STREAM_TO_UINT16 (nlen, p);
+            if (p_t4t->nlen_size == T4T_EFILE_LENGTH_SIZE)
+            {
+                BE_STREAM_TO_UINT32 (nlen, p);
+            }
+            else
+            {
+                BE_STREAM_TO_UINT16 (nlen, p);
+            }
 
-            if (nlen <= p_t4t->cc_file.ndef_fc.max_file_size - T4T_FILE_LENGTH_SIZE)
+            if (nlen <= p_t4t->cc_file.ndef_fc.max_file_size - p_t4t->nlen_size)
             {
                 p_t4t->ndef_status = RW_T4T_NDEF_STATUS_NDEF_DETECTED;
 
@@ -1651,37 +1979,7 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
                     p_t4t->ndef_status |= RW_T4T_NDEF_STATUS_NDEF_READ_ONLY;
                 }
 
-                /* Get max bytes to read per command */
-                if (p_t4t->cc_file.max_le >= RW_T4T_MAX_DATA_PER_READ)
-                {
-                    p_t4t->max_read_size = RW_T4T_MAX_DATA_PER_READ;
-                }
-                else
-                {
-                    p_t4t->max_read_size = p_t4t->cc_file.max_le;
-                }
-
-                /* Le: valid range is 0x01 to 0xFF */
-                if (p_t4t->max_read_size >= T4T_MAX_LENGTH_LE)
-                {
-                    p_t4t->max_read_size = T4T_MAX_LENGTH_LE;
-                }
-
-                /* Get max bytes to update per command */
-                if (p_t4t->cc_file.max_lc >= RW_T4T_MAX_DATA_PER_WRITE)
-                {
-                    p_t4t->max_update_size = RW_T4T_MAX_DATA_PER_WRITE;
-                }
-                else
-                {
-                    p_t4t->max_update_size = p_t4t->cc_file.max_lc;
-                }
-
-                /* Lc: valid range is 0x01 to 0xFF */
-                if (p_t4t->max_update_size >= T4T_MAX_LENGTH_LC)
-                {
-                    p_t4t->max_update_size = T4T_MAX_LENGTH_LC;
-                }
+                rw_t4t_set_max_rw_size ();
 
                 p_t4t->ndef_length = nlen;
                 p_t4t->state       = RW_T4T_STATE_IDLE;
@@ -1690,7 +1988,7 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
                 {
                     rw_data.ndef.status   = NFC_STATUS_OK;
                     rw_data.ndef.protocol = NFC_PROTOCOL_ISO_DEP;
-                    rw_data.ndef.max_size = (UINT32) (p_t4t->cc_file.ndef_fc.max_file_size - (UINT16) T4T_FILE_LENGTH_SIZE);
+                    rw_data.ndef.max_size = p_t4t->cc_file.ndef_fc.max_file_size - p_t4t->nlen_size;
                     rw_data.ndef.cur_size = nlen;
                     rw_data.ndef.flags    = RW_NDEF_FL_SUPPORTED | RW_NDEF_FL_FORMATED;
                     if (p_t4t->cc_file.ndef_fc.write_access != T4T_FC_WRITE_ACCESS)
@@ -1706,8 +2004,8 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
             else
             {
                 /* NLEN should be less than max file size */
-                RW_TRACE_ERROR2 ("rw_t4t_sm_detect_ndef (): NLEN (%d) + 2 must be <= max file size (%d)",
-                                 nlen, p_t4t->cc_file.ndef_fc.max_file_size);
+                RW_TRACE_ERROR3 ("rw_t4t_sm_detect_ndef (): NLEN (%lu) + %d must be <= max file size (%lu)",
+                                 nlen, p_t4t->nlen_size, p_t4t->cc_file.ndef_fc.max_file_size);
 
                 p_t4t->ndef_status &= ~ (RW_T4T_NDEF_STATUS_NDEF_DETECTED);
                 rw_t4t_handle_error (NFC_STATUS_BAD_RESP, 0, 0);
@@ -1715,9 +2013,9 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
         }
         else
         {
-            /* response payload size should be T4T_FILE_LENGTH_SIZE */
+            /* response payload size should be T4T_FILE_LENGTH_SIZE or T4T_EFILE_LENGTH_SIZE */
             RW_TRACE_ERROR2 ("rw_t4t_sm_detect_ndef (): Length (%d) of R-APDU must be %d",
-                             p_r_apdu->len, T4T_FILE_LENGTH_SIZE + T4T_RSP_STATUS_WORDS_SIZE);
+                             p_r_apdu->len, p_t4t->nlen_size + T4T_RSP_STATUS_WORDS_SIZE);
 
             p_t4t->ndef_status &= ~ (RW_T4T_NDEF_STATUS_NDEF_DETECTED);
             rw_t4t_handle_error (NFC_STATUS_BAD_RESP, 0, 0);
@@ -1731,6 +2029,52 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
     }
 }
 
+/*******************************************************************************
+**
+** Function         rw_t4t_strip_ddo
+**
+** Description      Remove the DDO header (53 L, 53 81 L or 53 82 L1 L2) in
+**                  front of the data of a ReadBinary with ODO response
+**
+** Returns          TRUE if the DDO is valid
+**
+*******************************************************************************/
+static BOOLEAN rw_t4t_strip_ddo (BT_HDR *p_r_apdu)
+{
+    UINT8   *p = (UINT8 *) (p_r_apdu + 1) + p_r_apdu->offset;
+    UINT16  hdr_len, data_len;
+
+    if ((p_r_apdu->len < 2) || (p[0] != T4T_DDO_TAG))
+    {
+        return FALSE;
+    }
+
+    if (p[1] == 0x82)
+    {
+        hdr_len  = 4;
+        data_len = (p_r_apdu->len >= hdr_len) ? (UINT16) ((p[2] << 8) | p[3]) : 0xFFFF;
+    }
+    else if (p[1] == 0x81)
+    {
+        hdr_len  = 3;
+        data_len = (p_r_apdu->len >= hdr_len) ? p[2] : 0xFFFF;
+    }
+    else
+    {
+        hdr_len  = 2;
+        data_len = p[1];
+    }
+
+    if (data_len != p_r_apdu->len - hdr_len)
+    {
+        return FALSE;
+    }
+
+    p_r_apdu->offset += hdr_len;
+    p_r_apdu->len    -= hdr_len;
+    return TRUE;
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t4t_sm_read_ndef
@@ -1773,6 +2117,16 @@ static void rw_t4t_sm_read_ndef (BT_HDR *p_r_apdu)
         /* Read partial or complete data */
         p_r_apdu->len -= T4T_RSP_STATUS_WORDS_SIZE;
 
+        /* data read with ODO comes in a DDO */
+        if (  (rw_t4t_is_odo (p_t4t->rw_offset))
+            &&(!rw_t4t_strip_ddo (p_r_apdu))  )
+        {
+            RW_TRACE_ERROR0 ("rw_t4t_sm_read_ndef (): invalid DDO");
+            rw_t4t_handle_error (NFC_STATUS_BAD_RESP, 0, 0);
+            GKI_freebuf (p_r_apdu);
+            return;
+        }
+
         if ((p_r_apdu->len > 0) && (p_r_apdu->len <= p_t4t->rw_length))
         {
             p_t4t->rw_length -= p_r_apdu->len;
@@ -1813,7 +2167,7 @@ static void rw_t4t_sm_read_ndef (BT_HDR *p_r_apdu)
         }
         else
         {
-            RW_TRACE_ERROR2 ("rw_t4t_sm_read_ndef (): invalid payload length (%d), rw_length (%d)",
+            RW_TRACE_ERROR2 ("rw_t4t_sm_read_ndef (): invalid payload length (%d), rw_length (%lu)",
                              p_r_apdu->len, p_t4t->rw_length);
             rw_t4t_handle_error (NFC_STATUS_BAD_RESP, 0, 0);
         }
@@ -2243,6 +2597,59 @@ tNFC_STATUS RW_T4tFormatNDef(void)
     return NFC_STATUS_OK;
 }
 #endif
+/*******************************************************************************
+**
+** Function         rw_t4t_ext_len_allowed
+**
+** Description      Check the historical bytes of ATS for the card capabilities
+**                  (ISO/IEC 7816-4, COMPACT-TLV tag 7). Extended Lc/Le are
+**                  denied only when the card says it does not support them;
+**                  FSC does not limit them as the NFCC chains I-blocks.
+**
+** Returns          TRUE if extended Lc/Le may be used
+**
+*******************************************************************************/
+static BOOLEAN rw_t4t_ext_len_allowed (tNFC_ACTIVATE_DEVT *p_activate_params)
+{
+    tNFC_INTF_PA_ISO_DEP *p_pa_iso;
+    UINT8   *p, *p_end, tag, len;
+
+    if (  (p_activate_params == NULL)
+        ||(p_activate_params->intf_param.type != NFC_INTERFACE_ISO_DEP)
+        ||(p_activate_params->rf_tech_param.mode != NFC_DISCOVERY_TYPE_POLL_A)  )
+    {
+        return TRUE;
+    }
+
+    p_pa_iso = &p_activate_params->intf_param.intf_param.pa_iso;
+    if (  (p_pa_iso->his_byte_len < 2)
+        ||(p_pa_iso->his_byte[0] != T4T_HIS_CATEGORY_COMPACT_TLV)  )
+    {
+        return TRUE;
+    }
+
+    p     = &p_pa_iso->his_byte[1];
+    p_end = &p_pa_iso->his_byte[p_pa_iso->his_byte_len];
+    while (p < p_end)
+    {
+        tag = (*p) >> 4;
+        len = (*p) & 0x0F;
+        p++;
+
+        if (p + len > p_end)
+            break;
+
+        if ((tag == T4T_HIS_CARD_CAPABILITIES_TAG) && (len >= 3))
+        {
+            RW_TRACE_DEBUG1 ("rw_t4t_ext_len_allowed (): card capabilities 3rd byte:0x%02X", p[2]);
+            return ((p[2] & T4T_HIS_CARD_CAP_EXT_LEN) != 0);
+        }
+        p += len;
+    }
+
+    return TRUE;
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t4t_select
@@ -2252,7 +2659,7 @@ tNFC_STATUS RW_T4tFormatNDef(void)
 ** Returns          NFC_STATUS_OK if success
 **
 *******************************************************************************/
-tNFC_STATUS rw_t4t_select (void)
+tNFC_STATUS rw_t4t_select (tNFC_ACTIVATE_DEVT *p_activate_params)
 {
     tRW_T4T_CB  *p_t4t = &rw_cb.tcb.t4t;
 
@@ -2269,6 +2676,9 @@ tNFC_STATUS rw_t4t_select (void)
     /* These will be udated during NDEF detection */
     p_t4t->max_read_size   = T4T_MAX_LENGTH_LE;
     p_t4t->max_update_size = T4T_MAX_LENGTH_LC;
+    p_t4t->nlen_size       = T4T_FILE_LENGTH_SIZE;
+
+    p_t4t->ext_len_allowed = rw_t4t_ext_len_allowed (p_activate_params);
 
     return NFC_STATUS_OK;
 }
@@ -2351,7 +2761,7 @@ tNFC_STATUS RW_T4tReadNDef (void)
     if (rw_cb.tcb.t4t.ndef_status & RW_T4T_NDEF_STATUS_NDEF_DETECTED)
     {
         /* start reading NDEF */
-        if (!rw_t4t_read_file (T4T_FILE_LENGTH_SIZE, rw_cb.tcb.t4t.ndef_length, FALSE))
+        if (!rw_t4t_read_file (rw_cb.tcb.t4t.nlen_size, rw_cb.tcb.t4t.ndef_length, FALSE))
         {
             return NFC_STATUS_FAILED;
         }
@@ -2384,9 +2794,9 @@ tNFC_STATUS RW_T4tReadNDef (void)
 **                  NFC_STATUS_FAILED if T4T is busy or other error
 **
 *******************************************************************************/
-tNFC_STATUS RW_T4tUpdateNDef (UINT16 length, UINT8 *p_data)
+tNFC_STATUS RW_T4tUpdateNDef (UINT32 length, UINT8 *p_data)
 {
-    RW_TRACE_API1 ("RW_T4tUpdateNDef () length:%d", length);
+    RW_TRACE_API1 ("RW_T4tUpdateNDef () length:%lu", length);
 
     if (rw_cb.tcb.t4t.state != RW_T4T_STATE_IDLE)
     {
@@ -2405,9 +2815,9 @@ tNFC_STATUS RW_T4tUpdateNDef (UINT16 length, UINT8 *p_data)
             return NFC_STATUS_FAILED;
         }
 
-        if (rw_cb.tcb.t4t.cc_file.ndef_fc.max_file_size < length + T4T_FILE_LENGTH_SIZE)
+        if (rw_cb.tcb.t4t.cc_file.ndef_fc.max_file_size < length + rw_cb.tcb.t4t.nlen_size)
         {
-            RW_TRACE_ERROR2 ("RW_T4tUpdateNDef ():data (%d bytes) plus NLEN is more than max file size (%d)",
+            RW_TRACE_ERROR2 ("RW_T4tUpdateNDef ():data (%lu bytes) plus NLEN is more than max file size (%lu)",
                               length, rw_cb.tcb.t4t.cc_file.ndef_fc.max_file_size);
             return NFC_STATUS_FAILED;
         }
@@ -2416,7 +2826,7 @@ tNFC_STATUS RW_T4tUpdateNDef (UINT16 length, UINT8 *p_data)
         rw_cb.tcb.t4t.ndef_length   = length;
         rw_cb.tcb.t4t.p_update_data = p_data;
 
-        rw_cb.tcb.t4t.rw_offset     = T4T_FILE_LENGTH_SIZE;
+        rw_cb.tcb.t4t.rw_offset     = rw_cb.tcb.t4t.nlen_size;
         rw_cb.tcb.t4t.rw_length     = length;
 
         /* set NLEN to 0x0000 for the first step */
@@ -2673,6 +3083,8 @@ static char *rw_t4t_get_sub_state_name (UINT8 sub_state)
         return ("WAIT_SELECT_NDEF_FILE");
     case RW_T4T_SUBSTATE_WAIT_READ_NLEN:
         return ("WAIT_READ_NLEN");
+    case RW_T4T_SUBSTATE_WAIT_ENDEF_FILE_CTRL_TLV:
+        return ("WAIT_ENDEF_FILE_CTRL_TLV");
 
     case RW_T4T_SUBSTATE_WAIT_READ_RESP:
         return ("WAIT_READ_RESP");
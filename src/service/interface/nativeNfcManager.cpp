@@ -65,6 +65,7 @@ extern "C"
     #include "phNxpExtns.h"
     #include "phNxpConfig.h"
     #include "phNxpNciHal.h"
+    #include "phNxpInitProfile.h"
 }
 
 /*****************************************************************************
@@ -1336,6 +1337,8 @@ INT32 nativeNfcManager_doInitialize ()
         __FUNCTION__, NCI_VERSION);
     tNFA_STATUS stat = NFA_STATUS_OK;
     unsigned long num = 0;
+    int total, phase;
+    bool configValid;
 
     gSyncMutex.lock();
     NfcTag::getInstance ().mNfcDisableinProgress = false;
@@ -1345,9 +1348,16 @@ INT32 nativeNfcManager_doInitialize ()
         gSyncMutex.unlock();
         return sIsNfaEnabled;
     }
-    if (!isNxpConfigValid(NXP_CONFIG_TYPE_INIT))
+    phNxpInitProfile_Reset ();
+    total = phNxpInitProfile_Begin ("initialize");
+
+    phase = phNxpInitProfile_Begin ("config");
+    configValid = isNxpConfigValid(NXP_CONFIG_TYPE_INIT);
+    phNxpInitProfile_End (phase);
+    if (!configValid)
     {
         NXPLOG_API_E ("%s: can't find libnfc-nxp-init.conf file", __FUNCTION__);
+        phNxpInitProfile_End (total);
         gSyncMutex.unlock();
         return sIsNfaEnabled;
     }
@@ -1362,11 +1372,14 @@ INT32 nativeNfcManager_doInitialize ()
 
     NfcAdaptation& NfcAdaptInstance = NfcAdaptation::GetInstance();
 
+    phase = phNxpInitProfile_Begin ("adaptation");
     NfcAdaptInstance.Initialize(); //start GKI, NCI task, NFC task
+    phNxpInitProfile_End (phase);
     {
         SyncEventGuard guard (sNfaEnableEvent);
         tHAL_NFC_ENTRY* halFuncEntries = NfcAdaptInstance.GetHalEntryFuncs ();
 
+        phase = phNxpInitProfile_Begin ("nfa_enable");
         NFA_Init (halFuncEntries);
 
         stat = NFA_Enable (nfaDeviceManagementCallback, nfaConnectionCallback);
@@ -1384,8 +1397,11 @@ INT32 nativeNfcManager_doInitialize ()
             NFA_SnepSetTraceLevel(num);
             sNfaEnableEvent.wait(); //wait for NFA command to finish
         }
+        phNxpInitProfile_End (phase);
+        phase = phNxpInitProfile_Begin ("configure");
         EXTNS_Init(nfaDeviceManagementCallback, nfaConnectionCallback);
         NfcAdaptInstance.Configure();
+        phNxpInitProfile_End (phase);
     }
 
     if (stat == NFA_STATUS_OK)
@@ -1393,6 +1409,7 @@ INT32 nativeNfcManager_doInitialize ()
         //sIsNfaEnabled indicates whether stack started successfully
         if (sIsNfaEnabled)
         {
+            phase = phNxpInitProfile_Begin ("services");
             RoutingManager::getInstance().initialize();
             nativeNfcTag_registerNdefTypeHandler ();
             NfcTag::getInstance().initialize ();
@@ -1429,6 +1446,7 @@ INT32 nativeNfcManager_doInitialize ()
                 sDiscovery_duration = DEFAULT_DISCOVERY_DURATION;
 
             NFA_SetRfDiscoveryDuration(sDiscovery_duration);
+            phNxpInitProfile_End (phase);
             goto TheEnd;
         }
     }
@@ -1444,6 +1462,14 @@ INT32 nativeNfcManager_doInitialize ()
     NfcAdaptInstance.Finalize();
 
 TheEnd:
+    phNxpInitProfile_End (total);
+    {
+        phNxpInitProfile_Phase_t profile[PHNXP_INIT_PROFILE_MAX];
+        int n = phNxpInitProfile_Get (profile, PHNXP_INIT_PROFILE_MAX);
+        for (int i = 0; i < n; i++)
+            NXPLOG_API_D ("%s: %s start=%uus duration=%uus", __FUNCTION__,
+                    profile[i].name, profile[i].start_us, profile[i].duration_us);
+    }
     NXPLOG_API_D ("%s: nfc enabled = %x", __FUNCTION__, sIsNfaEnabled);
     NXPLOG_API_D ("%s: exit", __FUNCTION__);
     gSyncMutex.unlock();
@@ -1516,6 +1542,15 @@ INT32 nativeNfcManager_doDeinitialize ()
     NfcAdaptation& theInstance = NfcAdaptation::GetInstance();
     theInstance.Finalize();
 
+    {
+        IntervalTimer::Stats timers;
+        IntervalTimer::getStats (timers);
+        NXPLOG_API_D ("%s: interval timers pending=%u fired=%llu latency avg=%lluus max=%uus",
+                __FUNCTION__, timers.pending, (unsigned long long) timers.fired,
+                (unsigned long long) (timers.fired ? timers.totalLatencyUs / timers.fired : 0),
+                timers.maxLatencyUs);
+    }
+
     NXPLOG_API_D ("%s: exit", __FUNCTION__);
     gSyncMutex.unlock();
     return stat;
@@ -24,6 +24,8 @@
 #include "nativeNdef.h"
 #include "nfa_api.h"
 #include "nativeNfcLlcp.h"
+#include "phNxpInitProfile.h"
+#include "phNxpNciTrace.h"
 
 int ndef_readText(unsigned char *ndef_buff, unsigned int ndef_buff_length, char * out_text, unsigned int out_text_length)
 {
@@ -219,6 +221,30 @@ int nfcManager_getFwVersion ()
     return ((fwVer.rom_code_version & 0xFF ) << 16) | ((fwVer.major_version & 0xFF ) << 8) | (fwVer.minor_version & 0xFF);
 }
 
+int nfcManager_getInitProfile(nfcInitPhase_t *phases, int max_phases)
+{
+    phNxpInitProfile_Phase_t profile[PHNXP_INIT_PROFILE_MAX];
+    int i, n;
+
+    if (phases == NULL)
+        return 0;
+    n = phNxpInitProfile_Get(profile, (max_phases < PHNXP_INIT_PROFILE_MAX) ? max_phases : PHNXP_INIT_PROFILE_MAX);
+    for (i = 0; i < n; i++)
+    {
+        phases[i].name = profile[i].name;
+        phases[i].start_us = profile[i].start_us;
+        phases[i].duration_us = profile[i].duration_us;
+    }
+    return n;
+}
+
+int nfcManager_dumpNciTrace(const char *path)
+{
+    if (path == NULL)
+        return -1;
+    return phNxpNciTrace_Dump(path);
+}
+
 int nfcSnep_registerClientCallback(nfcSnepClientCallback_t *client_callback)
 {
     return nativeNfcSnep_registerClientCallback(client_callback);
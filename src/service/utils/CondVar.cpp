@@ -145,3 +145,22 @@ void CondVar::notifyOne ()
     }
 }
 
+
+/*******************************************************************************
+**
+** Function:        notifyAll
+**
+** Description:     Unblock all the waiting threads.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void CondVar::notifyAll ()
+{
+    int const res = pthread_cond_broadcast (&mCondition);
+    if (res)
+    {
+        NXPLOG_API_D ("CondVar::notifyAll: fail broadcast; error=0x%X", res);
+    }
+}
+
@@ -85,6 +85,18 @@ public:
     *******************************************************************************/
     void notifyOne ();
 
+
+    /*******************************************************************************
+    **
+    ** Function:        notifyAll
+    **
+    ** Description:     Unblock all the waiting threads.
+    **
+    ** Returns:         None.
+    **
+    *******************************************************************************/
+    void notifyAll ();
+
 private:
     pthread_cond_t mCondition;
 };
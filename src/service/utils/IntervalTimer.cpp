@@ -21,85 +21,494 @@
 #include "IntervalTimer.h"
 #include "OverrideLog.h"
 #include "phNxpLog.h"
+#include "Mutex.h"
+#include "CondVar.h"
 #include <string.h>
-#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+#include <vector>
+#include <deque>
 
-IntervalTimer::IntervalTimer()
+#define INTERVAL_TIMER_WORKERS      2
+
+static uint64_t monotonicNs ()
 {
-    mTimerId = 0;
-    mCb = NULL;
+    struct timespec now;
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
 }
 
 
-bool IntervalTimer::set(int ms, TIMER_FUNC cb)
+/*
+ *  Timer thread, heap of the armed timers and worker pool shared by all
+ *  IntervalTimer objects. Created on first use and kept for the lifetime of
+ *  the process, so static timers may still be killed while exiting.
+ */
+class TimerService
 {
-    if (mTimerId == 0)
+public:
+    static TimerService& getInstance ();
+    bool start ();
+    void arm (IntervalTimer* timer, int ms);
+    void cancel (IntervalTimer* timer, bool wait);
+    void getStats (IntervalTimer::Stats& stats);
+
+private:
+    struct Expiry
     {
-        if (cb == NULL)
-            return false;
+        IntervalTimer* timer;
+        uint32_t seq;
+        uint64_t deadline;
+    };
 
-        if (!create(cb))
-            return false;
+    struct Running
+    {
+        IntervalTimer* timer;
+        pthread_t worker;
+    };
+
+    TimerService ();
+    void heapSet (size_t pos, IntervalTimer* timer);
+    void heapFix (size_t pos);
+    void heapRemove (IntervalTimer* timer);
+    void rearm ();
+    static void* timerThread (void* arg);
+    static void* workerThread (void* arg);
+
+    Mutex mMutex;
+    CondVar mWork;
+    CondVar mDone;
+    int mTimerFd;
+    bool mStarted;
+    std::vector<IntervalTimer*> mHeap;
+    std::deque<Expiry> mReady;
+    std::vector<Running> mRunning;    /* callbacks in progress */
+    IntervalTimer::Stats mStats;
+};
+
+
+TimerService& TimerService::getInstance ()
+{
+    static TimerService* sInstance = new TimerService ();
+    return *sInstance;
+}
+
+
+TimerService::TimerService ()
+:   mTimerFd (-1),
+    mStarted (false)
+{
+    memset (&mStats, 0, sizeof(mStats));
+}
+
+
+/*******************************************************************************
+**
+** Function:        start
+**
+** Description:     Create the timerfd, the timer thread and the workers, if
+**                  not done yet.
+**
+** Returns:         True if the service runs.
+**
+*******************************************************************************/
+bool TimerService::start ()
+{
+    AutoMutex mutex (mMutex);
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    if (mStarted)
+        return true;
+
+    mTimerFd = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (mTimerFd < 0)
+    {
+        NXPLOG_API_E ("TimerService::start: fail create timerfd; errno=0x%X", errno);
+        return false;
     }
-    if (cb != mCb)
+    pthread_attr_init (&attr);
+    pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create (&thread, &attr, timerThread, this) != 0)
     {
-        kill();
-        if (!create(cb))
-            return false;
+        NXPLOG_API_E ("TimerService::start: fail create timer thread");
+        pthread_attr_destroy (&attr);
+        close (mTimerFd);
+        mTimerFd = -1;
+        return false;
+    }
+    pthread_setname_np (thread, "INTERVAL_TIMER");
+    for (int i = 0; i < INTERVAL_TIMER_WORKERS; i++)
+    {
+        if (pthread_create (&thread, &attr, workerThread, this) != 0)
+        {
+            NXPLOG_API_E ("TimerService::start: fail create worker %d", i);
+        }
+        else
+        {
+            pthread_setname_np (thread, "INTERVAL_TIMER_W");
+        }
+    }
+    pthread_attr_destroy (&attr);
+    mStarted = true;
+    return true;
+}
+
+
+/*******************************************************************************
+**
+** Function:        arm
+**
+** Description:     (Re)start a timer to expire in ms milliseconds.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void TimerService::arm (IntervalTimer* timer, int ms)
+{
+    AutoMutex mutex (mMutex);
+
+    heapRemove (timer);
+    timer->mSeq++;
+    timer->mDeadline = monotonicNs () + (uint64_t) (ms > 0 ? ms : 0) * 1000000ULL;
+    mHeap.push_back (timer);
+    heapFix (mHeap.size () - 1);
+    rearm ();
+}
+
+
+/*******************************************************************************
+**
+** Function:        cancel
+**
+** Description:     Stop a timer and drop its callback if expired but not run.
+**                  With wait, also wait for the callback if a worker runs it,
+**                  so that the timer may be freed on return. A callback
+**                  killing its own timer is not waited for.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void TimerService::cancel (IntervalTimer* timer, bool wait)
+{
+    AutoMutex mutex (mMutex);
+    pthread_t self = pthread_self ();
+    bool running;
+
+    timer->mSeq++;
+    timer->mCb = NULL;
+    if (timer->mHeapPos != 0)
+    {
+        heapRemove (timer);
+        rearm ();
+    }
+    for (std::deque<Expiry>::iterator it = mReady.begin (); it != mReady.end (); )
+    {
+        if (it->timer == timer)
+            it = mReady.erase (it);
+        else
+            ++it;
+    }
+
+    if (!wait)
+        return;
+    do
+    {
+        running = false;
+        for (size_t i = 0; i < mRunning.size (); i++)
+        {
+            if (mRunning[i].timer == timer && !pthread_equal (mRunning[i].worker, self))
+                running = true;
+        }
+        if (running)
+            mDone.wait (mMutex);
+    } while (running);
+}
+
+
+/*******************************************************************************
+**
+** Function:        getStats
+**
+** Description:     Copy the counters of the service.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void TimerService::getStats (IntervalTimer::Stats& stats)
+{
+    AutoMutex mutex (mMutex);
+
+    stats = mStats;
+    stats.pending = mHeap.size ();
+    stats.queued = mReady.size ();
+}
+
+
+void TimerService::heapSet (size_t pos, IntervalTimer* timer)
+{
+    mHeap[pos] = timer;
+    timer->mHeapPos = pos + 1;
+}
+
+
+/*******************************************************************************
+**
+** Function:        heapFix
+**
+** Description:     Move the timer at pos up or down until the heap is ordered
+**                  by deadline again.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void TimerService::heapFix (size_t pos)
+{
+    IntervalTimer* timer = mHeap[pos];
+    size_t child;
+
+    while (pos > 0 && mHeap[(pos - 1) / 2]->mDeadline > timer->mDeadline)
+    {
+        heapSet (pos, mHeap[(pos - 1) / 2]);
+        pos = (pos - 1) / 2;
+    }
+    for (;;)
+    {
+        child = 2 * pos + 1;
+        if (child >= mHeap.size ())
+            break;
+        if (child + 1 < mHeap.size () && mHeap[child + 1]->mDeadline < mHeap[child]->mDeadline)
+            child++;
+        if (mHeap[child]->mDeadline >= timer->mDeadline)
+            break;
+        heapSet (pos, mHeap[child]);
+        pos = child;
+    }
+    heapSet (pos, timer);
+}
+
+
+void TimerService::heapRemove (IntervalTimer* timer)
+{
+    size_t pos = timer->mHeapPos;
+    IntervalTimer* last;
+
+    if (pos == 0)
+        return;
+    pos--;
+    timer->mHeapPos = 0;
+    last = mHeap.back ();
+    mHeap.pop_back ();
+    if (pos < mHeap.size ())
+    {
+        heapSet (pos, last);
+        heapFix (pos);
     }
+}
+
 
-    int stat = 0;
+/*******************************************************************************
+**
+** Function:        rearm
+**
+** Description:     Arm the timerfd for the earliest deadline, or disarm it
+**                  when no timer runs.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void TimerService::rearm ()
+{
     struct itimerspec ts;
-    ts.it_value.tv_sec = ms / 1000;
-    ts.it_value.tv_nsec = (ms % 1000) * 1000000;
 
-    ts.it_interval.tv_sec = 0;
-    ts.it_interval.tv_nsec = 0;
+    memset (&ts, 0, sizeof(ts));
+    if (!mHeap.empty ())
+    {
+        ts.it_value.tv_sec = mHeap[0]->mDeadline / 1000000000ULL;
+        ts.it_value.tv_nsec = mHeap[0]->mDeadline % 1000000000ULL;
+    }
+    if (timerfd_settime (mTimerFd, TFD_TIMER_ABSTIME, &ts, NULL) == -1)
+    {
+        NXPLOG_API_E ("TimerService::rearm: fail set timerfd; errno=0x%X", errno);
+    }
+}
+
+
+/*******************************************************************************
+**
+** Function:        timerThread
+**
+** Description:     Wait on the timerfd and hand every expired timer to the
+**                  workers.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void* TimerService::timerThread (void* arg)
+{
+    TimerService* service = (TimerService*) arg;
+    uint64_t expirations;
+
+    for (;;)
+    {
+        if (read (service->mTimerFd, &expirations, sizeof(expirations)) < 0 &&
+                errno != EINTR && errno != EAGAIN)
+        {
+            NXPLOG_API_E ("TimerService::timerThread: fail read; errno=0x%X", errno);
+        }
+
+        AutoMutex mutex (service->mMutex);
+        uint64_t now = monotonicNs ();
+        while (!service->mHeap.empty () && service->mHeap[0]->mDeadline <= now)
+        {
+            IntervalTimer* timer = service->mHeap[0];
+            Expiry expiry = { timer, timer->mSeq, timer->mDeadline };
+
+            service->heapRemove (timer);
+            service->mReady.push_back (expiry);
+            service->mWork.notifyOne ();
+        }
+        service->rearm ();
+    }
+    return NULL;
+}
+
+
+/*******************************************************************************
+**
+** Function:        workerThread
+**
+** Description:     Run the callbacks of expired timers.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void* TimerService::workerThread (void* arg)
+{
+    TimerService* service = (TimerService*) arg;
+
+    for (;;)
+    {
+        IntervalTimer* timer;
+        IntervalTimer::TIMER_FUNC cb;
+        union sigval value;
+
+        service->mMutex.lock ();
+        while (service->mReady.empty ())
+            service->mWork.wait (service->mMutex);
+        Expiry expiry = service->mReady.front ();
+        service->mReady.pop_front ();
+        timer = expiry.timer;
+        if (expiry.seq != timer->mSeq)
+        {
+            /* killed or set again after it expired */
+            service->mMutex.unlock ();
+            continue;
+        }
+        cb = timer->mCb;
+        uint64_t latencyUs = (monotonicNs () - expiry.deadline) / 1000;
+        service->mStats.fired++;
+        service->mStats.totalLatencyUs += latencyUs;
+        if (latencyUs > service->mStats.maxLatencyUs)
+            service->mStats.maxLatencyUs = latencyUs;
+        Running running = { timer, pthread_self () };
+        service->mRunning.push_back (running);
+        service->mMutex.unlock ();
+
+        value.sival_ptr = timer;
+        cb (value);
+
+        /* the callback may have freed the timer: only its address is used */
+        service->mMutex.lock ();
+        for (size_t i = 0; i < service->mRunning.size (); i++)
+        {
+            if (pthread_equal (service->mRunning[i].worker, running.worker))
+            {
+                service->mRunning.erase (service->mRunning.begin () + i);
+                break;
+            }
+        }
+        service->mDone.notifyAll ();
+        service->mMutex.unlock ();
+    }
+    return NULL;
+}
+
 
-    stat = timer_settime(mTimerId, 0, &ts, 0);
-    if (stat == -1)
+IntervalTimer::IntervalTimer()
+{
+    mCb = NULL;
+    mDeadline = 0;
+    mHeapPos = 0;
+    mSeq = 0;
+}
+
+
+bool IntervalTimer::set(int ms, TIMER_FUNC cb)
+{
+    if (mCb == NULL || cb != mCb)
     {
-        NXPLOG_API_D("IntervalTimer::set: fail set timer");
+        if (cb == NULL)
+            return false;
+
+        if (!create(cb))
+            return false;
     }
-    return stat == 0;
+
+    TimerService::getInstance ().arm (this, ms);
+    return true;
 }
 
 
 IntervalTimer::~IntervalTimer()
 {
-    kill();
+    killSync();
 }
 
 
+/*
+ *  Does not wait for a callback already running: callers may hold locks the
+ *  callback takes.
+ */
 void IntervalTimer::kill()
 {
-    if (mTimerId == 0)
+    if (mCb == NULL)
         return;
 
-    timer_delete(mTimerId);
-    mTimerId = 0;
-    mCb = NULL;
+    TimerService::getInstance ().cancel (this, false);
+}
+
+
+/*
+ *  Like kill, and also waits for a running callback, so that the timer may be
+ *  freed. Must not be called with a lock the callback takes.
+ */
+void IntervalTimer::killSync()
+{
+    /* also when mCb is NULL: an earlier kill did not wait */
+    if (mCb == NULL && mSeq == 0)
+        return;
+
+    TimerService::getInstance ().cancel (this, true);
 }
 
 
 bool IntervalTimer::create(TIMER_FUNC cb)
 {
-    struct sigevent se = {0, 0, 0, 0};
-    int stat = 0;
-
-    /*
-     * Set the sigevent structure to cause the signal to be
-     * delivered by creating a new thread.
-     */
-    se.sigev_notify = SIGEV_THREAD;
-    se.sigev_value.sival_ptr = &mTimerId;
-    se.sigev_notify_function = cb;
-    se.sigev_notify_attributes = NULL;
-    mCb = cb;
-    stat = timer_create(CLOCK_MONOTONIC, &se, &mTimerId);
-    if (stat == -1)
+    if (!TimerService::getInstance ().start ())
     {
         NXPLOG_API_D("IntervalTimer::create: fail create timer");
+        return false;
     }
-    return stat == 0;
+    kill();
+    mCb = cb;
+    return true;
+}
+
+
+void IntervalTimer::getStats(Stats& stats)
+{
+    TimerService::getInstance ().getStats (stats);
 }
@@ -16,9 +16,17 @@
 
 /*
  *  Asynchronous interval timer.
+ *
+ *  All interval timers are served by one thread waiting on a CLOCK_MONOTONIC
+ *  timerfd, armed for the earliest deadline of a heap of the running timers.
+ *  Expired callbacks run on a small fixed pool of worker threads, so a slow
+ *  callback delays neither the other timers nor the expiry of new ones.
  */
 
+#pragma once
 #include <time.h>
+#include <stdint.h>
+#include <signal.h>
 
 
 class IntervalTimer
@@ -26,13 +34,29 @@ class IntervalTimer
 public:
     typedef void (*TIMER_FUNC) (union sigval);
 
+    /* counters of the shared timer service */
+    struct Stats
+    {
+        uint32_t pending;           /* timers armed and not expired yet */
+        uint32_t queued;            /* expired, waiting for a worker */
+        uint64_t fired;             /* callbacks run */
+        uint64_t totalLatencyUs;    /* sum of deadline to callback start */
+        uint32_t maxLatencyUs;
+    };
+
     IntervalTimer();
     ~IntervalTimer();
     bool set(int ms, TIMER_FUNC cb);
     void kill();
+    void killSync();
     bool create(TIMER_FUNC );
+    static void getStats(Stats& stats);
 
 private:
-    timer_t mTimerId;
+    friend class TimerService;
+
     TIMER_FUNC mCb;
+    uint64_t mDeadline;     /* CLOCK_MONOTONIC in ns */
+    size_t mHeapPos;        /* position + 1 in the heap, 0 if not armed */
+    uint32_t mSeq;          /* changed by set and kill, cancels a queued callback */
 };
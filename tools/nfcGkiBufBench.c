@@ -0,0 +1,255 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License")
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  GKI_getbuf pool selection benchmark. Initializes GKI with the pools of
+ *  gki_target.h, then allocates and frees buffers of a fixed size mix two
+ *  ways:
+ *    scan  - the former selection: first pool_list position that fits the
+ *            size, then the first public pool with a free buffer from
+ *            there, taken with GKI_getpoolbuf
+ *    index - GKI_getbuf: size class table and pool bitmaps
+ *  Both take the buffer from the same lock-free free stack, so the
+ *  difference is the selection. The former GKI mutex around the scan is
+ *  not counted. Holding <depth> buffers at once exhausts the small pools
+ *  and exercises the fallback to larger ones. The two ways are first
+ *  checked to pick the same pools.
+ *
+ *  Usage: nfcGkiBufBench [-n <rounds>] [-d <depth>]
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "gki_int.h"
+
+#define BENCH_MAX_DEPTH     256
+
+/* NCI control and data sizes seen by the stack, then a few larger ones */
+static const UINT16 bench_sizes[] =
+{
+    16, 40, 64, 100, 128, 200, 260, 268, 300, 512, 660, 748, 1024, 2048, 2500
+};
+#define BENCH_NUM_SIZES     (sizeof (bench_sizes) / sizeof (bench_sizes[0]))
+
+typedef void *(tBENCH_ALLOC) (UINT16 size);
+
+/*******************************************************************************
+**
+** Function         now_ns
+**
+** Description      CLOCK_MONOTONIC in nanoseconds
+**
+*******************************************************************************/
+static unsigned long long now_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*******************************************************************************
+**
+** Function         scan_getbuf
+**
+** Description      Pool selection of GKI_getbuf before the size class table:
+**                  two linear passes over pool_list
+**
+** Returns          buffer, NULL if none available
+**
+*******************************************************************************/
+static void *scan_getbuf (UINT16 size)
+{
+    tGKI_COM_CB  *p_cb = &gki_cb.com;
+    FREE_QUEUE_T *Q;
+    UINT8         i;
+
+    for (i = 0; i < p_cb->curr_total_no_of_pools; i++)
+    {
+        if (size <= p_cb->freeq[p_cb->pool_list[i]].size)
+            break;
+    }
+    if (i == p_cb->curr_total_no_of_pools)
+        return NULL;
+
+    for ( ; i < p_cb->curr_total_no_of_pools; i++)
+    {
+        if (((UINT16)1 << p_cb->pool_list[i]) & p_cb->pool_access_mask)
+            continue;
+
+        Q = &p_cb->freeq[p_cb->pool_list[i]];
+        if (Q->cur_cnt < Q->total)
+            return GKI_getpoolbuf (p_cb->pool_list[i]);
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         index_getbuf
+**
+** Description      GKI_getbuf, whatever GKI_BUFFER_DEBUG says
+**
+** Returns          buffer, NULL if none available
+**
+*******************************************************************************/
+static void *index_getbuf (UINT16 size)
+{
+    return GKI_getbuf (size);
+}
+
+/*******************************************************************************
+**
+** Function         run
+**
+** Description      Allocates <depth> buffers of the size mix, then frees
+**                  them, <rounds> times
+**
+** Returns          nanoseconds per allocation and free
+**
+*******************************************************************************/
+static double run (tBENCH_ALLOC *p_alloc, int rounds, int depth, long *p_failed)
+{
+    void *held[BENCH_MAX_DEPTH];
+    unsigned long long t0, t1;
+    unsigned int next = 0;
+    int r, k;
+
+    *p_failed = 0;
+    t0 = now_ns ();
+    for (r = 0; r < rounds; r++)
+    {
+        for (k = 0; k < depth; k++)
+        {
+            held[k] = p_alloc (bench_sizes[next]);
+            if (++next == BENCH_NUM_SIZES)
+                next = 0;
+        }
+        for (k = 0; k < depth; k++)
+        {
+            if (held[k])
+                GKI_freebuf (held[k]);
+            else
+                (*p_failed)++;
+        }
+    }
+    t1 = now_ns ();
+    return (double) (t1 - t0) / ((double) rounds * depth);
+}
+
+/*******************************************************************************
+**
+** Function         check
+**
+** Description      Checks that both selections pick pools of the same buffer
+**                  size for every allocation of one round of each start
+**                  offset in the size mix
+**
+** Returns          number of mismatches
+**
+*******************************************************************************/
+static int check (int depth)
+{
+    void *held[BENCH_MAX_DEPTH];
+    UINT16 scan_size[BENCH_MAX_DEPTH];
+    unsigned int start;
+    int k, mismatch = 0;
+
+    for (start = 0; start < BENCH_NUM_SIZES; start++)
+    {
+        for (k = 0; k < depth; k++)
+            held[k] = scan_getbuf (bench_sizes[(start + k) % BENCH_NUM_SIZES]);
+        for (k = 0; k < depth; k++)
+        {
+            scan_size[k] = (held[k]) ? GKI_get_buf_size (held[k]) : 0;
+            if (held[k])
+                GKI_freebuf (held[k]);
+        }
+
+        for (k = 0; k < depth; k++)
+            held[k] = index_getbuf (bench_sizes[(start + k) % BENCH_NUM_SIZES]);
+        for (k = 0; k < depth; k++)
+        {
+            if (scan_size[k] != ((held[k]) ? GKI_get_buf_size (held[k]) : 0))
+                mismatch++;
+            if (held[k])
+                GKI_freebuf (held[k]);
+        }
+    }
+    return mismatch;
+}
+
+int main (int argc, char *argv[])
+{
+    tGKI_COM_CB *p_cb;
+    int rounds = 200000, depth = 1;
+    double scan_ns, index_ns;
+    long scan_failed, index_failed;
+    int opt, i, mismatch;
+
+    while ((opt = getopt (argc, argv, "n:d:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': rounds = atoi (optarg); break;
+        case 'd': depth = atoi (optarg); break;
+        default:
+            fprintf (stderr, "usage: %s [-n <rounds>] [-d <depth>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((rounds <= 0) || (depth <= 0) || (depth > BENCH_MAX_DEPTH))
+    {
+        fprintf (stderr, "rounds must be positive and depth 1 to %d\n", BENCH_MAX_DEPTH);
+        return 1;
+    }
+
+    GKI_init ();
+    p_cb = &gki_cb.com;
+
+    printf ("pool  size  count  access\n");
+    for (i = 0; i < p_cb->curr_total_no_of_pools; i++)
+    {
+        printf ("%4d %5u %6u  %s\n", p_cb->pool_list[i],
+                p_cb->freeq[p_cb->pool_list[i]].size, p_cb->freeq[p_cb->pool_list[i]].total,
+                (((UINT16)1 << p_cb->pool_list[i]) & p_cb->pool_access_mask) ? "restricted" : "public");
+    }
+
+    if ((mismatch = check (depth)) != 0)
+    {
+        fprintf (stderr, "%d allocations got a buffer of another pool\n", mismatch);
+        return 1;
+    }
+
+    /* warm up the pools, which may be allocated on first use */
+    run (index_getbuf, 1000, depth, &index_failed);
+
+    scan_ns  = run (scan_getbuf, rounds, depth, &scan_failed);
+    index_ns = run (index_getbuf, rounds, depth, &index_failed);
+
+    printf ("depth %d, %d sizes, %d rounds\n", depth, (int) BENCH_NUM_SIZES, rounds);
+    printf ("scan   %8.1f ns per getbuf/freebuf  %ld failed\n", scan_ns, scan_failed);
+    printf ("index  %8.1f ns per getbuf/freebuf  %ld failed\n", index_ns, index_failed);
+    return 0;
+}
@@ -0,0 +1,279 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License")
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  TIMER_LIST_Q stress benchmark. Measures the backend the library was
+ *  built with: the delta list, or the timing wheel with
+ *  GKI_TIMER_WHEEL=TRUE (build both with the same CFLAGS).
+ *
+ *  First a random mix of starts, restarts, stops and list updates runs
+ *  against a plain array model, which checks every expiry and a sample of
+ *  GKI_get_remaining_ticks values. Then <timers> timers of 1 to <span>
+ *  units are timed through a start of all of them, a stop of every other
+ *  one, and updates one unit at a time until the list is empty.
+ *
+ *  Usage: nfcGkiTimerBench [-n <timers>] [-s <span>] [-c <check ops>]
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "gki.h"
+
+#define BENCH_NO_DEADLINE   0xFFFFFFFF
+
+static TIMER_LIST_Q     bench_q;
+static TIMER_LIST_ENT  *bench_tle;
+static UINT32          *bench_deadline;     /* model: absolute expiry, or BENCH_NO_DEADLINE */
+static UINT32           bench_now;          /* model: list units updated so far */
+static UINT32           bench_rand_state = 0x2545F491;
+
+/*******************************************************************************
+**
+** Function         now_ns
+**
+** Description      CLOCK_MONOTONIC in nanoseconds
+**
+*******************************************************************************/
+static unsigned long long now_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*******************************************************************************
+**
+** Function         bench_rand
+**
+** Description      xorshift32, so that runs are repeatable
+**
+*******************************************************************************/
+static UINT32 bench_rand (void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 17;
+    bench_rand_state ^= bench_rand_state << 5;
+    return bench_rand_state;
+}
+
+/*******************************************************************************
+**
+** Function         start / stop
+**
+** Description      Start or stop timer i in the list and in the model
+**
+*******************************************************************************/
+static void start (UINT32 i, INT32 ticks)
+{
+    GKI_remove_from_timer_list (&bench_q, &bench_tle[i]);
+    bench_tle[i].ticks = ticks;
+    bench_tle[i].param = i;
+    GKI_add_to_timer_list (&bench_q, &bench_tle[i]);
+    bench_deadline[i] = bench_now + ticks;
+}
+
+static void stop (UINT32 i)
+{
+    GKI_remove_from_timer_list (&bench_q, &bench_tle[i]);
+    bench_deadline[i] = BENCH_NO_DEADLINE;
+}
+
+/*******************************************************************************
+**
+** Function         update
+**
+** Description      Moves the list on by <units>, then removes the expired
+**                  entries the way nfc_process_quick_timer_evt does. With
+**                  <check>, each expired entry must be due in the model and
+**                  come no earlier than the one before it.
+**
+** Returns          number of errors
+**
+*******************************************************************************/
+static int update (UINT32 units, BOOLEAN check, UINT32 *p_expired)
+{
+    TIMER_LIST_ENT *p_tle;
+    UINT32 last = 0;
+    int errors = 0;
+
+    bench_now += units;
+    GKI_update_timer_list (&bench_q, (INT32) units);
+
+    while (((p_tle = GKI_timer_getfirst (&bench_q)) != NULL) && (!p_tle->ticks))
+    {
+        GKI_remove_from_timer_list (&bench_q, p_tle);
+        if (check)
+        {
+            if ((bench_deadline[p_tle->param] == BENCH_NO_DEADLINE)
+             || (bench_deadline[p_tle->param] > bench_now)
+             || (bench_deadline[p_tle->param] < last))
+            {
+                errors++;
+            }
+            last = bench_deadline[p_tle->param];
+        }
+        bench_deadline[p_tle->param] = BENCH_NO_DEADLINE;
+        (*p_expired)++;
+    }
+    return errors;
+}
+
+/*******************************************************************************
+**
+** Function         check_model
+**
+** Description      Runs <ops> random operations on <timers> timers and
+**                  compares the list with the model
+**
+** Returns          number of errors
+**
+*******************************************************************************/
+static int check_model (UINT32 timers, UINT32 span, UINT32 ops)
+{
+    UINT32 op, i, k, expired = 0;
+    int errors = 0;
+
+    for (op = 0; op < ops; op++)
+    {
+        i = bench_rand () % timers;
+        switch (bench_rand () % 10)
+        {
+        case 0: case 1: case 2: case 3: case 4:
+            start (i, (INT32) (1 + bench_rand () % span));
+            break;
+        case 5: case 6:
+            stop (i);
+            break;
+        default:
+            errors += update (1 + bench_rand () % (span / 16 + 1), TRUE, &expired);
+            break;
+        }
+
+        /* nothing due may be left behind, and a sample of the remaining
+        ** times must match (GKI_get_remaining_ticks walks the delta list) */
+        if ((op % 997) == 0)
+        {
+            for (i = 0; i < timers; i++)
+            {
+                if ((bench_deadline[i] != BENCH_NO_DEADLINE) && (bench_deadline[i] <= bench_now))
+                    errors++;
+            }
+            for (k = 0; k < 16; k++)
+            {
+                i = bench_rand () % timers;
+                if ((bench_deadline[i] != BENCH_NO_DEADLINE)
+                 && (GKI_get_remaining_ticks (&bench_q, &bench_tle[i]) != bench_deadline[i] - bench_now))
+                {
+                    errors++;
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < timers; i++)
+        stop (i);
+    if (!GKI_timer_list_empty (&bench_q))
+        errors++;
+
+    printf ("check: %lu operations, %lu expiries, %d errors\n",
+            (unsigned long) ops, (unsigned long) expired, errors);
+    return errors;
+}
+
+int main (int argc, char *argv[])
+{
+    unsigned long long t0, t1, t2, t3;
+    UINT32 timers = 20000, span = 60000, ops = 100000;
+    UINT32 i, steps = 0, expired = 0;
+    int opt, errors;
+
+    while ((opt = getopt (argc, argv, "n:s:c:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': timers = (UINT32) atol (optarg); break;
+        case 's': span   = (UINT32) atol (optarg); break;
+        case 'c': ops    = (UINT32) atol (optarg); break;
+        default:
+            fprintf (stderr, "usage: %s [-n <timers>] [-s <span>] [-c <check ops>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((timers == 0) || (span == 0) || (span > 0x7FFFFFFF))
+    {
+        fprintf (stderr, "timers and span must be positive\n");
+        return 1;
+    }
+
+    bench_tle      = (TIMER_LIST_ENT *) calloc (timers, sizeof (TIMER_LIST_ENT));
+    bench_deadline = (UINT32 *) malloc (timers * sizeof (UINT32));
+    if ((bench_tle == NULL) || (bench_deadline == NULL))
+    {
+        fprintf (stderr, "out of memory\n");
+        return 1;
+    }
+
+    GKI_init_timer_list (&bench_q);
+    for (i = 0; i < timers; i++)
+    {
+        GKI_init_timer_list_entry (&bench_tle[i]);
+        bench_deadline[i] = BENCH_NO_DEADLINE;
+    }
+
+#if (GKI_TIMER_WHEEL == TRUE)
+    printf ("backend: timing wheel, %d levels of %d slots\n", GKI_TW_LEVELS, GKI_TW_SIZE);
+#else
+    printf ("backend: delta list\n");
+#endif
+
+    if ((errors = check_model (timers, span, ops)) != 0)
+        return 1;
+
+    t0 = now_ns ();
+    for (i = 0; i < timers; i++)
+        start (i, (INT32) (1 + bench_rand () % span));
+    t1 = now_ns ();
+    for (i = 0; i < timers; i += 2)
+        stop (i);
+    t2 = now_ns ();
+    while (!GKI_timer_list_empty (&bench_q))
+    {
+        errors += update (1, FALSE, &expired);
+        steps++;
+    }
+    t3 = now_ns ();
+
+    printf ("%lu timers over 1..%lu units\n", (unsigned long) timers, (unsigned long) span);
+    printf ("start   %10.1f ns per timer\n", (double) (t1 - t0) / timers);
+    printf ("stop    %10.1f ns per timer\n", (double) (t2 - t1) / ((timers + 1) / 2));
+    printf ("update  %10.1f ns per unit, %lu units, %lu expiries\n",
+            (double) (t3 - t2) / (steps ? steps : 1), (unsigned long) steps, (unsigned long) expired);
+    if (expired != timers / 2)
+        errors++;
+
+    free (bench_tle);
+    free (bench_deadline);
+    return (errors) ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License")
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  NCI frame logging benchmark. Measures the cost per frame of
+ *  phNxpNciHal_print_packet at NCIX/NCIR log levels 0 to 3, for a short
+ *  control frame and a full data frame, two ways:
+ *    snprintf - the former function: hex string built with one snprintf
+ *               per byte in a VLA, whatever the log level
+ *    lazy     - phNxpNciHal_print_packet: level checked first, table
+ *               driven hex encoding
+ *  Log lines go to stderr, which is sent to /dev/null while timing. Both
+ *  are first checked to print the same lines at the debug level.
+ *
+ *  Usage: nfcLogBench [-n <frames>]
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include <phNxpNciHal_utils.h>
+#include <phNxpLog.h>
+
+typedef void (tBENCH_PRINT) (const char *pString, const uint8_t *p_data, uint16_t len);
+
+static const uint16_t bench_lens[] = { 8, 258 };
+
+/*******************************************************************************
+**
+** Function         snprintf_print_packet
+**
+** Description      phNxpNciHal_print_packet as it was before the lazy
+**                  formatting
+**
+*******************************************************************************/
+static void snprintf_print_packet(const char *pString, const uint8_t *p_data,
+        uint16_t len)
+{
+    uint32_t i;
+    char print_buffer[len * 3 + 1];
+
+    memset (print_buffer, 0, sizeof(print_buffer));
+    for (i = 0; i < len; i++) {
+        snprintf(&print_buffer[i * 2], 3, "%02X", p_data[i]);
+    }
+    if( 0 == memcmp(pString,"SEND",0x04))
+    {
+        NXPLOG_NCIX_D("len = %3d > %s", len, print_buffer);
+    }
+    else if( 0 == memcmp(pString,"RECV",0x04))
+    {
+        NXPLOG_NCIR_D("len = %3d > %s", len, print_buffer);
+    }
+
+    return;
+}
+
+/*******************************************************************************
+**
+** Function         now_ns
+**
+** Description      CLOCK_MONOTONIC in nanoseconds
+**
+*******************************************************************************/
+static unsigned long long now_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*******************************************************************************
+**
+** Function         set_level
+**
+** Description      Sets the NCIX and NCIR log levels
+**
+*******************************************************************************/
+static void set_level (UINT8 level)
+{
+    gLog_level.ncix_log_level = level;
+    gLog_level.ncir_log_level = level;
+}
+
+/*******************************************************************************
+**
+** Function         capture
+**
+** Description      Prints one SEND and one RECV frame of each length to a
+**                  temporary file and keeps the lines without their time
+**                  stamps
+**
+** Returns          number of bytes in buf, -1 on failure
+**
+*******************************************************************************/
+static int capture (tBENCH_PRINT *p_print, const uint8_t *p_frame, char *buf, int size)
+{
+    FILE *p_tmp = tmpfile ();
+    int saved, len = 0, c, skip = 1;
+    unsigned int i;
+
+    if (p_tmp == NULL)
+        return -1;
+
+    fflush (stderr);
+    saved = dup (2);
+    dup2 (fileno (p_tmp), 2);
+    for (i = 0; i < sizeof (bench_lens) / sizeof (bench_lens[0]); i++)
+    {
+        p_print ("SEND", p_frame, bench_lens[i]);
+        p_print ("RECV", p_frame, bench_lens[i]);
+    }
+    fflush (stderr);
+    dup2 (saved, 2);
+    close (saved);
+
+    rewind (p_tmp);
+    while (((c = fgetc (p_tmp)) != EOF) && (len < size - 1))
+    {
+        /* each line starts with a time stamp up to a tab */
+        if (skip)
+        {
+            skip = (c != '\t');
+            continue;
+        }
+        buf[len++] = (char) c;
+        if (c == '\n')
+            skip = 1;
+    }
+    buf[len] = '\0';
+    fclose (p_tmp);
+    return len;
+}
+
+/*******************************************************************************
+**
+** Function         run
+**
+** Description      Prints <frames> frames of <len> bytes, alternately SEND
+**                  and RECV
+**
+** Returns          nanoseconds per frame
+**
+*******************************************************************************/
+static double run (tBENCH_PRINT *p_print, const uint8_t *p_frame, uint16_t len, long frames)
+{
+    unsigned long long t0, t1;
+    long f;
+
+    t0 = now_ns ();
+    for (f = 0; f < frames; f++)
+        p_print ((f & 1) ? "RECV" : "SEND", p_frame, len);
+    t1 = now_ns ();
+    return (double) (t1 - t0) / (double) frames;
+}
+
+int main (int argc, char *argv[])
+{
+    static char before[4096], after[4096];
+    uint8_t frame[258];
+    double ns_snprintf, ns_lazy;
+    long frames = 200000;
+    int opt, saved, null_fd, level;
+    unsigned int i;
+
+    while ((opt = getopt (argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': frames = atol (optarg); break;
+        default:
+            fprintf (stderr, "usage: %s [-n <frames>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (frames <= 0)
+    {
+        fprintf (stderr, "frames must be positive\n");
+        return 1;
+    }
+
+    for (i = 0; i < sizeof (frame); i++)
+        frame[i] = (uint8_t) (i * 37 + 1);
+
+    set_level (NXPLOG_LOG_DEBUG_LOGLEVEL);
+    if ((capture (snprintf_print_packet, frame, before, sizeof (before)) <= 0)
+     || (capture (phNxpNciHal_print_packet, frame, after, sizeof (after)) <= 0)
+     || strcmp (before, after))
+    {
+        fprintf (stderr, "the two ways print different lines:\n%s---\n%s", before, after);
+        return 1;
+    }
+
+    if ((null_fd = open ("/dev/null", O_WRONLY)) < 0)
+        return 1;
+
+    printf ("level  bytes  snprintf ns/frame  lazy ns/frame\n");
+    for (level = 0; level <= NXPLOG_LOG_DEBUG_LOGLEVEL; level++)
+    {
+        set_level ((UINT8) level);
+        for (i = 0; i < sizeof (bench_lens) / sizeof (bench_lens[0]); i++)
+        {
+            /* printed lines cost the same both ways: time fewer of them */
+            long n = (level == NXPLOG_LOG_DEBUG_LOGLEVEL) ? (frames / 10 + 1) : frames;
+
+            fflush (stderr);
+            saved = dup (2);
+            dup2 (null_fd, 2);
+            ns_snprintf = run (snprintf_print_packet, frame, bench_lens[i], n);
+            ns_lazy     = run (phNxpNciHal_print_packet, frame, bench_lens[i], n);
+            fflush (stderr);
+            dup2 (saved, 2);
+            close (saved);
+
+            printf ("%5d  %5u  %17.1f  %13.1f\n", level, bench_lens[i], ns_snprintf, ns_lazy);
+        }
+    }
+    close (null_fd);
+    return 0;
+}
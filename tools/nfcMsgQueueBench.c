@@ -0,0 +1,334 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License")
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  TML/HAL message queue benchmark. <producers> threads each post
+ *  <messages> messages to one queue drained by the main thread, two ways:
+ *    list - the former queue: one malloc'ed item per message, appended
+ *           by walking the list from its head
+ *    ring - phDal4Nfc_msgget/msgsnd/msgrcv: ring of initially
+ *           PHDAL4NFC_MSGQ_DEPTH messages, doubled when full
+ *  Every message carries its producer and sequence number, and the
+ *  consumer checks that each producer's messages arrive in order.
+ *
+ *  Usage: nfcMsgQueueBench [-n <messages>] [-p <producers>]
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include <phDal4Nfc_messageQueueLib.h>
+
+#define BENCH_MAX_PRODUCERS     16
+
+typedef struct bench_queue_ops
+{
+    const char *name;
+    intptr_t (*msgget) (key_t key, int msgflg);
+    int      (*msgctl) (intptr_t msqid, int cmd, void *buf);
+    intptr_t (*msgsnd) (intptr_t msqid, phLibNfc_Message_t *msg, int msgflg);
+    int      (*msgrcv) (intptr_t msqid, phLibNfc_Message_t *msg, long msgtyp, int msgflg);
+} bench_queue_ops_t;
+
+typedef struct bench_producer
+{
+    pthread_t                  thread;
+    const bench_queue_ops_t   *p_ops;
+    intptr_t                   msqid;
+    uint32_t                   id;
+    uint32_t                   count;
+} bench_producer_t;
+
+/*******************************************************************************
+**
+** The former queue of phDal4Nfc_messageQueueLib.c, kept as it was apart
+** from the names and the error traces
+**
+*******************************************************************************/
+typedef struct list_item
+{
+    phLibNfc_Message_t nMsg;
+    struct list_item *pPrev;
+    struct list_item *pNext;
+} list_item_t;
+
+typedef struct list_queue
+{
+    list_item_t *pItems;
+    pthread_mutex_t nCriticalSectionMutex;
+    sem_t nProcessSemaphore;
+} list_queue_t;
+
+static intptr_t list_msgget(key_t key, int msgflg)
+{
+    list_queue_t *pQueue;
+    (void)key;
+    (void)msgflg;
+    pQueue = (list_queue_t *) malloc(sizeof(list_queue_t));
+    if (pQueue == NULL)
+        return -1;
+    memset(pQueue, 0, sizeof(list_queue_t));
+    if (pthread_mutex_init(&pQueue->nCriticalSectionMutex, NULL) == -1)
+    {
+        free(pQueue);
+        return -1;
+    }
+    if (sem_init(&pQueue->nProcessSemaphore, 0, 0) == -1)
+    {
+        free(pQueue);
+        return -1;
+    }
+    return ((intptr_t) pQueue);
+}
+
+static int list_msgctl(intptr_t msqid, int cmd, void *buf)
+{
+    list_queue_t *pQueue = (list_queue_t *) msqid;
+    list_item_t *p;
+    (void)cmd;
+    (void)buf;
+
+    while (NULL != (p = pQueue->pItems))
+    {
+        pQueue->pItems = p->pNext;
+        free(p);
+    }
+    sem_destroy(&pQueue->nProcessSemaphore);
+    pthread_mutex_destroy(&pQueue->nCriticalSectionMutex);
+    free(pQueue);
+    return 0;
+}
+
+static intptr_t list_msgsnd(intptr_t msqid, phLibNfc_Message_t *msg, int msgflg)
+{
+    list_queue_t *pQueue = (list_queue_t *) msqid;
+    list_item_t *p;
+    list_item_t *pNew;
+    (void)msgflg;
+
+    pNew = (list_item_t *) malloc(sizeof(list_item_t));
+    if (pNew == NULL)
+        return -1;
+    memset(pNew, 0, sizeof(list_item_t));
+    memcpy(&pNew->nMsg, msg, sizeof(phLibNfc_Message_t));
+    pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
+    if (pQueue->pItems != NULL)
+    {
+        p = pQueue->pItems;
+        while (p->pNext != NULL)
+        {
+            p = p->pNext;
+        }
+        p->pNext = pNew;
+        pNew->pPrev = p;
+    }
+    else
+    {
+        pQueue->pItems = pNew;
+    }
+    pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
+    sem_post(&pQueue->nProcessSemaphore);
+    return 0;
+}
+
+static int list_msgrcv(intptr_t msqid, phLibNfc_Message_t *msg, long msgtyp, int msgflg)
+{
+    list_queue_t *pQueue = (list_queue_t *) msqid;
+    list_item_t *p;
+    (void)msgtyp;
+    (void)msgflg;
+
+    sem_wait(&pQueue->nProcessSemaphore);
+    pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
+    if (pQueue->pItems != NULL)
+    {
+        memcpy(msg, &(pQueue->pItems)->nMsg, sizeof(phLibNfc_Message_t));
+        p = pQueue->pItems->pNext;
+        free(pQueue->pItems);
+        pQueue->pItems = p;
+    }
+    pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
+    return 0;
+}
+
+static const bench_queue_ops_t list_ops =
+{
+    "list", list_msgget, list_msgctl, list_msgsnd, list_msgrcv
+};
+
+static const bench_queue_ops_t ring_ops =
+{
+    "ring", phDal4Nfc_msgget, phDal4Nfc_msgctl, phDal4Nfc_msgsnd, phDal4Nfc_msgrcv
+};
+
+/*******************************************************************************
+**
+** Function         now_ns
+**
+** Description      CLOCK_MONOTONIC in nanoseconds
+**
+*******************************************************************************/
+static unsigned long long now_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*******************************************************************************
+**
+** Function         producer_thread
+**
+** Description      Posts <count> messages tagged with the producer id and
+**                  their sequence number
+**
+*******************************************************************************/
+static void *producer_thread (void *p_param)
+{
+    bench_producer_t *p_producer = (bench_producer_t *) p_param;
+    phLibNfc_Message_t msg;
+    uint32_t seq;
+
+    for (seq = 0; seq < p_producer->count; seq++)
+    {
+        msg.eMsgType = p_producer->id;
+        msg.pMsgData = NULL;
+        msg.Size     = seq;
+        if (p_producer->p_ops->msgsnd (p_producer->msqid, &msg, 0) != 0)
+        {
+            fprintf (stderr, "%s: producer %u failed to post message %u\n",
+                     p_producer->p_ops->name, p_producer->id, seq);
+            exit (1);
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         run
+**
+** Description      Runs the producers against one queue and drains it
+**
+** Returns          number of messages received out of order, nanoseconds
+**                  per message in *p_ns
+**
+*******************************************************************************/
+static long run (const bench_queue_ops_t *p_ops, int producers, uint32_t count, double *p_ns)
+{
+    bench_producer_t producer[BENCH_MAX_PRODUCERS];
+    uint32_t next_seq[BENCH_MAX_PRODUCERS];
+    phLibNfc_Message_t msg;
+    unsigned long long t0, t1;
+    unsigned long total = (unsigned long) producers * count, i;
+    long disorder = 0;
+    intptr_t msqid;
+    int p;
+
+    msqid = p_ops->msgget (0, 0600);
+    if ((msqid == 0) || (msqid == -1))
+    {
+        fprintf (stderr, "%s: msgget failed\n", p_ops->name);
+        exit (1);
+    }
+
+    memset (next_seq, 0, sizeof (next_seq));
+    t0 = now_ns ();
+    for (p = 0; p < producers; p++)
+    {
+        producer[p].p_ops = p_ops;
+        producer[p].msqid = msqid;
+        producer[p].id = (uint32_t) p;
+        producer[p].count = count;
+        if (pthread_create (&producer[p].thread, NULL, producer_thread, &producer[p]) != 0)
+        {
+            fprintf (stderr, "%s: pthread_create failed\n", p_ops->name);
+            exit (1);
+        }
+    }
+
+    for (i = 0; i < total; i++)
+    {
+        p_ops->msgrcv (msqid, &msg, 0, 0);
+        if ((msg.eMsgType >= (uint32_t) producers) || (msg.Size != next_seq[msg.eMsgType]))
+        {
+            disorder++;
+        }
+        if (msg.eMsgType < (uint32_t) producers)
+        {
+            next_seq[msg.eMsgType] = msg.Size + 1;
+        }
+    }
+    t1 = now_ns ();
+
+    for (p = 0; p < producers; p++)
+    {
+        pthread_join (producer[p].thread, NULL);
+    }
+    p_ops->msgctl (msqid, 0, NULL);
+
+    *p_ns = (double) (t1 - t0) / (double) total;
+    return disorder;
+}
+
+int main (int argc, char *argv[])
+{
+    const bench_queue_ops_t *ops[] = { &list_ops, &ring_ops };
+    int producers = 2;
+    long count = 100000;
+    double ns;
+    long disorder;
+    int opt, i, failed = 0;
+
+    while ((opt = getopt (argc, argv, "n:p:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': count = atol (optarg); break;
+        case 'p': producers = atoi (optarg); break;
+        default:
+            fprintf (stderr, "usage: %s [-n <messages>] [-p <producers>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((count <= 0) || (producers <= 0) || (producers > BENCH_MAX_PRODUCERS))
+    {
+        fprintf (stderr, "messages must be positive and producers 1 to %d\n", BENCH_MAX_PRODUCERS);
+        return 1;
+    }
+
+    printf ("%d producers x %ld messages, initial ring depth %d\n", producers, count, PHDAL4NFC_MSGQ_DEPTH);
+    for (i = 0; i < (int) (sizeof (ops) / sizeof (ops[0])); i++)
+    {
+        disorder = run (ops[i], producers, (uint32_t) count, &ns);
+        printf ("%s  %8.1f ns per message  %ld out of order\n", ops[i]->name, ns, disorder);
+        if (disorder)
+        {
+            failed = 1;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,317 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License")
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  NDEF read/write benchmark. Waits for a tag, then times NDEF detection,
+ *  reading and optionally writing back the NDEF message through the public
+ *  API. With the NCI trace of the stack (NXP_NCI_TRACE_FILE) it also counts
+ *  the round trips over RF: the ReadBinary/UpdateBinary C-APDUs sent to a
+ *  Type 4 tag, or the commands sent to a Type 2 tag.
+ *
+ *  Usage: nfcNdefBench [-n <reads>] [-w] [-t <trace file>] [-s <seconds>]
+ *
+ *  Run it against the mock NFCC with scenarios/t4t-ndef.scn, changing MLe
+ *  and MLc of the "t4t" statement to compare short and extended APDUs, with
+ *  scenarios/ntag216-ndef.scn to compare FAST_READ with READ, or with
+ *  scenarios/st25dv64k-ndef.scn to compare Read Multiple Blocks sizes.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "linux_nfc_api.h"
+#include "phNxpNciTrace.h"
+
+static pthread_mutex_t tag_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tag_cond = PTHREAD_COND_INITIALIZER;
+static int tag_present = 0;
+static nfc_tag_info_t tag_info;
+
+static const phNxpNciTrace_Header_t *trace_hdr = NULL;
+static const phNxpNciTrace_Record_t *trace_rec = NULL;
+
+/*******************************************************************************
+**
+** Function         on_tag_arrival / on_tag_departure
+**
+** Description      Tag callbacks of the stack
+**
+*******************************************************************************/
+static void on_tag_arrival (nfc_tag_info_t *p_info)
+{
+    pthread_mutex_lock (&tag_lock);
+    tag_info = *p_info;
+    tag_present = 1;
+    pthread_cond_signal (&tag_cond);
+    pthread_mutex_unlock (&tag_lock);
+}
+
+static void on_tag_departure (void)
+{
+    pthread_mutex_lock (&tag_lock);
+    tag_present = 0;
+    pthread_mutex_unlock (&tag_lock);
+}
+
+/*******************************************************************************
+**
+** Function         now_us
+**
+** Description      CLOCK_MONOTONIC in microseconds
+**
+*******************************************************************************/
+static unsigned long long now_us (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/*******************************************************************************
+**
+** Function         trace_open
+**
+** Description      Maps the NCI trace file written by the stack
+**
+** Returns          0 if success
+**
+*******************************************************************************/
+static int trace_open (const char *path)
+{
+    struct stat st;
+    void *p;
+    int fd;
+
+    if ((fd = open (path, O_RDONLY)) < 0)
+    {
+        perror (path);
+        return -1;
+    }
+    if ((fstat (fd, &st) < 0) || ((size_t) st.st_size < sizeof (phNxpNciTrace_Header_t)))
+    {
+        fprintf (stderr, "%s: not a trace file\n", path);
+        close (fd);
+        return -1;
+    }
+    p = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (p == MAP_FAILED)
+    {
+        perror ("mmap");
+        return -1;
+    }
+
+    trace_hdr = (const phNxpNciTrace_Header_t *) p;
+    if (  (trace_hdr->magic != PHNXPNCI_TRACE_MAGIC)
+        ||(trace_hdr->record_size != sizeof (phNxpNciTrace_Record_t))
+        ||(sizeof (*trace_hdr) + (size_t) trace_hdr->slot_count * sizeof (*trace_rec) > (size_t) st.st_size)  )
+    {
+        fprintf (stderr, "%s: unsupported trace file\n", path);
+        munmap (p, st.st_size);
+        trace_hdr = NULL;
+        return -1;
+    }
+    trace_rec = (const phNxpNciTrace_Record_t *) (trace_hdr + 1);
+    return 0;
+}
+
+/*******************************************************************************
+**
+** Function         trace_seq
+**
+** Description      Last sequence number of the trace
+**
+*******************************************************************************/
+static unsigned long long trace_seq (void)
+{
+    return (trace_hdr) ? __atomic_load_n (&trace_hdr->next_seq, __ATOMIC_ACQUIRE) : 0;
+}
+
+/*******************************************************************************
+**
+** Function         trace_round_trips
+**
+** Description      Counts the commands the stack sent to the tag between two
+**                  sequence numbers: ReadBinary/UpdateBinary C-APDUs for ISO-DEP,
+**                  every command for the other protocols. A command segmented
+**                  over several data packets is counted once.
+**
+** Returns          number of C-APDUs, -1 if the trace wrapped or is absent
+**
+*******************************************************************************/
+static long trace_round_trips (unsigned long long from, unsigned long long to)
+{
+    const phNxpNciTrace_Record_t *rec;
+    unsigned long long seq;
+    int in_chain = 0;
+    long count = 0;
+    unsigned char ins;
+
+    if ((trace_hdr == NULL) || (to - from > trace_hdr->slot_count))
+        return -1;
+
+    for (seq = from + 1; seq <= to; seq++)
+    {
+        rec = &trace_rec[(seq - 1) & (trace_hdr->slot_count - 1)];
+        if (  (rec->seq != seq)
+            ||(rec->direction != PHNXPNCI_TRACE_DIR_STACK_TX)
+            ||(rec->length < 4)
+            ||((rec->data[0] & 0xE0) != 0x00)  )
+        {
+            continue;
+        }
+        if (!in_chain)
+        {
+            ins = (rec->length > 4) ? rec->data[4] : 0;
+            if (  (tag_info.protocol != NFA_PROTOCOL_ISO_DEP)
+                ||(ins == 0xB0) || (ins == 0xB1) || (ins == 0xD6) || (ins == 0xD7)  )
+                count++;
+        }
+        in_chain = (rec->data[0] & 0x10) != 0;
+    }
+    return count;
+}
+
+/*******************************************************************************
+**
+** Function         report
+**
+** Description      Prints one timed operation
+**
+*******************************************************************************/
+static void report (const char *op, int len, unsigned long long t0, unsigned long long t1,
+                    unsigned long long s0, unsigned long long s1)
+{
+    long rt = trace_round_trips (s0, s1);
+
+    printf ("%-8s %7d bytes %10.3f ms", op, len, (t1 - t0) / 1000.0);
+    if (rt >= 0)
+        printf (" %6ld round trips", rt);
+    printf ("\n");
+}
+
+int main (int argc, char *argv[])
+{
+    nfcTagCallback_t cb = { on_tag_arrival, on_tag_departure };
+    nfc_friendly_type_t type;
+    ndef_info_t info;
+    unsigned long long t0, t1, s0, s1;
+    struct timespec deadline;
+    unsigned char *buf;
+    int reads = 1, do_write = 0, wait_s = 10;
+    const char *trace = NULL;
+    int opt, i, len, ret = 1;
+
+    while ((opt = getopt (argc, argv, "n:wt:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': reads = atoi (optarg); break;
+        case 'w': do_write = 1; break;
+        case 't': trace = optarg; break;
+        case 's': wait_s = atoi (optarg); break;
+        default:
+            fprintf (stderr, "usage: %s [-n <reads>] [-w] [-t <trace file>] [-s <seconds>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (nfcManager_doInitialize () != 0)
+    {
+        fprintf (stderr, "cannot initialize the NFC stack\n");
+        return 1;
+    }
+    if ((trace != NULL) && (trace_open (trace) != 0))
+        fprintf (stderr, "round trips are not counted\n");
+
+    nfcManager_registerTagCallback (&cb);
+    nfcManager_enableDiscovery (DEFAULT_NFA_TECH_MASK, 1, 0, 0);
+
+    clock_gettime (CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += wait_s;
+    pthread_mutex_lock (&tag_lock);
+    while (!tag_present)
+    {
+        if (pthread_cond_timedwait (&tag_cond, &tag_lock, &deadline) != 0)
+            break;
+    }
+    pthread_mutex_unlock (&tag_lock);
+    if (!tag_present)
+    {
+        fprintf (stderr, "no tag found\n");
+        goto out;
+    }
+    printf ("tag: technology 0x%X, protocol 0x%X\n", tag_info.technology, tag_info.protocol);
+
+    s0 = trace_seq (); t0 = now_us ();
+    if (!nfcTag_isNdef (tag_info.handle, &info))
+    {
+        fprintf (stderr, "no NDEF message\n");
+        goto out;
+    }
+    t1 = now_us (); s1 = trace_seq ();
+    report ("detect", info.current_ndef_length, t0, t1, s0, s1);
+
+    if ((buf = (unsigned char *) malloc (info.current_ndef_length + 1)) == NULL)
+        goto out;
+
+    for (i = 0; i < reads; i++)
+    {
+        s0 = trace_seq (); t0 = now_us ();
+        len = nfcTag_readNdef (tag_info.handle, buf, info.current_ndef_length, &type);
+        t1 = now_us (); s1 = trace_seq ();
+        if (len < 0)
+        {
+            fprintf (stderr, "read failed\n");
+            free (buf);
+            goto out;
+        }
+        report ("read", len, t0, t1, s0, s1);
+    }
+
+    if (do_write)
+    {
+        s0 = trace_seq (); t0 = now_us ();
+        if (nfcTag_writeNdef (tag_info.handle, buf, info.current_ndef_length) != 0)
+        {
+            fprintf (stderr, "write failed\n");
+            free (buf);
+            goto out;
+        }
+        t1 = now_us (); s1 = trace_seq ();
+        report ("write", info.current_ndef_length, t0, t1, s0, s1);
+    }
+    free (buf);
+    ret = 0;
+
+out:
+    nfcManager_disableDiscovery ();
+    nfcManager_deregisterTagCallback ();
+    nfcManager_doDeinitialize ();
+    return ret;
+}
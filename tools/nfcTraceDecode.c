@@ -0,0 +1,259 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License")
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Host side decoder for the binary NCI trace written by phNxpNciTrace.
+ *  Reads a trace file (or a dump of one) and prints every frame, oldest
+ *  first, with the NCI header decoded.
+ *
+ *  The tool only depends on the C library, so it can be built for the host
+ *  when the stack itself is cross compiled:
+ *      cc -Isrc/halimpl/pn54x/log -Isrc/libnfc-nci/hal/include
+ *         -Isrc/libnfc-nci/gki/ulinux tools/nfcTraceDecode.c -o nfcTraceDecode
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "data_types.h"
+#include "nci_defs.h"
+#include "phNxpNciTrace.h"
+
+typedef struct
+{
+    UINT8 gid;
+    UINT8 oid;
+    const char *name;
+} tNCI_MSG_NAME;
+
+#define NCI_NAME(gid, msg)  { NCI_GID_##gid, NCI_MSG_##msg, #msg }
+
+static const tNCI_MSG_NAME nci_msg_names[] =
+{
+    NCI_NAME (CORE, CORE_RESET),
+    NCI_NAME (CORE, CORE_INIT),
+    NCI_NAME (CORE, CORE_SET_CONFIG),
+    NCI_NAME (CORE, CORE_GET_CONFIG),
+    NCI_NAME (CORE, CORE_CONN_CREATE),
+    NCI_NAME (CORE, CORE_CONN_CLOSE),
+    NCI_NAME (CORE, CORE_CONN_CREDITS),
+    NCI_NAME (CORE, CORE_GEN_ERR_STATUS),
+    NCI_NAME (CORE, CORE_INTF_ERR_STATUS),
+    NCI_NAME (RF_MANAGE, RF_DISCOVER_MAP),
+    NCI_NAME (RF_MANAGE, RF_SET_ROUTING),
+    NCI_NAME (RF_MANAGE, RF_GET_ROUTING),
+    NCI_NAME (RF_MANAGE, RF_DISCOVER),
+    NCI_NAME (RF_MANAGE, RF_DISCOVER_SELECT),
+    NCI_NAME (RF_MANAGE, RF_INTF_ACTIVATED),
+    NCI_NAME (RF_MANAGE, RF_DEACTIVATE),
+    NCI_NAME (RF_MANAGE, RF_FIELD),
+    NCI_NAME (RF_MANAGE, RF_T3T_POLLING),
+    NCI_NAME (RF_MANAGE, RF_EE_ACTION),
+    NCI_NAME (RF_MANAGE, RF_EE_DISCOVERY_REQ),
+    NCI_NAME (RF_MANAGE, RF_PARAMETER_UPDATE),
+    NCI_NAME (EE_MANAGE, NFCEE_DISCOVER),
+    NCI_NAME (EE_MANAGE, NFCEE_MODE_SET),
+};
+
+static const char *mt_names[] = { "DATA", "CMD", "RSP", "NTF" };
+
+/*******************************************************************************
+**
+** Function         msg_name
+**
+** Description      Looks up the name of a control message.
+**
+** Returns          Message name, or NULL if unknown
+**
+*******************************************************************************/
+static const char *msg_name (UINT8 gid, UINT8 oid)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(nci_msg_names) / sizeof(nci_msg_names[0]); i++)
+    {
+        if ((nci_msg_names[i].gid == gid) && (nci_msg_names[i].oid == oid))
+            return nci_msg_names[i].name;
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         compare_seq
+**
+** Description      qsort helper, orders records by sequence number.
+**
+** Returns          <0, 0 or >0
+**
+*******************************************************************************/
+static int compare_seq (const void *a, const void *b)
+{
+    const phNxpNciTrace_Record_t *ra = *(const phNxpNciTrace_Record_t * const *) a;
+    const phNxpNciTrace_Record_t *rb = *(const phNxpNciTrace_Record_t * const *) b;
+
+    return (ra->seq > rb->seq) - (ra->seq < rb->seq);
+}
+
+/*******************************************************************************
+**
+** Function         print_record
+**
+** Description      Prints one frame: wall clock time, delta to the previous
+**                  frame, direction, decoded header and raw bytes.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void print_record (const phNxpNciTrace_Header_t *hdr, const phNxpNciTrace_Record_t *rec,
+        UINT64 prev_ns)
+{
+    UINT64 wall_ns = rec->timestamp_ns + hdr->realtime_offset_ns;
+    time_t secs = (time_t) (wall_ns / 1000000000ULL);
+    UINT16 stored = (rec->length < PHNXPNCI_TRACE_MAX_DATA) ? rec->length : PHNXPNCI_TRACE_MAX_DATA;
+    const char *dir;
+    char when[32];
+    char desc[64];
+    struct tm tm_info;
+    UINT16 i;
+
+    switch (rec->direction)
+    {
+    case PHNXPNCI_TRACE_DIR_TX:         dir = "TX "; break;
+    case PHNXPNCI_TRACE_DIR_RX:         dir = "RX "; break;
+    case PHNXPNCI_TRACE_DIR_STACK_TX:   dir = "STK"; break;
+    default:                            dir = "???"; break;
+    }
+
+    localtime_r (&secs, &tm_info);
+    strftime (when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm_info);
+
+    desc[0] = '\0';
+    if (stored >= NCI_MSG_HDR_SIZE)
+    {
+        UINT8 mt = (rec->data[0] & NCI_MT_MASK) >> NCI_MT_SHIFT;
+        UINT8 pbf = (rec->data[0] & NCI_PBF_MASK) >> NCI_PBF_SHIFT;
+
+        if (mt == NCI_MT_DATA)
+        {
+            snprintf (desc, sizeof(desc), "DATA conn=%u%s", rec->data[0] & NCI_CID_MASK,
+                    pbf ? " (frag)" : "");
+        }
+        else if (mt <= NCI_MT_NTF)
+        {
+            UINT8 gid = rec->data[0] & NCI_GID_MASK;
+            UINT8 oid = rec->data[1] & NCI_OID_MASK;
+            const char *name = msg_name (gid, oid);
+
+            if (name)
+                snprintf (desc, sizeof(desc), "%s %s", mt_names[mt], name);
+            else if (gid == NCI_GID_PROP)
+                snprintf (desc, sizeof(desc), "%s PROP oid=0x%02X", mt_names[mt], oid);
+            else
+                snprintf (desc, sizeof(desc), "%s gid=0x%X oid=0x%02X", mt_names[mt], gid, oid);
+            if ((mt == NCI_MT_RSP) && (stored > NCI_MSG_HDR_SIZE))
+            {
+                size_t used = strlen (desc);
+                snprintf (desc + used, sizeof(desc) - used, " status=0x%02X",
+                        rec->data[NCI_MSG_HDR_SIZE]);
+            }
+        }
+        else
+        {
+            snprintf (desc, sizeof(desc), "MT=%u", mt);
+        }
+    }
+
+    printf ("%s.%06lu +%9.6f %s %-40s len=%-3u ", when,
+            (unsigned long) ((wall_ns % 1000000000ULL) / 1000),
+            prev_ns ? (double) (rec->timestamp_ns - prev_ns) / 1e9 : 0.0,
+            dir, desc, rec->length);
+    for (i = 0; i < stored; i++)
+        printf ("%02X", rec->data[i]);
+    if (stored < rec->length)
+        printf ("...");
+    printf ("\n");
+}
+
+int main (int argc, char *argv[])
+{
+    phNxpNciTrace_Header_t hdr;
+    phNxpNciTrace_Record_t *records;
+    phNxpNciTrace_Record_t **order;
+    size_t count, used, i;
+    UINT64 prev_ns = 0;
+    FILE *fp;
+
+    if (argc != 2)
+    {
+        fprintf (stderr, "usage: %s <trace file>\n", argv[0]);
+        return 2;
+    }
+    fp = fopen (argv[1], "rb");
+    if (fp == NULL)
+    {
+        perror (argv[1]);
+        return 1;
+    }
+    if ((fread (&hdr, sizeof(hdr), 1, fp) != 1)
+            || (hdr.magic != PHNXPNCI_TRACE_MAGIC)
+            || (hdr.version != PHNXPNCI_TRACE_VERSION)
+            || (hdr.record_size != sizeof(phNxpNciTrace_Record_t)))
+    {
+        fprintf (stderr, "%s: not an NCI trace (or written by another version)\n", argv[1]);
+        fclose (fp);
+        return 1;
+    }
+
+    records = calloc (hdr.slot_count, sizeof(*records));
+    order = calloc (hdr.slot_count, sizeof(*order));
+    if ((records == NULL) || (order == NULL))
+    {
+        fprintf (stderr, "out of memory\n");
+        fclose (fp);
+        return 1;
+    }
+    count = fread (records, sizeof(*records), hdr.slot_count, fp);
+    fclose (fp);
+
+    for (i = 0, used = 0; i < count; i++)
+    {
+        if (records[i].seq != 0)
+            order[used++] = &records[i];
+    }
+    qsort (order, used, sizeof(*order), compare_seq);
+
+    printf ("# %zu of %llu frames, %u slots\n", used,
+            (unsigned long long) hdr.next_seq, hdr.slot_count);
+    for (i = 0; i < used; i++)
+    {
+        if ((i > 0) && (order[i]->seq != order[i - 1]->seq + 1))
+            printf ("# %llu frames lost\n",
+                    (unsigned long long) (order[i]->seq - order[i - 1]->seq - 1));
+        print_record (&hdr, order[i], prev_ns);
+        prev_ns = order[i]->timestamp_ns;
+    }
+
+    free (order);
+    free (records);
+    return 0;
+}
@@ -0,0 +1,202 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2026 The libnfc-nci Linux contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License")
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  NDEF update benchmark for the TML write queue. Waits for a tag, then
+ *  writes a MIME record of <bytes> bytes <writes> times through the public
+ *  API and prints the NDEF bytes written per second, with the
+ *  NXP_ASYNC_DATA_WRITE setting the HAL ran with. The message is read back
+ *  and compared at the end.
+ *
+ *  Usage: nfcWriteQueueBench [-n <writes>] [-b <bytes>] [-s <seconds>]
+ *
+ *  The HAL reads NXP_ASYNC_DATA_WRITE when it opens, so run it once with
+ *  NXP_ASYNC_DATA_WRITE=0x00 and once with 0x01 in libnfc-nxp-init.conf.
+ *  Against the mock NFCC (--enable-mock), use scenarios/t4t-write.scn. It
+ *  puts the NFCC behind a 400 kbit/s I2C bus, so that data packets take as
+ *  long to write as on a PN7150; change its "i2c" and "latency" statements
+ *  to see where queuing pays.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "linux_nfc_api.h"
+#include "phNxpConfig.h"
+
+static pthread_mutex_t tag_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tag_cond = PTHREAD_COND_INITIALIZER;
+static int tag_present = 0;
+static nfc_tag_info_t tag_info;
+
+/*******************************************************************************
+**
+** Function         on_tag_arrival / on_tag_departure
+**
+** Description      Tag callbacks of the stack
+**
+*******************************************************************************/
+static void on_tag_arrival (nfc_tag_info_t *p_info)
+{
+    pthread_mutex_lock (&tag_lock);
+    tag_info = *p_info;
+    tag_present = 1;
+    pthread_cond_signal (&tag_cond);
+    pthread_mutex_unlock (&tag_lock);
+}
+
+static void on_tag_departure (void)
+{
+    pthread_mutex_lock (&tag_lock);
+    tag_present = 0;
+    pthread_mutex_unlock (&tag_lock);
+}
+
+/*******************************************************************************
+**
+** Function         now_us
+**
+** Description      CLOCK_MONOTONIC in microseconds
+**
+*******************************************************************************/
+static unsigned long long now_us (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+int main (int argc, char *argv[])
+{
+    nfcTagCallback_t cb = { on_tag_arrival, on_tag_departure };
+    nfc_friendly_type_t type;
+    ndef_info_t info;
+    unsigned long long t0, t1;
+    unsigned long async_write = 0;
+    struct timespec deadline;
+    unsigned char *payload = NULL, *msg = NULL, *check = NULL;
+    int writes = 10, bytes = 16384, wait_s = 10;
+    int opt, i, len, ret = 1;
+
+    while ((opt = getopt (argc, argv, "n:b:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': writes = atoi (optarg); break;
+        case 'b': bytes = atoi (optarg); break;
+        case 's': wait_s = atoi (optarg); break;
+        default:
+            fprintf (stderr, "usage: %s [-n <writes>] [-b <bytes>] [-s <seconds>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((writes <= 0) || (bytes <= 0))
+    {
+        fprintf (stderr, "writes and bytes must be positive\n");
+        return 1;
+    }
+
+    /* as the HAL will read it from libnfc-nxp-init.conf */
+    GetNxpNumValue (NAME_NXP_ASYNC_DATA_WRITE, &async_write, sizeof (async_write));
+    if (nfcManager_doInitialize () != 0)
+    {
+        fprintf (stderr, "cannot initialize the NFC stack\n");
+        return 1;
+    }
+
+    nfcManager_registerTagCallback (&cb);
+    nfcManager_enableDiscovery (DEFAULT_NFA_TECH_MASK, 1, 0, 0);
+
+    clock_gettime (CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += wait_s;
+    pthread_mutex_lock (&tag_lock);
+    while (!tag_present)
+    {
+        if (pthread_cond_timedwait (&tag_cond, &tag_lock, &deadline) != 0)
+            break;
+    }
+    pthread_mutex_unlock (&tag_lock);
+    if (!tag_present)
+    {
+        fprintf (stderr, "no tag found\n");
+        goto out;
+    }
+    printf ("tag: technology 0x%X, protocol 0x%X\n", tag_info.technology, tag_info.protocol);
+
+    if (!nfcTag_isNdef (tag_info.handle, &info) || !info.is_writable)
+    {
+        fprintf (stderr, "no writable NDEF tag\n");
+        goto out;
+    }
+
+    /* one MIME record, with room for its header and type */
+    if (bytes > (int) info.max_ndef_length)
+        bytes = (int) info.max_ndef_length;
+    payload = (unsigned char *) malloc (bytes);
+    msg     = (unsigned char *) malloc (bytes);
+    check   = (unsigned char *) malloc (bytes);
+    if ((payload == NULL) || (msg == NULL) || (check == NULL))
+        goto out;
+    for (i = 0; i < bytes; i++)
+        payload[i] = (unsigned char) (i * 37 + 1);
+    len = ndef_createMime ("x/y", payload, (bytes > 16) ? bytes - 16 : 1, msg, bytes);
+    if (len <= 0)
+    {
+        fprintf (stderr, "cannot build a %d byte NDEF message\n", bytes);
+        goto out;
+    }
+
+    t0 = now_us ();
+    for (i = 0; i < writes; i++)
+    {
+        if (nfcTag_writeNdef (tag_info.handle, msg, len) != 0)
+        {
+            fprintf (stderr, "write %d failed\n", i);
+            goto out;
+        }
+    }
+    t1 = now_us ();
+
+    if (  (nfcTag_readNdef (tag_info.handle, check, bytes, &type) != len)
+        ||(memcmp (check, msg, len) != 0)  )
+    {
+        fprintf (stderr, "the message read back differs\n");
+        goto out;
+    }
+
+    printf ("NXP_ASYNC_DATA_WRITE=0x%02lX  %d writes of %d bytes  %8.3f ms per write  %8.1f kB/s\n",
+            async_write, writes, len, (t1 - t0) / 1000.0 / writes,
+            (double) len * writes * 1000.0 / (double) (t1 - t0));
+    ret = 0;
+
+out:
+    free (payload);
+    free (msg);
+    free (check);
+    nfcManager_disableDiscovery ();
+    nfcManager_deregisterTagCallback ();
+    nfcManager_doDeinitialize ();
+    return ret;
+}